@@ -17,6 +17,9 @@ int main(int argc, char* argv[]) {
 
 	w.SetTitle("Sample window");
 
+	FramePacer pacer;
+	pacer.MatchDisplay(w.GetDisplay());
+
 	for (int frame = 0; input.running; frame++) {
 		input.Update();
 
@@ -29,7 +32,7 @@ int main(int argc, char* argv[]) {
 
 		r.Present();
 
-		Delay(16);
+		pacer.Wait();
 	}
 	Quit();
 
@@ -0,0 +1,504 @@
+// Benchmarks of the wrapper's hot paths against the SDL calls they wrap.
+//
+// Runs headless: drawing goes to a software renderer on a Surface, and events
+// are pushed into SDL's queue rather than read from a window.  Results are
+// written to stdout as JSON, one entry per group and implementation, so runs
+// can be diffed; a readable table goes to stderr.  Each result also counts the
+// C++ heap allocations made per operation.  The frame.hotpath group must make
+// none, and the run fails if it does, or if a check of drawing output fails.
+//
+//   Bench [--filter text] [--time seconds] [--samples n] [--out file]
+
+#include <SDL.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace SDL;
+
+// Stops the compiler from dropping work whose result is otherwise unused
+static volatile Uint64 sink;
+
+// Every operator new in the program, counted so results can show what allocates.
+// SDL's own mallocs are not seen
+static std::atomic<Uint64> allocations{ 0 };
+
+void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+struct Result {
+	std::string group;
+	std::string impl;
+	// The operations done by one call of the benchmark, e.g. sprites drawn
+	int ops;
+	double nsPerOp;
+	double allocsPerOp;
+};
+
+struct Bench {
+	const char* filter = NULL;
+	double seconds = 0.25;
+	int samples = 7;
+	std::vector<Result> results;
+	// Set when a group that must not allocate did, or a check failed
+	bool failed = false;
+
+	bool Wanted(const char* group) const { return filter == NULL || strstr(group, filter) != NULL; }
+
+	// Times \c run, which does \c ops operations per call, and keeps the median of the samples
+	void Run(const char* group, const std::string& impl, int ops, const std::function<void()>& run) {
+		if (!Wanted(group)) return;
+
+		double frequency = (double)SDL_GetPerformanceFrequency();
+		Uint64 start = SDL_GetPerformanceCounter();
+		run();
+		double once = std::max((SDL_GetPerformanceCounter() - start) / frequency, 1e-7);
+		int calls = std::max(1, (int)(seconds / samples / once));
+
+		std::vector<double> times;
+		times.reserve(samples);
+		Uint64 allocated = 0;
+		for (int s = 0; s < samples; s++) {
+			Uint64 before = allocations.load(std::memory_order_relaxed);
+			start = SDL_GetPerformanceCounter();
+			for (int i = 0; i < calls; i++) run();
+			times.push_back((SDL_GetPerformanceCounter() - start) / frequency);
+			allocated += allocations.load(std::memory_order_relaxed) - before;
+		}
+		std::nth_element(times.begin(), times.begin() + samples / 2, times.end());
+
+		double perOp = (double)calls * ops;
+		results.push_back({ group, impl, ops, times[samples / 2] * 1e9 / perOp, allocated / (samples * perOp) });
+		fprintf(stderr, "%-24s %-16s %12.2f ns/op %8.3f allocs/op", group, impl.c_str(), results.back().nsPerOp, results.back().allocsPerOp);
+		for (const Result& r : results)
+			if (r.group == group && r.impl == "sdl" && impl != "sdl") fprintf(stderr, "  %6.2fx", r.nsPerOp / results.back().nsPerOp);
+		fprintf(stderr, "\n");
+	}
+
+	void Write(FILE* file) const {
+		SDL_version version;
+		SDL_GetVersion(&version);
+		fprintf(file, "{\n  \"sdl\": \"%d.%d.%d\",\n  \"simd\": \"%s\",\n  \"results\": [\n", version.major, version.minor, version.patch, SIMD::GetLevelName(SIMD::GetSupportedLevel()));
+		for (size_t i = 0; i < results.size(); i++) {
+			const Result& r = results[i];
+			fprintf(file, "    { \"group\": \"%s\", \"impl\": \"%s\", \"ops\": %d, \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f }%s\n", r.group.c_str(), r.impl.c_str(), r.ops, r.nsPerOp, r.allocsPerOp, i + 1 < results.size() ? "," : "");
+		}
+		fprintf(file, "  ]\n}\n");
+	}
+};
+
+// Runs \c run once for each SIMD level the CPU has, named after the level
+static void RunLevels(Bench& bench, const char* group, int ops, const std::function<void()>& run) {
+	const SIMD::Level levels[] = { SIMD::Level::SCALAR, SIMD::Level::SSE2, SIMD::Level::SSE41, SIMD::Level::AVX2, SIMD::Level::NEON };
+	SIMD::Level original = SIMD::GetLevel();
+	for (SIMD::Level level : levels)
+		if (SIMD::SetLevel(level)) bench.Run(group, std::string("sdlpp-") + SIMD::GetLevelName(level), ops, run);
+	SIMD::SetLevel(original);
+}
+
+static const int WIDTH = 640, HEIGHT = 480;
+static const int COUNT = 1000;
+
+// A repeatable spread of rectangles over the target
+static std::vector<Rect> Scatter(int count, int size) {
+	std::vector<Rect> rects;
+	Uint32 seed = 12345;
+	for (int i = 0; i < count; i++) {
+		seed = seed * 1664525 + 1013904223;
+		int x = (int)(seed >> 8) % (WIDTH - size);
+		seed = seed * 1664525 + 1013904223;
+		int y = (int)(seed >> 8) % (HEIGHT - size);
+		rects.push_back(Rect(x, y, size, size));
+	}
+	return rects;
+}
+
+static void Sprites(Bench& bench, Renderer& renderer) {
+	Surface image(0, 32, 32, SDL_PIXELFORMAT_RGBA32);
+	image.Fill(0xFF8040C0);
+	Texture texture(renderer, image);
+	texture.SetBlendMode(SDL_BLENDMODE_BLEND);
+
+	Rect src(0, 0, 32, 32);
+	std::vector<Rect> dst = Scatter(COUNT, 32);
+	std::vector<FRect> fdst;
+	for (const Rect& r : dst) fdst.push_back(FRect((float)r.x, (float)r.y, (float)r.w, (float)r.h));
+
+	bench.Run("sprites.copy", "sdl", COUNT, [&] {
+		for (const Rect& r : dst) SDL_RenderCopy(renderer.renderer, texture.texture, &src.rect, &r.rect);
+		SDL_RenderFlush(renderer.renderer);
+	});
+	bench.Run("sprites.copy", "sdlpp", COUNT, [&] {
+		for (const Rect& r : dst) texture.Copy(src, r);
+		renderer.Flush();
+	});
+
+	bench.Run("sprites.copyf", "sdl", COUNT, [&] {
+		for (const FRect& r : fdst) SDL_RenderCopyF(renderer.renderer, texture.texture, &src.rect, &r.rect);
+		SDL_RenderFlush(renderer.renderer);
+	});
+	bench.Run("sprites.copyf", "sdlpp", COUNT, [&] {
+		for (const FRect& r : fdst) texture.CopyF(src, r);
+		renderer.Flush();
+	});
+#if SDL_VERSION_ATLEAST(2,0,18)
+	SpriteBatch batch(renderer, COUNT);
+	bench.Run("sprites.copyf", "sdlpp-batch", COUNT, [&] {
+		for (const FRect& r : fdst) batch.Draw(texture, src, r);
+		batch.Flush();
+		renderer.Flush();
+	});
+#endif
+}
+
+static void Primitives(Bench& bench, Renderer& renderer) {
+	std::vector<Rect> rects = Scatter(COUNT, 8);
+	std::vector<Point> points;
+	for (const Rect& r : rects) points.push_back(Point(r.x, r.y));
+
+	renderer.SetDrawColor(255, 255, 255, 255);
+	bench.Run("primitives.fillrect", "sdl", COUNT, [&] {
+		for (const Rect& r : rects) SDL_RenderFillRect(renderer.renderer, &r.rect);
+		SDL_RenderFlush(renderer.renderer);
+	});
+	bench.Run("primitives.fillrect", "sdlpp", COUNT, [&] {
+		for (const Rect& r : rects) renderer.FillRect(r);
+		renderer.Flush();
+	});
+
+	bench.Run("primitives.fillrects", "sdl", COUNT, [&] {
+		SDL_RenderFillRects(renderer.renderer, (const SDL_Rect*)rects.data(), (int)rects.size());
+		SDL_RenderFlush(renderer.renderer);
+	});
+	bench.Run("primitives.fillrects", "sdlpp", COUNT, [&] {
+		renderer.FillRects(rects);
+		renderer.Flush();
+	});
+
+	bench.Run("primitives.lines", "sdl", COUNT, [&] {
+		SDL_RenderDrawLines(renderer.renderer, (const SDL_Point*)points.data(), (int)points.size());
+		SDL_RenderFlush(renderer.renderer);
+	});
+	bench.Run("primitives.lines", "sdlpp", COUNT, [&] {
+		renderer.DrawLines(points);
+		renderer.Flush();
+	});
+
+	bench.Run("primitives.points", "sdl", COUNT, [&] {
+		SDL_RenderDrawPoints(renderer.renderer, (const SDL_Point*)points.data(), (int)points.size());
+		SDL_RenderFlush(renderer.renderer);
+	});
+	bench.Run("primitives.points", "sdlpp", COUNT, [&] {
+		renderer.DrawPoints(points);
+		renderer.Flush();
+	});
+}
+
+// The calls a frame makes over and over, through the overloads meant for them:
+// pointer and count draws, non-owning texture handles and formatting into a
+// buffer.  None of them may allocate
+static void HotPaths(Bench& bench, Renderer& renderer) {
+	const char* group = "frame.hotpath";
+	if (!bench.Wanted(group)) return;
+
+	Surface image(0, 16, 16, SDL_PIXELFORMAT_RGBA32);
+	image.Fill(0xFFFFFFFF);
+	Texture texture(renderer, image);
+	std::vector<Rect> rects = Scatter(64, 16);
+	Point points[64];
+	for (int i = 0; i < 64; i++) points[i] = Point(rects[i].x, rects[i].y);
+	Rect src(0, 0, 16, 16);
+	char text[128];
+
+	bench.Run(group, "sdlpp", 64, [&] {
+		renderer.DrawLines(points, 64);
+		renderer.DrawPoints(points, 64);
+		renderer.FillRects(rects.data(), (int)rects.size());
+		TextureRef ref = texture;
+		int length = 0;
+		for (const Rect& r : rects) {
+			ref.Copy(src, r);
+			length += r.Format(text, sizeof(text));
+		}
+		length += (int)GetVideoDriverName(0).size();
+		renderer.Flush();
+		sink = length;
+	});
+	if (bench.results.back().allocsPerOp != 0) {
+		fprintf(stderr, "%s allocated on the heap\n", group);
+		bench.failed = true;
+	}
+}
+
+// Checks of output the timings would not catch, which fail the run like an allocating hot path
+static void Checks(Bench& bench, Renderer& renderer) {
+#if SDL_VERSION_ATLEAST(2,0,18)
+	// A right-angle corner 10 wide gets its outer miter point, not a bevel
+	ShapeBatch shapes(renderer);
+	const FPoint corner[] = { FPoint(0, 0), FPoint(100, 0), FPoint(100, 100) };
+	shapes.DrawLines(corner, 3, 10, { 255, 255, 255, 255 }, ShapeBatch::Join::MITER);
+	bool mitered = false;
+	for (const Vertex& v : shapes.vertices)
+		if (std::fabs(v.position.x - 105) < 1e-3f && std::fabs(v.position.y + 5) < 1e-3f) mitered = true;
+	if (!mitered) {
+		fprintf(stderr, "shapes.miter: the corner of a polyline was not mitered\n");
+		bench.failed = true;
+	}
+#endif
+}
+
+static void Surfaces(Bench& bench) {
+	const int SIZE = 256;
+	const int PIXELS = SIZE * SIZE;
+	Surface src(0, SIZE, SIZE, SDL_PIXELFORMAT_ARGB8888);
+	Surface src24(0, SIZE, SIZE, SDL_PIXELFORMAT_RGB24);
+	Surface dst(0, WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+	Surface dstSwapped(0, WIDTH, HEIGHT, SDL_PIXELFORMAT_ABGR8888);
+	src.Fill(0xFF102030);
+	src24.Fill(0x102030);
+	SDL_SetSurfaceBlendMode(src.surface, SDL_BLENDMODE_NONE);
+	SDL_SetSurfaceBlendMode(src24.surface, SDL_BLENDMODE_NONE);
+
+	bench.Run("surface.blit", "sdl", PIXELS, [&] {
+		Rect at(10, 10, 0, 0);
+		SDL_BlitSurface(src.surface, NULL, dst.surface, &at.rect);
+	});
+	RunLevels(bench, "surface.blit", PIXELS, [&] {
+		Rect at(10, 10, 0, 0);
+		src.BlitSurface(NULL, dst, &at);
+	});
+
+	bench.Run("surface.blit.swizzle", "sdl", PIXELS, [&] {
+		Rect at(10, 10, 0, 0);
+		SDL_BlitSurface(src.surface, NULL, dstSwapped.surface, &at.rect);
+	});
+	RunLevels(bench, "surface.blit.swizzle", PIXELS, [&] {
+		Rect at(10, 10, 0, 0);
+		src.BlitSurface(NULL, dstSwapped, &at);
+	});
+
+	bench.Run("surface.blit.24to32", "sdl", PIXELS, [&] {
+		Rect at(10, 10, 0, 0);
+		SDL_BlitSurface(src24.surface, NULL, dst.surface, &at.rect);
+	});
+	RunLevels(bench, "surface.blit.24to32", PIXELS, [&] {
+		Rect at(10, 10, 0, 0);
+		src24.BlitSurface(NULL, dst, &at);
+	});
+
+	bench.Run("surface.convert", "sdl", PIXELS, [&] {
+		SDL_FreeSurface(SDL_ConvertSurfaceFormat(src.surface, SDL_PIXELFORMAT_ABGR8888, 0));
+	});
+	RunLevels(bench, "surface.convert", PIXELS, [&] {
+		Surface converted = src.ConvertSurfaceFormat(SDL_PIXELFORMAT_ABGR8888, 0);
+	});
+
+	bench.Run("surface.fill", "sdl", WIDTH * HEIGHT, [&] { SDL_FillRect(dst.surface, NULL, 0xFF000000); });
+	RunLevels(bench, "surface.fill", WIDTH * HEIGHT, [&] { dst.Fill(0xFF000000); });
+}
+
+static void Geometry(Bench& bench) {
+	const int N = 4096;
+	std::vector<FPoint> points;
+	for (int i = 0; i < N; i++) points.push_back(FPoint::FromAngle(i * 0.01f, 1.0f + i % 7));
+	std::vector<Rect> rects = Scatter(N, 16);
+
+	bench.Run("math.fpoint", "sdl", N, [&] {
+		float total = 0;
+		SDL_FPoint previous = { 0, 0 };
+		for (const FPoint& v : points) {
+			SDL_FPoint p = { previous.x + v.x * 0.5f, previous.y + v.y * 0.5f };
+			float length = std::sqrt(p.x * p.x + p.y * p.y);
+			if (length != 0) { p.x /= length; p.y /= length; }
+			total += p.x + p.y;
+			previous = v.point;
+		}
+		sink = (Uint64)(total * 1000);
+	});
+	bench.Run("math.fpoint", "sdlpp", N, [&] {
+		float total = 0;
+		FPoint previous;
+		for (const FPoint& v : points) {
+			FPoint p = (previous + v * 0.5f).norm();
+			total += p.x + p.y;
+			previous = v;
+		}
+		sink = (Uint64)(total * 1000);
+	});
+
+	bench.Run("math.rect.intersect", "sdl", N, [&] {
+		SDL_Rect clip = { 100, 100, 300, 200 }, result;
+		int hits = 0;
+		for (const Rect& r : rects) hits += SDL_IntersectRect(&r.rect, &clip, &result);
+		sink = hits;
+	});
+	bench.Run("math.rect.intersect", "sdlpp", N, [&] {
+		Rect clip(100, 100, 300, 200), result;
+		int hits = 0;
+		for (const Rect& r : rects) hits += r.intersectRect(clip, result);
+		sink = hits;
+	});
+
+	bench.Run("math.rect.union", "sdl", N, [&] {
+		SDL_Rect total = rects[0].rect;
+		for (const Rect& r : rects) SDL_UnionRect(&total, &r.rect, &total);
+		sink = total.w;
+	});
+	bench.Run("math.rect.union", "sdlpp", N, [&] {
+		Rect total = rects[0];
+		for (const Rect& r : rects) total.rectUnion(r, total);
+		sink = total.w;
+	});
+
+	// SDL has no ray test, so the baseline clips the ray's segment to each rectangle
+	FPoint origin(WIDTH / 2.0f, HEIGHT / 2.0f);
+	FPoint dir(173.0f, 91.0f);
+	bench.Run("ray.intersectrect", "sdl", N, [&] {
+		int hits = 0;
+		for (const Rect& r : rects) {
+			int x1 = (int)origin.x, y1 = (int)origin.y, x2 = (int)(origin.x + dir.x), y2 = (int)(origin.y + dir.y);
+			hits += SDL_IntersectRectAndLine(&r.rect, &x1, &y1, &x2, &y2);
+		}
+		sink = hits;
+	});
+	bench.Run("ray.intersectrect", "sdlpp", N, [&] {
+		Ray ray(origin, dir);
+		int hits = 0;
+		for (const Rect& r : rects) hits += ray.intersectRect(r);
+		sink = hits;
+	});
+
+	FRectArray array;
+	for (const Rect& r : rects) array.push_back(FRect((float)r.x, (float)r.y, (float)r.w, (float)r.h));
+	std::vector<float> times(N);
+	bench.Run("ray.intersectrect", "sdlpp-batch", N, [&] {
+		sink = Ray(origin, dir).intersectRects(array, times.data());
+	});
+}
+
+static void Events(Bench& bench) {
+	// A flood like a fast mouse and keyboard: motion, with key and button presses mixed in
+	std::vector<SDL_Event> flood(COUNT);
+	for (int i = 0; i < COUNT; i++) {
+		SDL_Event& e = flood[i];
+		SDL_zero(e);
+		switch (i % 4) {
+		case 0:
+		case 1:
+			e.type = SDL_MOUSEMOTION;
+			e.motion.x = i % WIDTH;
+			e.motion.y = i % HEIGHT;
+			break;
+		case 2:
+			e.type = (i / 4) % 2 ? SDL_KEYUP : SDL_KEYDOWN;
+			e.key.keysym.scancode = (SDL_Scancode)(SDL_SCANCODE_A + (i / 8) % 26);
+			break;
+		case 3:
+			e.type = (i / 4) % 2 ? SDL_MOUSEBUTTONUP : SDL_MOUSEBUTTONDOWN;
+			e.button.button = SDL_BUTTON_LEFT;
+			break;
+		}
+	}
+
+	// Pushing is timed in both, so the difference is the cost of dispatch
+	Input input;
+	bench.Run("input.update", "sdl", COUNT, [&] {
+		for (SDL_Event& e : flood) SDL_PushEvent(&e);
+		SDL_Event e;
+		int count = 0;
+		while (SDL_PollEvent(&e)) count++;
+		sink = count;
+	});
+	bench.Run("input.update", "sdlpp", COUNT, [&] {
+		for (SDL_Event& e : flood) SDL_PushEvent(&e);
+		input.Update();
+	});
+	bench.Run("input.update", "sdlpp-queue", COUNT, [&] {
+		for (SDL_Event& e : flood) input.queue.Push(e);
+		input.Update();
+	});
+}
+
+static void AudioStreams(Bench& bench) {
+	const int FRAMES = 4096;
+	std::vector<Sint16> input(FRAMES * 2);
+	for (int i = 0; i < FRAMES * 2; i++) input[i] = (Sint16)((i * 37) % 65536 - 32768);
+	std::vector<float> output(FRAMES * 4);
+	int inBytes = (int)(input.size() * sizeof(Sint16));
+	int outBytes = (int)(output.size() * sizeof(float));
+
+	SDL_AudioStream* raw = SDL_NewAudioStream(AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 48000);
+	bench.Run("audiostream.putget", "sdl", FRAMES, [&] {
+		SDL_AudioStreamPut(raw, input.data(), inBytes);
+		while (SDL_AudioStreamGet(raw, output.data(), outBytes) > 0) {}
+	});
+	SDL_FreeAudioStream(raw);
+
+	AudioStream stream({ AUDIO_S16SYS }, 2, 44100, { AUDIO_F32SYS }, 2, 48000);
+	bench.Run("audiostream.putget", "sdlpp", FRAMES, [&] {
+		stream.Put(input.data(), inBytes);
+		while (stream.Get(output.data(), outBytes) > 0) {}
+	});
+}
+
+int main(int argc, char* argv[]) {
+	Bench bench;
+	const char* out = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--filter") && i + 1 < argc) bench.filter = argv[++i];
+		else if (!strcmp(argv[i], "--time") && i + 1 < argc) bench.seconds = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--samples") && i + 1 < argc) bench.samples = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--out") && i + 1 < argc) out = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--filter text] [--time seconds] [--samples n] [--out file]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	if (Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0) {
+		fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	Surface target(0, WIDTH, HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+	Renderer renderer(target);
+	if (renderer.renderer == NULL) {
+		fprintf(stderr, "The software renderer failed: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	Sprites(bench, renderer);
+	Primitives(bench, renderer);
+	HotPaths(bench, renderer);
+	Checks(bench, renderer);
+	Surfaces(bench);
+	Geometry(bench);
+	Events(bench);
+	AudioStreams(bench);
+
+	FILE* file = out ? fopen(out, "w") : stdout;
+	if (file == NULL) {
+		fprintf(stderr, "Cannot write %s\n", out);
+		return 1;
+	}
+	bench.Write(file);
+	if (file != stdout) fclose(file);
+
+	Quit();
+	return bench.failed ? 3 : 0;
+}
@@ -2,14 +2,35 @@
 
 #include <SDL.h>
 #include "audio.hpp"
+#include "mixer.hpp"
+#include "wavstream.hpp"
+#include "audioconverter.hpp"
 #include "error.hpp"
 #include "events.hpp"
 #include "ray.hpp"
+#include "spatial.hpp"
+#include "dirtyregion.hpp"
 #include "render.hpp"
+#include "atlas.hpp"
+#include "texturecache.hpp"
+#include "compressedtexture.hpp"
+#include "spritebatch.hpp"
+#include "shapebatch.hpp"
+#include "commandbuffer.hpp"
+#include "streamingtexture.hpp"
+#include "targetpool.hpp"
+#include "tilemap.hpp"
+#include "parallelrenderer.hpp"
+#include "framecapture.hpp"
+#include "windowset.hpp"
 #include "timer.hpp"
+#include "timerwheel.hpp"
+#include "profiler.hpp"
 #include "video.hpp"
 
 #include "image.hpp"
+#include "imageloader.hpp"
+#include "font.hpp"
 
 namespace SDL {
 	// This function initializes the subsystems specified by \c flags.
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+#include "render.hpp"
+#include "surface.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief A skyline rectangle packer.
+	 *
+	 *  The packer keeps the top edge of the packed area as a list of horizontal
+	 *  segments, and places each rectangle on the lowest segment it fits on.
+	 */
+	struct AtlasPacker {
+		// \brief A horizontal piece of the skyline
+		struct Segment {
+			int x, y, w;
+		};
+
+		Point size;
+		std::vector<Segment> skyline;
+		// \brief The total area of all packed rectangles
+		int used = 0;
+
+		/**
+		 *  \brief Create a packer covering an empty area.
+		 *
+		 *  \param size The size of the area to pack rectangles into.
+		 */
+		AtlasPacker(const Point& size);
+
+		// \brief Remove all packed rectangles, keeping the size.
+		void Reset();
+
+		/**
+		 *  \brief Find space for a rectangle and mark it used.
+		 *
+		 *  \param rectSize The size of the rectangle to place.
+		 *  \param pos      A reference filled in with the top left corner of the placed rectangle.
+		 *
+		 *  \return true if the rectangle was placed, or false if there is no room for it.
+		 */
+		bool Pack(const Point& rectSize, Point& pos);
+
+		// \brief The fraction of the area covered by packed rectangles, from 0 to 1.
+		float Occupancy() const;
+
+	private:
+		bool Fit(size_t i, const Point& rectSize, int& y) const;
+	};
+
+	// \brief A portion of a texture, usually a sprite packed into a TextureAtlas
+	struct AtlasRegion {
+		Texture* texture = nullptr;
+		Rect src;
+
+		// \brief Evaluates to true if the region refers to a texture.
+		bool Valid() const { return texture != nullptr; }
+
+		// \brief Copy the region to the current rendering target. See Texture::Copy().
+		int Copy(const Rect& dst) const { return texture->Copy(src, dst); }
+		// \brief Copy the region to the current rendering target. See Texture::CopyF().
+		int CopyF(const FRect& dst) const { return texture->CopyF(src, dst); }
+		// \brief Copy the region to the current rendering target, rotated and flipped. See Texture::CopyEx().
+		int CopyEx(const Rect& dst, const Point& center, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE) const { return texture->CopyEx(src, dst, center, angle, flipType); }
+		// \brief Copy the region to the current rendering target, rotated and flipped. See Texture::CopyEx().
+		int CopyEx(const Rect& dst, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE) const { return texture->CopyEx(src, dst, angle, flipType); }
+		// \brief Copy the region to the current rendering target, rotated and flipped. See Texture::CopyExF().
+		int CopyExF(const FRect& dst, const FPoint& center, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE) const { return texture->CopyExF(src, dst, center, angle, flipType); }
+		// \brief Copy the region to the current rendering target, rotated and flipped. See Texture::CopyExF().
+		int CopyExF(const FRect& dst, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE) const { return texture->CopyExF(src, dst, angle, flipType); }
+	};
+
+	/**
+	 *  \brief Packs many images into a few large textures.
+	 *
+	 *  Images are packed into pages of a fixed size, and a new page is created
+	 *  whenever an image does not fit on any existing page.  Drawing sprites from
+	 *  the same page needs no texture changes, so a SpriteBatch can draw them with
+	 *  a single call.
+	 *
+	 *  Regions hold pointers to the pages, and stay valid until the atlas is
+	 *  cleared or destroyed.
+	 */
+	struct TextureAtlas {
+		Renderer& renderer;
+		Point pageSize;
+		// \brief The number of transparent pixels kept around each image, to stop neighbours bleeding in when filtering
+		int padding;
+		Uint32 format;
+
+		std::deque<Texture> pages;
+		std::vector<AtlasPacker> packers;
+
+		/**
+		 *  \brief Create an empty atlas.
+		 *
+		 *  \param renderer The renderer the pages are created for.
+		 *  \param pageSize The size of each page texture.
+		 *  \param padding  The number of transparent pixels kept around each image.
+		 *  \param format   The pixel format of the page textures.
+		 */
+		TextureAtlas(Renderer& renderer, const Point& pageSize = { 2048, 2048 }, int padding = 1, Uint32 format = SDL_PIXELFORMAT_RGBA32);
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		/**
+		 *  \brief Pack a surface into the atlas.
+		 *
+		 *  \param surface The image to copy into the atlas.
+		 *
+		 *  \return The region the image was copied to, which is not Valid() on error.
+		 *
+		 *  \note The surface is not modified or freed by this function.
+		 */
+		AtlasRegion Add(Surface& surface);
+		/**
+		 *  \brief Load an image file and pack it into the atlas.
+		 *
+		 *  \param file The path of any image format SDL_image can load.
+		 *
+		 *  \return The region the image was copied to, which is not Valid() on error.
+		 */
+		AtlasRegion Add(const std::string& file);
+		/**
+		 *  \brief Pack several surfaces into the atlas.
+		 *
+		 *  The surfaces are packed tallest first, which packs tighter than adding
+		 *  them one at a time in an arbitrary order.
+		 *
+		 *  \param surfaces The images to copy into the atlas.
+		 *
+		 *  \return The regions the images were copied to, in the same order as \c surfaces.
+		 */
+		std::vector<AtlasRegion> Add(const std::vector<Surface*>& surfaces);
+		/**
+		 *  \brief Load several image files and pack them into the atlas.
+		 *
+		 *  \param files The paths of any image format SDL_image can load.
+		 *
+		 *  \return The regions the images were copied to, in the same order as \c files.
+		 */
+		std::vector<AtlasRegion> Add(const std::vector<std::string>& files);
+
+		// \brief Destroy all pages. All regions from this atlas become invalid.
+		void Clear();
+
+	private:
+		bool AddPage();
+	};
+}
@@ -684,12 +684,12 @@ namespace SDL {
      *  for full audio volume.  Note this does not change hardware volume.
      *  This is provided for convenience -- you can mix your own audio data.
      */
-    void MixAudio(Uint8* dst, const Uint8* src, Uint32 len, int volume = SDL_MIX_MAXVOLUME) { SDL_MixAudio(dst, src, len, volume); }
+    static void MixAudio(Uint8* dst, const Uint8* src, Uint32 len, int volume = SDL_MIX_MAXVOLUME) { SDL_MixAudio(dst, src, len, volume); }
 
     /**
      *  This works like MixAudio(), but you specify the audio format instead of
      *  using the format of audio device 1. Thus it can be used when no audio
      *  device is open at all.
      */
-    void MixAudioFormat(Uint8* dst, const Uint8* src, AudioFormat format, Uint32 len, int volume = SDL_MIX_MAXVOLUME) { SDL_MixAudioFormat(dst, src, format.format, len, volume); }
+    static void MixAudioFormat(Uint8* dst, const Uint8* src, AudioFormat format, Uint32 len, int volume = SDL_MIX_MAXVOLUME) { SDL_MixAudioFormat(dst, src, format.format, len, volume); }
 }
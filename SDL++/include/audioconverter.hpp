@@ -0,0 +1,123 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "audio.hpp"
+#include "mixer.hpp"
+#include "threadpool.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Shares audio converters and their buffers between many conversions.
+	 *
+	 *  Each distinct conversion builds its SDL_AudioCVT once; after that it is only
+	 *  copied, which makes it safe to run on many threads at once.  Conversions run
+	 *  in scratch buffers taken from a pool, so loading hundreds of sounds allocates
+	 *  little more than the converted results.  AudioStreams can be borrowed the
+	 *  same way, and are cleared and kept for reuse when given back.
+	 *
+	 *  Every function is thread safe.
+	 */
+	struct AudioConverterCache {
+		// \brief A conversion from one format, channel count and rate to another.
+		struct Key {
+			SDL_AudioFormat srcFormat;
+			Uint8 srcChannels;
+			int srcRate;
+			SDL_AudioFormat dstFormat;
+			Uint8 dstChannels;
+			int dstRate;
+
+			bool operator==(const Key& other) const {
+				return srcFormat == other.srcFormat && srcChannels == other.srcChannels && srcRate == other.srcRate &&
+					dstFormat == other.dstFormat && dstChannels == other.dstChannels && dstRate == other.dstRate;
+			}
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const {
+				size_t hash = key.srcFormat;
+				hash = hash * 31 + key.srcChannels;
+				hash = hash * 31 + (size_t)key.srcRate;
+				hash = hash * 31 + key.dstFormat;
+				hash = hash * 31 + key.dstChannels;
+				return hash * 31 + (size_t)key.dstRate;
+			}
+		};
+
+		// \brief Gives a borrowed stream back to its cache.
+		struct StreamReturn {
+			AudioConverterCache* cache;
+			Key key;
+			void operator()(AudioStream* stream) const;
+		};
+		// \brief A stream borrowed from the cache.  The cache must outlive it.
+		typedef std::unique_ptr<AudioStream, StreamReturn> Stream;
+
+		AudioConverterCache() {}
+
+		AudioConverterCache(const AudioConverterCache&) = delete;
+		AudioConverterCache& operator=(const AudioConverterCache&) = delete;
+
+		// \brief The conversion from a WAV's format to a spec's format, channels and rate.
+		static Key Conversion(const AudioSpec& src, const AudioSpec& dst) { return Key{ src.format, src.channels, src.freq, dst.format, dst.channels, dst.freq }; }
+
+		/**
+		 *  \brief Copy out the converter for a conversion, building it the first time.
+		 *
+		 *  \return 0 if no conversion is needed, 1 if \c cvt is set up, or -1 on error.
+		 */
+		int Get(const Key& key, SDL_AudioCVT& cvt);
+
+		/**
+		 *  \brief Convert \c len bytes of audio, replacing the contents of \c out.
+		 *
+		 *  \return 0 on success or -1 on error.
+		 */
+		int Convert(const Key& key, const Uint8* data, Uint32 len, std::vector<Uint8>& out);
+		// \brief Convert a loaded WAV to the format, channels and rate of \c dst.
+		int Convert(const WAV& wav, const AudioSpec& dst, std::vector<Uint8>& out);
+		/**
+		 *  \brief Convert a loaded WAV to a Sound for the Mixer.
+		 *
+		 *  \param rate The rate to resample to, such as the mixer's, or 0 to keep the
+		 *              WAV's own.  Sounds already at the mixer's rate mix without
+		 *              resampling.
+		 *  \return The sound, which is not Valid() if the conversion failed.
+		 */
+		Sound ToSound(const WAV& wav, int rate = 0);
+
+		/**
+		 *  \brief Convert many WAVs in parallel, one job each on \c pool.
+		 *
+		 *  Blocks until all are done.  Empty results are WAVs that failed to convert.
+		 *  Must not be called from a worker of \c pool: it waits on jobs queued
+		 *  behind the caller, which deadlocks once every worker is waiting.
+		 */
+		std::vector<std::vector<Uint8>> ConvertAll(const std::vector<const WAV*>& wavs, const AudioSpec& dst, ThreadPool& pool);
+		// \brief Convert many WAVs to Sounds in parallel, as ToSound() does.  Not from a worker of \c pool.
+		std::vector<Sound> ConvertAll(const std::vector<const WAV*>& wavs, int rate, ThreadPool& pool);
+
+		// \brief Borrow a stream for a conversion.  Empty if the stream could not be created.
+		Stream GetStream(const Key& key);
+
+		// \brief The number of distinct conversions built.
+		size_t Size() const;
+		// \brief Free every converter, pooled buffer and idle stream.
+		void Clear();
+
+	private:
+		mutable std::mutex mutex;
+		std::unordered_map<Key, AudioCVT, KeyHash> converters;
+		std::vector<std::vector<Uint8>> scratch;
+		std::unordered_map<Key, std::vector<std::unique_ptr<AudioStream>>, KeyHash> streams;
+
+		std::vector<Uint8> TakeScratch();
+		void GiveScratch(std::vector<Uint8>&& buffer);
+
+		template<typename T>
+		int ConvertInto(const Key& key, const Uint8* data, Uint32 len, std::vector<T>& out);
+	};
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "render.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Records Renderer and Texture draws so they can be built on any thread
+	 *         and replayed later on the thread that owns the renderer.
+	 *
+	 *  Each worker records into a CommandBuffer of its own; nothing here touches the
+	 *  renderer until Replay(), which takes any number of buffers, sorts their
+	 *  commands into one list and submits it in a single pass.  Commands and their
+	 *  points, rectangles and vertices are stored in arena blocks that Clear()
+	 *  keeps, so a buffer reused every frame stops allocating once it has grown.
+	 *
+	 *  Every command carries the layer, draw colour and draw blend mode current
+	 *  when it was recorded.  Textures are referenced, not copied, and their own
+	 *  colour mod, alpha mod and blend mode are whatever they are at replay.
+	 */
+	struct CommandBuffer {
+		// \brief How Replay() orders commands.
+		enum class Sort {
+			NONE,   /**< In the order the buffers and their commands were given */
+			LAYER,  /**< By layer, keeping recorded order within a layer */
+			STATE   /**< By layer, then blend mode and texture, so draws sharing state run together */
+		};
+
+		/**
+		 *  \param blockSize The size of each arena block, in bytes.  Larger
+		 *                   recordings simply take more blocks.
+		 */
+		CommandBuffer(size_t blockSize = 64 * 1024);
+
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+		// \brief Set the layer of the commands recorded after this.  Lower layers are drawn first.
+		CommandBuffer& SetLayer(Uint16 layer);
+		CommandBuffer& SetDrawColor(const Colour& color);
+		CommandBuffer& SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+		CommandBuffer& SetDrawBlendMode(const BlendMode& blendMode);
+
+		CommandBuffer& DrawLine(const Point& a, const Point& b);
+		CommandBuffer& DrawLineF(const FPoint& a, const FPoint& b);
+		CommandBuffer& DrawLines(const Point* points, int count);
+		CommandBuffer& DrawLinesF(const FPoint* points, int count);
+		CommandBuffer& DrawPoint(const Point& point);
+		CommandBuffer& DrawPointF(const FPoint& point);
+		CommandBuffer& DrawPoints(const Point* points, int count);
+		CommandBuffer& DrawPointsF(const FPoint* points, int count);
+		// \brief Outline the whole viewport current at replay.
+		CommandBuffer& DrawOutline();
+		CommandBuffer& DrawRect(const Rect& rect);
+		CommandBuffer& DrawRectF(const FRect& rect);
+		CommandBuffer& DrawRects(const Rect* rects, int count);
+		CommandBuffer& DrawRectsF(const FRect* rects, int count);
+		// \brief Fill the whole viewport current at replay.
+		CommandBuffer& Fill();
+		CommandBuffer& FillRect(const Rect& rect);
+		CommandBuffer& FillRectF(const FRect& rect);
+		CommandBuffer& FillRects(const Rect* rects, int count);
+		CommandBuffer& FillRectsF(const FRect* rects, int count);
+#if SDL_VERSION_ATLEAST(2,0,18)
+		// \brief Untextured geometry, as Renderer::Geometry().
+		CommandBuffer& Geometry(const Vertex* vertices, int numVertices, const int* indices = NULL, int numIndices = 0);
+		// \brief Textured geometry, as Texture::Geometry().
+		CommandBuffer& Geometry(Texture& texture, const Vertex* vertices, int numVertices, const int* indices = NULL, int numIndices = 0);
+#endif
+
+		// \brief As Texture::Copy().  NULL rectangles are the whole texture and the whole target.
+		CommandBuffer& Copy(Texture& texture, const Rect* src, const Rect* dst);
+		CommandBuffer& Copy(Texture& texture, const Rect& src, const Rect& dst);
+		CommandBuffer& Copy(Texture& texture, const Rect& dst);
+		// \brief As Texture::CopyF().
+		CommandBuffer& CopyF(Texture& texture, const Rect* src, const FRect* dst);
+		CommandBuffer& CopyF(Texture& texture, const Rect& src, const FRect& dst);
+		CommandBuffer& CopyF(Texture& texture, const FRect& dst);
+		// \brief As Texture::CopyEx().  A NULL center rotates around the middle of dst.
+		CommandBuffer& CopyEx(Texture& texture, const Rect* src, const Rect* dst, const Point* center, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE);
+		// \brief As Texture::CopyExF().
+		CommandBuffer& CopyExF(Texture& texture, const Rect* src, const FRect* dst, const FPoint* center, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE);
+
+		// \brief The number of commands recorded.
+		size_t Size() const { return commands.size(); }
+		bool Empty() const { return commands.empty(); }
+		// \brief Discard every command, keeping the arena for the next recording.
+		CommandBuffer& Clear();
+
+		/**
+		 *  \brief Draw this buffer's commands.  The buffer is not cleared.
+		 *
+		 *  \return 0 on success, or -1 if any draw failed.
+		 */
+		int Replay(Renderer& renderer, Sort sort = Sort::STATE) const;
+		/**
+		 *  \brief Draw the commands of several buffers as one sorted list.
+		 *
+		 *  Must not run while any of the buffers is being recorded into.  Runs of
+		 *  rectangle and point commands sharing their state are joined into single
+		 *  calls.  The renderer's draw colour and blend mode are left as the last
+		 *  command set them.
+		 *
+		 *  \return 0 on success, or -1 if any draw failed.
+		 */
+		static int Replay(Renderer& renderer, const std::vector<const CommandBuffer*>& buffers, Sort sort = Sort::STATE);
+
+	private:
+		enum class Op : Uint8 {
+			LINES,
+			POINTS,
+			RECTS,
+			FILL_RECTS,
+			GEOMETRY,
+			COPY,
+			COPY_EX
+		};
+
+		struct Command {
+			Op op;
+			BlendMode blendMode;
+			Uint16 layer;
+			Colour color;
+			SDL_Texture* texture;
+			// The number of points, rectangles or vertices; for RECTS and FILL_RECTS, 0 is the whole viewport
+			int count;
+			int numIndices;
+			// Where the command's data follows it in the arena
+			void* data;
+		};
+
+		// Everything but the points, rectangles and vertices of a copy
+		struct CopyData {
+			SDL_Rect src;
+			SDL_FRect dst;
+			SDL_FPoint center;
+			double angle;
+			Texture::Flip flip;
+			bool hasSrc, hasDst, hasCenter;
+		};
+
+		struct Block {
+			std::unique_ptr<Uint8[]> memory;
+			size_t size;
+		};
+
+		size_t blockSize;
+		std::vector<Block> blocks;
+		size_t block = 0;
+		size_t used = 0;
+		std::vector<Command*> commands;
+
+		Uint16 layer = 0;
+		Colour color = { 0, 0, 0, 255 };
+		BlendMode blendMode = SDL_BLENDMODE_NONE;
+
+		void* Allocate(size_t bytes);
+		Command& Push(Op op, SDL_Texture* texture = NULL, int count = 0, size_t dataBytes = 0);
+		template<typename T, typename S>
+		CommandBuffer& PushConverted(Op op, const S* items, int count);
+		CommandBuffer& PushCopy(Op op, Texture& texture, const Rect* src, const FRect* dst, const FPoint* center, double angle, Texture::Flip flipType);
+	};
+}
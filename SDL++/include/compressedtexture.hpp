@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "render.hpp"
+#include "surface.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief A block compressed image read from a DDS or KTX2 file.
+	 *
+	 *  Only the first mip level of the first layer or face is kept, as that is all
+	 *  a 2D renderer draws.  CreateTexture() uploads the blocks as they are where
+	 *  the renderer can take them, which takes 4 to 8 times less bandwidth and
+	 *  video memory than RGBA, and otherwise decodes them in software.
+	 *
+	 *  SDL only lets compressed data through to its OpenGL and OpenGL ES 2
+	 *  renderers; Direct3D, Metal and the software renderer always get decoded
+	 *  pixels.  BC1 to BC5 and BC7 can be decoded; ETC2 and ASTC need a
+	 *  renderer that takes them as they are, and CreateTexture() fails for them
+	 *  on any other.  sRGB formats are treated as their UNORM counterparts, as
+	 *  SDL blends in sRGB space anyway.
+	 */
+	struct CompressedImage {
+		enum class Format {
+			UNKNOWN,
+			BC1,        /**< DXT1: RGB with optional 1 bit alpha, 8 bytes per block */
+			BC2,        /**< DXT3: RGB with explicit 4 bit alpha, 16 bytes per block */
+			BC3,        /**< DXT5: RGB with interpolated alpha, 16 bytes per block */
+			BC4,        /**< One channel, decoded to red */
+			BC5,        /**< Two channels, decoded to red and green */
+			BC7,        /**< High quality RGBA, 16 bytes per block */
+			ETC2_RGB,   /**< Upload only */
+			ETC2_RGBA,  /**< Upload only */
+			ASTC_4x4    /**< Upload only */
+		};
+
+		Format format = Format::UNKNOWN;
+		int w = 0, h = 0;
+		// \brief The blocks of the first mip level, row by row
+		std::vector<Uint8> data;
+		int error = 0;
+
+		CompressedImage() {}
+		// \brief Read a DDS or KTX2 file, recognised by its contents.
+		CompressedImage(const std::string& file);
+		// \brief Read a DDS or KTX2 file from an SDL data source, which must be seekable and know its size.
+		CompressedImage(SDL_RWops* src, bool freesrc);
+
+		// Resets the error
+		CompressedImage& FlushError();
+
+		// \brief Evaluates to true if an image was read.
+		bool Valid() const { return format != Format::UNKNOWN && !data.empty(); }
+		// \brief The bytes in one 4 by 4 block of \c format.
+		static int BlockBytes(Format format);
+		// \brief Evaluates to true if Decode() can decode \c format.
+		static bool Decodable(Format format);
+		static const char* GetFormatName(Format format);
+
+		/**
+		 *  \brief Whether the renderer can take \c format without decoding.
+		 *
+		 *  True when the renderer is OpenGL or OpenGL ES 2 and its context has the
+		 *  extension for the format.  The renderer's context must be current.
+		 */
+		static bool UploadSupported(Renderer& renderer, Format format);
+
+		/**
+		 *  \brief Decode the image to an SDL_PIXELFORMAT_RGBA32 surface.
+		 *
+		 *  \return The surface, which is NULL if the format cannot be decoded.
+		 */
+		Surface Decode() const;
+
+		/**
+		 *  \brief Create a static texture from the image.
+		 *
+		 *  \param renderer   The renderer to create the texture for.
+		 *  \param compressed If not NULL, set to whether the blocks were uploaded as they are.
+		 *
+		 *  \return The texture, which refers to NULL on error.  Textures created from
+		 *          blocks must not be updated, as SDL believes them to be RGBA32.
+		 */
+		Texture CreateTexture(Renderer& renderer, bool* compressed = NULL);
+
+	private:
+		int Read(SDL_RWops* src);
+		int ReadDDS(SDL_RWops* src);
+		int ReadKTX2(SDL_RWops* src);
+		int ReadBlocks(SDL_RWops* src, Sint64 offset);
+	};
+}
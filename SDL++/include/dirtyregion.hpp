@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include "rect.hpp"
+
+namespace SDL {
+	struct Window;
+
+	/**
+	 *  \brief Collects the parts of a surface changed in a frame, so only those are
+	 *         copied to the screen.
+	 *
+	 *  Give a region to Surface::Track() or Renderer::Track() and every fill, blit
+	 *  and draw adds the rectangle it touched.  Present() merges the rectangles and
+	 *  passes them to Window::UpdateSurfaceRects().  Rectangles that overlap or
+	 *  touch are joined, as are those whose union wastes little area, until at most
+	 *  \c maxRects are left; when they cover most of the surface the whole surface
+	 *  is updated instead.
+	 */
+	struct DirtyRegion {
+		/**
+		 *  \param width    The width of the surface being tracked.
+		 *  \param height   The height of the surface being tracked.
+		 *  \param maxRects The most rectangles to pass to the window at once.
+		 */
+		DirtyRegion(int width = 0, int height = 0, int maxRects = 16);
+
+		// \brief Change the size of the surface being tracked, marking all of it dirty.
+		void Resize(int width, int height);
+
+		// \brief Mark a rectangle changed.  It is clipped to the surface.
+		void Add(const Rect& rect);
+		// \brief Mark every pixel a floating point rectangle touches.
+		void Add(const FRect& rect);
+		// \brief Mark the whole surface changed.
+		void AddAll();
+
+		bool Empty() const { return rects.empty(); }
+		void Clear() { rects.clear(); }
+
+		// \brief The merged rectangles.
+		const std::vector<Rect>& Rects();
+		// \brief The number of pixels the merged rectangles cover.
+		int Area();
+
+		/**
+		 *  \brief Copy the changed parts of the window surface to the screen, then clear.
+		 *
+		 *  \return 0 on success, or -1 on error.
+		 */
+		int Present(Window& window);
+
+	private:
+		Rect bounds;
+		int maxRects;
+		// Rectangles covering more than this share of the surface become one update
+		static constexpr float FULL_SHARE = 0.6f;
+		std::vector<Rect> rects;
+		bool merged = true;
+
+		void Merge();
+	};
+}
@@ -1,8 +1,15 @@
 #include <SDL_events.h>
+#include <list>
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <atomic>
+#include <bitset>
+#include <climits>
+#include <memory>
 #include "rect.hpp"
+#include "profiler.hpp"
+#include "timerwheel.hpp"
 
 namespace SDL {
 	struct Event {
@@ -287,26 +294,121 @@ namespace SDL {
 		Uint32 RegisterEvents(int numevents) { return SDL_RegisterEvents(numevents); }
 	};
 
+	/**
+	 *  \brief A bounded, lock-free queue that any number of threads can push
+	 *         events into, and one thread drains.
+	 *
+	 *  This avoids the global lock taken by SDL_PushEvent() when worker threads
+	 *  post results back to the main thread.  Each slot carries a sequence number,
+	 *  so producers only contend on the head index and never wait on each other.
+	 *  The capacity is rounded up to a power of two.
+	 */
+	class EventQueue {
+		struct Slot {
+			std::atomic<size_t> sequence;
+			SDL_Event event;
+		};
+
+		std::unique_ptr<Slot[]> slots;
+		size_t mask;
+		alignas(64) std::atomic<size_t> head{ 0 };
+		alignas(64) size_t tail = 0;
+	public:
+		EventQueue(size_t capacity = 1024) {
+			size_t size = 2;
+			while (size < capacity) size <<= 1;
+
+			slots.reset(new Slot[size]);
+			mask = size - 1;
+			for (size_t i = 0; i < size; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		EventQueue(const EventQueue&) = delete;
+		EventQueue& operator=(const EventQueue&) = delete;
+
+		/**
+		 *  \brief Add an event to the queue.  Safe to call from any thread.
+		 *
+		 *  \return false if the queue is full, in which case the event is dropped.
+		 */
+		bool Push(const SDL_Event& event) {
+			size_t pos = head.load(std::memory_order_relaxed);
+			for (;;) {
+				Slot& slot = slots[pos & mask];
+				size_t seq = slot.sequence.load(std::memory_order_acquire);
+				intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+				if (diff == 0) {
+					if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						slot.event = event;
+						slot.sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0) return false;
+				else pos = head.load(std::memory_order_relaxed);
+			}
+		}
+		bool Push(const Event& event) { return Push(event.event); }
+		// \brief Push an SDL_UserEvent of \c type, stamped with the current tick count.
+		bool Push(Uint32 type, Sint32 code = 0, void* data1 = NULL, void* data2 = NULL) {
+			SDL_Event event;
+			SDL_zero(event);
+			event.user.type = type;
+			event.user.timestamp = SDL_GetTicks();
+			event.user.code = code;
+			event.user.data1 = data1;
+			event.user.data2 = data2;
+			return Push(event);
+		}
+
+		/**
+		 *  \brief Take the oldest event from the queue.  Only one thread may pop.
+		 *
+		 *  \return false if the queue is empty.
+		 */
+		bool Pop(SDL_Event& event) {
+			Slot& slot = slots[tail & mask];
+			size_t seq = slot.sequence.load(std::memory_order_acquire);
+			if (seq != tail + 1) return false;
+
+			event = slot.event;
+			slot.sequence.store(tail + mask + 1, std::memory_order_release);
+			tail++;
+			return true;
+		}
+		bool Pop(Event& event) { return Pop(event.event); }
+
+		bool Empty() const { return slots[tail & mask].sequence.load(std::memory_order_acquire) != tail + 1; }
+		size_t Capacity() const { return mask + 1; }
+	};
+
 	template<typename... Ts>
 	class Callback {
 	protected:
-		std::vector<std::function<void(Ts...)>> callbacks;
+		// A list, so a callback added while the callbacks are being called
+		// neither moves the one running nor is missed by the call
+		std::list<std::function<void(Ts...)>> callbacks;
 	public:
 		Callback& operator+=(std::function<void(Ts...)> f) {
-			callbacks.push_back(f);
+			callbacks.push_back(std::move(f));
 			return *this;
 		}
-		Callback& operator-=(std::function<void(Ts...)> f) {
-			auto it = std::find(callbacks.begin(), callbacks.end());
-			if (it == callbacks.end()) return *this;
-
-			*it = callbacks.end();
-			callbacks.pop_back();
+		// \brief Remove a callback added as a plain function pointer.  Not from inside a callback.
+		Callback& operator-=(void (*f)(Ts...)) {
+			for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+				auto target = it->template target<void(*)(Ts...)>();
+				if (target && *target == f) {
+					callbacks.erase(it);
+					break;
+				}
+			}
 
 			return *this;
 		}
+		bool Empty() const { return callbacks.empty(); }
 		void operator()(Ts... a) {
-			for (auto c : callbacks) c(a...);
+			// Callbacks added by a callback go at the end, so they are called too
+			for (auto& callback : callbacks) callback(a...);
 		}
 	};
 
@@ -316,6 +418,9 @@ namespace SDL {
 		InputCallback* typed_callback;
 		InputCallback callback;
 
+		// \brief Events pushed here from other threads are dispatched by Update().  Call Wake() after pushing to end a Wait().
+		EventQueue queue;
+
 		bool running = true;
 		Point prev_mouse;
 		Point mouse;
@@ -323,18 +428,27 @@ namespace SDL {
 
 		Uint32* event_at;
 
-		Uint32 button_up_at[5]{ 0 };
-		Uint32 button_down_at[5]{ 0 };
+		static constexpr int NUM_BUTTONS = SDL_BUTTON_X2 + 1;
+
+		Uint32 button_up_at[NUM_BUTTONS]{ 0 };
+		Uint32 button_down_at[NUM_BUTTONS]{ 0 };
 		Uint32 scancode_up_at[SDL_NUM_SCANCODES]{ 0 };
 		Uint32 scancode_down_at[SDL_NUM_SCANCODES]{ 0 };
 
-		bool prev_buttons[5]{ false };
-		bool buttons[5]{ false };
-		bool prev_scancodes[SDL_NUM_SCANCODES]{ false };
-		bool scancodes[SDL_NUM_SCANCODES]{ false };
+		std::bitset<NUM_BUTTONS> prev_buttons;
+		std::bitset<NUM_BUTTONS> buttons;
+		std::bitset<SDL_NUM_SCANCODES> prev_scancodes;
+		std::bitset<SDL_NUM_SCANCODES> scancodes;
 
-		Input() { typed_callback = new InputCallback[SDL_LASTEVENT]; event_at = new Uint32[SDL_LASTEVENT]; }
+		// \brief The scancodes pressed or released during the last Update()
+		SDL_Scancode changed_scancodes[SDL_NUM_SCANCODES];
+		int changed_count = 0;
+		std::bitset<SDL_NUM_SCANCODES> changed;
+
+		Input() { typed_callback = new InputCallback[SDL_LASTEVENT]; event_at = new Uint32[SDL_LASTEVENT](); }
 		~Input() { delete[] typed_callback; delete[] event_at; }
+		Input(const Input&) = delete;
+		Input& operator=(const Input&) = delete;
 
 		bool button    (Uint8 i) { return  buttons[i]; }
 		bool buttonDown(Uint8 i) { return !prev_buttons[i] &&  buttons[i]; }
@@ -343,68 +457,192 @@ namespace SDL {
 		bool scancode     (SDL_Scancode i) { return  scancodes[i]; }
 		bool scancodeDown (SDL_Scancode i) { return !prev_scancodes[i] &&  scancodes[i]; }
 		bool scancodeUp   (SDL_Scancode i) { return  prev_scancodes[i] && !scancodes[i]; }
+		bool scancodeChanged(SDL_Scancode i) { return prev_scancodes[i] != scancodes[i]; }
 
 		void Update() {
+			SDLPP_PROFILE_ZONE("Input::Update");
 			Event e;
 
-			memcpy(&prev_mouse, &mouse, sizeof(Point));
-			memcpy(&prev_buttons, &buttons, 5 * sizeof(bool));
-			memcpy(&prev_scancodes, &scancodes, SDL_NUM_SCANCODES * sizeof(bool));
+			BeginUpdate();
+			while (e.Poll()) Handle(e);
+			while (queue.Pop(e)) Dispatch(e);
+		}
 
-			while (e.Poll()) {
-				SDL_CommonEvent c = e.common;
-				switch (e.type) {
-				case Event::Type::QUIT:
-					running = false;
-					break;
-				case Event::Type::WINDOWEVENT:
-					switch (e.window.event)
-					{
-					case SDL_WINDOWEVENT_RESIZED:
-						windowSize = { e.window.data1, e.window.data2 };
-						break;
+		/**
+		 *  \brief Sleep until there is something to redraw, then update as Update() does.
+		 *
+		 *  Blocks in SDL_WaitEventTimeout until an event arrives, the next timer of
+		 *  \c timers is due, RequestRedraw() is called, or \c timeoutMs passes.
+		 *  Wake-ups that bring nothing to redraw, such as a Wake() or a timer wheel
+		 *  placing far timers, go back to sleep without returning.  Events are
+		 *  dispatched and due timers run before returning.
+		 *
+		 *  \param timers    Timers to wake for and run, or NULL.
+		 *  \param timeoutMs The longest to sleep, 0 to only poll, or -1 for as long as it takes.
+		 *
+		 *  \return true if the frame needs redrawing: an event was dispatched, a
+		 *          timer ran, or a redraw was requested.  false on timeout.
+		 */
+		bool Wait(TimerWheel* timers = NULL, int timeoutMs = -1) {
+			SDLPP_PROFILE_ZONE("Input::Wait");
+			Event e;
+			Uint32 start = SDL_GetTicks();
+			bool redraw = false;
+
+			BeginUpdate();
+			for (;;) {
+				int wait = timeoutMs;
+				if (timeoutMs > 0) {
+					Uint32 elapsed = SDL_GetTicks() - start;
+					wait = elapsed >= (Uint32)timeoutMs ? 0 : timeoutMs - (int)elapsed;
+				}
+				if (timers != NULL) {
+					Uint64 due = timers->NextDue(), now = timers->Now();
+					if (due != ~(Uint64)0) {
+						// Rounded up, so the timer is due by the time the wait ends
+						Uint64 ms = due <= now ? 0 : std::min((due - now + 999) / 1000, (Uint64)INT_MAX);
+						wait = wait < 0 ? (int)ms : std::min(wait, (int)ms);
 					}
-					break;
-				case Event::Type::MOUSEMOTION:
-					mouse.x = e.motion.x;
-					mouse.y = e.motion.y;
-					break;
-				case Event::Type::MOUSEBUTTONDOWN:
-				{
-					Uint8 button = e.button.button;
-					button_down_at[button] = c.timestamp;
-					buttons[button] = true;
 				}
-					break;
-				case Event::Type::MOUSEBUTTONUP:
-				{
-					Uint8 button = e.button.button;
-					button_up_at[button] = c.timestamp;
-					buttons[button] = false;
+				if (redraw_requested.load(std::memory_order_acquire) || !queue.Empty()) wait = 0;
+
+				if (wait == 0 ? e.Poll() : e.WaitTimeout(wait)) {
+					do redraw |= Handle(e);
+					while (e.Poll());
 				}
-					break;
-				case Event::Type::KEYDOWN:
-				{
-					SDL_Scancode scancode = e.key.keysym.scancode;
-					scancode_down_at[scancode] = c.timestamp;
-					scancodes[scancode] = true;
+				while (queue.Pop(e)) {
+					Dispatch(e);
+					redraw = true;
 				}
-					break;
-				case Event::Type::KEYUP:
+				if (timers != NULL && timers->Update() > 0) redraw = true;
+				if (redraw_requested.exchange(false, std::memory_order_acq_rel)) redraw = true;
+
+				if (redraw || !running) return true;
+				if (timeoutMs == 0 || (timeoutMs > 0 && SDL_GetTicks() - start >= (Uint32)timeoutMs)) return false;
+			}
+		}
+
+		// \brief Make Wait() return for a redraw.  Safe to call from any thread.
+		void RequestRedraw() {
+			if (!redraw_requested.exchange(true, std::memory_order_acq_rel)) Wake();
+		}
+		/**
+		 *  \brief Wake a thread sleeping in Wait() so it looks at \c queue and its
+		 *         timers again.  Safe to call from any thread.
+		 *
+		 *  Calls before the wake-up is seen are merged, so SDL's queue gets at most
+		 *  one wake event however often this is called.
+		 */
+		void Wake() {
+			if (wake_pending.exchange(true, std::memory_order_acq_rel)) return;
+			Uint32 type = WakeEventType();
+			if (type == (Uint32)-1) return;
+
+			SDL_Event event;
+			SDL_zero(event);
+			event.user.type = type;
+			event.user.timestamp = SDL_GetTicks();
+			if (SDL_PushEvent(&event) != 1) wake_pending.store(false, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<bool> redraw_requested{ false };
+		std::atomic<bool> wake_pending{ false };
+
+		// The user event Wake() posts, registered on first use
+		static Uint32 WakeEventType() {
+			static const Uint32 type = SDL_RegisterEvents(1);
+			return type;
+		}
+
+		void BeginUpdate() {
+			prev_mouse = mouse;
+			prev_buttons = buttons;
+
+			// Only the keys that changed last frame can differ from their previous state
+			for (int i = 0; i < changed_count; i++) {
+				SDL_Scancode scancode = changed_scancodes[i];
+				prev_scancodes[scancode] = scancodes[scancode];
+				changed[scancode] = false;
+			}
+			changed_count = 0;
+		}
+
+		// Dispatches an event, except for Wake()'s.  Returns whether it was dispatched
+		bool Handle(Event& e) {
+			if ((Uint32)e.type == WakeEventType()) {
+				wake_pending.store(false, std::memory_order_release);
+				return false;
+			}
+			Dispatch(e);
+			return true;
+		}
+
+		void SetScancode(SDL_Scancode scancode, bool down) {
+			if (scancodes[scancode] == down) return;
+
+			if (!changed[scancode]) {
+				changed[scancode] = true;
+				changed_scancodes[changed_count++] = scancode;
+			}
+			scancodes[scancode] = down;
+		}
+
+		void Dispatch(Event& e) {
+			SDL_CommonEvent c = e.common;
+			switch (e.type) {
+			case Event::Type::QUIT:
+				running = false;
+				break;
+			case Event::Type::WINDOWEVENT:
+				switch (e.window.event)
 				{
-					SDL_Scancode scancode = e.key.keysym.scancode;
-					scancode_up_at[scancode] = c.timestamp;
-					scancodes[scancode] = false;
-				}
-					break;
-				default:
+				case SDL_WINDOWEVENT_RESIZED:
+					windowSize = { e.window.data1, e.window.data2 };
 					break;
 				}
-
-				event_at[(Uint32)e.type] = c.timestamp;
-				typed_callback[(Uint32)e.type](e);
-				callback(e);
+				break;
+			case Event::Type::MOUSEMOTION:
+				mouse.x = e.motion.x;
+				mouse.y = e.motion.y;
+				break;
+			case Event::Type::MOUSEBUTTONDOWN:
+			{
+				Uint8 button = e.button.button;
+				if (button >= NUM_BUTTONS) break;
+				button_down_at[button] = c.timestamp;
+				buttons[button] = true;
 			}
+				break;
+			case Event::Type::MOUSEBUTTONUP:
+			{
+				Uint8 button = e.button.button;
+				if (button >= NUM_BUTTONS) break;
+				button_up_at[button] = c.timestamp;
+				buttons[button] = false;
+			}
+				break;
+			case Event::Type::KEYDOWN:
+			{
+				SDL_Scancode scancode = e.key.keysym.scancode;
+				scancode_down_at[scancode] = c.timestamp;
+				SetScancode(scancode, true);
+			}
+				break;
+			case Event::Type::KEYUP:
+			{
+				SDL_Scancode scancode = e.key.keysym.scancode;
+				scancode_up_at[scancode] = c.timestamp;
+				SetScancode(scancode, false);
+			}
+				break;
+			default:
+				break;
+			}
+
+			event_at[(Uint32)e.type] = c.timestamp;
+			typed_callback[(Uint32)e.type](e);
+			callback(e);
 		}
 	};
 }
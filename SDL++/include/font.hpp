@@ -0,0 +1,206 @@
+#pragma once
+
+#include <SDL_ttf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "atlas.hpp"
+#include "render.hpp"
+
+namespace SDL {
+	namespace TTF {
+		static const SDL_version* Linked_Version() { return TTF_Linked_Version(); }
+
+		/* Initialize the TTF engine.  Returns 0 if successful, -1 on error. */
+		static int Init() { return TTF_Init(); }
+		/* De-initialize the TTF engine */
+		static void Quit() { TTF_Quit(); }
+		/* Check if the TTF engine is initialized */
+		static int WasInit() { return TTF_WasInit(); }
+	}
+
+	// \brief A TrueType font at one point size, opened with SDL_ttf
+	struct Font {
+		TTF_Font* font = NULL;
+		bool freeFont = false;
+
+		Font() {}
+		/**
+		 *  \brief Open a font file.
+		 *
+		 *  \param file   The path of a TTF or OTF file.
+		 *  \param ptsize The point size to render glyphs at.
+		 */
+		Font(const std::string& file, int ptsize) : font(TTF_OpenFont(file.c_str(), ptsize)), freeFont(font != NULL) {}
+		// \brief Open a font from an SDL data source.
+		Font(SDL_RWops* src, bool freesrc, int ptsize) : font(TTF_OpenFontRW(src, freesrc, ptsize)), freeFont(font != NULL) {}
+		// \brief Wrap a font opened elsewhere.
+		Font(TTF_Font* font, bool free = false) : font(font), freeFont(free && font != NULL) {}
+		Font(Font&& that) noexcept : font(that.font), freeFont(that.freeFont) { that.font = NULL; that.freeFont = false; }
+		~Font() { if (freeFont) TTF_CloseFont(font); }
+
+		Font(const Font&) = delete;
+		Font& operator=(const Font&) = delete;
+
+		// \brief The maximum pixel height of all glyphs.
+		int Height() const { return TTF_FontHeight(font); }
+		// \brief The offset from the top of a line to the baseline.
+		int Ascent() const { return TTF_FontAscent(font); }
+		// \brief The offset from the baseline to the bottom of a line, usually negative.
+		int Descent() const { return TTF_FontDescent(font); }
+		// \brief The recommended distance between the tops of two lines.
+		int LineSkip() const { return TTF_FontLineSkip(font); }
+		bool GetKerning() const { return TTF_GetFontKerning(font) != 0; }
+		Font& SetKerning(bool enable) { TTF_SetFontKerning(font, enable); return *this; }
+	};
+
+	/**
+	 *  \brief Rasterises the glyphs of a font once each and packs them into a
+	 *         shared TextureAtlas.
+	 *
+	 *  Glyphs are rendered white on first use, so one cache serves text of every
+	 *  colour, and cropped to their visible pixels.  Changing the font's style,
+	 *  outline or hinting afterwards needs a Clear().
+	 */
+	struct GlyphCache {
+		// \brief A rasterised glyph
+		struct Glyph {
+			// \brief The glyph's pixels, which is not Valid() for glyphs with none such as spaces
+			AtlasRegion region;
+			// \brief The position of the region relative to the pen, with y measured from the top of the line
+			Point offset;
+			// \brief How far the pen moves after the glyph
+			int advance = 0;
+		};
+
+		Renderer& renderer;
+		Font& font;
+		TextureAtlas atlas;
+		// \brief Counts calls to Clear(), so a TextBuffer can tell its glyphs are gone
+		Uint32 generation = 0;
+		int error = 0;
+
+		/**
+		 *  \param renderer The renderer the atlas pages are created for.
+		 *  \param font     The font glyphs are rendered with, which must outlive the cache.
+		 *  \param pageSize The size of each atlas page.
+		 */
+		GlyphCache(Renderer& renderer, Font& font, const Point& pageSize = { 1024, 1024 });
+
+		GlyphCache(const GlyphCache&) = delete;
+		GlyphCache& operator=(const GlyphCache&) = delete;
+
+		// Resets the error
+		GlyphCache& FlushError();
+
+		/**
+		 *  \brief The glyph for a code point, rasterising it if it is not cached.
+		 *
+		 *  \return The glyph, which stays valid until Clear().  A glyph that cannot
+		 *          be rendered is cached empty, with its advance if the font has one.
+		 */
+		const Glyph& Get(Uint32 codepoint);
+		// \brief The kerning adjustment between two code points, in pixels.
+		int Kerning(Uint32 previous, Uint32 codepoint);
+		// \brief Rasterise every glyph in a UTF-8 string ahead of time.
+		GlyphCache& Preload(const std::string& utf8);
+
+		/**
+		 *  \brief Forget every glyph and destroy the atlas pages.
+		 *
+		 *  Text laid out before then is dropped by its TextBuffer rather than drawn.
+		 */
+		GlyphCache& Clear();
+
+	private:
+		// Looked up on every character, so ASCII skips the hash
+		Glyph ascii[128];
+		bool asciiCached[128] = {};
+		std::unordered_map<Uint32, Glyph> glyphs;
+		std::unordered_map<Uint64, int> kerning;
+		bool kerningEnabled;
+
+		Glyph Render(Uint32 codepoint);
+	};
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+	/**
+	 *  \brief Lays out UTF-8 text with a GlyphCache into a vertex buffer that is
+	 *         drawn with one geometry call per atlas page.
+	 *
+	 *  Add() appends a paragraph, so a whole HUD can be laid out into one buffer
+	 *  and most frames need a single draw call.  Clear() keeps the storage, so
+	 *  laying out changing text each frame allocates nothing once the buffer has
+	 *  grown and the glyphs are cached.  Text that does not change can be kept and
+	 *  drawn again without laying it out, until the cache is cleared: its pages
+	 *  are destroyed then, so the buffer drops what it holds instead of drawing
+	 *  it, and the text has to be added again.
+	 */
+	struct TextBuffer {
+		enum class Align { LEFT, CENTER, RIGHT };
+
+		// \brief The glyphs from one atlas page
+		struct Batch {
+			Texture* page;
+			std::vector<Vertex> vertices;
+			std::vector<int> indices;
+		};
+
+		GlyphCache& cache;
+		std::vector<Batch> batches;
+		int error = 0;
+
+		TextBuffer(GlyphCache& cache);
+
+		// Resets the error
+		TextBuffer& FlushError();
+
+		/**
+		 *  \brief Lay out a paragraph and append it to the buffer.
+		 *
+		 *  Lines break at '\n', and at spaces to keep lines within \c wrapWidth.
+		 *
+		 *  \param utf8      The text.
+		 *  \param pos       The top left of the first line.
+		 *  \param colour    The colour of the text.
+		 *  \param wrapWidth The width to wrap lines at, or 0 not to wrap.
+		 *  \param align     How lines are aligned, within \c wrapWidth if it is set or around \c pos otherwise.
+		 *
+		 *  \return The bounds of the laid out text.
+		 */
+		FRect Add(const std::string& utf8, const FPoint& pos, const Colour& colour = { 255, 255, 255, 255 }, float wrapWidth = 0, Align align = Align::LEFT);
+		// \brief The size the text would take up if added. See Add().
+		FPoint Measure(const std::string& utf8, float wrapWidth = 0);
+
+		// \brief The number of glyphs in the buffer.
+		size_t Size() const;
+		// \brief Remove all text, keeping the storage for reuse.
+		TextBuffer& Clear();
+		/**
+		 *  \brief Draw the buffer to the current rendering target.
+		 *
+		 *  \return 0 on success, or -1 on error, including when the cache was
+		 *          cleared since the text was added, which empties the buffer.
+		 */
+		int Draw();
+
+	private:
+		// A glyph placed on the line being laid out
+		struct Placed {
+			const GlyphCache::Glyph* glyph;
+			float x;
+		};
+
+		std::vector<Placed> line;
+		size_t lastBatch = 0;
+		// The cache's generation when the text in the buffer was laid out
+		Uint32 generation;
+
+		// Forgets the batches if the cache has destroyed their pages since, and says whether it did
+		bool DropStale();
+		// Lays out the text, adding glyphs only if there is a colour to give them
+		FRect Layout(const std::string& utf8, const FPoint& pos, float wrapWidth, Align align, const SDL_Color* colour);
+		void Push(const GlyphCache::Glyph& glyph, float x, float y, const SDL_Color& colour);
+	};
+#endif
+}
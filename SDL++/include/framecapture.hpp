@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "render.hpp"
+#include "threadpool.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Records the frames of a renderer to disk without waiting for each
+	 *         one to be read back and encoded.
+	 *
+	 *  SDL cannot copy the window's back buffer into a texture, so frames are
+	 *  drawn between Begin() and End() into a ring of render target textures
+	 *  instead, and End() copies the finished frame to the window.  A frame is
+	 *  read back when Begin() comes round to its texture again, \c ringSize
+	 *  frames later.  Begin() is called after the last frame was presented and
+	 *  before the next is drawn, so no drawing of the new frame is queued for
+	 *  the read to wait on, and the frame read was presented \c ringSize - 1
+	 *  frames ago.  The pixels are handed to an encoder running on a thread of
+	 *  its own, one frame at a time in the order they were drawn.
+	 *
+	 *  Pixel buffers are reused once encoded, so after the first few frames
+	 *  capturing makes no allocations the size of a frame.  If the encoder falls
+	 *  behind by \c maxQueued frames, the frames are dropped without being read
+	 *  back rather than holding up the render thread.
+	 */
+	struct FrameCapture {
+		// \brief The pixels of a captured frame
+		struct Frame {
+			std::vector<Uint8> pixels;
+			Point size;
+			int pitch = 0;
+			Uint32 format = 0;
+			// \brief The number of frames ended before this one, counting dropped frames
+			Uint64 index = 0;
+			// \brief The value of SDL_GetTicks() when the frame was ended
+			Uint32 ticks = 0;
+		};
+
+		/**
+		 *  \brief Writes out a frame.  Runs on the encoder thread, and must not use
+		 *         the renderer.
+		 *
+		 *  \return 0 on success, or -1 on error.
+		 */
+		typedef std::function<int(Frame& frame)> Encoder;
+
+		Renderer& renderer;
+		// \brief The pixel format frames are read back in
+		Uint32 format;
+		// \brief The most frames waiting for the encoder before new frames are dropped
+		size_t maxQueued;
+
+		// \brief The number of frames handed to the encoder
+		std::atomic<Uint64> captured{ 0 };
+		// \brief The number of frames dropped because the encoder was behind
+		std::atomic<Uint64> dropped{ 0 };
+		// \brief The number of frames the encoder failed to write
+		std::atomic<Uint64> failed{ 0 };
+		int error = 0;
+
+		/**
+		 *  \param renderer  The renderer whose frames are captured.
+		 *  \param encoder   Writes out each frame, see PNGFiles() and RawFrames().
+		 *  \param ringSize  The number of frames drawn before the oldest is read back, at least 2.
+		 *  \param format    The pixel format to read frames back in.
+		 *  \param maxQueued The most frames waiting for the encoder before new frames are dropped.
+		 */
+		FrameCapture(Renderer& renderer, Encoder encoder, int ringSize = 3, Uint32 format = SDL_PIXELFORMAT_RGBA32, size_t maxQueued = 4);
+		/**
+		 *  \brief Waits for the encoder to finish the frames handed to it.
+		 *
+		 *  Frames still in the ring are lost; call Flush() first to keep them.
+		 */
+		~FrameCapture();
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		// Resets the error
+		FrameCapture& FlushError();
+
+		/**
+		 *  \brief Start a frame: read back the oldest frame of the ring and queue
+		 *         it for the encoder, then make its texture the rendering target.
+		 *
+		 *  Call after the Renderer::Present() of the last frame, before drawing
+		 *  anything of the new one.  The textures match the renderer's output size, and are recreated if it
+		 *  changes.  Logical size scaling does not apply to the frame.
+		 *
+		 *  \return 0 on success, or -1 if the texture cannot be made the target.
+		 */
+		int Begin();
+		/**
+		 *  \brief End a frame: copy it to the window.
+		 *
+		 *  Call before Renderer::Present().
+		 *
+		 *  \return 0 on success, or -1 on error.
+		 */
+		int End();
+		/**
+		 *  \brief Read back every frame still in the ring, and wait until the
+		 *         encoder has written all of them.
+		 *
+		 *  Blocks, so it is meant for the end of a recording.
+		 *
+		 *  \return 0 on success, or -1 if a frame could not be read back.
+		 */
+		int Flush();
+
+		// \brief The number of frames waiting for or being written by the encoder.
+		size_t Queued();
+
+		/**
+		 *  \brief An encoder that saves each frame to a PNG file.
+		 *
+		 *  \param pattern A printf pattern for the file names, given the frame index
+		 *                 as an unsigned long long, such as "frame%05llu.png".
+		 */
+		static Encoder PNGFiles(const std::string& pattern);
+		/**
+		 *  \brief An encoder that writes the pixels of each frame one after
+		 *         another, rows tightly packed, as raw video for other tools.
+		 *
+		 *  \param dst     The data source to write to, which is only used by the encoder thread.
+		 *  \param freedst Whether the source is closed once the encoder is destroyed.
+		 */
+		static Encoder RawFrames(SDL_RWops* dst, bool freedst);
+
+	private:
+		struct Slot {
+			std::unique_ptr<Texture> texture;
+			// Whether the texture holds a frame that has not been read back
+			bool pending = false;
+			Uint64 index = 0;
+			Uint32 ticks = 0;
+		};
+
+		Encoder encoder;
+		std::vector<Slot> ring;
+		Point size;
+		size_t next = 0;
+		Uint64 frames = 0;
+		bool drawing = false;
+
+		std::mutex mutex;
+		// Buffers the encoder has finished with
+		std::vector<std::vector<Uint8>> spare;
+		size_t queued = 0;
+
+		// Declared last so its thread stops before the state it uses is destroyed
+		ThreadPool worker{ 1 };
+
+		int Resize(const Point& outputSize);
+		int Readback(Slot& slot);
+	};
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "image.hpp"
+#include "threadpool.hpp"
+
+namespace SDL {
+	namespace IMG {
+		/**
+		 *  \brief Decodes images on a thread pool, and turns them into textures on the
+		 *         render thread a few at a time.
+		 *
+		 *  Load() and LoadTexture() return immediately with a handle.  Decoding happens
+		 *  on the pool; textures are only created inside Upload(), which should be
+		 *  called once a frame from the thread that owns the renderer.
+		 */
+		struct AsyncLoader {
+			enum class Status {
+				QUEUED,    /**< Waiting for a worker */
+				DECODING,  /**< Being decoded by a worker */
+				DECODED,   /**< Decoded to a surface; textures are waiting for Upload() */
+				UPLOADED,  /**< Turned into a texture by Upload() */
+				FAILED,    /**< Decoding or texture creation failed, see Handle::GetError() */
+				CANCELLED  /**< Cancelled before it finished */
+			};
+
+			// \brief The shared state of one load
+			struct Request {
+				std::atomic<Status> status{ Status::QUEUED };
+				std::atomic<bool> cancelled{ false };
+				bool upload = false;
+
+				std::string file;
+				SDL_RWops* src = NULL;
+				bool freesrc = false;
+				std::string type;
+
+				SDL_Surface* surface = NULL;
+				SDL_Texture* texture = NULL;
+				std::string error;
+
+				~Request();
+			};
+
+			// \brief A reference to a queued load
+			struct Handle {
+				std::shared_ptr<Request> request;
+
+				Status GetStatus() const;
+				// \brief Evaluates to true once the load has stopped, successfully or not.
+				bool Done() const;
+				// \brief Evaluates to true if the load finished successfully.
+				bool Succeeded() const;
+				// \brief The reason the load failed, or an empty string.
+				const std::string& GetError() const;
+
+				/**
+				 *  \brief Ask for the load to stop.
+				 *
+				 *  A decode already in progress still runs to completion, but its result
+				 *  is thrown away.
+				 *
+				 *  \return true if the load had not already finished.
+				 */
+				bool Cancel();
+
+				// \brief Take ownership of the decoded surface of a Load(). Empty if it is not DECODED.
+				Surface TakeSurface();
+				// \brief Take ownership of the texture of a LoadTexture(). Empty if it is not UPLOADED.
+				Texture TakeTexture(Renderer& renderer);
+			};
+
+			// \brief State shared with the jobs running on the pool
+			struct Shared {
+				std::mutex mutex;
+				// \brief Decoded LoadTexture() requests waiting for Upload()
+				std::deque<std::shared_ptr<Request>> decoded;
+			};
+
+			ThreadPool& pool;
+			std::shared_ptr<Shared> shared;
+
+			// \param pool The pool decoding is done on.
+			AsyncLoader(ThreadPool& pool);
+			// \brief Cancels all loads that have not finished.
+			~AsyncLoader();
+
+			// \brief Decode an image file to a surface.
+			Handle Load(const std::string& file);
+			/**
+			 *  \brief Decode an image from an SDL data source to a surface.
+			 *
+			 *  \param src     The data source, which is only used by the worker thread until the load finishes.
+			 *  \param freesrc Whether the source is closed when the load finishes.
+			 *  \param type    The image type, as given to LoadTyped_RW(), or NULL to detect it.
+			 */
+			Handle Load_RW(SDL_RWops* src, bool freesrc, const char* type = NULL);
+			// \brief Decode an image file and turn it into a texture during Upload().
+			Handle LoadTexture(const std::string& file);
+			// \brief Decode an image from an SDL data source and turn it into a texture during Upload(). See Load_RW().
+			Handle LoadTexture_RW(SDL_RWops* src, bool freesrc, const char* type = NULL);
+
+			/**
+			 *  \brief Create textures for decoded images until the time budget is spent.
+			 *
+			 *  \param renderer The renderer to create the textures with.
+			 *  \param budgetMs The time to spend, in milliseconds.  At least one texture is
+			 *                  created if any are waiting, so a single large image can exceed it.
+			 *
+			 *  \return The number of textures created.
+			 */
+			int Upload(Renderer& renderer, Uint32 budgetMs);
+
+			// \brief Cancel every load that has not finished.
+			void CancelAll();
+
+			// \brief The number of loads that have not finished yet.
+			int Pending() const;
+			// \brief The fraction of loads started since the last ResetProgress() that have finished, from 0 to 1.
+			float Progress() const;
+			// \brief Restart the Progress() count from the loads still pending.
+			void ResetProgress();
+
+		private:
+			mutable std::mutex requestsMutex;
+			std::vector<std::weak_ptr<Request>> requests;
+
+			Handle Queue(std::shared_ptr<Request> request);
+			int CountPending() const;
+		};
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "audio.hpp"
+#include "spscqueue.hpp"
+
+namespace SDL {
+	// \brief Decoded audio for the Mixer: interleaved 32 bit float samples, mono or stereo.
+	struct Sound {
+		std::vector<float> samples;
+		int channels = 0;
+		int rate = 0;
+
+		Sound() {}
+		Sound(const float* samples, int frames, int channels, int rate);
+		/**
+		 *  \brief Convert a loaded WAV.  WAVs of more than two channels are mixed down to stereo.
+		 *
+		 *  If the WAV did not load or cannot be converted, the sound is not Valid().
+		 */
+		Sound(const WAV& wav);
+
+		int Frames() const { return channels ? (int)(samples.size() / channels) : 0; }
+		bool Valid() const { return channels != 0; }
+	};
+
+	/**
+	 *  \brief Mixes many voices into an audio device, in 32 bit float.
+	 *
+	 *  The Mixer opens the device with its own callback.  Play() and the other
+	 *  voice functions queue commands through a lock-free queue which the callback
+	 *  reads each time it runs, so the game thread never takes the device lock and
+	 *  the audio thread never waits for the game.  Commands must all come from one
+	 *  thread.
+	 *
+	 *  Voices are mixed to stereo, then converted to whatever format, channel count
+	 *  and rate the device gave.  A Sound must outlive the voices playing it.
+	 *  Anything else, such as a stream, can be played through a Source.
+	 */
+	struct Mixer {
+		// \brief Identifies a voice.  0 is never a voice.
+		typedef Uint32 VoiceID;
+
+		static constexpr int MAX_VOICES = 128;
+
+		/**
+		 *  \brief Audio made while it plays, such as a file streamed from disk.
+		 *
+		 *  Read() and Finished() are called on the audio thread, so must not block.
+		 */
+		struct Source {
+			virtual ~Source() {}
+			/**
+			 *  \brief Fill \c stereo with up to \c frames interleaved stereo frames at
+			 *         the mixer's rate.
+			 *
+			 *  \return The number of frames written.  Fewer than asked for, when the
+			 *          source has not Finished(), is an underrun and becomes silence.
+			 */
+			virtual int Read(float* stereo, int frames) = 0;
+			// \brief Evaluates to true once the source will never read anything more.
+			virtual bool Finished() const = 0;
+		};
+
+		/**
+		 *  \brief Open an audio device and start mixing.
+		 *
+		 *  \param device   The device name, or NULL for the default device.
+		 *  \param rate     The sample rate to ask for.
+		 *  \param samples  The buffer size to ask for, in sample frames.
+		 *  \param commands The number of commands that can be queued between callbacks.
+		 */
+		Mixer(const char* device = NULL, int rate = 48000, Uint16 samples = 512, size_t commands = 1024);
+
+		Mixer(const Mixer&) = delete;
+		Mixer& operator=(const Mixer&) = delete;
+
+		// \brief Evaluates to true if the device opened.
+		bool Valid() const { return device.ID != 0; }
+		// \brief The format the device was opened with.
+		const AudioSpec& GetSpec() const { return spec; }
+
+		/**
+		 *  \brief Start a voice playing a sound.
+		 *
+		 *  \param gain  The volume, where 1 is unchanged.
+		 *  \param pan   From -1 for left to 1 for right.
+		 *  \param pitch The playback speed, where 1 is unchanged.  Negative speeds are taken as 0.
+		 *  \param loop  Whether to repeat the sound until stopped.
+		 *  \return The new voice, or 0 if the command queue is full.
+		 */
+		VoiceID Play(const Sound& sound, float gain = 1, float pan = 0, float pitch = 1, bool loop = false);
+		/**
+		 *  \brief Start a voice playing a source, which must outlive it.
+		 *
+		 *  The voice ends when the source is Finished().  Pitch does not apply to sources.
+		 */
+		VoiceID Play(Source& source, float gain = 1, float pan = 0);
+		void Stop(VoiceID voice);
+		void SetGain(VoiceID voice, float gain);
+		void SetPan(VoiceID voice, float pan);
+		void SetPitch(VoiceID voice, float pitch);
+		void SetPaused(VoiceID voice, bool paused);
+		void StopAll();
+		// \brief Set the volume of every voice together.
+		void SetMasterGain(float gain);
+
+		// \brief Evaluates to true if a voice is playing or about to start.
+		bool Playing(VoiceID voice) const;
+		// \brief The number of voices the callback is mixing.
+		int ActiveVoices() const;
+
+	private:
+		enum class Op : Uint8 {
+			PLAY,
+			STOP,
+			GAIN,
+			PAN,
+			PITCH,
+			PAUSE,
+			STOP_ALL,
+			MASTER_GAIN
+		};
+
+		struct Command {
+			Op op;
+			bool loop;
+			VoiceID id;
+			const Sound* sound;
+			Source* source;
+			float gain, pan, pitch;
+		};
+
+		struct Voice {
+			VoiceID id = 0;
+			const Sound* sound = nullptr;
+			Source* source = nullptr;
+			double position = 0;
+			float gain = 1, pan = 0, pitch = 1;
+			// The gains applied at the end of the last callback, ramped from to avoid clicks
+			float left = 0, right = 0;
+			bool loop = false;
+			bool paused = false;
+		};
+
+		AudioSpec spec;
+		SPSCQueue<Command> commands;
+		VoiceID nextID = 1;
+
+		// Used only by the audio thread
+		Voice voices[MAX_VOICES];
+		float masterGain = 1;
+		std::vector<float> mix;
+		std::vector<float> resampled;
+
+		// Written by the audio thread for Playing()
+		std::atomic<VoiceID> playing[MAX_VOICES];
+		std::atomic<VoiceID> started{ 0 };
+
+		// Last, so the device is closed before anything its callback uses is destroyed
+		AudioDevice device;
+
+		static AudioSpec Desired(int rate, Uint16 samples, Mixer* mixer);
+		static void SDLCALL Callback(void* userdata, Uint8* stream, int len);
+
+		bool Send(Op op, VoiceID id, float value = 0);
+		void Run(const Command& command);
+		Voice* Find(VoiceID id);
+		void End(int slot);
+		void Mix(Uint8* stream, int len);
+		void MixVoice(int slot, int frames);
+		void Write(Uint8* stream, int frames);
+	};
+}
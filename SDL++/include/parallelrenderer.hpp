@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+#include "render.hpp"
+#include "surface.hpp"
+#include "threadpool.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief A software renderer that draws into a Surface on every core.
+	 *
+	 *  Draws are recorded, not drawn, until Present().  Present() splits the
+	 *  surface into tiles, bins each recorded command into the tiles its bounds
+	 *  touch, and rasterises the tiles in parallel: the caller and every worker
+	 *  of the pool take the next undrawn tile until none are left, so a busy tile
+	 *  never holds up the others.  Each tile applies its commands in recorded
+	 *  order and no two threads touch the same pixel, so the result does not
+	 *  depend on the number of threads.
+	 *
+	 *  Meant for headless rendering of thumbnails and replays, where
+	 *  Renderer(Surface&) draws on one thread.  The surface must be 32 bits per
+	 *  pixel, as must the sources of Copy().  Blend modes are SDL's built in ones;
+	 *  rotation is not supported.  Pixels match SDL's software renderer closely
+	 *  but not exactly.
+	 */
+	struct ParallelRenderer {
+		Surface& target;
+		ThreadPool& pool;
+		// \brief The size of the tiles Present() hands out
+		Point tileSize;
+		// \brief The number of tiles that had commands in the last Present()
+		int drawnTiles = 0;
+		int error = 0;
+
+		/**
+		 *  \param target   The surface to draw into.
+		 *  \param pool     The workers tiles are rasterised on, alongside the thread calling Present().
+		 *  \param tileSize The size of each tile.  Smaller tiles balance better; larger tiles bin faster.
+		 */
+		ParallelRenderer(Surface& target, ThreadPool& pool, const Point& tileSize = { 64, 64 });
+
+		ParallelRenderer(const ParallelRenderer&) = delete;
+		ParallelRenderer& operator=(const ParallelRenderer&) = delete;
+
+		// Resets the error
+		ParallelRenderer& FlushError();
+
+		ParallelRenderer& SetDrawColor(const Colour& color);
+		ParallelRenderer& SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a = 255);
+		Colour GetDrawColor() const { return color; }
+		/**
+		 *  \brief Set the blend mode of the points, lines and rectangles recorded after this.
+		 *
+		 *  Custom blend modes are not supported and set the error.
+		 */
+		ParallelRenderer& SetDrawBlendMode(const BlendMode& blendMode);
+		BlendMode GetDrawBlendMode() const { return blendMode; }
+		// \brief Clip the commands recorded after this to a rectangle of the surface.
+		ParallelRenderer& SetClipRect(const Rect& rect);
+		// \brief Stop clipping the commands recorded after this.
+		ParallelRenderer& DisableClip();
+
+		// \brief Fill the whole surface with the draw colour, ignoring the blend mode and clip rectangle.
+		ParallelRenderer& Clear();
+		ParallelRenderer& DrawPoint(const Point& point);
+		ParallelRenderer& DrawPoints(const Point* points, int count);
+		ParallelRenderer& DrawLine(const Point& a, const Point& b);
+		// \brief Draw a series of connected lines, drawing each joint once.
+		ParallelRenderer& DrawLines(const Point* points, int count);
+		ParallelRenderer& DrawRect(const Rect& rect);
+		ParallelRenderer& DrawRects(const Rect* rects, int count);
+		ParallelRenderer& FillRect(const Rect& rect);
+		ParallelRenderer& FillRects(const Rect* rects, int count);
+		// \brief Fill the clip rectangle, or the whole surface if clipping is disabled.
+		ParallelRenderer& Fill();
+
+		/**
+		 *  \brief Copy a portion of a surface, scaled to fit and flipped.
+		 *
+		 *  The surface's colour mod, alpha mod and blend mode are taken when the
+		 *  copy is recorded; its pixels are read at Present(), so it must not be
+		 *  changed or freed before then.  Colour keys are ignored.
+		 *
+		 *  \param source   The surface to copy from.
+		 *  \param src      The source rectangle, or NULL for the whole surface.
+		 *  \param dst      The destination rectangle, or NULL for the whole target.
+		 *  \param flipType Which flipping actions should be performed.
+		 */
+		ParallelRenderer& Copy(Surface& source, const Rect* src, const Rect* dst, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE);
+		ParallelRenderer& Copy(Surface& source, const Rect& src, const Rect& dst, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE);
+		ParallelRenderer& Copy(Surface& source, const Rect& dst, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE);
+
+		// \brief The number of commands recorded since the last Present().
+		size_t Size() const { return commands.size(); }
+		// \brief Discard every recorded command without drawing it.
+		ParallelRenderer& Discard();
+		/**
+		 *  \brief Rasterise every recorded command into the surface and clear the record.
+		 *
+		 *  Waits only for tiles other threads have started, not for workers to
+		 *  become free, so it returns as soon as the tiles are drawn even when the
+		 *  pool is busy with other jobs, and may be called from one of its workers.
+		 *
+		 *  \return 0 on success, or -1 if the surface or a source cannot be drawn.
+		 */
+		int Present();
+
+	private:
+		enum class Op : Uint8 {
+			POINTS,
+			LINES,
+			FILL_RECTS,
+			COPY
+		};
+
+		struct Command {
+			Op op;
+			BlendMode blendMode;
+			Colour color;
+			// The pixels the command may touch, already clipped
+			Rect bounds;
+			// The points or rectangles of the command
+			size_t first;
+			int count;
+			// For copies
+			SDL_Surface* source;
+			Rect src, dst;
+			Texture::Flip flip;
+		};
+
+		Colour color = { 255, 255, 255, 255 };
+		BlendMode blendMode = SDL_BLENDMODE_NONE;
+		bool clipEnabled = false;
+		Rect clip;
+
+		std::vector<Command> commands;
+		std::vector<Point> points;
+		std::vector<Rect> rects;
+		// The commands touching each tile, in recorded order
+		std::vector<std::vector<Uint32>> bins;
+
+		Rect TargetRect() const;
+		Rect Clipped(const Rect& rect) const;
+		Command& Record(Op op, const Rect& bounds, size_t first, int count);
+		void Bin(Uint32 index, const Point& tiles);
+		void DrawTile(const Rect& tile, const std::vector<Uint32>& bin) const;
+	};
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <SDL_timer.h>
+
+/**
+ *  Define SDLPP_PROFILE to build the profiling zones and counters into the
+ *  library and the program.  Without it the SDLPP_PROFILE_* macros expand to
+ *  nothing; the Profiler functions still exist but have nothing to record.
+ */
+#define SDLPP_CONCAT_(a, b) a##b
+#define SDLPP_CONCAT(a, b) SDLPP_CONCAT_(a, b)
+
+#ifdef SDLPP_PROFILE
+// \brief Time the rest of the enclosing scope under \c name, which must be a string literal.
+#define SDLPP_PROFILE_ZONE(name) ::SDL::ProfileZone SDLPP_CONCAT(sdlpp_zone_, __LINE__)(name)
+// \brief Time the rest of the enclosing function.
+#define SDLPP_PROFILE_FUNCTION() SDLPP_PROFILE_ZONE(__FUNCTION__)
+// \brief Count a draw call using \c texture, or NULL for untextured drawing.
+#define SDLPP_PROFILE_DRAW(texture) ::SDL::Profiler::CountDraw(texture)
+// \brief Count \c bytes of pixel data sent to the GPU.
+#define SDLPP_PROFILE_UPLOAD(bytes) ::SDL::Profiler::CountUpload(bytes)
+// \brief Mark the end of a frame.
+#define SDLPP_PROFILE_FRAME() ::SDL::Profiler::EndFrame()
+#else
+#define SDLPP_PROFILE_ZONE(name) ((void)0)
+#define SDLPP_PROFILE_FUNCTION() ((void)0)
+#define SDLPP_PROFILE_DRAW(texture) ((void)0)
+#define SDLPP_PROFILE_UPLOAD(bytes) ((void)0)
+#define SDLPP_PROFILE_FRAME() ((void)0)
+#endif
+
+namespace SDL {
+	/**
+	 *  \brief A recording profiler for finding where a frame's time goes.
+	 *
+	 *  Each thread writes finished zones into its own ring buffer without locking.
+	 *  EndFrame() drains every ring; while a capture is running the zones are kept
+	 *  and can be written out with WriteChromeTrace(), otherwise they are dropped.
+	 *  A thread that fills its ring before the next EndFrame() loses the zones that
+	 *  do not fit, and these are counted in Counters::dropped.
+	 *
+	 *  Zones are added inside the library around Renderer::Present(), Input::Update(),
+	 *  the Texture::Copy functions and Surface blits.  Use SDLPP_PROFILE_ZONE() to
+	 *  add your own.
+	 */
+	namespace Profiler {
+		// \brief A finished zone.  Times are in performance counter ticks.
+		struct Sample {
+			const char* name;
+			Uint64 start;
+			Uint64 end;
+			Uint32 thread;
+		};
+
+		// \brief Totals for one frame
+		struct Counters {
+			Uint32 drawCalls = 0;
+			// \brief Draw calls using a different texture to the one before
+			Uint32 textureSwitches = 0;
+			Uint64 bytesUploaded = 0;
+			// \brief Zones lost because a thread's ring was full
+			Uint32 dropped = 0;
+		};
+
+		// \brief A frame, from the end of the previous one to its EndFrame().
+		struct Frame {
+			Uint64 start = 0;
+			Uint64 end = 0;
+			Counters counters;
+
+			double Milliseconds() const;
+		};
+
+		// \brief The number of zones each thread can hold between calls to EndFrame().
+		constexpr Uint32 RING_SIZE = 1 << 14;
+
+		// \brief Record a finished zone on the calling thread.
+		void Record(const char* name, Uint64 start, Uint64 end);
+		void CountDraw(const void* texture);
+		void CountUpload(Uint64 bytes);
+
+		/**
+		 *  \brief Name the calling thread in exported traces.
+		 *
+		 *  \param name A string that outlives the profiler, such as a literal.
+		 */
+		void SetThreadName(const char* name);
+
+		/**
+		 *  \brief Finish the current frame: drain every thread's ring and reset the
+		 *         counters.  Renderer::Present() calls this when profiling is built in.
+		 */
+		void EndFrame();
+		// \brief The frame finished by the last EndFrame().
+		Frame LastFrame();
+
+		// \brief Start keeping zones and frames, discarding any previous capture.
+		void BeginCapture();
+		// \brief Stop keeping zones and frames.  The capture is kept until the next BeginCapture().
+		void EndCapture();
+		bool Capturing();
+
+		const std::vector<Sample>& CapturedSamples();
+		const std::vector<Frame>& CapturedFrames();
+
+		/**
+		 *  \brief Write the capture in the Chrome trace event format, which can be
+		 *         opened in chrome://tracing, Perfetto, or imported into Tracy.
+		 *
+		 *  \return 0 on success or a negative error code on failure; call GetError()
+		 *          for more information.
+		 */
+		int WriteChromeTrace(const std::string& file);
+	}
+
+	// \brief Records the time from its construction to its destruction as a zone.
+	struct ProfileZone {
+		const char* name;
+		Uint64 start;
+
+		ProfileZone(const char* name) : name(name), start(SDL_GetPerformanceCounter()) {}
+		~ProfileZone() { Profiler::Record(name, start, SDL_GetPerformanceCounter()); }
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+	};
+}
@@ -3,6 +3,7 @@
 #include "rect.hpp"
 #include <string>
 #include <ostream>
+#include <vector>
 
 namespace SDL {
 	struct RayContact {
@@ -12,6 +13,29 @@ namespace SDL {
 		float time = 0;
 	};
 
+	// \brief Rectangles stored as one array per field, for the batch intersection tests
+	struct FRectArray {
+		std::vector<float> x, y, w, h;
+
+		void push_back(const FRect& rect) { x.push_back(rect.x); y.push_back(rect.y); w.push_back(rect.w); h.push_back(rect.h); }
+		void clear() { x.clear(); y.clear(); w.clear(); h.clear(); }
+		void reserve(size_t n) { x.reserve(n); y.reserve(n); w.reserve(n); h.reserve(n); }
+		size_t size() const { return x.size(); }
+		FRect operator[](size_t i) const { return FRect(x[i], y[i], w[i], h[i]); }
+	};
+
+	struct Ray;
+
+	// \brief Rays stored as one array per field, for the batch intersection tests
+	struct RayArray {
+		std::vector<float> originX, originY, dirX, dirY;
+
+		void push_back(const Ray& ray);
+		void clear() { originX.clear(); originY.clear(); dirX.clear(); dirY.clear(); }
+		void reserve(size_t n) { originX.reserve(n); originY.reserve(n); dirX.reserve(n); dirY.reserve(n); }
+		size_t size() const { return originX.size(); }
+	};
+
 	struct Ray {
 		FPoint origin;
 		FPoint dir;
@@ -22,12 +46,50 @@ namespace SDL {
 		Ray(FPoint origin, FPoint dir);
 
 		operator std::string() const;
+		// \brief Write the string conversion into a buffer without allocating. See FPoint::Format().
+		int Format(char* buffer, size_t size) const;
 
 		bool intersectsRect(const Rect& rect) const;
 		bool intersectsRect(const FRect& rect) const;
 		bool intersectRect(const Rect& rect);
 		bool intersectRect(const FRect& rect);
 
+		// \brief The contact of the ray with \c rect, without touching \c hit, so it is safe to share the ray between threads.
+		RayContact intersect(const Rect& rect) const;
+		RayContact intersect(const FRect& rect) const;
+
+		/**
+		 *  \brief Intersect the ray with many rectangles at once.
+		 *
+		 *  The tests run 4 or 8 rectangles at a time using the SIMD::GetLevel()
+		 *  instruction set, and give the same contacts as intersect().
+		 *
+		 *  \param rects    The rectangles.
+		 *  \param contacts An array of \c rects.size() contacts to fill in.
+		 *
+		 *  \return The number of rectangles hit.
+		 */
+		int intersectRects(const FRectArray& rects, RayContact* contacts) const;
+		/**
+		 *  \brief Intersect the ray with many rectangles at once, finding only the time of each contact.
+		 *
+		 *  \param times An array of \c rects.size() floats, set to the time of each contact,
+		 *               or to INFINITY where a rectangle is missed.
+		 *
+		 *  \return The number of rectangles hit.
+		 */
+		int intersectRects(const FRectArray& rects, float* times) const;
+		/**
+		 *  \brief Find the rectangle the ray hits first.
+		 *
+		 *  \return The index of the rectangle, or -1 if none is hit.
+		 */
+		int nearestRect(const FRectArray& rects, RayContact& contact) const;
+
+		// \brief Intersect many rays with one rectangle at once. See intersectRects().
+		static int intersectRays(const RayArray& rays, const FRect& rect, RayContact* contacts);
+		static int intersectRays(const RayArray& rays, const FRect& rect, float* times);
+
 		friend static std::ostream& operator<<(std::ostream& os, const Ray& r);
 	};
 }
\ No newline at end of file
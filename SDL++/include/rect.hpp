@@ -3,6 +3,10 @@
 #include <SDL_rect.h>
 #include <string>
 #include <ostream>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
 
 namespace SDL {
 	struct Point;
@@ -22,25 +26,31 @@ namespace SDL {
 			SDL_FPoint point;
 		};
 
-		FPoint();
-		FPoint(float x, float y);
-		FPoint(const FPoint& v);
-		FPoint(const SDL_FPoint& point);
+		constexpr FPoint();
+		constexpr FPoint(float x, float y);
+		constexpr FPoint(const SDL_FPoint& point);
 
 		static FPoint FromAngle(float angle, float mag = 1.0f);
 
 		operator std::string() const;
-
-		float sqrMag() const;
+		/**
+		 *  \brief Write the same text as the string conversion into a buffer,
+		 *         without allocating.
+		 *
+		 *  \return The length of the text, which is cut short if it is not less than \c size.
+		 */
+		int Format(char* buffer, size_t size) const;
+
+		constexpr float sqrMag() const;
 		float mag() const;
-		float min() const;
-		float max() const;
+		constexpr float min() const;
+		constexpr float max() const;
 
-		bool nonZero() const;
-		bool inRect(const FRect& r) const;
+		constexpr bool nonZero() const;
+		constexpr bool inRect(const FRect& r) const;
 
 		FPoint turn(float a) const;
-		FPoint perp() const;
+		constexpr FPoint perp() const;
 		FPoint norm() const;
 		FPoint abs()  const;
 
@@ -48,62 +58,62 @@ namespace SDL {
 		Point round() const;
 		Point ceil()  const;
 
-		FPoint clampX(float x1, float x2) const;
-		FPoint clampY(float y1, float y2) const;
+		constexpr FPoint clampX(float x1, float x2) const;
+		constexpr FPoint clampY(float y1, float y2) const;
 		FPoint clampR(float r1, float r2) const;
 
-		static float    dot(const FPoint& v1, const FPoint& v2);
-		static float  cross(const FPoint& v1, const FPoint& v2);
-		static FPoint min(const FPoint& v1, const FPoint& v2);
-		static FPoint max(const FPoint& v1, const FPoint& v2);
-
-		FPoint operator+() const;
-		FPoint operator-() const;
-
-		FPoint operator+(const FPoint& v) const;
-		FPoint operator-(const FPoint& v) const;
-		FPoint operator*(const FPoint& v) const;
-		FPoint operator/(const FPoint& v) const;
-
-		FPoint operator+(const Point& v) const;
-		FPoint operator-(const Point& v) const;
-		FPoint operator*(const Point& v) const;
-		FPoint operator/(const Point& v) const;
-
-		FPoint& operator+=(const FPoint& v);
-		FPoint& operator-=(const FPoint& v);
-		FPoint& operator*=(const FPoint& v);
-		FPoint& operator/=(const FPoint& v);
-
-		FPoint& operator+=(const Point& v);
-		FPoint& operator-=(const Point& v);
-		FPoint& operator*=(const Point& v);
-		FPoint& operator/=(const Point& v);
-
-		FPoint operator*(double m) const;
-		FPoint operator/(double m) const;
-		FPoint operator*(float m) const;
-		FPoint operator/(float m) const;
-		FPoint operator*(int m) const;
-		FPoint operator/(int m) const;
-
-		FPoint& operator*=(double m);
-		FPoint& operator/=(double m);
-		FPoint& operator*=(float m);
-		FPoint& operator/=(float m);
-		FPoint& operator*=(int m);
-		FPoint& operator/=(int m);
-
-		bool operator==(const FPoint& v) const;
-		bool operator!=(const FPoint& v) const;
+		static constexpr float    dot(const FPoint& v1, const FPoint& v2);
+		static constexpr float  cross(const FPoint& v1, const FPoint& v2);
+		static constexpr FPoint min(const FPoint& v1, const FPoint& v2);
+		static constexpr FPoint max(const FPoint& v1, const FPoint& v2);
+
+		constexpr FPoint operator+() const;
+		constexpr FPoint operator-() const;
+
+		constexpr FPoint operator+(const FPoint& v) const;
+		constexpr FPoint operator-(const FPoint& v) const;
+		constexpr FPoint operator*(const FPoint& v) const;
+		constexpr FPoint operator/(const FPoint& v) const;
+
+		constexpr FPoint operator+(const Point& v) const;
+		constexpr FPoint operator-(const Point& v) const;
+		constexpr FPoint operator*(const Point& v) const;
+		constexpr FPoint operator/(const Point& v) const;
+
+		constexpr FPoint& operator+=(const FPoint& v);
+		constexpr FPoint& operator-=(const FPoint& v);
+		constexpr FPoint& operator*=(const FPoint& v);
+		constexpr FPoint& operator/=(const FPoint& v);
+
+		constexpr FPoint& operator+=(const Point& v);
+		constexpr FPoint& operator-=(const Point& v);
+		constexpr FPoint& operator*=(const Point& v);
+		constexpr FPoint& operator/=(const Point& v);
+
+		constexpr FPoint operator*(double m) const;
+		constexpr FPoint operator/(double m) const;
+		constexpr FPoint operator*(float m) const;
+		constexpr FPoint operator/(float m) const;
+		constexpr FPoint operator*(int m) const;
+		constexpr FPoint operator/(int m) const;
+
+		constexpr FPoint& operator*=(double m);
+		constexpr FPoint& operator/=(double m);
+		constexpr FPoint& operator*=(float m);
+		constexpr FPoint& operator/=(float m);
+		constexpr FPoint& operator*=(int m);
+		constexpr FPoint& operator/=(int m);
+
+		constexpr bool operator==(const FPoint& v) const;
+		constexpr bool operator!=(const FPoint& v) const;
 	};
 
-	FPoint operator*(double a, const FPoint& b);
-	FPoint operator/(double a, const FPoint& b);
-	FPoint operator*(float a, const FPoint& b);
-	FPoint operator/(float a, const FPoint& b);
-	FPoint operator*(int a, const FPoint& b);
-	FPoint operator/(int a, const FPoint& b);
+	constexpr FPoint operator*(double a, const FPoint& b);
+	constexpr FPoint operator/(double a, const FPoint& b);
+	constexpr FPoint operator*(float a, const FPoint& b);
+	constexpr FPoint operator/(float a, const FPoint& b);
+	constexpr FPoint operator*(int a, const FPoint& b);
+	constexpr FPoint operator/(int a, const FPoint& b);
 
 	struct Point {
 	public:
@@ -117,83 +127,84 @@ namespace SDL {
 			SDL_Point point;
 		};
 
-		Point();
-		Point(int x, int y);
-		Point(const Point& v);
-		Point(const SDL_Point& point);
+		constexpr Point();
+		constexpr Point(int x, int y);
+		constexpr Point(const SDL_Point& point);
 
-		operator FPoint() const;
+		constexpr operator FPoint() const;
 		operator std::string() const;
+		// \brief Write the string conversion into a buffer without allocating. See FPoint::Format().
+		int Format(char* buffer, size_t size) const;
 
-		int sqrMag() const;
+		constexpr int sqrMag() const;
 		float mag() const;
-		int min() const;
-		int max() const;
+		constexpr int min() const;
+		constexpr int max() const;
 
-		bool nonZero() const;
-		bool inRect(const Rect& r) const;
+		constexpr bool nonZero() const;
+		constexpr bool inRect(const Rect& r) const;
 
 		FPoint turn(float a) const;
-		Point perp() const;
+		constexpr Point perp() const;
 		FPoint norm() const;
 		Point abs() const;
 
-		Point  clampX(int x1, int x2) const;
-		Point  clampY(int y1, int y2) const;
+		constexpr Point  clampX(int x1, int x2) const;
+		constexpr Point  clampY(int y1, int y2) const;
 		FPoint clampR(float r1, float r2) const;
 
-		static int dot(const Point& v1, const Point& v2);
-		static int cross(const Point& v1, const Point& v2);
-		static Point min(const Point& v1, const Point& v2);
-		static Point max(const Point& v1, const Point& v2);
-
-		Point operator+ () const;
-		Point operator- () const;
-
-		FPoint operator+(const FPoint& v) const;
-		FPoint operator-(const FPoint& v) const;
-		FPoint operator*(const FPoint& v) const;
-		FPoint operator/(const FPoint& v) const;
-
-		Point operator+(const Point& v) const;
-		Point operator-(const Point& v) const;
-		Point operator*(const Point& v) const;
-		Point operator/(const Point& v) const;
-
-		Point& operator+=(const FPoint& v);
-		Point& operator-=(const FPoint& v);
-		Point& operator*=(const FPoint& v);
-		Point& operator/=(const FPoint& v);
-
-		Point& operator+=(const Point& v);
-		Point& operator-=(const Point& v);
-		Point& operator*=(const Point& v);
-		Point& operator/=(const Point& v);
-
-		FPoint operator*(double m) const;
-		FPoint operator/(double m) const;
-		FPoint operator*(float m) const;
-		FPoint operator/(float m) const;
-		Point  operator*(int m) const;
-		Point  operator/(int m) const;
-
-		Point& operator*=(double m);
-		Point& operator/=(double m);
-		Point& operator*=(float m);
-		Point& operator/=(float m);
-		Point& operator*=(int m);
-		Point& operator/=(int m);
-
-		bool operator==(const Point& v) const;
-		bool operator!=(const Point& v) const;
+		static constexpr int dot(const Point& v1, const Point& v2);
+		static constexpr int cross(const Point& v1, const Point& v2);
+		static constexpr Point min(const Point& v1, const Point& v2);
+		static constexpr Point max(const Point& v1, const Point& v2);
+
+		constexpr Point operator+ () const;
+		constexpr Point operator- () const;
+
+		constexpr FPoint operator+(const FPoint& v) const;
+		constexpr FPoint operator-(const FPoint& v) const;
+		constexpr FPoint operator*(const FPoint& v) const;
+		constexpr FPoint operator/(const FPoint& v) const;
+
+		constexpr Point operator+(const Point& v) const;
+		constexpr Point operator-(const Point& v) const;
+		constexpr Point operator*(const Point& v) const;
+		constexpr Point operator/(const Point& v) const;
+
+		constexpr Point& operator+=(const FPoint& v);
+		constexpr Point& operator-=(const FPoint& v);
+		constexpr Point& operator*=(const FPoint& v);
+		constexpr Point& operator/=(const FPoint& v);
+
+		constexpr Point& operator+=(const Point& v);
+		constexpr Point& operator-=(const Point& v);
+		constexpr Point& operator*=(const Point& v);
+		constexpr Point& operator/=(const Point& v);
+
+		constexpr FPoint operator*(double m) const;
+		constexpr FPoint operator/(double m) const;
+		constexpr FPoint operator*(float m) const;
+		constexpr FPoint operator/(float m) const;
+		constexpr Point  operator*(int m) const;
+		constexpr Point  operator/(int m) const;
+
+		constexpr Point& operator*=(double m);
+		constexpr Point& operator/=(double m);
+		constexpr Point& operator*=(float m);
+		constexpr Point& operator/=(float m);
+		constexpr Point& operator*=(int m);
+		constexpr Point& operator/=(int m);
+
+		constexpr bool operator==(const Point& v) const;
+		constexpr bool operator!=(const Point& v) const;
 	};
 
-	FPoint operator*(double a, const Point& b);
-	FPoint operator/(double a, const Point& b);
-	FPoint operator*(float a, const Point& b);
-	FPoint operator/(float a, const Point& b);
-	Point operator*(int a, const Point& b);
-	Point operator/(int a, const Point& b);
+	constexpr FPoint operator*(double a, const Point& b);
+	constexpr FPoint operator/(double a, const Point& b);
+	constexpr FPoint operator*(float a, const Point& b);
+	constexpr FPoint operator/(float a, const Point& b);
+	constexpr Point operator*(int a, const Point& b);
+	constexpr Point operator/(int a, const Point& b);
 
 	struct FRect {
 		union {
@@ -214,81 +225,82 @@ namespace SDL {
 			SDL_FRect rect;
 		};
 
-		FRect();
-		FRect(float x, float y, float w, float h);
-		FRect(const FPoint& pos, const FPoint& size);
-		FRect(const FRect& rect);
-		FRect(const SDL_FRect& rect);
+		constexpr FRect();
+		constexpr FRect(float x, float y, float w, float h);
+		constexpr FRect(const FPoint& pos, const FPoint& size);
+		constexpr FRect(const SDL_FRect& rect);
 
 		operator std::string() const;
+		// \brief Write the string conversion into a buffer without allocating. See FPoint::Format().
+		int Format(char* buffer, size_t size) const;
 
-		bool  empty() const;
-		float area() const;
-		float perimeter() const;
+		constexpr bool  empty() const;
+		constexpr float area() const;
+		constexpr float perimeter() const;
 		float diagonal() const;
 
 		Rect floor() const;
 		Rect round() const;
 		Rect ceil() const;
 
-		FPoint topLeft() const;
-		FPoint topRight() const;
-		FPoint bottomLeft() const;
-		FPoint bottomRight() const;
-		FPoint middle() const;
+		constexpr FPoint topLeft() const;
+		constexpr FPoint topRight() const;
+		constexpr FPoint bottomLeft() const;
+		constexpr FPoint bottomRight() const;
+		constexpr FPoint middle() const;
 
-		FPoint clamp(const Point& v) const;
-		FPoint clamp(const FPoint& v) const;
+		constexpr FPoint clamp(const Point& v) const;
+		constexpr FPoint clamp(const FPoint& v) const;
 
-		FRect transform(const Rect& target) const;
-		FPoint transform(const Point& target) const;
-		FRect transform(const FRect& target) const;
-		FPoint transform(const FPoint& target) const;
+		constexpr FRect transform(const Rect& target) const;
+		constexpr FPoint transform(const Point& target) const;
+		constexpr FRect transform(const FRect& target) const;
+		constexpr FPoint transform(const FPoint& target) const;
 
-		bool intersectsPoint(const Point& v) const;
-		bool intersectsPoint(const FPoint& v) const;
-		bool intersectsRect(const Rect& r) const;
-		bool intersectsRect(const FRect& r) const;
+		constexpr bool intersectsPoint(const Point& v) const;
+		constexpr bool intersectsPoint(const FPoint& v) const;
+		constexpr bool intersectsRect(const Rect& r) const;
+		constexpr bool intersectsRect(const FRect& r) const;
 
 		bool intersectRect(const Rect& rect, FRect& result) const;
 		bool intersectRect(const FRect& rect, FRect& result) const;
 
-		FRect operator+ (const FPoint& v) const;
-		FRect operator- (const FPoint& v) const;
-		FRect operator+ (const Point& v) const;
-		FRect operator- (const Point& v) const;
-
-		FRect& operator+=(const FPoint& v);
-		FRect& operator-=(const FPoint& v);
-		FRect& operator+=(const Point& v);
-		FRect& operator-=(const Point& v);
-
-		FRect operator*(const FPoint& v) const;
-		FRect operator/(const FPoint& v) const;
-		FRect operator*(const Point& v) const;
-		FRect operator/(const Point& v) const;
-
-		FRect& operator*=(const FPoint& v);
-		FRect& operator/=(const FPoint& v);
-		FRect& operator*=(const Point& v);
-		FRect& operator/=(const Point& v);
-
-		FRect operator*(double m) const;
-		FRect operator/(double m) const;
-		FRect operator*(float m) const;
-		FRect operator/(float m) const;
-		FRect operator*(int m) const;
-		FRect operator/(int m) const;
-
-		FRect& operator*=(double m);
-		FRect& operator/=(double m);
-		FRect& operator*=(float m);
-		FRect& operator/=(float m);
-		FRect& operator*=(int m);
-		FRect& operator/=(int m);
-
-		bool operator==(const FRect& v) const;
-		bool operator!=(const FRect& v) const;
+		constexpr FRect operator+ (const FPoint& v) const;
+		constexpr FRect operator- (const FPoint& v) const;
+		constexpr FRect operator+ (const Point& v) const;
+		constexpr FRect operator- (const Point& v) const;
+
+		constexpr FRect& operator+=(const FPoint& v);
+		constexpr FRect& operator-=(const FPoint& v);
+		constexpr FRect& operator+=(const Point& v);
+		constexpr FRect& operator-=(const Point& v);
+
+		constexpr FRect operator*(const FPoint& v) const;
+		constexpr FRect operator/(const FPoint& v) const;
+		constexpr FRect operator*(const Point& v) const;
+		constexpr FRect operator/(const Point& v) const;
+
+		constexpr FRect& operator*=(const FPoint& v);
+		constexpr FRect& operator/=(const FPoint& v);
+		constexpr FRect& operator*=(const Point& v);
+		constexpr FRect& operator/=(const Point& v);
+
+		constexpr FRect operator*(double m) const;
+		constexpr FRect operator/(double m) const;
+		constexpr FRect operator*(float m) const;
+		constexpr FRect operator/(float m) const;
+		constexpr FRect operator*(int m) const;
+		constexpr FRect operator/(int m) const;
+
+		constexpr FRect& operator*=(double m);
+		constexpr FRect& operator/=(double m);
+		constexpr FRect& operator*=(float m);
+		constexpr FRect& operator/=(float m);
+		constexpr FRect& operator*=(int m);
+		constexpr FRect& operator/=(int m);
+
+		constexpr bool operator==(const FRect& v) const;
+		constexpr bool operator!=(const FRect& v) const;
 	};
 
 	struct Rect {
@@ -310,45 +322,46 @@ namespace SDL {
 			SDL_Rect rect;
 		};
 
-		Rect();
-		Rect(int x, int y, int w, int h);
-		Rect(const Point& pos, const Point& size);
-		Rect(const Rect& rect);
-		Rect(const SDL_Rect& rect);
+		constexpr Rect();
+		constexpr Rect(int x, int y, int w, int h);
+		constexpr Rect(const Point& pos, const Point& size);
+		constexpr Rect(const SDL_Rect& rect);
 
-		operator FRect() const;
+		constexpr operator FRect() const;
 		operator std::string() const;
+		// \brief Write the string conversion into a buffer without allocating. See FPoint::Format().
+		int Format(char* buffer, size_t size) const;
 
-		bool empty() const;
-		int area() const;
-		int perimeter() const;
+		constexpr bool empty() const;
+		constexpr int area() const;
+		constexpr int perimeter() const;
 		float diagonal() const;
 
-		Point topLeft() const;
-		Point topRight() const;
-		Point bottomLeft() const;
-		Point bottomRight() const;
-		FPoint middle() const;
+		constexpr Point topLeft() const;
+		constexpr Point topRight() const;
+		constexpr Point bottomLeft() const;
+		constexpr Point bottomRight() const;
+		constexpr FPoint middle() const;
 
-		Point clamp(const Point& v) const;
-		FPoint clamp(const FPoint& v) const;
+		constexpr Point clamp(const Point& v) const;
+		constexpr FPoint clamp(const FPoint& v) const;
 
-		FPoint percent(const FPoint& p) const;
+		constexpr FPoint percent(const FPoint& p) const;
 
 		template <typename iterator>
 		bool enclosePoints(iterator begin, iterator end, const Rect& clip);
 		template <typename iterator>
 		bool enclosePoints(iterator begin, iterator end);
 
-		Rect transform(const Rect& target) const;
-		Point transform(const Point& target) const;
-		FRect transform(const FRect& target) const;
-		FPoint transform(const FPoint& target) const;
+		constexpr Rect transform(const Rect& target) const;
+		constexpr Point transform(const Point& target) const;
+		constexpr FRect transform(const FRect& target) const;
+		constexpr FPoint transform(const FPoint& target) const;
 
-		bool intersectsPoint(const Point& v) const;
-		bool intersectsPoint(const FPoint& v) const;
-		bool intersectsRect(const Rect& r) const;
-		bool intersectsRect(const FRect& r) const;
+		constexpr bool intersectsPoint(const Point& v) const;
+		constexpr bool intersectsPoint(const FPoint& v) const;
+		constexpr bool intersectsRect(const Rect& r) const;
+		constexpr bool intersectsRect(const FRect& r) const;
 		bool intersectsLine(const Point& P1, const Point& P2);
 
 		void rectUnion(const Rect& rect, Rect& result) const;
@@ -357,46 +370,429 @@ namespace SDL {
 		bool intersectRect(const FRect& rect, FRect& result) const;
 		bool intersectLine(Point& P1, Point& P2) const;
 
-		FRect operator+(const FPoint& v) const;
-		FRect operator-(const FPoint& v) const;
-		Rect  operator+(const Point& v) const;
-		Rect  operator-(const Point& v) const;
-
-		Rect& operator+=(const FPoint& v);
-		Rect& operator-=(const FPoint& v);
-		Rect& operator+=(const Point& v);
-		Rect& operator-=(const Point& v);
-
-		FRect operator*(const FPoint& v) const;
-		FRect operator/(const FPoint& v) const;
-		Rect  operator*(const Point& v) const;
-		Rect  operator/(const Point& v) const;
-
-		Rect& operator*=(const FPoint& v);
-		Rect& operator/=(const FPoint& v);
-		Rect& operator*=(const Point& v);
-		Rect& operator/=(const Point& v);
-
-		FRect operator*(double m) const;
-		FRect operator/(double m) const;
-		FRect operator*(float m) const;
-		FRect operator/(float m) const;
-		Rect  operator*(int m) const;
-		Rect  operator/(int m) const;
-
-		Rect& operator*=(double m);
-		Rect& operator/=(double m);
-		Rect& operator*=(float m);
-		Rect& operator/=(float m);
-		Rect& operator*=(int m);
-		Rect& operator/=(int m);
-
-		bool operator==(const Rect& v) const;
-		bool operator!=(const Rect& v) const;
+		constexpr FRect operator+(const FPoint& v) const;
+		constexpr FRect operator-(const FPoint& v) const;
+		constexpr Rect  operator+(const Point& v) const;
+		constexpr Rect  operator-(const Point& v) const;
+
+		constexpr Rect& operator+=(const FPoint& v);
+		constexpr Rect& operator-=(const FPoint& v);
+		constexpr Rect& operator+=(const Point& v);
+		constexpr Rect& operator-=(const Point& v);
+
+		constexpr FRect operator*(const FPoint& v) const;
+		constexpr FRect operator/(const FPoint& v) const;
+		constexpr Rect  operator*(const Point& v) const;
+		constexpr Rect  operator/(const Point& v) const;
+
+		constexpr Rect& operator*=(const FPoint& v);
+		constexpr Rect& operator/=(const FPoint& v);
+		constexpr Rect& operator*=(const Point& v);
+		constexpr Rect& operator/=(const Point& v);
+
+		constexpr FRect operator*(double m) const;
+		constexpr FRect operator/(double m) const;
+		constexpr FRect operator*(float m) const;
+		constexpr FRect operator/(float m) const;
+		constexpr Rect  operator*(int m) const;
+		constexpr Rect  operator/(int m) const;
+
+		constexpr Rect& operator*=(double m);
+		constexpr Rect& operator/=(double m);
+		constexpr Rect& operator*=(float m);
+		constexpr Rect& operator/=(float m);
+		constexpr Rect& operator*=(int m);
+		constexpr Rect& operator/=(int m);
+
+		constexpr bool operator==(const Rect& v) const;
+		constexpr bool operator!=(const Rect& v) const;
 	};
 
-	std::ostream& operator<<(std::ostream& os, const FPoint& v);
-	std::ostream& operator<<(std::ostream& os, const Point& v);
-	std::ostream& operator<<(std::ostream& os, const FRect& r);
-	std::ostream& operator<<(std::ostream& os, const Rect& r);
-}
\ No newline at end of file
+#pragma region FPoint
+	constexpr FPoint::FPoint() : x(0), y(0) {}
+	constexpr FPoint::FPoint(float x, float y) : x(x), y(y) {}
+	constexpr FPoint::FPoint(const SDL_FPoint& point) : point(point) {}
+
+	inline FPoint FPoint::FromAngle(float angle, float mag) { return { cosf(angle) * mag, sinf(angle) * mag }; }
+
+	inline FPoint::operator std::string() const { return "(" + std::to_string(x) + ", " + std::to_string(y) + ")"; }
+	inline int FPoint::Format(char* buffer, size_t size) const { return SDL_snprintf(buffer, size, "(%f, %f)", (double)x, (double)y); }
+
+	constexpr float FPoint::sqrMag() const { return x * x + y * y; }
+	inline float FPoint::mag() const { return std::sqrt(x * x + y * y); }
+	constexpr float FPoint::min() const { return std::min(x, y); }
+	constexpr float FPoint::max() const { return std::max(x, y); }
+
+	constexpr bool FPoint::nonZero() const { return x != 0 || y != 0; }
+	constexpr bool FPoint::inRect(const FRect& r) const { return x >= r.x && y >= r.y && x < r.x + r.w && y < r.y + r.h; }
+
+	inline FPoint FPoint::turn(float a) const { return { x * cos(a) - y * sin(a), x * sin(a) + y * cos(a) }; }
+	constexpr FPoint FPoint::perp() const { return { -y, x }; }
+	inline FPoint FPoint::norm() const { float size = mag(); return size == 0.0f ? FPoint(0, 0) : FPoint(x / size, y / size); }
+	inline FPoint FPoint::abs() const { return { std::abs(x), std::abs(y) }; }
+
+	inline Point FPoint::floor() const { return { (int)std::floor(x), (int)std::floor(y) }; }
+	inline Point FPoint::round() const { return { (int)std::round(x), (int)std::round(y) }; }
+	inline Point FPoint::ceil()  const { return { (int)std::ceil(x),  (int)std::ceil(y) }; }
+
+	constexpr FPoint FPoint::clampX(float x1, float x2) const { return { std::clamp(x, x1, x2), y }; }
+	constexpr FPoint FPoint::clampY(float y1, float y2) const { return { x, std::clamp(y, y1, y2) }; }
+	inline FPoint FPoint::clampR(float r1, float r2) const { float size = mag(); float r = std::max(0.0f, std::clamp(size, r1, r2)); if (size == r) return FPoint(*this); else return *this * (r / size); }
+
+	constexpr float FPoint::dot(const FPoint& v1, const FPoint& v2) { return v1.x * v2.x + v1.y * v2.y; }
+	constexpr float FPoint::cross(const FPoint& v1, const FPoint& v2) { return v1.y * v2.x - v1.x * v2.y; }
+	constexpr FPoint FPoint::min(const FPoint& v1, const FPoint& v2) { return { std::min(v1.x, v2.x), std::min(v1.y, v2.y) }; }
+	constexpr FPoint FPoint::max(const FPoint& v1, const FPoint& v2) { return { std::max(v1.x, v2.x), std::max(v1.y, v2.y) }; }
+
+#pragma region FPoint arithmetic
+	constexpr FPoint FPoint::operator+() const { return { +x, +y }; }
+	constexpr FPoint FPoint::operator-() const { return { -x, -y }; }
+
+	constexpr FPoint FPoint::operator+(const FPoint& v) const { return { x + v.x, y + v.y }; }
+	constexpr FPoint FPoint::operator-(const FPoint& v) const { return { x - v.x, y - v.y }; }
+	constexpr FPoint FPoint::operator*(const FPoint& v) const { return { x * v.x, y * v.y }; }
+	constexpr FPoint FPoint::operator/(const FPoint& v) const { return { x / v.x, y / v.y }; }
+
+	constexpr FPoint FPoint::operator+(const Point& v) const { return { x + v.x, y + v.y }; }
+	constexpr FPoint FPoint::operator-(const Point& v) const { return { x - v.x, y - v.y }; }
+	constexpr FPoint FPoint::operator*(const Point& v) const { return { x * v.x, y * v.y }; }
+	constexpr FPoint FPoint::operator/(const Point& v) const { return { x / v.x, y / v.y }; }
+
+	constexpr FPoint& FPoint::operator+=(const FPoint& v) { x += v.x; y += v.y; return *this; }
+	constexpr FPoint& FPoint::operator-=(const FPoint& v) { x -= v.x; y -= v.y; return *this; }
+	constexpr FPoint& FPoint::operator*=(const FPoint& v) { x *= v.x; y *= v.y; return *this; }
+	constexpr FPoint& FPoint::operator/=(const FPoint& v) { x /= v.x; y /= v.y; return *this; }
+
+	constexpr FPoint& FPoint::operator+=(const Point& v) { x += v.x; y += v.y; return *this; }
+	constexpr FPoint& FPoint::operator-=(const Point& v) { x -= v.x; y -= v.y; return *this; }
+	constexpr FPoint& FPoint::operator*=(const Point& v) { x *= v.x; y *= v.y; return *this; }
+	constexpr FPoint& FPoint::operator/=(const Point& v) { x /= v.x; y /= v.y; return *this; }
+
+	constexpr FPoint FPoint::operator*(double m) const { return { float(x * m), float(y * m) }; }
+	constexpr FPoint FPoint::operator/(double m) const { return { float(x / m), float(y / m) }; }
+	constexpr FPoint FPoint::operator*(float m ) const { return { x * m, y * m }; }
+	constexpr FPoint FPoint::operator/(float m ) const { return { x / m, y / m }; }
+	constexpr FPoint FPoint::operator*(int m   ) const { return { x * m, y * m }; }
+	constexpr FPoint FPoint::operator/(int m   ) const { return { x / m, y / m }; }
+
+	constexpr FPoint& FPoint::operator*=(double m) { x *= m; y *= m; return *this; }
+	constexpr FPoint& FPoint::operator/=(double m) { x /= m; y /= m; return *this; }
+	constexpr FPoint& FPoint::operator*=(float m ) { x *= m; y *= m; return *this; }
+	constexpr FPoint& FPoint::operator/=(float m ) { x /= m; y /= m; return *this; }
+	constexpr FPoint& FPoint::operator*=(int m   ) { x *= m; y *= m; return *this; }
+	constexpr FPoint& FPoint::operator/=(int m   ) { x /= m; y /= m; return *this; }
+
+	constexpr FPoint operator*(double m, const FPoint& v) { return { float(m * v.x), float(m * v.y) }; }
+	constexpr FPoint operator/(double m, const FPoint& v) { return { float(m / v.x), float(m / v.y) }; }
+	constexpr FPoint operator*(float m,  const FPoint& v) { return { m * v.x, m * v.y }; }
+	constexpr FPoint operator/(float m,  const FPoint& v) { return { m / v.x, m / v.y }; }
+	constexpr FPoint operator*(int m,    const FPoint& v) { return { m * v.x, m * v.y }; }
+	constexpr FPoint operator/(int m,    const FPoint& v) { return { m / v.x, m / v.y }; }
+#pragma endregion
+
+	constexpr bool FPoint::operator==(const FPoint& v) const { return x == v.x && y == v.y; }
+	constexpr bool FPoint::operator!=(const FPoint& v) const { return x != v.x || y != v.y; }
+
+	inline std::ostream& operator<<(std::ostream& os, const FPoint& v) { char buffer[256]; v.Format(buffer, sizeof(buffer)); return os << buffer; }
+#pragma endregion
+
+#pragma region Point
+	constexpr Point::Point() : x(0), y(0) {}
+	constexpr Point::Point(int x, int y) : x(x), y(y) {}
+	constexpr Point::Point(const SDL_Point& point) : point(point) {}
+
+	constexpr Point::operator FPoint() const { return { float(x), float(y) }; }
+	inline Point::operator std::string() const { return "(" + std::to_string(x) + ", " + std::to_string(y) + ")"; }
+	inline int Point::Format(char* buffer, size_t size) const { return SDL_snprintf(buffer, size, "(%d, %d)", x, y); }
+
+	constexpr int Point::sqrMag() const { return x * x + y * y; }
+	inline float Point::mag() const { return std::sqrt(x * x + y * y); }
+	constexpr int Point::min() const { return std::min(x, y); }
+	constexpr int Point::max() const { return std::max(x, y); }
+
+	constexpr bool Point::nonZero() const { return x != 0 || y != 0; }
+	constexpr bool Point::inRect(const Rect& r) const { return x >= r.x && y >= r.y && x < r.x + r.w && y < r.y + r.h; };
+
+	inline FPoint Point::turn(float a) const { return { x * cos(a) - y * sin(a), x * sin(a) + y * cos(a) }; }
+	constexpr Point Point::perp() const { return { -y, x }; }
+	inline FPoint Point::norm() const { float size = mag(); return size == 0 ? FPoint(0, 0) : FPoint(x / size, y / size); }
+	inline Point Point::abs() const { return { std::abs(x), std::abs(y) }; }
+
+	constexpr Point  Point::clampX(int x1, int x2) const { return { std::clamp(x, x1, x2), y }; }
+	constexpr Point  Point::clampY(int y1, int y2) const { return { x, std::clamp(y, y1, y2) }; }
+	inline FPoint Point::clampR(float r1, float r2) const { float size = mag(); float r = std::max(0.0f, std::clamp(size, r1, r2)); if (size == r) return FPoint(*this); else return *this * (r / size); };
+
+	constexpr int Point::dot(const Point& v1, const Point& v2) { return v1.x * v2.x + v2.y * v1.y; }
+	constexpr int Point::cross(const Point& v1, const Point& v2) { return v2.x * v1.y - v2.y * v1.x; }
+	constexpr Point Point::min(const Point& v1, const Point& v2) { return { std::min(v1.x, v2.x), std::min(v1.y, v2.y) }; }
+	constexpr Point Point::max(const Point& v1, const Point& v2) { return { std::max(v1.x, v2.x), std::max(v1.y, v2.y) }; }
+
+#pragma region Point arithmetic
+	constexpr Point Point::operator+() const { return { +x, +y }; }
+	constexpr Point Point::operator-() const { return { -x, -y }; }
+
+	constexpr FPoint Point::operator+(const FPoint& v) const { return { x + v.x, y + v.y }; }
+	constexpr FPoint Point::operator-(const FPoint& v) const { return { x - v.x, y - v.y }; }
+	constexpr FPoint Point::operator*(const FPoint& v) const { return { x * v.x, y * v.y }; }
+	constexpr FPoint Point::operator/(const FPoint& v) const { return { x / v.x, y / v.y }; }
+
+	constexpr Point Point::operator+(const Point& v) const { return { x + v.x, y + v.y }; }
+	constexpr Point Point::operator-(const Point& v) const { return { x - v.x, y - v.y }; }
+	constexpr Point Point::operator*(const Point& v) const { return { x * v.x, y * v.y }; }
+	constexpr Point Point::operator/(const Point& v) const { return { x / v.x, y / v.y }; }
+
+	constexpr Point& Point::operator+=(const FPoint& v) { x += v.x; y += v.y; return *this; }
+	constexpr Point& Point::operator-=(const FPoint& v) { x -= v.x; y -= v.y; return *this; }
+	constexpr Point& Point::operator*=(const FPoint& v) { x *= v.x; y *= v.y; return *this; }
+	constexpr Point& Point::operator/=(const FPoint& v) { x /= v.x; y /= v.y; return *this; }
+
+	constexpr Point& Point::operator+=(const Point& v) { x += v.x; y += v.y; return *this; }
+	constexpr Point& Point::operator-=(const Point& v) { x -= v.x; y -= v.y; return *this; }
+	constexpr Point& Point::operator*=(const Point& v) { x *= v.x; y *= v.y; return *this; }
+	constexpr Point& Point::operator/=(const Point& v) { x /= v.x; y /= v.y; return *this; }
+
+	constexpr FPoint Point::operator*(double m) const { return { float(x * m), float(y * m) }; }
+	constexpr FPoint Point::operator/(double m) const { return { float(x / m), float(y / m) }; }
+	constexpr FPoint Point::operator*(float m) const { return { x * m, y * m }; }
+	constexpr FPoint Point::operator/(float m) const { return { x / m, y / m }; }
+	constexpr Point  Point::operator*(int m) const { return { x * m, y * m }; };
+	constexpr Point  Point::operator/(int m) const { return { x / m, y / m }; };
+
+	constexpr Point& Point::operator*=(double m) { x *= m; y *= m; return *this; }
+	constexpr Point& Point::operator/=(double m) { x /= m; y /= m; return *this; }
+	constexpr Point& Point::operator*=(float m) { x *= m; y *= m; return *this; }
+	constexpr Point& Point::operator/=(float m) { x /= m; y /= m; return *this; }
+	constexpr Point& Point::operator*=(int m) { x *= m; y *= m; return *this; }
+	constexpr Point& Point::operator/=(int m) { x /= m; y /= m; return *this; }
+
+	constexpr FPoint operator*(double m, const Point& v) { return { float(m * v.x), float(m * v.y) }; }
+	constexpr FPoint operator/(double m, const Point& v) { return { float(m / v.x), float(m / v.y) }; }
+	constexpr FPoint operator*(float m,  const Point& v) { return { v.x * m, v.y * m }; };
+	constexpr FPoint operator/(float m,  const Point& v) { return { v.x / m, v.y / m }; };
+	constexpr Point  operator*(int m,    const Point& v) { return { v.x * m, v.y * m }; };
+	constexpr Point  operator/(int m,    const Point& v) { return { v.x / m, v.y / m }; };
+#pragma endregion
+
+	constexpr bool Point::operator==(const Point& v) const { return x == v.x && y == v.y; };
+	constexpr bool Point::operator!=(const Point& v) const { return x != v.x || y != v.y; };
+
+	inline std::ostream& operator<<(std::ostream& os, const Point& v) { char buffer[64]; v.Format(buffer, sizeof(buffer)); return os << buffer; }
+#pragma endregion
+
+#pragma region FRect
+	constexpr FRect::FRect() : pos(0, 0), size(0, 0) {}
+	constexpr FRect::FRect(float x, float y, float w, float h) : x(x), y(y), w(w), h(h) {}
+	constexpr FRect::FRect(const FPoint& pos, const FPoint& size) : pos(pos), size(size) {}
+	constexpr FRect::FRect(const SDL_FRect& rect) : rect(rect) {}
+
+	inline FRect::operator std::string() const { return "(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(w) + ", " + std::to_string(h) + ")"; }
+	inline int FRect::Format(char* buffer, size_t size) const { return SDL_snprintf(buffer, size, "(%f, %f, %f, %f)", (double)x, (double)y, (double)w, (double)h); }
+
+	constexpr bool  FRect::empty() const { return w <= 0 || h <= 0; }
+	constexpr float FRect::area() const { return w * h; }
+	constexpr float FRect::perimeter() const { return 2 * (w + h); }
+	inline float FRect::diagonal() const { return size.mag(); }
+
+	inline Rect FRect::floor() const { return { pos.floor(), (pos + size).floor() - pos.floor() }; }
+	inline Rect FRect::round() const { return { pos.round(), (pos + size).round() - pos.round() }; }
+	inline Rect FRect::ceil()  const { return { pos.ceil(),  (pos + size).ceil()  - pos.ceil()  }; }
+
+	constexpr FPoint FRect::topLeft() const { return FPoint(pos); }
+	constexpr FPoint FRect::topRight() const { return { pos.x + w, pos.y }; }
+	constexpr FPoint FRect::bottomLeft() const { return { pos.x, pos.y + h }; }
+	constexpr FPoint FRect::bottomRight() const { return pos + size; }
+	constexpr FPoint FRect::middle() const { return pos + size / 2.0f; }
+
+	constexpr FPoint FRect::clamp(const Point& v) const { return { std::clamp<float>(v.x, x, x + w), std::clamp<float>(v.y, y, y + h) }; }
+	constexpr FPoint FRect::clamp(const FPoint& v) const { return { std::clamp<float>(v.x, x, x + w), std::clamp<float>(v.y, y, y + h) }; }
+
+	constexpr FRect  FRect::transform(const Rect& target) const { return { (target.x - x) * w, (target.y - y) * h, target.w * w, target.h * h }; }
+	constexpr FPoint FRect::transform(const Point& target) const { return { (target.x - x) * w, (target.y - y) * h }; }
+	constexpr FRect  FRect::transform(const FRect& target) const { return { (target.x - x) * w, (target.y - y) * h, target.w * w, target.h * h }; }
+	constexpr FPoint FRect::transform(const FPoint& target) const { return { (target.x - x) * w, (target.y - y) * h }; }
+
+	constexpr bool FRect::intersectsPoint(const Point& v) const { return v.x > x && v.y > y && v.x < x + w && v.y < y + h; }
+	constexpr bool FRect::intersectsPoint(const FPoint& v) const { return v.x > x && v.y > y && v.x < x + w && v.y < y + h; }
+	constexpr bool FRect::intersectsRect(const  Rect& r) const { return x < r.x + r.w && y < r.y + r.h && x + w > r.x && y + h > r.y; }
+	constexpr bool FRect::intersectsRect(const FRect& r) const { return x < r.x + r.w && y < r.y + r.h && x + w > r.x && y + h > r.y; }
+
+	inline bool FRect::intersectRect(const Rect& rect, FRect& result) const {
+		if (!intersectsRect(rect)) return false;
+
+		FPoint topLeft = FPoint::max(this->topLeft(), (FPoint)rect.topLeft());
+		FPoint bottomRight = FPoint::min(this->bottomRight(), rect.bottomRight());
+		result = { topLeft, bottomRight - topLeft };
+
+		return true;
+	}
+	inline bool FRect::intersectRect(const FRect& rect, FRect& result) const {
+		if (!intersectsRect(rect)) return false;
+
+		FPoint topLeft = FPoint::max(this->topLeft(), rect.topLeft());
+		FPoint bottomRight = FPoint::min(this->bottomRight(), rect.bottomRight());
+		result = { topLeft, bottomRight - topLeft };
+
+		return true;
+	}
+
+#pragma region FRect arithmetic
+	constexpr FRect FRect::operator+(const FPoint& v) const { return { pos + v, size }; }
+	constexpr FRect FRect::operator-(const FPoint& v) const { return { pos - v, size }; }
+	constexpr FRect FRect::operator+(const Point& v) const { return { pos + v, size }; }
+	constexpr FRect FRect::operator-(const Point& v) const { return { pos - v, size }; }
+
+	constexpr FRect& FRect::operator+=(const FPoint& v) { pos += v; return *this; }
+	constexpr FRect& FRect::operator-=(const FPoint& v) { pos -= v; return *this; }
+	constexpr FRect& FRect::operator+=(const Point& v) { pos += v; return *this; }
+	constexpr FRect& FRect::operator-=(const Point& v) { pos -= v; return *this; }
+
+	constexpr FRect FRect::operator* (const FPoint& v) const { return { pos, size * v }; }
+	constexpr FRect FRect::operator/ (const FPoint& v) const { return { pos, size / v }; }
+	constexpr FRect FRect::operator* (const Point& v) const { return { pos, size * v }; }
+	constexpr FRect FRect::operator/ (const Point& v) const { return { pos, size / v }; }
+
+	constexpr FRect& FRect::operator*=(const FPoint& v) { size *= v; return *this; }
+	constexpr FRect& FRect::operator/=(const FPoint& v) { size /= v; return *this; }
+	constexpr FRect& FRect::operator*=(const Point& v) { size *= v; return *this; }
+	constexpr FRect& FRect::operator/=(const Point& v) { size /= v; return *this; }
+
+	constexpr FRect FRect::operator*(double m) const { return { pos, size * m }; }
+	constexpr FRect FRect::operator/(double m) const { return { pos, size / m }; }
+	constexpr FRect FRect::operator*(float m) const { return { pos, size * m }; }
+	constexpr FRect FRect::operator/(float m) const { return { pos, size / m }; }
+	constexpr FRect FRect::operator*(int m) const { return { pos, size * m }; }
+	constexpr FRect FRect::operator/(int m) const { return { pos, size / m }; }
+
+	constexpr FRect& FRect::operator*=(double m) { size *= m; return *this; }
+	constexpr FRect& FRect::operator/=(double m) { size /= m; return *this; }
+	constexpr FRect& FRect::operator*=(float m) { size *= m; return *this; }
+	constexpr FRect& FRect::operator/=(float m) { size /= m; return *this; }
+	constexpr FRect& FRect::operator*=(int m) { size *= m; return *this; }
+	constexpr FRect& FRect::operator/=(int m) { size /= m; return *this; }
+#pragma endregion
+
+	constexpr bool FRect::operator==(const FRect& v) const { return x == v.x && y == v.y && w == v.w && h == v.h; }
+	constexpr bool FRect::operator!=(const FRect& v) const { return x != v.x || y != v.y || w != v.w || h != v.h; }
+
+	inline std::ostream& operator<<(std::ostream& os, const FRect& r) { char buffer[256]; r.Format(buffer, sizeof(buffer)); return os << buffer; }
+#pragma endregion
+
+#pragma region Rect
+	constexpr Rect::Rect() : pos(), size() {}
+	constexpr Rect::Rect(int x, int y, int w, int h) : x(x), y(y), w(w), h(h) {}
+	constexpr Rect::Rect(const Point& pos, const Point& size) : pos(pos), size(size) {}
+	constexpr Rect::Rect(const SDL_Rect& rect) : rect(rect) {}
+
+	constexpr Rect::operator FRect() const { return { pos, size }; }
+	inline Rect::operator std::string() const { return "(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(w) + ", " + std::to_string(h) + ")"; }
+	inline int Rect::Format(char* buffer, size_t size) const { return SDL_snprintf(buffer, size, "(%d, %d, %d, %d)", x, y, w, h); }
+
+	constexpr bool  Rect::empty() const { return w <= 0 || h <= 0; }
+	constexpr int   Rect::area() const { return w * h; }
+	constexpr int   Rect::perimeter() const { return 2 * (w + h); }
+	inline float Rect::diagonal() const { return size.mag(); }
+
+	constexpr Point  Rect::topLeft() const { return Point(pos); }
+	constexpr Point  Rect::topRight() const { return { pos.x + w, pos.y }; }
+	constexpr Point  Rect::bottomLeft() const { return { pos.x, pos.y + h }; }
+	constexpr Point  Rect::bottomRight() const { return pos + size; }
+	constexpr FPoint Rect::middle() const { return pos + size / 2.0f; }
+
+	constexpr Point  Rect::clamp(const Point& v) const { return v.clampX(x, x + w).clampY(y, y + h); }
+	constexpr FPoint Rect::clamp(const FPoint& v) const { return v.clampX(x, x + w).clampY(y, y + h); }
+
+	constexpr FPoint Rect::percent(const FPoint& p) const { return pos + size * p; }
+
+	template <typename iterator>
+	bool Rect::enclosePoints(iterator begin, iterator end, const Rect& clip) {
+		std::vector<SDL_Point> points;
+		points.insert(points.begin(), begin, end);
+		return SDL_EnclosePoints(points.data(), points.size(), &clip.rect, &rect);
+	}
+	template <typename iterator>
+	bool Rect::enclosePoints(iterator begin, iterator end) {
+		std::vector<SDL_Point> points;
+		points.insert(points.begin(), begin, end);
+		return SDL_EnclosePoints(points.data(), points.size(), NULL, &rect);
+	}
+
+	constexpr Rect   Rect::transform(const Rect& target) const { return { (target.x - x) * w, (target.y - y) * h, target.w * w, target.h * h }; }
+	constexpr Point  Rect::transform(const Point& target) const { return { (target.x - x) * w, (target.y - y) * h }; }
+	constexpr FRect  Rect::transform(const FRect& target) const { return { (target.x - x) * w, (target.y - y) * h, target.w * w, target.h * h }; }
+	constexpr FPoint Rect::transform(const FPoint& target) const { return { (target.x - x) * w, (target.y - y) * h }; }
+
+	constexpr bool Rect::intersectsPoint(const Point& v) const { return v.x > x && v.y > y && v.x < x + w && v.y < y + h; }
+	constexpr bool Rect::intersectsPoint(const FPoint& v) const { return v.x > x && v.y > y && v.x < x + w && v.y < y + h; }
+	constexpr bool Rect::intersectsRect(const Rect& r) const { return x < r.x + r.w && y < r.y + r.h && x + w > r.x && y + h > r.y; }
+	constexpr bool Rect::intersectsRect(const FRect& r) const { return x < r.x + r.w && y < r.y + r.h && x + w > r.x && y + h > r.y; }
+	inline bool Rect::intersectsLine(const Point& P1, const Point& P2) {
+		Rect result(P1, P2);
+		return SDL_IntersectRectAndLine(&rect, &result.x, &result.y, &result.w, &result.h);
+	}
+
+	inline void Rect::rectUnion(const Rect& rect, Rect& result) const {
+		SDL_UnionRect(&this->rect, &rect.rect, &result.rect);
+	}
+
+	inline bool Rect::intersectRect(const Rect& rect, Rect& result) const {
+		return SDL_IntersectRect(&this->rect, &rect.rect, &result.rect);
+	}
+	inline bool Rect::intersectRect(const FRect& rect, FRect& result) const {
+		if (!intersectsRect(rect)) return false;
+
+		FPoint topLeft = FPoint::max(this->topLeft(), rect.topLeft());
+		FPoint bottomRight = FPoint::min(this->bottomRight(), rect.bottomRight());
+		result = { topLeft, bottomRight - topLeft };
+
+		return true;
+	}
+	inline bool Rect::intersectLine(Point& P1, Point& P2) const {
+		return SDL_IntersectRectAndLine(&rect, &P1.x, &P1.y, &P2.w, &P2.h);
+	}
+
+#pragma region Rect arithmetic
+	constexpr FRect Rect::operator+ (const FPoint& v) const { return { pos + v, size }; }
+	constexpr FRect Rect::operator- (const FPoint& v) const { return { pos - v, size }; }
+	constexpr Rect Rect::operator+ (const Point& v) const { return { pos + v, size }; }
+	constexpr Rect Rect::operator- (const Point& v) const { return { pos - v, size }; }
+
+	constexpr Rect& Rect::operator+=(const FPoint& v) { pos += v; return *this; }
+	constexpr Rect& Rect::operator-=(const FPoint& v) { pos -= v; return *this; }
+	constexpr Rect& Rect::operator+=(const Point& v) { pos += v; return *this; }
+	constexpr Rect& Rect::operator-=(const Point& v) { pos -= v; return *this; }
+
+	constexpr FRect Rect::operator* (const FPoint& v) const { return { pos, size * v }; }
+	constexpr FRect Rect::operator/ (const FPoint& v) const { return { pos, size / v }; }
+	constexpr Rect Rect::operator* (const Point& v) const { return { pos, size * v }; }
+	constexpr Rect Rect::operator/ (const Point& v) const { return { pos, size / v }; }
+
+	constexpr Rect& Rect::operator*=(const FPoint& v) { size *= v; return *this; }
+	constexpr Rect& Rect::operator/=(const FPoint& v) { size /= v; return *this; }
+	constexpr Rect& Rect::operator*=(const Point& v) { size *= v; return *this; }
+	constexpr Rect& Rect::operator/=(const Point& v) { size /= v; return *this; }
+
+	constexpr FRect Rect::operator*(double m) const { return { pos, size * m }; }
+	constexpr FRect Rect::operator/(double m) const { return { pos, size / m }; }
+	constexpr FRect Rect::operator*(float m)  const { return { pos, size * m }; }
+	constexpr FRect Rect::operator/(float m)  const { return { pos, size / m }; }
+	constexpr Rect  Rect::operator*(int m  )  const { return { pos, size * m }; }
+	constexpr Rect  Rect::operator/(int m  )  const { return { pos, size / m }; }
+
+	constexpr Rect& Rect::operator*=(double m) { size *= m; return *this; }
+	constexpr Rect& Rect::operator/=(double m) { size /= m; return *this; }
+	constexpr Rect& Rect::operator*=(float m)  { size *= m; return *this; }
+	constexpr Rect& Rect::operator/=(float m)  { size /= m; return *this; }
+	constexpr Rect& Rect::operator*=(int m  )  { size *= m; return *this; }
+	constexpr Rect& Rect::operator/=(int m  )  { size /= m; return *this; }
+#pragma endregion
+
+	constexpr bool Rect::operator==(const Rect& v) const { return x == v.x && y == v.y && w == v.w && h == v.h; }
+	constexpr bool Rect::operator!=(const Rect& v) const { return x != v.x || y != v.y || w != v.w || h != v.h; }
+
+	inline std::ostream& operator<<(std::ostream& os, const Rect& r) { char buffer[64]; r.Format(buffer, sizeof(buffer)); return os << buffer; }
+#pragma endregion
+
+	// Arrays of these are copied with memcpy and handed to SDL as arrays of its own types
+	static_assert(std::is_trivially_copyable<FPoint>::value && std::is_trivially_copyable<Point>::value, "points must be trivially copyable");
+	static_assert(std::is_trivially_copyable<FRect>::value && std::is_trivially_copyable<Rect>::value, "rectangles must be trivially copyable");
+}
@@ -3,12 +3,20 @@
 #include <tuple>
 #include <SDL_render.h>
 #include <stack>
+#if defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#endif
 #include "rect.hpp"
 #include "video.hpp"
 
 namespace SDL {
 	struct Texture;
 
+	// \brief Vertex structure used by Geometry
+	typedef SDL_Vertex Vertex;
+
 	// \brief A structure representing rendering state
 	struct Renderer {
 		// \brief Flags used when creating a rendering context
@@ -19,6 +27,53 @@ namespace SDL {
 		SDL_Renderer* renderer = nullptr;
 		bool freeRenderer = false;
 		int error;
+		// \brief Where draws to the output are recorded, if anywhere.  See Track().
+		DirtyRegion* dirty = nullptr;
+
+		/**
+		 *  \brief A shadow copy of the render state, used to skip SDL calls that would
+		 *         not change anything.
+		 *
+		 *  The cache is disabled by default; see EnableStateCache().  State changed by
+		 *  calling SDL directly is not seen by the cache, so call InvalidateStateCache()
+		 *  after doing so.
+		 */
+		struct StateCache {
+			// \brief Counts of calls skipped, by the state they would have set
+			struct Counters {
+				int color = 0;
+				int blendMode = 0;
+				int scale = 0;
+				int viewport = 0;
+				int clip = 0;
+				int target = 0;
+
+				int Total() const { return color + blendMode + scale + viewport + clip + target; }
+			};
+
+			bool enabled = false;
+
+			bool colorValid = false;
+			bool blendModeValid = false;
+			bool scaleValid = false;
+			bool viewportValid = false;
+			bool clipValid = false;
+			bool targetValid = false;
+
+			Colour color;
+			BlendMode blendMode;
+			FPoint scale;
+			bool viewportFull;
+			Rect viewport;
+			bool clipEnabled;
+			Rect clip;
+			SDL_Texture* target;
+
+			// \brief Calls skipped since the last Present()
+			Counters skipped;
+			// \brief Calls skipped in the frame ended by the last Present()
+			Counters lastFrame;
+		} cache;
 
 		Renderer(const Renderer& r);
 		Renderer(Renderer&& r);
@@ -39,6 +94,8 @@ namespace SDL {
 		/**
 		 *  \brief Create a 2D software rendering context for a surface.
 		 *
+		 *  If the surface is tracked, draws are recorded in its DirtyRegion too.
+		 *
 		 *  \param surface The surface where rendering is done.
 		 *
 		 *  \return A valid rendering context or NULL if there was an error.
@@ -51,6 +108,29 @@ namespace SDL {
 		// Resets the error
 		Renderer& FlushError();
 
+		/**
+		 *  \brief Record the output pixels each draw may touch in \c region, or stop
+		 *         recording for NULL.
+		 *
+		 *  Meant for software renderers drawing to a window surface.  The rectangles
+		 *  cover each draw's bounds after scale and viewport, and nothing is recorded
+		 *  while a texture is the target.
+		 */
+		Renderer& Track(DirtyRegion* region);
+
+		/**
+		 *  \brief Enable or disable the render state cache.
+		 *
+		 *  While enabled, SetDrawColor(), SetDrawBlendMode(), SetScale(), SetViewport(),
+		 *  SetClipRect() and SetTarget() do nothing when the state they set is already
+		 *  current.  The cache is invalidated when the target changes and on Present().
+		 *
+		 *  \param enable true to enable the cache, false to disable it.
+		 */
+		Renderer& EnableStateCache(bool enable = true);
+		// \brief Forget all cached render state, so that the next call to set each state reaches SDL.
+		Renderer& InvalidateStateCache();
+
 		/**
 		 *  \brief Set the drawing scale for rendering on the current target.
 		 *
@@ -463,6 +543,48 @@ namespace SDL {
 		 */
 		Renderer& FillRectsF(const std::vector<FRect>& rects);
 
+#ifdef __cpp_lib_span
+		// Spans for points and rectangles kept in arrays or other containers, so
+		// they need not be copied into a vector each frame.  C++20 only.
+		Renderer& DrawLines(std::span<const Point> points) { return DrawLines(points.data(), (int)points.size()); }
+		Renderer& DrawLinesF(std::span<const FPoint> points) { return DrawLinesF(points.data(), (int)points.size()); }
+		Renderer& DrawPoints(std::span<const Point> points) { return DrawPoints(points.data(), (int)points.size()); }
+		Renderer& DrawPointsF(std::span<const FPoint> points) { return DrawPointsF(points.data(), (int)points.size()); }
+		Renderer& DrawRects(std::span<const Rect> rects) { return DrawRects(rects.data(), (int)rects.size()); }
+		Renderer& DrawRectsF(std::span<const FRect> rects) { return DrawRectsF(rects.data(), (int)rects.size()); }
+		Renderer& FillRects(std::span<const Rect> rects) { return FillRects(rects.data(), (int)rects.size()); }
+		Renderer& FillRectsF(std::span<const FRect> rects) { return FillRectsF(rects.data(), (int)rects.size()); }
+#endif
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+		/**
+		 *  \brief Render a list of untextured triangles, optionally using indices into the vertex array.
+		 *
+		 *  \param vertices    Vertices.
+		 *  \param numVertices Number of vertices.
+		 *  \param indices     (optional) An array of integer indices into the 'vertices' array,
+		 *                     if NULL all vertices will be rendered in sequential order.
+		 *  \param numIndices  Number of indices.
+		 *
+		 *  \return 0 on success, or -1 if the operation is not supported
+		 */
+		Renderer& Geometry(const Vertex* vertices, int numVertices, const int* indices = NULL, int numIndices = 0);
+		/**
+		 *  \brief Render a list of untextured triangles, optionally using indices into the vertex array.
+		 *
+		 *  \param vertices A vector of vertices.
+		 *  \param indices  A vector of indices into vertices, if empty all vertices
+		 *                  will be rendered in sequential order.
+		 *
+		 *  \return 0 on success, or -1 if the operation is not supported
+		 */
+		Renderer& Geometry(const std::vector<Vertex>& vertices, const std::vector<int>& indices = {});
+#ifdef __cpp_lib_span
+		// \brief See Geometry(const Vertex*, int, const int*, int).  C++20 only.
+		Renderer& Geometry(std::span<const Vertex> vertices, std::span<const int> indices = {}) { return Geometry(vertices.data(), (int)vertices.size(), indices.empty() ? NULL : indices.data(), (int)indices.size()); }
+#endif
+#endif
+
 		/**
 		 *  \brief Get the number of 2D rendering drivers available for the current
 		 *         display.
@@ -514,18 +636,36 @@ namespace SDL {
 		 * \return 0 on success, or -1 on error
 		 */
 		Renderer& SetTarget(Texture& texture);
+		/**
+		 * \brief Set a texture as the current rendering target.
+		 *
+		 * \param texture The targeted texture, or NULL for the default render target
+		 *
+		 * \return 0 on success, or -1 on error
+		 */
+		Renderer& SetTarget(SDL_Texture* texture);
+		// \brief Make the default render target current.
+		Renderer& ResetTarget();
 		/**
 		 * \brief Get the current render target or NULL for the default render target.
 		 *
-		 * \return The current render target
+		 * \return A Texture that refers to, but does not own, the current render target
 		 */
 		Texture GetTarget();
 		/**
 		 * \brief Get the current render target or NULL for the default render target.
 		 *
-		 * \return The current render target
+		 * \param target A reference to be set to refer to, but not own, the current render target
 		 */
 		Renderer& GetTarget(Texture& target);
+		/**
+		 * \brief Get the current render target without wrapping it in a Texture.
+		 *
+		 * Answered from the state cache when it is enabled and knows the target.
+		 *
+		 * \return The current render target, or NULL for the default render target
+		 */
+		SDL_Texture* GetTargetTexture();
 
 		/**
 		 *  \brief Set device independent resolution for rendering
@@ -1149,6 +1289,39 @@ namespace SDL {
 		 */
 		int CopyExF(const Rect* src, const FRect* dst, const FPoint* center, double angle = 0.0, Flip flipType = Flip::SDL_FLIP_NONE);
 
+#if SDL_VERSION_ATLEAST(2,0,18)
+		/**
+		 *  \brief Render a list of triangles textured with this texture, optionally using
+		 *         indices into the vertex array.
+		 *
+		 *  \param vertices    Vertices, with texture coordinates normalized to [0, 1].
+		 *  \param numVertices Number of vertices.
+		 *  \param indices     (optional) An array of integer indices into the 'vertices' array,
+		 *                     if NULL all vertices will be rendered in sequential order.
+		 *  \param numIndices  Number of indices.
+		 *
+		 *  \return 0 on success, or -1 if the operation is not supported
+		 *
+		 *  \note Colour modulation comes from the vertex colours.
+		 */
+		int Geometry(const Vertex* vertices, int numVertices, const int* indices = NULL, int numIndices = 0);
+		/**
+		 *  \brief Render a list of triangles textured with this texture, optionally using
+		 *         indices into the vertex array.
+		 *
+		 *  \param vertices A vector of vertices, with texture coordinates normalized to [0, 1].
+		 *  \param indices  A vector of indices into vertices, if empty all vertices
+		 *                  will be rendered in sequential order.
+		 *
+		 *  \return 0 on success, or -1 if the operation is not supported
+		 */
+		int Geometry(const std::vector<Vertex>& vertices, const std::vector<int>& indices = {});
+#ifdef __cpp_lib_span
+		// \brief See Geometry(const Vertex*, int, const int*, int).  C++20 only.
+		int Geometry(std::span<const Vertex> vertices, std::span<const int> indices = {}) { return Geometry(vertices.data(), (int)vertices.size(), indices.empty() ? NULL : indices.data(), (int)indices.size()); }
+#endif
+#endif
+
 		/**
 		 *  \brief Query the format of a texture
 		 *
@@ -1310,6 +1483,62 @@ namespace SDL {
 		int GetScaleMode(ScaleMode& scaleMode);
 	};
 
+	/**
+	 *  \brief A non-owning handle for drawing a texture.
+	 *
+	 *  Two pointers and trivially copyable, so it can be passed around by value
+	 *  and kept in per-frame draw lists, where copying a Texture would build a
+	 *  new wrapper each time.  It never destroys the texture, which must outlive it.
+	 */
+	struct TextureRef {
+		Renderer* renderer = NULL;
+		SDL_Texture* texture = NULL;
+
+		TextureRef() {}
+		TextureRef(Texture& texture) : renderer(&texture.renderer), texture(texture.texture) {}
+		TextureRef(Renderer& renderer, SDL_Texture* texture) : renderer(&renderer), texture(texture) {}
+
+		// \brief Evaluates to true if the handle refers to a texture.
+		explicit operator bool() const { return texture != NULL; }
+
+		// \brief See Texture::Copy(const Rect*, const Rect*).
+		int Copy(const Rect* src, const Rect* dst) const;
+		int Copy(const Rect& src, const Rect& dst) const { return Copy(&src, &dst); }
+		// \brief See Texture::CopyF(const Rect*, const FRect*).
+		int CopyF(const Rect* src, const FRect* dst) const;
+		int CopyF(const Rect& src, const FRect& dst) const { return CopyF(&src, &dst); }
+		// \brief See Texture::CopyExF(const Rect*, const FRect*, const FPoint*, double, Flip).
+		int CopyExF(const Rect* src, const FRect* dst, const FPoint* center, double angle = 0.0, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE) const;
+#if SDL_VERSION_ATLEAST(2,0,18)
+		// \brief See Texture::Geometry(const Vertex*, int, const int*, int).
+		int Geometry(const Vertex* vertices, int numVertices, const int* indices = NULL, int numIndices = 0) const;
+#endif
+	};
+
+	/**
+	 *  \brief Makes a texture the rendering target for as long as it lives, then
+	 *         puts the previous target back.
+	 *
+	 *  Going back to a texture target resets its viewport and scale, which SDL
+	 *  only keeps for the default target, so the guard saves and restores them.
+	 */
+	struct TargetGuard {
+		Renderer& renderer;
+		// \brief 0 if the texture is the target, or -1 if it could not be made the target
+		int error = 0;
+
+		TargetGuard(Renderer& renderer, Texture& target);
+		~TargetGuard();
+
+		TargetGuard(const TargetGuard&) = delete;
+		TargetGuard& operator=(const TargetGuard&) = delete;
+
+	private:
+		SDL_Texture* previous;
+		Rect viewport;
+		FPoint scale;
+	};
+
 	/**
 	 *  \brief Create a window and default renderer
 	 *
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <vector>
+#include "render.hpp"
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+namespace SDL {
+	/**
+	 *  \brief Tessellates circles, ellipses, polygons, thick lines and rounded
+	 *         rectangles into triangles and submits them with one geometry call.
+	 *
+	 *  Shapes are added to a vertex and index list that Flush() submits and then
+	 *  empties without freeing, so a batch reused every frame stops allocating once
+	 *  its lists have grown to the frame's size.  Curves use as many segments as
+	 *  keep them within \c tolerance pixels of the true shape, unless a shape is
+	 *  given a segment count.
+	 *
+	 *  All shapes in a flush share one blend mode.  Outlines straddle the edge of
+	 *  their shape, half of the thickness inside and half outside.
+	 */
+	struct ShapeBatch {
+		// \brief How the segments of a thick line meet.
+		enum class Join {
+			MITER,  /**< Extend the edges to a point, or bevel if it would be too long */
+			BEVEL,  /**< Cut the corner off */
+			ROUND   /**< Round the corner */
+		};
+
+		Renderer& renderer;
+
+		std::vector<Vertex> vertices;
+		std::vector<int> indices;
+
+		// \brief The blend mode the shapes are drawn with
+		BlendMode blendMode = SDL_BLENDMODE_BLEND;
+		// \brief The furthest a curve may stray from the true shape, in pixels
+		float tolerance = 0.25f;
+		// \brief The longest a miter may be, in multiples of half the line's thickness
+		float miterLimit = 4;
+		// \brief The number of geometry calls made by the last Flush()
+		int drawCalls = 0;
+		int error = 0;
+
+		/**
+		 *  \brief Create a shape batch for a renderer.
+		 *
+		 *  \param renderer The renderer the shapes are flushed to.
+		 *  \param reserve  The number of vertices to reserve space for.
+		 */
+		ShapeBatch(Renderer& renderer, size_t reserve = 0);
+
+		// Resets the error
+		ShapeBatch& FlushError();
+
+		// \brief Set the blend mode, flushing the shapes already added if it changes.
+		ShapeBatch& SetBlendMode(BlendMode blendMode);
+
+		/**
+		 *  \param segments The number of segments around the whole circle, or 0 to
+		 *                  choose from the radius and tolerance.
+		 */
+		ShapeBatch& FillCircle(const FPoint& center, float radius, const Colour& color, int segments = 0);
+		ShapeBatch& DrawCircle(const FPoint& center, float radius, float thickness, const Colour& color, int segments = 0);
+		ShapeBatch& FillEllipse(const FPoint& center, const FPoint& radii, const Colour& color, int segments = 0);
+		ShapeBatch& DrawEllipse(const FPoint& center, const FPoint& radii, float thickness, const Colour& color, int segments = 0);
+
+		/**
+		 *  \brief Fill a simple polygon, convex or concave.
+		 *
+		 *  Convex polygons are fanned; others are ear clipped, in time quadratic in
+		 *  the number of points.  The points may wind either way, but the edges must
+		 *  not cross.
+		 */
+		ShapeBatch& FillPolygon(const FPoint* points, int count, const Colour& color);
+		ShapeBatch& FillPolygon(const std::vector<FPoint>& points, const Colour& color);
+		// \brief Outline a polygon with a closed thick line.
+		ShapeBatch& DrawPolygon(const FPoint* points, int count, float thickness, const Colour& color, Join join = Join::MITER);
+
+		ShapeBatch& DrawLine(const FPoint& a, const FPoint& b, float thickness, const Colour& color);
+		/**
+		 *  \brief Draw a thick line through a series of points.
+		 *
+		 *  \param closed Whether to join the last point back to the first.
+		 */
+		ShapeBatch& DrawLines(const FPoint* points, int count, float thickness, const Colour& color, Join join = Join::MITER, bool closed = false);
+		ShapeBatch& DrawLines(const std::vector<FPoint>& points, float thickness, const Colour& color, Join join = Join::MITER, bool closed = false);
+
+		/**
+		 *  \param radius   The radius of the corners, limited to half the rectangle's
+		 *                  shorter side.
+		 *  \param segments The number of segments in each corner, or 0 to choose.
+		 */
+		ShapeBatch& FillRoundedRect(const FRect& rect, float radius, const Colour& color, int segments = 0);
+		ShapeBatch& DrawRoundedRect(const FRect& rect, float radius, float thickness, const Colour& color, int segments = 0);
+
+		// \brief The number of vertices waiting for Flush().
+		size_t Size() const;
+		// \brief Discard every shape without drawing it.
+		ShapeBatch& Clear();
+		// \brief Submit every shape to the renderer in one call, then clear the batch.
+		ShapeBatch& Flush();
+
+	private:
+		std::vector<int> polygon;
+
+		int Segments(float radius, int segments, float turn = 1) const;
+		int Add(float x, float y, const Colour& color);
+		void Triangle(int a, int b, int c);
+		void Fan(int center, int first, int count);
+		void Ring(int outer, int inner, int count);
+		void Ellipse(const FPoint& center, float rx, float ry, int segments, const Colour& color);
+		void RoundedRect(const FRect& rect, float radius, int segments, const Colour& color);
+		void AddJoin(const FPoint& p, const FPoint& d0, const FPoint& d1, float half, Join join, const Colour& color);
+	};
+}
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <SDL_surface.h>
+
+// SDLPP_SIMD_X86 or SDLPP_SIMD_NEON tell kernel sources which intrinsics they can use.
+// On x86, SDLPP_TARGET() marks a function as using instructions beyond the build's baseline.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SDLPP_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SDLPP_TARGET(x)
+#else
+#define SDLPP_TARGET(x) __attribute__((target(x)))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64) || defined(_M_ARM)
+#define SDLPP_SIMD_NEON
+#endif
+
+namespace SDL {
+	/**
+	 *  \brief Vectorised pixel kernels used by Surface for the common 8 bit per
+	 *         channel formats.
+	 *
+	 *  The fastest instruction set the CPU supports is picked the first time a
+	 *  kernel is used.  Anything the kernels do not handle, such as paletted or
+	 *  packed 16 bit formats, colour keys and blending, is passed on to SDL.
+	 */
+	namespace SIMD {
+		enum class Level {
+			SCALAR,  /**< Plain C++ */
+			SSE2,    /**< x86 SSE2 */
+			SSE41,   /**< x86 SSE4.1, for byte shuffles */
+			AVX2,    /**< x86 AVX2 */
+			NEON     /**< ARM NEON */
+		};
+
+		// \brief The fastest level supported by this CPU.
+		Level GetSupportedLevel();
+		// \brief The level the kernels currently run at.
+		Level GetLevel();
+		/**
+		 *  \brief Force the kernels to run at a given level, e.g. to compare them.
+		 *
+		 *  \return false if the CPU does not support \c level, in which case the level is unchanged.
+		 */
+		bool SetLevel(Level level);
+		// \brief A printable name for \c level.
+		const char* GetLevelName(Level level);
+
+		// \brief Selects the constant 0xFF instead of a source byte in a byte order.
+		static const Uint8 OPAQUE_BYTE = 0xFF;
+
+		/**
+		 *  \brief Reorder the bytes of 32 bit pixels.
+		 *
+		 *  \param order For each destination byte, the source byte it is copied from, or ::OPAQUE_BYTE.
+		 *
+		 *  \c src and \c dst may be the same.
+		 */
+		void Shuffle32(const void* src, void* dst, int count, const Uint8 order[4]);
+		// \brief Expand 24 bit pixels to 32 bits. See Shuffle32().
+		void Expand24To32(const void* src, void* dst, int count, const Uint8 order[4]);
+		// \brief Pack 32 bit pixels to 24 bits. See Shuffle32(); ::OPAQUE_BYTE is not allowed.
+		void Pack32To24(const void* src, void* dst, int count, const Uint8 order[3]);
+		// \brief Multiply the colour of 32 bit pixels by their alpha, which is byte \c alphaByte of each pixel.
+		void Premultiply32(void* pixels, int count, int alphaByte);
+		// \brief Set \c count 32 bit pixels to \c color.
+		void Fill32(void* dst, int count, Uint32 color);
+		/**
+		 *  \brief Write a 4 by 4 block of 32 bit pixels, each picked from \c palette
+		 *         by 2 bits of \c indices, as in BC1 compressed textures.
+		 *
+		 *  The first pixel takes the lowest 2 bits, and rows are \c pitch bytes apart.
+		 */
+		void Palette4x4(const Uint32 palette[4], Uint32 indices, void* dst, int pitch);
+
+		// \brief Evaluates to true if pixels can be converted between the formats without going through SDL.
+		bool CanConvert(Uint32 src_format, Uint32 dst_format);
+
+		// \brief SDL_ConvertPixels(), using the kernels when CanConvert().
+		int ConvertPixels(int width, int height, Uint32 src_format, const void* src, int src_pitch, Uint32 dst_format, void* dst, int dst_pitch);
+		// \brief SDL_ConvertSurfaceFormat(), using the kernels for surfaces without a colour key or RLE.
+		SDL_Surface* ConvertSurfaceFormat(SDL_Surface* surface, Uint32 pixel_format, Uint32 flags);
+		// \brief Premultiply the colour of a surface by its alpha, in place.
+		int PremultiplyAlpha(SDL_Surface* surface);
+		// \brief SDL_FillRects(), using the kernels for 32 bit surfaces. A NULL \c rects fills the clip rectangle.
+		int FillRects(SDL_Surface* dst, const SDL_Rect* rects, int count, Uint32 color);
+		// \brief SDL_BlitSurface(), using the kernels for copies that do no blending, modulation or colour keying.
+		int BlitSurface(SDL_Surface* src, const SDL_Rect* srcrect, SDL_Surface* dst, SDL_Rect* dstrect);
+	}
+}
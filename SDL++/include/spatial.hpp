@@ -0,0 +1,136 @@
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "rect.hpp"
+#include "ray.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief A broadphase for finding which of many rectangles overlap a region or
+	 *         are hit by a ray, without testing every one of them.
+	 *
+	 *  Rectangles are stored under a user chosen ID, and can be moved and removed
+	 *  one at a time.  Two structures are available:
+	 *
+	 *  - Mode::GRID hashes rectangles into square cells of a fixed size.  It is the
+	 *    fastest when objects are of similar size to the cells, and ray casts walk
+	 *    the cells along the ray.
+	 *  - Mode::TREE keeps a dynamic bounding box tree.  It copes with objects of very
+	 *    different sizes and worlds without bounds.
+	 *
+	 *  Queries are const but reuse internal scratch state, so a SpatialIndex must not
+	 *  be queried from several threads at once.
+	 */
+	struct SpatialIndex {
+		typedef Uint32 ID;
+
+		enum class Mode {
+			GRID, /**< A uniform grid hash */
+			TREE  /**< A dynamic AABB tree */
+		};
+
+		// \brief The nearest rectangle hit by a ray
+		struct Hit {
+			ID id = 0;
+			RayContact contact;
+		};
+
+		/**
+		 *  \param mode     The structure to store rectangles in.
+		 *  \param cellSize For Mode::GRID, the size of a cell.  For Mode::TREE, the
+		 *                  margin boxes are grown by so small moves need no update.
+		 */
+		SpatialIndex(Mode mode = Mode::GRID, float cellSize = 64);
+
+		// \brief Add a rectangle, or move it if \c id is already stored.
+		void Insert(ID id, const FRect& rect);
+		void Insert(ID id, const Rect& rect) { Insert(id, (FRect)rect); }
+		// \brief Move a stored rectangle. Returns false if \c id is not stored.
+		bool Move(ID id, const FRect& rect);
+		bool Move(ID id, const Rect& rect) { return Move(id, (FRect)rect); }
+		// \brief Remove a rectangle. Returns false if \c id is not stored.
+		bool Remove(ID id);
+		// \brief Remove every rectangle.
+		void Clear();
+
+		bool Contains(ID id) const;
+		// \brief The rectangle stored for \c id, which must be stored.
+		const FRect& Get(ID id) const;
+		size_t Size() const;
+
+		/**
+		 *  \brief Find the rectangles that overlap a region.
+		 *
+		 *  \param region The region to search.
+		 *  \param result The IDs found are appended to this.
+		 */
+		void Query(const FRect& region, std::vector<ID>& result) const;
+		void Query(const Rect& region, std::vector<ID>& result) const { Query((FRect)region, result); }
+		/**
+		 *  \brief Find every pair of stored rectangles that overlap.
+		 *
+		 *  \param pairs Each overlapping pair is appended once, with the lower ID first.
+		 */
+		void QueryPairs(std::vector<std::pair<ID, ID>>& pairs) const;
+
+		/**
+		 *  \brief Find the nearest rectangle hit by a ray.
+		 *
+		 *  The ray runs from \c ray.origin to \c ray.origin + \c ray.dir, as in
+		 *  Ray::intersectRect().  Rectangles containing the origin are not hits.
+		 *
+		 *  \return true if anything was hit, in which case \c hit is filled in.
+		 */
+		bool RayCast(const Ray& ray, Hit& hit) const;
+
+	private:
+		struct Entry {
+			FRect rect;
+			// Grid: the cells covered, inclusive
+			int x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+			// Tree: the leaf node
+			int node = -1;
+			// Marks the entry as already visited by the current query
+			mutable Uint32 stamp = 0;
+		};
+
+		struct Node {
+			FRect box;
+			int parent = -1;
+			int left = -1, right = -1;
+			ID id = 0;
+
+			bool Leaf() const { return left == -1; }
+		};
+
+		Mode mode;
+		float cellSize;
+		std::unordered_map<ID, Entry> entries;
+		mutable Uint32 stamp = 0;
+
+		// Grid
+		std::unordered_map<Uint64, std::vector<ID>> cells;
+
+		// Tree
+		std::vector<Node> nodes;
+		int root = -1;
+		int freeNode = -1;
+
+		Uint32 NextStamp() const;
+		bool Visit(const Entry& entry) const;
+		bool TestRay(const Ray& ray, ID id, const Entry& entry, Hit& hit) const;
+
+		void CellRange(const FRect& rect, int& x0, int& y0, int& x1, int& y1) const;
+		void GridAdd(ID id, Entry& entry);
+		void GridRemove(ID id, Entry& entry);
+		bool GridRayCast(const Ray& ray, Hit& hit) const;
+
+		int AllocateNode();
+		void FreeNode(int node);
+		void TreeInsert(int leaf);
+		void TreeRemove(int leaf);
+		bool TreeRayCast(const Ray& ray, Hit& hit) const;
+	};
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include "render.hpp"
+#include "atlas.hpp"
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+namespace SDL {
+	/**
+	 *  \brief Collects textured quads and submits them with Renderer geometry calls.
+	 *
+	 *  Sprites are queued with Draw() and DrawEx() and sent to the renderer by Flush(),
+	 *  which issues one geometry call per run of sprites sharing a texture and blend
+	 *  mode.  With sorting enabled, the number of calls per flush is the number of
+	 *  distinct texture / blend mode pairs rather than the number of sprites.
+	 *
+	 *  \note The colour passed to Draw() is written into the vertices and replaces the
+	 *        texture's colour and alpha mod.
+	 */
+	struct SpriteBatch {
+		// \brief A queued quad
+		struct Sprite {
+			SDL_Texture* texture;
+			BlendMode blendMode;
+			Vertex vertices[4];
+		};
+
+		Renderer& renderer;
+
+		std::vector<Sprite> sprites;
+		std::vector<Vertex> vertices;
+		std::vector<int> indices;
+
+		// \brief Whether Flush() groups sprites by texture and blend mode, keeping submission order within a group
+		bool sort = true;
+		// \brief The blend mode given to sprites queued after it is set
+		BlendMode blendMode = SDL_BLENDMODE_BLEND;
+		// \brief The number of geometry calls made by the last Flush()
+		int drawCalls = 0;
+		int error = 0;
+
+		/**
+		 *  \brief Create a sprite batch for a renderer.
+		 *
+		 *  \param renderer The renderer the sprites are flushed to.
+		 *  \param reserve  The number of sprites to reserve space for.
+		 */
+		SpriteBatch(Renderer& renderer, size_t reserve = 0);
+
+		// Resets the error
+		SpriteBatch& FlushError();
+
+		// \brief Set the blend mode used by sprites queued after this call.
+		SpriteBatch& SetBlendMode(BlendMode blendMode);
+		// \brief Set whether Flush() sorts sprites by texture and blend mode.
+		SpriteBatch& SetSort(bool sort);
+
+		/**
+		 *  \brief Queue a portion of a texture.
+		 *
+		 *  \param texture The source texture.
+		 *  \param src     The source rectangle, in pixels.
+		 *  \param dst     The destination rectangle.
+		 *  \param mod     The colour multiplied into the texture.
+		 */
+		SpriteBatch& Draw(Texture& texture, const Rect& src, const FRect& dst, const Colour& mod = { 255, 255, 255, 255 });
+		/**
+		 *  \brief Queue an entire texture.
+		 *
+		 *  \param texture The source texture.
+		 *  \param dst     The destination rectangle.
+		 *  \param mod     The colour multiplied into the texture.
+		 */
+		SpriteBatch& Draw(Texture& texture, const FRect& dst, const Colour& mod = { 255, 255, 255, 255 });
+		/**
+		 *  \brief Queue a portion of a texture, rotated and flipped.
+		 *
+		 *  \param texture  The source texture.
+		 *  \param src      The source rectangle, in pixels.
+		 *  \param dst      The destination rectangle.
+		 *  \param center   The point around which dst will be rotated, relative to dst.
+		 *  \param angle    An angle in degrees that indicates the rotation that will be applied to dst, rotating it in a clockwise direction.
+		 *  \param flipType A ::Texture::Flip value stating which flipping actions should be performed on the texture.
+		 *  \param mod      The colour multiplied into the texture.
+		 */
+		SpriteBatch& DrawEx(Texture& texture, const Rect& src, const FRect& dst, const FPoint& center, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE, const Colour& mod = { 255, 255, 255, 255 });
+		/**
+		 *  \brief Queue a portion of a texture, rotated around the centre of dst and flipped.
+		 *
+		 *  \param texture  The source texture.
+		 *  \param src      The source rectangle, in pixels.
+		 *  \param dst      The destination rectangle.
+		 *  \param angle    An angle in degrees that indicates the rotation that will be applied to dst, rotating it in a clockwise direction.
+		 *  \param flipType A ::Texture::Flip value stating which flipping actions should be performed on the texture.
+		 *  \param mod      The colour multiplied into the texture.
+		 */
+		SpriteBatch& DrawEx(Texture& texture, const Rect& src, const FRect& dst, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE, const Colour& mod = { 255, 255, 255, 255 });
+		// \brief Queue an atlas region. See Draw().
+		SpriteBatch& Draw(const AtlasRegion& region, const FRect& dst, const Colour& mod = { 255, 255, 255, 255 });
+		// \brief Queue an atlas region, rotated and flipped. See DrawEx().
+		SpriteBatch& DrawEx(const AtlasRegion& region, const FRect& dst, const FPoint& center, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE, const Colour& mod = { 255, 255, 255, 255 });
+		// \brief Queue an atlas region, rotated around the centre of dst and flipped. See DrawEx().
+		SpriteBatch& DrawEx(const AtlasRegion& region, const FRect& dst, double angle, Texture::Flip flipType = Texture::Flip::SDL_FLIP_NONE, const Colour& mod = { 255, 255, 255, 255 });
+
+		// \brief The number of queued sprites.
+		size_t Size() const;
+		// \brief Discard all queued sprites without drawing them.
+		SpriteBatch& Clear();
+		/**
+		 *  \brief Submit all queued sprites to the renderer and clear the batch.
+		 *
+		 *  The blend mode of each texture is set to the blend mode of its sprites
+		 *  before they are submitted.
+		 */
+		SpriteBatch& Flush();
+
+	private:
+		SDL_Texture* sizedTexture = nullptr;
+		FPoint texelSize;
+
+		Sprite& Push(Texture& texture, const Rect& src, const Colour& mod, Texture::Flip flipType);
+	};
+}
+#endif
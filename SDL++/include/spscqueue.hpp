@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <SDL_stdinc.h>
+
+namespace SDL {
+	/**
+	 *  \brief A bounded, lock-free queue between exactly one producer thread and
+	 *         one consumer thread.
+	 *
+	 *  Neither side ever blocks or allocates, which makes it safe to use from an
+	 *  audio callback.  The capacity is rounded up to a power of two.
+	 */
+	template<typename T>
+	class SPSCQueue {
+		std::unique_ptr<T[]> items;
+		size_t mask;
+		alignas(64) std::atomic<size_t> head{ 0 };
+		alignas(64) std::atomic<size_t> tail{ 0 };
+	public:
+		SPSCQueue(size_t capacity = 1024) {
+			size_t size = 2;
+			while (size < capacity) size <<= 1;
+			items.reset(new T[size]);
+			mask = size - 1;
+		}
+		SPSCQueue(const SPSCQueue&) = delete;
+		SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+		// \brief Add an item.  Returns false if the queue is full.  Producer only.
+		bool Push(const T& item) {
+			size_t h = head.load(std::memory_order_relaxed);
+			if (h - tail.load(std::memory_order_acquire) > mask) return false;
+			items[h & mask] = item;
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+		// \brief Take the oldest item.  Returns false if the queue is empty.  Consumer only.
+		bool Pop(T& item) {
+			size_t t = tail.load(std::memory_order_relaxed);
+			if (t == head.load(std::memory_order_acquire)) return false;
+			item = items[t & mask];
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 *  \brief Add as many of \c count items as fit.  Producer only.
+		 *
+		 *  \return The number of items added.
+		 */
+		size_t Write(const T* src, size_t count) {
+			size_t h = head.load(std::memory_order_relaxed);
+			count = std::min(count, mask + 1 - (h - tail.load(std::memory_order_acquire)));
+			for (size_t i = 0; i < count; i++) items[(h + i) & mask] = src[i];
+			head.store(h + count, std::memory_order_release);
+			return count;
+		}
+
+		/**
+		 *  \brief Take up to \c count of the oldest items.  Consumer only.
+		 *
+		 *  \return The number of items taken.
+		 */
+		size_t Read(T* dst, size_t count) {
+			size_t t = tail.load(std::memory_order_relaxed);
+			count = std::min(count, head.load(std::memory_order_acquire) - t);
+			for (size_t i = 0; i < count; i++) dst[i] = items[(t + i) & mask];
+			tail.store(t + count, std::memory_order_release);
+			return count;
+		}
+
+		// \brief The number of items queued.  Only exact when called by the producer or consumer.
+		size_t Size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+		bool Empty() const { return Size() == 0; }
+		size_t Capacity() const { return mask + 1; }
+		// \brief The number of items that can be added.  Only exact when called by the producer.
+		size_t Space() const { return Capacity() - Size(); }
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "error.hpp"
+#include "render.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief A ring of streaming textures for writing new pixels every frame.
+	 *
+	 *  Each Lock() hands out the pixels of the texture that was drawn longest ago,
+	 *  so the producer never waits on a texture the GPU may still be reading, and can
+	 *  write straight into the locked memory instead of a staging buffer.  After
+	 *  Unlock(), that texture becomes Current().
+	 *
+	 *  Locked pixels are write-only.  Because each texture in the ring misses the
+	 *  changes written to the others, LockRect() grows the requested rectangle to
+	 *  cover everything that is out of date in the texture being locked, and the
+	 *  whole of the returned rectangle must be written.
+	 */
+	struct StreamingTexture {
+		Renderer& renderer;
+		Point size;
+		Uint32 format;
+
+		std::deque<Texture> textures;
+		// \brief The part of each texture that does not hold the latest pixels
+		std::vector<Rect> stale;
+
+		// \brief The index of the texture last unlocked
+		int current = 0;
+		// \brief The index of the locked texture, or -1
+		int locked = -1;
+		// \brief The rectangle passed to SDL by the last lock
+		Rect lockedRect;
+
+		/**
+		 *  \brief Create a ring of streaming textures.
+		 *
+		 *  \param renderer The renderer.
+		 *  \param size     The size of the textures in pixels.
+		 *  \param count    The number of textures in the ring, usually 2 or 3.
+		 *  \param format   The format of the textures.
+		 */
+		StreamingTexture(Renderer& renderer, const Point& size, int count = 2, Uint32 format = SDL_PIXELFORMAT_RGBA32);
+
+		StreamingTexture(const StreamingTexture&) = delete;
+		StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+		/**
+		 *  \brief Lock the whole of the next texture for write-only pixel access.
+		 *
+		 *  \param pixels    This is filled in with a pointer to the locked pixels.
+		 *  \param pitch     This is filled in with the pitch of the locked pixels.
+		 *
+		 *  \return 0 on success, or -1 if the texture could not be locked.
+		 */
+		int Lock(void*& pixels, int& pitch);
+		/**
+		 *  \brief Lock part of the next texture for write-only pixel access.
+		 *
+		 *  \param rect      The rectangle that changed since the last frame.
+		 *  \param pixels    This is filled in with a pointer to the top left of \c locked.
+		 *  \param pitch     This is filled in with the pitch of the locked pixels.
+		 *  \param locked    This is filled in with the rectangle that was locked, which
+		 *                   contains \c rect and must be written in full.
+		 *
+		 *  \return 0 on success, or -1 if the texture could not be locked.
+		 */
+		int LockRect(const Rect& rect, void*& pixels, int& pitch, Rect& locked);
+		// \brief Unlock the texture and make it the one returned by Current().
+		void Unlock();
+
+		// \brief The texture holding the most recently unlocked pixels.
+		Texture& Current();
+
+		// \brief Evaluates to true if all the textures were created.
+		bool Valid() const;
+	};
+}
@@ -2,8 +2,11 @@
 
 #include <SDL_surface.h>
 #include "rect.hpp"
+#include "dirtyregion.hpp"
 #include "blendmode.hpp"
 #include "pixels.hpp"
+#include "simd.hpp"
+#include "profiler.hpp"
 
 namespace SDL {
 
@@ -19,6 +22,8 @@ namespace SDL {
 	struct Surface {
 		SDL_Surface* surface = NULL;
 		bool freeSurface = false;
+		// \brief Where fills and blits onto this surface are recorded, if anywhere.
+		DirtyRegion* dirty = NULL;
 
 		// Evaluates to true if the surface needs to be locked before access.
 		bool MustLock() { return (surface->flags & SDL_RLEACCEL) != 0; }
@@ -67,6 +72,26 @@ namespace SDL {
 
 		~Surface() { if(freeSurface) SDL_FreeSurface(surface); }
 
+		// \brief Record the rectangles changed by fills and blits onto this surface, or stop recording for NULL.
+		Surface& Track(DirtyRegion* region) { dirty = region; return *this; }
+		/**
+		 *  \brief Mark the destination of a blit changed.
+		 *
+		 *  With no destination rectangle a blit goes to the top left corner, at the
+		 *  size of the source rectangle or surface.
+		 */
+		void MarkBlit(const SDL_Rect* srcrect, const SDL_Rect* dstrect, const SDL_Surface* src) const {
+			if (dirty == NULL || dstrect != NULL || src == NULL) return MarkDirty(dstrect);
+			SDL_Rect area = { 0, 0, srcrect ? srcrect->w : src->w, srcrect ? srcrect->h : src->h };
+			MarkDirty(&area);
+		}
+		// \brief Mark a rectangle of this surface changed, or all of it for NULL.
+		void MarkDirty(const SDL_Rect* rect) const {
+			if (dirty == NULL) return;
+			if (rect != NULL) dirty->Add(Rect(*rect));
+			else dirty->AddAll();
+		}
+
 		/**
 		 *  \brief Set the palette used by a surface.
 		 *
@@ -267,7 +292,7 @@ namespace SDL {
 			return newSurface;
 		}
 		Surface ConvertSurfaceFormat(Uint32 pixel_format, Uint32 flags) {
-			Surface newSurface = Surface(SDL_ConvertSurfaceFormat(surface, pixel_format, flags));
+			Surface newSurface = Surface(SIMD::ConvertSurfaceFormat(surface, pixel_format, flags));
 			newSurface.freeSurface = newSurface.surface != NULL;
 			return newSurface;
 		}
@@ -280,13 +305,13 @@ namespace SDL {
 		 *
 		 *  \return 0 on success, or -1 on error.
 		 */
-		int Fill(Uint32 color) { return SDL_FillRect(surface, NULL, color); }
+		int Fill(Uint32 color) { MarkDirty(NULL); return SIMD::FillRects(surface, NULL, 1, color); }
 		/**
 		 *  Performs a fast fill of the whole surface with r, g, b.
 		 *
 		 *  \return 0 on success, or -1 on error.
 		 */
-		int Fill(Uint8 r, Uint8 g, Uint8 b) { return SDL_FillRect(surface, NULL, ((PixelFormat*)surface->format)->MapRGB(r, g, b)); }
+		int Fill(Uint8 r, Uint8 g, Uint8 b) { MarkDirty(NULL); return SIMD::FillRects(surface, NULL, 1, ((PixelFormat*)surface->format)->MapRGB(r, g, b)); }
 		/**
 		 *  Performs a fast fill of the given rectangle with \c color.
 		 *
@@ -295,15 +320,22 @@ namespace SDL {
 		 *
 		 *  \return 0 on success, or -1 on error.
 		 */
-		int FillRect(const Rect& rect, Uint32 color) { return SDL_FillRect(surface, &rect.rect, color); }
+		int FillRect(const Rect& rect, Uint32 color) { MarkDirty(&rect.rect); return SIMD::FillRects(surface, &rect.rect, 1, color); }
 		/**
 		 *  Performs a fast fill of the given rectangle with r, g, b.
 		 *
 		 *  \return 0 on success, or -1 on error.
 		 */
-		int FillRect(const Rect& rect, Uint8 r, Uint8 g, Uint8 b) { return SDL_FillRect(surface, &rect.rect, ((PixelFormat*)surface->format)->MapRGB(r, g, b)); }
-		int FillRects(const Rect* rects, int count, Uint32 color) { return SDL_FillRects(surface, (const SDL_Rect*)rects, count, color); }
-		int FillRects(const Rect* rects, int count, Uint8 r, Uint8 g, Uint8 b) { return SDL_FillRects(surface, (const SDL_Rect*)rects, count, ((PixelFormat*)surface->format)->MapRGB(r, g, b)); }
+		int FillRect(const Rect& rect, Uint8 r, Uint8 g, Uint8 b) { MarkDirty(&rect.rect); return SIMD::FillRects(surface, &rect.rect, 1, ((PixelFormat*)surface->format)->MapRGB(r, g, b)); }
+		int FillRects(const Rect* rects, int count, Uint32 color) { for (int i = 0; i < count; i++) MarkDirty(&rects[i].rect); return SIMD::FillRects(surface, (const SDL_Rect*)rects, count, color); }
+		int FillRects(const Rect* rects, int count, Uint8 r, Uint8 g, Uint8 b) { for (int i = 0; i < count; i++) MarkDirty(&rects[i].rect); return SIMD::FillRects(surface, (const SDL_Rect*)rects, count, ((PixelFormat*)surface->format)->MapRGB(r, g, b)); }
+
+		/**
+		 *  Multiplies the colour of every pixel by its alpha, in place.
+		 *
+		 *  \return 0 on success, or -1 if the format has no alpha or is not supported.
+		 */
+		int PremultiplyAlpha() { return SIMD::PremultiplyAlpha(surface); }
 
 		/**
 		 *  Performs a fast blit from the source surface to the destination surface.
@@ -363,17 +395,26 @@ namespace SDL {
 		 *  blitting works internally and how to use the other blit functions.
 		 */
 		int BlitSurface(Rect* srcrect, Surface& dst, Rect* dstrect) {
-			return SDL_BlitSurface(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			SDLPP_PROFILE_ZONE("Surface::Blit");
+			int result = SIMD::BlitSurface(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			dst.MarkBlit(srcrect ? &srcrect->rect : NULL, dstrect ? &dstrect->rect : NULL, surface);
+			return result;
 		}
 
 		// This is the public blit function, SDL_BlitSurface(), and it performs rectangle validation and clipping before passing it to SDL_LowerBlit()
 		int UpperBlit(const Rect& srcrect, Surface& dst, Rect& dstrect) {
-			return SDL_UpperBlit(surface, &srcrect.rect, dst.surface, &dstrect.rect);
+			SDLPP_PROFILE_ZONE("Surface::Blit");
+			int result = SDL_UpperBlit(surface, &srcrect.rect, dst.surface, &dstrect.rect);
+			dst.MarkDirty(&dstrect.rect);
+			return result;
 		}
 
 		// This is a semi-private blit function and it performs low-level surface blitting only.
 		int LowerBlit(Rect& srcrect, Surface& dst, Rect& dstrect) {
-			return SDL_LowerBlit(surface, &srcrect.rect, dst.surface, &dstrect.rect);
+			SDLPP_PROFILE_ZONE("Surface::Blit");
+			int result = SDL_LowerBlit(surface, &srcrect.rect, dst.surface, &dstrect.rect);
+			dst.MarkDirty(&dstrect.rect);
+			return result;
 		}
 
 		/**
@@ -383,11 +424,17 @@ namespace SDL {
 		 *  \note This function uses a static buffer, and is not thread-safe.
 		 */
 		int SoftStretch(const Rect* srcrect, const Surface& dst, const Rect* dstrect) {
-			return SDL_SoftStretch(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			SDLPP_PROFILE_ZONE("Surface::BlitScaled");
+			int result = SDL_SoftStretch(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			dst.MarkDirty((const SDL_Rect*)dstrect);
+			return result;
 		}
 
 		int BlitScaled(Rect* srcrect, Surface& dst, Rect* dstrect) {
-			return SDL_BlitScaled(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			SDLPP_PROFILE_ZONE("Surface::BlitScaled");
+			int result = SDL_BlitScaled(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			dst.MarkDirty(dstrect ? &dstrect->rect : NULL);
+			return result;
 		}
 
 		/**
@@ -395,7 +442,10 @@ namespace SDL {
 		 *  rectangle validation and clipping before passing it to SDL_LowerBlitScaled()
 		 */
 		int UpperBlitScaled(const Rect* srcrect, Surface& dst, Rect* dstrect) {
-			return SDL_UpperBlitScaled(surface, (const SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			SDLPP_PROFILE_ZONE("Surface::BlitScaled");
+			int result = SDL_UpperBlitScaled(surface, (const SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			dst.MarkDirty(dstrect ? &dstrect->rect : NULL);
+			return result;
 		}
 
 		/**
@@ -403,7 +453,10 @@ namespace SDL {
 		 *  scaled blitting only.
 		 */
 		int LowerBlitScaled(Rect* srcrect, Surface& dst, Rect* dstrect) {
-			return SDL_LowerBlitScaled(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			SDLPP_PROFILE_ZONE("Surface::BlitScaled");
+			int result = SDL_LowerBlitScaled(surface, (SDL_Rect*)srcrect, dst.surface, (SDL_Rect*)dstrect);
+			dst.MarkDirty(dstrect ? &dstrect->rect : NULL);
+			return result;
 		}
 	};
 
@@ -413,7 +466,7 @@ namespace SDL {
 	 *  \return 0 on success, or -1 if there was an error
 	 */
 	static int ConvertPixels(const Rect& size, Uint32 src_format, const void* src, int src_pitch, Uint32 dst_format, void* dst, int dst_pitch) {
-		return SDL_ConvertPixels(size.w, size.h, src_format, src, src_pitch, dst_format, dst, dst_pitch);
+		return SIMD::ConvertPixels(size.w, size.h, src_format, src, src_pitch, dst_format, dst, dst_pitch);
 	}
 
 	namespace YUV {
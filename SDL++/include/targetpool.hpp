@@ -0,0 +1,116 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "render.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Lends out render target textures and keeps them for reuse, so post
+	 *         effects and cached UI don't create and destroy textures every frame.
+	 *
+	 *  Acquire() hands out an idle texture of the same size, format and access if
+	 *  there is one, and creates one otherwise.  Every texture acquired in a frame
+	 *  goes back to the pool at EndFrame(), and textures nobody has acquired for
+	 *  \c maxIdleFrames frames are destroyed.  The contents of a texture are not
+	 *  kept between leases.
+	 *
+	 *  The pool owns its textures; a Texture& it returns stays valid until the
+	 *  texture is evicted, which never happens while it is leased.  After an
+	 *  SDL_RENDER_DEVICE_RESET event every texture is lost, so call Clear().
+	 */
+	struct RenderTargetPool {
+		// \brief The texture properties a lease must match exactly
+		struct Key {
+			int w, h;
+			Uint32 format;
+			Texture::Access access;
+
+			bool operator==(const Key& that) const { return w == that.w && h == that.h && format == that.format && access == that.access; }
+		};
+
+		// \brief Counts of Acquire() calls, by how they were answered
+		struct Stats {
+			int reused = 0;
+			int created = 0;
+			int evicted = 0;
+		};
+
+		Renderer& renderer;
+		// \brief The frames a texture may sit idle before it is destroyed
+		int maxIdleFrames;
+		// \brief Counts since the pool was created
+		Stats stats;
+		int error = 0;
+
+		/**
+		 *  \param renderer      The renderer the textures are created for.
+		 *  \param maxIdleFrames The frames a texture may sit idle before it is destroyed.
+		 */
+		RenderTargetPool(Renderer& renderer, int maxIdleFrames = 3);
+
+		RenderTargetPool(const RenderTargetPool&) = delete;
+		RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+		// \brief Resets the error
+		RenderTargetPool& FlushError();
+
+		/**
+		 *  \brief Lease a texture until Release() or the end of the frame.
+		 *
+		 *  \param size   The size of the texture in pixels.
+		 *  \param format The format of the texture.
+		 *  \param access The access of the texture, SDL_TEXTUREACCESS_TARGET unless
+		 *                the texture is only drawn from.
+		 *
+		 *  \return The texture, which refers to NULL if it could not be created.
+		 */
+		Texture& Acquire(const Point& size, Uint32 format = SDL_PIXELFORMAT_RGBA32, Texture::Access access = Texture::Access::SDL_TEXTUREACCESS_TARGET);
+		/**
+		 *  \brief Return a texture before the end of the frame, so the frame can
+		 *         lease it again.  Does nothing if the pool did not lend it.
+		 */
+		RenderTargetPool& Release(Texture& texture);
+
+		/**
+		 *  \brief Return every leased texture and destroy those idle too long.
+		 *
+		 *  Call once per frame, after the last draw from a leased texture.  If a
+		 *  texture about to be destroyed is the render target, the default target
+		 *  is made current first.
+		 */
+		RenderTargetPool& EndFrame();
+		// \brief Destroy every texture that is not leased.
+		RenderTargetPool& Trim();
+		// \brief Forget every texture, leased or not, destroying them.
+		RenderTargetPool& Clear();
+
+		// \brief The number of textures the pool holds, leased or not.
+		size_t Size() const { return entries.size(); }
+		// \brief The number of textures leased and not yet returned.
+		size_t Leased() const;
+		/**
+		 *  \brief The memory held by the pool's textures, in bytes.
+		 *
+		 *  Estimated from the size and format; drivers may pad or compress.
+		 */
+		size_t Memory() const;
+		// \brief The memory held by leased textures, in bytes.
+		size_t LeasedMemory() const;
+
+	private:
+		struct Entry {
+			Key key;
+			std::unique_ptr<Texture> texture;
+			bool leased;
+			Uint64 lastUsed;
+		};
+
+		// Few enough that a linear search beats hashing
+		std::vector<Entry> entries;
+		Uint64 frame = 0;
+
+		static size_t Bytes(const Key& key);
+		void Destroy(Entry& entry);
+	};
+}
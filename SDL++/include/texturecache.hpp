@@ -0,0 +1,129 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "atlas.hpp"
+#include "render.hpp"
+#include "surface.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Bakes images into a texture cache file that TextureCache loads with
+	 *         no decoding or conversion.
+	 *
+	 *  Run this offline, or once on first start, with the format the renderer
+	 *  will use; see NativeFormat().  Images are converted as they are added and
+	 *  written by Write(), either each as its own page or, when \c pageSize is
+	 *  set, packed tallest first into atlas pages.
+	 *
+	 *  The file is a header, a table of pages, a table of named regions, the
+	 *  names, and then the pixels of each page, 64 byte aligned and with no row
+	 *  padding.  Numbers are in the byte order of the machine that baked it.
+	 */
+	struct TextureCacheBaker {
+		Uint32 format;
+		// \brief The size of the atlas pages, or 0 by 0 to give every image a page of its own
+		Point pageSize;
+		// \brief The number of transparent pixels kept around each atlased image
+		int padding;
+		int error = 0;
+
+		/**
+		 *  \param format   The pixel format the pages are stored and created in.
+		 *                  FOURCC formats are not supported.
+		 *  \param pageSize The size of the atlas pages, or 0 by 0 not to atlas.
+		 *  \param padding  The number of transparent pixels kept around each atlased image.
+		 */
+		TextureCacheBaker(Uint32 format = SDL_PIXELFORMAT_RGBA32, const Point& pageSize = { 0, 0 }, int padding = 1);
+
+		// \brief The first texture format the renderer supports that a cache can hold.
+		static Uint32 NativeFormat(Renderer& renderer);
+
+		// Resets the error
+		TextureCacheBaker& FlushError();
+
+		/**
+		 *  \brief Convert an image and add it under a name.  A later image with the
+		 *         same name replaces it.
+		 *
+		 *  \return 0 on success, or -1 on error.
+		 */
+		int Add(const std::string& name, Surface& surface);
+		// \brief Load an image file that SDL_image can read and add it. See Add().
+		int Add(const std::string& name, const std::string& file);
+
+		// \brief The number of images added.
+		size_t Size() const { return images.size(); }
+		void Clear() { images.clear(); }
+
+		/**
+		 *  \brief Pack the images and write the cache file.
+		 *
+		 *  \return 0 on success, or -1 on error.
+		 */
+		int Write(const std::string& file);
+		// \brief Write the cache to an SDL data source. See Write().
+		int Write_RW(SDL_RWops* dst, bool freedst);
+
+	private:
+		struct Image {
+			std::string name;
+			int w, h;
+			std::vector<Uint8> pixels;
+		};
+
+		std::vector<Image> images;
+	};
+
+	/**
+	 *  \brief Loads texture cache files baked by TextureCacheBaker.
+	 *
+	 *  The file is memory mapped and each page's pixels are passed straight to
+	 *  Texture::Update(), so loading costs one copy by the driver and no decoding.
+	 *  The mapping is released once the pages are created, as the renderer keeps
+	 *  its own copy.  Several files may be loaded into one cache.
+	 *
+	 *  Regions hold pointers to the pages and stay valid until the cache is
+	 *  cleared or destroyed.
+	 */
+	struct TextureCache {
+		Renderer& renderer;
+		std::deque<Texture> pages;
+		int error = 0;
+
+		TextureCache(Renderer& renderer);
+
+		TextureCache(const TextureCache&) = delete;
+		TextureCache& operator=(const TextureCache&) = delete;
+
+		// Resets the error
+		TextureCache& FlushError();
+
+		/**
+		 *  \brief Map a cache file and create its textures.
+		 *
+		 *  Falls back to reading the file through SDL_RWops where it cannot be
+		 *  mapped, such as inside an Android APK.
+		 *
+		 *  \return 0 on success, or -1 if the file cannot be read, is not a cache
+		 *          baked on a machine of the same byte order, or a page texture
+		 *          cannot be created.  Nothing is added on failure.
+		 */
+		int Load(const std::string& file);
+		// \brief Create the textures of a cache already in memory. See Load().
+		int Load(const void* data, size_t size);
+
+		// \brief The region of a named image, which is not Valid() if there is none.
+		AtlasRegion Get(const std::string& name) const;
+		bool Has(const std::string& name) const { return regions.count(name) != 0; }
+		// \brief The number of named images.
+		size_t Size() const { return regions.size(); }
+		// \brief Destroy all pages. All regions from this cache become invalid.
+		void Clear();
+
+	private:
+		std::unordered_map<std::string, AtlasRegion> regions;
+	};
+}
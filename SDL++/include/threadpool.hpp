@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SDL {
+	/**
+	 *  \brief A fixed set of worker threads running queued jobs in order.
+	 *
+	 *  Jobs still queued when the pool is destroyed are run before the workers exit.
+	 */
+	struct ThreadPool {
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable idle;
+		size_t active = 0;
+		bool stopping = false;
+
+		/**
+		 *  \brief Start the worker threads.
+		 *
+		 *  \param threads The number of workers, or 0 for one less than the number of
+		 *                 CPU cores (at least one).
+		 */
+		ThreadPool(unsigned threads = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// \brief Queue a job to run on a worker thread.
+		void Push(std::function<void()> job);
+
+		/**
+		 *  \brief Queue a job to run on a worker thread.
+		 *
+		 *  \return A future holding the result of the job.
+		 */
+		template <typename F>
+		auto Submit(F&& f) -> std::future<decltype(f())> {
+			auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::forward<F>(f));
+			auto future = task->get_future();
+			Push([task]() { (*task)(); });
+			return future;
+		}
+
+		// \brief Block until the queue is empty and no job is running.
+		void Wait();
+
+		// \brief The number of worker threads.
+		size_t Size() const;
+	};
+}
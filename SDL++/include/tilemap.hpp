@@ -0,0 +1,124 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "render.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief A grid of tiles drawn from a tileset, cached in chunks so a frame
+	 *         costs a draw per visible chunk instead of a copy per visible tile.
+	 *
+	 *  The map is split into square chunks of \c chunkTiles by \c chunkTiles
+	 *  tiles.  A chunk is built the first time it is drawn and rebuilt only
+	 *  after one of its tiles changes; Draw() skips chunks outside the viewport
+	 *  without looking at them, so neither the size of the map nor the number
+	 *  of tiles in view adds to the work of a frame.
+	 *
+	 *  Tile 0 is empty, and tile n is the n-th tile of the tileset, counting
+	 *  from 1 along its rows.  Tiles past the end of the tileset are drawn empty.
+	 */
+	struct TileMap {
+		enum class Mode {
+			/**
+			 *  Each chunk is baked into a render target texture and drawn with a
+			 *  single copy.  Needs render target support; after an
+			 *  SDL_RENDER_TARGETS_RESET event call Invalidate().
+			 */
+			TARGET,
+			/**
+			 *  Each chunk keeps its vertices and is drawn with a single geometry
+			 *  call.  Needs no render targets and no texture memory beyond the
+			 *  tileset, but the vertices are moved whenever the view moves.
+			 */
+			GEOMETRY
+		};
+
+		Renderer& renderer;
+		Texture& tileset;
+		// \brief The size of a tile in pixels
+		Point tileSize;
+		// \brief The size of the map in tiles
+		Point size;
+		// \brief The width and height of a chunk in tiles
+		int chunkTiles;
+		Mode mode;
+
+		// \brief The tiles, row by row.  Call Invalidate() after changing them directly.
+		std::vector<Uint16> tiles;
+
+		// \brief The number of chunks drawn by the last Draw()
+		int drawnChunks = 0;
+		// \brief The number of chunks built by the last Draw()
+		int builtChunks = 0;
+		int error = 0;
+
+		/**
+		 *  \brief Create an empty tile map.
+		 *
+		 *  \param renderer   The renderer the map is drawn with.
+		 *  \param tileset    The texture the tiles are taken from, which must outlive the map.
+		 *  \param tileSize   The size of a tile in pixels, both in the tileset and on screen.
+		 *  \param size       The size of the map in tiles.
+		 *  \param chunkTiles The width and height of a chunk in tiles.
+		 *  \param mode       How chunks are cached.
+		 */
+		TileMap(Renderer& renderer, Texture& tileset, const Point& tileSize, const Point& size, int chunkTiles = 16, Mode mode = Mode::TARGET);
+
+		TileMap(const TileMap&) = delete;
+		TileMap& operator=(const TileMap&) = delete;
+
+		// Resets the error
+		TileMap& FlushError();
+
+		// \brief The tile at a position, or 0 outside the map.
+		Uint16 GetTile(int x, int y) const;
+		// \brief Set the tile at a position, marking its chunk for rebuilding if it changed.
+		TileMap& SetTile(int x, int y, Uint16 tile);
+		// \brief Set every tile in an area, given in tiles.
+		TileMap& Fill(const Rect& area, Uint16 tile);
+
+		// \brief Mark every chunk for rebuilding, such as after the tileset changes.
+		TileMap& Invalidate();
+		// \brief Mark the chunks covering an area, given in tiles, for rebuilding.
+		TileMap& Invalidate(const Rect& area);
+		/**
+		 *  \brief Destroy all chunk textures and vertices; chunks are built again
+		 *         when next drawn.  Call after an SDL_RENDER_DEVICE_RESET event.
+		 */
+		TileMap& Release();
+
+		/**
+		 *  \brief Draw the part of the map that falls inside the viewport.
+		 *
+		 *  Chunks that are in view and have changed are built first.  The tileset's
+		 *  colour and alpha mod are baked into TARGET chunks when they are built.
+		 *
+		 *  \param camera The position in the map, in pixels, drawn at the top left of the viewport.
+		 *
+		 *  \return 0 on success, or -1 on error.
+		 */
+		int Draw(const FPoint& camera);
+
+	private:
+		struct Chunk {
+			bool dirty = true;
+			std::unique_ptr<Texture> texture;
+			std::vector<Vertex> vertices;
+			std::vector<int> indices;
+			// The vertex positions relative to the chunk
+			std::vector<FPoint> corners;
+			// The origin the vertices were last moved to
+			FPoint offset;
+		};
+
+		Point chunkCount;
+		std::vector<Chunk> chunks;
+
+		// The tiles covered by a chunk, clipped to the map
+		Rect ChunkArea(int cx, int cy) const;
+		bool TileSrc(Uint16 tile, int columns, int rows, Rect& src) const;
+		int Bake(Chunk& chunk, const Rect& area, const Point& tilesetSize);
+		void Tessellate(Chunk& chunk, const Rect& area, const Point& tilesetSize);
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include<SDL_timer.h>
+#include <vector>
 
 namespace SDL {
 	/**
@@ -62,4 +63,112 @@ namespace SDL {
 		 */
 		~Timer() { SDL_RemoveTimer(id); }
 	};
+	struct Display;
+
+	/**
+	 *  \brief Paces a frame loop to a target rate, and runs fixed size update steps.
+	 *
+	 *  Wait() sleeps with Delay() while there is more time left than a Delay(1)
+	 *  is expected to take, estimated as the running mean of observed sleeps plus
+	 *  one standard deviation.  It then spins on the performance counter for the
+	 *  rest, so frames end close to their deadline even where Delay() is coarse.
+	 *
+	 *  e.g.
+	 *  FramePacer pacer(60, 1.0 / 120);
+	 *  while (running) {
+	 *      while (pacer.Step()) Update(pacer.GetFixedStep());
+	 *      Draw(pacer.Alpha());
+	 *      renderer.Present();
+	 *      pacer.Wait();
+	 *  }
+	 */
+	struct FramePacer {
+		// \brief Frame times, in seconds, over the frames recorded since ResetStats()
+		struct Stats {
+			int frames = 0;
+			double min = 0;
+			double max = 0;
+			double mean = 0;
+			double p50 = 0;
+			double p95 = 0;
+			double p99 = 0;
+		};
+
+		/**
+		 *  \param rate      The target frames per second, or 0 not to wait at all.
+		 *  \param fixedStep The length of an update step in seconds, or 0 for one
+		 *                   frame at the target rate.
+		 */
+		FramePacer(double rate = 60, double fixedStep = 0);
+
+		void SetTargetRate(double rate);
+		double GetTargetRate() const { return rate; }
+
+		/**
+		 *  \brief Set the target rate to the refresh rate of a display's current mode.
+		 *
+		 *  \return 0 on success or a negative error code on failure; call GetError()
+		 *          for more information.  The rate is unchanged on failure, or if the
+		 *          refresh rate is unknown.
+		 */
+		int MatchDisplay(Display display);
+
+		void SetFixedStep(double seconds);
+		double GetFixedStep() const { return fixedStep; }
+
+		/**
+		 *  \brief Wait until the current frame's deadline, and start the next frame.
+		 *
+		 *  If the frame took longer than a whole period, the next deadline is one
+		 *  period from now rather than trying to catch up.
+		 *
+		 *  \return The length in seconds of the frame just finished.
+		 */
+		double Wait();
+
+		/**
+		 *  \brief Take one fixed update step from the time accumulated by Wait().
+		 *
+		 *  \return true if a step should be run; call until it returns false.
+		 */
+		bool Step();
+
+		// \brief How far between the last update step and the next one, from 0 to 1.
+		double Alpha() const { return accumulator / fixedStep; }
+
+		// \brief The length in seconds of the frame finished by the last Wait().
+		double GetFrameTime() const { return frameTime; }
+
+		Stats GetStats() const;
+		void ResetStats();
+
+		// \brief The number of frames kept for GetStats()
+		static constexpr int HISTORY = 512;
+		// \brief Update time is capped at this many seconds per frame, so a long stall does not cause a burst of steps.
+		static constexpr double MAX_ACCUMULATED = 0.25;
+
+	private:
+		double rate = 0;
+		Uint64 period = 0;
+		double fixedStep = 0;
+		bool defaultStep = true;
+
+		Uint64 frequency;
+		Uint64 deadline = 0;
+		Uint64 frameStart = 0;
+		double frameTime = 0;
+		double accumulator = 0;
+
+		// The estimated length of Delay(1), from the running mean and variance of past calls
+		double sleepEstimate = 0.002;
+		double sleepMean = 0.001;
+		double sleepM2 = 0;
+		Uint64 sleepCount = 1;
+
+		std::vector<double> history;
+		int historyNext = 0;
+		mutable std::vector<double> sorted;
+
+		void Sleep(Uint64 until);
+	};
 }
\ No newline at end of file
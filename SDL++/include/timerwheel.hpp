@@ -0,0 +1,137 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <vector>
+#include <SDL_timer.h>
+
+namespace SDL {
+	/**
+	 *  \brief Runs many timers from one thread, with microsecond resolution.
+	 *
+	 *  Timers are kept in a hierarchical wheel, so adding and cancelling one takes
+	 *  constant time however many are scheduled.  Nothing runs on its own: call
+	 *  Update() from the main loop, or from a thread of your own, and every timer
+	 *  that has come due is run there, in order of when it was due.
+	 *
+	 *  Times are in microseconds since the wheel was created, measured with the
+	 *  performance counter.  A TimerWheel is not thread safe; add and cancel timers
+	 *  on the thread that updates it, including from inside callbacks.
+	 */
+	struct TimerWheel {
+		// \brief Identifies a timer.  Never 0, and not reused once the timer ends.
+		typedef Uint64 ID;
+		typedef std::function<void()> Callback;
+
+		TimerWheel();
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		/**
+		 *  \brief Schedule a callback.
+		 *
+		 *  \param delay    Microseconds from the wheel's current time until it runs.
+		 *  \param callback The function to run.
+		 *  \param period   If not 0, the timer repeats this many microseconds after
+		 *                  each time it was due, until cancelled.
+		 */
+		ID Add(Uint64 delay, Callback callback, Uint64 period = 0);
+		// \brief Schedule a callback at a time returned by Now().
+		ID AddAt(Uint64 time, Callback callback, Uint64 period = 0);
+
+		/**
+		 *  \brief Stop a timer from running again.
+		 *
+		 *  \return false if the timer had already ended or been cancelled.
+		 */
+		bool Cancel(ID id);
+		bool Pending(ID id) const;
+
+		// \brief Cancel every timer.
+		void Clear();
+		// \brief The number of timers scheduled.
+		size_t Size() const { return count; }
+
+		// \brief Microseconds since the wheel was created.
+		Uint64 Now() const;
+		// \brief The time the wheel has been advanced to.
+		Uint64 Time() const { return current - 1; }
+
+		/**
+		 *  \brief Run every timer that is due by Now().
+		 *
+		 *  \return The number of callbacks run.
+		 */
+		int Update() { return Advance(Now()); }
+		/**
+		 *  \brief Run every timer that is due by \c time, which is then the wheel's time.
+		 *
+		 *  Callbacks may add and cancel timers, but must not update the wheel.
+		 */
+		int Advance(Uint64 time);
+
+		/**
+		 *  \brief A time no timer is due before, for sleeping until the next one.
+		 *
+		 *  Timers far away are only placed exactly as they draw near, so nothing
+		 *  may be due at the time itself; updating then runs nothing and the next
+		 *  call gives a later time.
+		 *
+		 *  \return The time, which is Time() + 1 if a timer is already due, or
+		 *          ~0 if none is scheduled.
+		 */
+		Uint64 NextDue() const;
+
+	private:
+		static constexpr int BITS = 6;
+		static constexpr int SLOTS = 1 << BITS;
+		static constexpr int LEVELS = 6;
+		// Timers further away than this wait in the top level and are placed again
+		static constexpr Uint64 RANGE = (Uint64)1 << (BITS * LEVELS);
+
+		enum class State : Uint8 {
+			FREE,
+			SCHEDULED,
+			DUE,
+			RUNNING
+		};
+
+		struct Node {
+			Uint64 expiry = 0;
+			Uint64 period = 0;
+			Callback callback;
+			int prev = -1, next = -1;
+			int level = 0, slot = 0;
+			Uint32 generation = 1;
+			State state = State::FREE;
+			// Cancelled from inside its own callback
+			bool cancelled = false;
+		};
+
+		// Deque so a callback can add timers without moving the node being run
+		std::deque<Node> nodes;
+		int freeNode = -1;
+		size_t count = 0;
+
+		int slots[LEVELS][SLOTS];
+		Uint64 occupied[LEVELS]{ 0 };
+		// The next tick to process
+		Uint64 current = 1;
+
+		Uint64 start;
+		Uint64 frequency;
+
+		std::vector<ID> due;
+
+		int Find(ID id) const;
+		ID MakeID(int index) const { return ((Uint64)nodes[index].generation << 32) | (Uint32)(index + 1); }
+		int Allocate();
+		void Free(int index);
+
+		void Link(int index);
+		void Unlink(int index);
+		void Cascade(int level);
+		Uint64 NextTick() const;
+	};
+}
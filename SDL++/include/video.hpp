@@ -2,6 +2,7 @@
 
 #include <SDL_video.h>
 #include <string>
+#include <string_view>
 #include "rect.hpp"
 #include "surface.hpp"
 
@@ -26,6 +27,8 @@ namespace SDL {
 	 *		normally checked during initialization.
 	 */
 	static std::string GetVideoDriver(int index) { return std::string(SDL_GetVideoDriver(index)); }
+	// \brief Get the name of a built in video driver without copying it, or an empty view if there is none.
+	static std::string_view GetVideoDriverName(int index) { const char* name = SDL_GetVideoDriver(index); return name != NULL ? std::string_view(name) : std::string_view(); }
 
 	/**
 	 *  \brief Initialize the video subsystem, specifying a video driver.
@@ -296,6 +299,8 @@ namespace SDL {
 		std::string GetTitle() { return std::string(SDL_GetWindowTitle(window)); }
 		// \brief Get the title of this window.
 		Window& GetTitle(std::string& title) { title = SDL_GetWindowTitle(window); return *this; }
+		// \brief Get the title of this window without copying it.  The view is valid until the title is next set.
+		Window& GetTitle(std::string_view& title) { title = SDL_GetWindowTitle(window); return *this; }
 
 		/**
 		 *  \brief Set the icon for this window.
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mixer.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Plays a WAV file through a Mixer without loading all of it.
+	 *
+	 *  A background thread reads the file's sample data a chunk at a time, converts
+	 *  it with an AudioStream to stereo float at the mixer's rate, and keeps a
+	 *  lock-free ring of about \c bufferSeconds filled for the audio thread.  Memory
+	 *  stays at a few hundred kilobytes however long the file is.
+	 *
+	 *  PCM of 8, 16, 24 or 32 bits and 32 bit float are supported, including
+	 *  WAVE_FORMAT_EXTENSIBLE files; compressed WAVs are not.  The stream must
+	 *  outlive any voice playing it, and can only be played by one voice at a time.
+	 */
+	struct WAVStream : Mixer::Source {
+		/**
+		 *  \brief Open a file and start buffering.
+		 *
+		 *  \param file          The WAV file.
+		 *  \param output        The spec of the mixer it will play through.
+		 *  \param loop          Whether to repeat the file until the stream is destroyed.
+		 *  \param bufferSeconds How much converted audio to keep ready.
+		 */
+		WAVStream(const std::string& file, const AudioSpec& output, bool loop = false, double bufferSeconds = 0.25);
+		/**
+		 *  \brief Stream from any SDL_RWops, which must be seekable to loop.
+		 *
+		 *  The RWops is only read from the background thread once this returns.
+		 */
+		WAVStream(SDL_RWops* src, bool freesrc, const AudioSpec& output, bool loop = false, double bufferSeconds = 0.25);
+		/**
+		 *  \brief Stream from memory, such as a memory-mapped file.
+		 *
+		 *  Only the pages being read are touched, so a mapping costs no more resident
+		 *  memory than a file.  The memory must outlive the stream.
+		 */
+		WAVStream(const void* mem, size_t size, const AudioSpec& output, bool loop = false, double bufferSeconds = 0.25);
+		~WAVStream();
+
+		WAVStream(const WAVStream&) = delete;
+		WAVStream& operator=(const WAVStream&) = delete;
+
+		// \brief Evaluates to true if the file was a WAV that can be streamed.
+		bool Valid() const { return reader.joinable(); }
+		// \brief The format of the file itself.
+		const AudioSpec& GetSourceSpec() const { return source; }
+		// \brief The length of the file, in seconds.
+		double Duration() const;
+
+		int Read(float* stereo, int frames) override;
+		bool Finished() const override { return done.load(std::memory_order_acquire) && ring.Empty(); }
+
+	private:
+		static constexpr int CHUNK_FRAMES = 4096;
+
+		SDL_RWops* src;
+		bool freesrc;
+		bool loop;
+		AudioSpec source;
+		// Bytes per sample frame in the file, and whether 24 bit samples need widening for SDL
+		int blockAlign = 0;
+		bool packed24 = false;
+		Sint64 dataStart = 0;
+		Sint64 dataLength = 0;
+
+		std::unique_ptr<AudioStream> stream;
+		SPSCQueue<float> ring;
+		// Used only by the reader thread
+		std::vector<Uint8> chunk;
+		std::vector<Uint8> widened;
+		std::vector<float> converted;
+
+		std::atomic<bool> stopping{ false };
+		std::atomic<bool> done{ false };
+		std::thread reader;
+
+		static size_t RingSize(const AudioSpec& output, double bufferSeconds);
+		void Open(const AudioSpec& output);
+		int ParseHeader();
+		void Run();
+		bool Drain();
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "commandbuffer.hpp"
+#include "render.hpp"
+#include "video.hpp"
+
+namespace SDL {
+	/**
+	 *  \brief Drives several windows from one thread, so that their vsync waits
+	 *         do not add up.
+	 *
+	 *  SDL's render API must be used on the thread that handles events, so every
+	 *  window and renderer of the set belongs to that thread.  Only the first
+	 *  window's renderer is created with the SDL_RENDERER_PRESENTVSYNC asked
+	 *  for, and Present() waits on its display once per frame.  The others are
+	 *  created without vsync and paced instead to the refresh rate of their
+	 *  display's current mode: a window whose display has not yet finished its
+	 *  last refresh keeps its frame, and a newer frame replaces it.
+	 *
+	 *  This has two costs.  Every window but the first presents unsynchronised,
+	 *  so it can tear.  And windows on displays faster than the first one's are
+	 *  capped at the first one's rate.  Put the fastest display first.
+	 *
+	 *  If the first renderer does not get vsync, or has no frame submitted, it
+	 *  is paced by sleeping in Present() instead.  Displays whose refresh rate
+	 *  is unknown are paced as 60 Hz.
+	 */
+	struct WindowSet {
+		// \brief A window, its renderer and the frames recorded for them
+		struct Output {
+			Window window;
+			Renderer renderer;
+			// \brief The refresh rate of the window's display in Hz, or 0 if it is unknown
+			int refreshRate = 0;
+			// \brief Whether the renderer waits on vsync when presenting
+			bool vsync = false;
+			// \brief The number of frames presented
+			Uint64 presented = 0;
+			// \brief The number of frames replaced by a newer one before the window drew them
+			Uint64 dropped = 0;
+
+			Output(const std::string& title, const Rect& shape, Uint32 windowFlags, Uint32 rendererFlags);
+
+			Output(const Output&) = delete;
+			Output& operator=(const Output&) = delete;
+
+		private:
+			friend struct WindowSet;
+
+			// The frame being recorded, and the last one submitted and not yet presented
+			CommandBuffer buffers[2];
+			CommandBuffer* recording = &buffers[0];
+			CommandBuffer* pending = &buffers[1];
+			bool submitted = false;
+			// The performance counter value before which the window is not presented again
+			Uint64 deadline = 0;
+		};
+
+		std::vector<std::unique_ptr<Output>> outputs;
+		// \brief How each window's frame is ordered when it is replayed
+		CommandBuffer::Sort sort = CommandBuffer::Sort::STATE;
+		int error = 0;
+
+		WindowSet() {}
+
+		WindowSet(const WindowSet&) = delete;
+		WindowSet& operator=(const WindowSet&) = delete;
+
+		// Resets the error
+		WindowSet& FlushError();
+
+		/**
+		 *  \brief Open a window and its renderer.
+		 *
+		 *  \param title         The title of the window.
+		 *  \param shape         The position and size of the window.
+		 *  \param windowFlags   ::SDL_WindowFlags for the window.
+		 *  \param rendererFlags ::SDL_RendererFlags for its renderer.  SDL_RENDERER_PRESENTVSYNC
+		 *                       is dropped for every window but the first, so the
+		 *                       others can tear and run no faster than the first.
+		 *
+		 *  \return The index of the window, or -1 if the window or its renderer could not be created.
+		 */
+		int Add(const std::string& title, const Rect& shape, Uint32 windowFlags = SDL_WINDOW_SHOWN, Uint32 rendererFlags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+		size_t Size() const { return outputs.size(); }
+		Output& operator[](size_t index) { return *outputs[index]; }
+		// \brief The index of the window with an ID, as in window events, or -1.
+		int Find(Uint32 windowID) const;
+
+		// \brief The buffer to record a window's next frame into, until Submit().
+		CommandBuffer& Record(size_t index) { return *outputs[index]->recording; }
+		// \brief Hand over the recorded frame of a window for the next Present(), and start recording the next.
+		WindowSet& Submit(size_t index);
+		// \brief Submit the recorded frame of every window.
+		WindowSet& SubmitAll();
+
+		/**
+		 *  \brief Draw and present the submitted frame of every window that is due.
+		 *
+		 *  The first window is presented last, whenever a frame was submitted to
+		 *  it, so each call waits on its display once.  Without a frame for it,
+		 *  the call sleeps until the first display's next refresh.
+		 *
+		 *  \return 0 on success, or -1 if a frame could not be drawn.
+		 */
+		int Present();
+
+		/**
+		 *  \brief Read each window's refresh rate from the current mode of its display
+		 *         again.  Call after a window moves display or a display mode changes.
+		 */
+		WindowSet& UpdateRefreshRates();
+
+	private:
+		// Replays and presents a window's submitted frame
+		int Draw(Output& output);
+		// Sets when the window is due again, one refresh after the last deadline or now
+		static void Schedule(Output& output, Uint64 now, Uint64 frequency);
+		// Sleeps until the window is due, then schedules its next refresh
+		static void SleepUntilDue(Output& output, Uint64 frequency);
+		// The refresh rate the window is paced to
+		static int PacingRate(const Output& output) { return output.refreshRate > 0 ? output.refreshRate : 60; }
+	};
+}
@@ -0,0 +1,167 @@
+#include "atlas.hpp"
+#include "image.hpp"
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+using namespace SDL;
+
+AtlasPacker::AtlasPacker(const Point& size) : size(size) { Reset(); }
+
+void AtlasPacker::Reset() {
+	skyline.clear();
+	skyline.push_back({ 0, 0, size.w });
+	used = 0;
+}
+
+// Finds the height a rectangle would rest at if its left edge was placed on segment i
+bool AtlasPacker::Fit(size_t i, const Point& rectSize, int& y) const {
+	if (skyline[i].x + rectSize.w > size.w) return false;
+
+	int remaining = rectSize.w;
+	y = 0;
+	while (remaining > 0) {
+		if (i >= skyline.size()) return false;
+		y = std::max(y, skyline[i].y);
+		if (y + rectSize.h > size.h) return false;
+		remaining -= skyline[i].w;
+		i++;
+	}
+	return true;
+}
+
+bool AtlasPacker::Pack(const Point& rectSize, Point& pos) {
+	if (rectSize.w <= 0 || rectSize.h <= 0) return false;
+
+	size_t best = skyline.size();
+	int bestY = INT_MAX, bestWidth = INT_MAX;
+	for (size_t i = 0; i < skyline.size(); i++) {
+		int y;
+		if (!Fit(i, rectSize, y)) continue;
+		if (y < bestY || (y == bestY && skyline[i].w < bestWidth)) {
+			best = i;
+			bestY = y;
+			bestWidth = skyline[i].w;
+		}
+	}
+	if (best == skyline.size()) return false;
+
+	pos = { skyline[best].x, bestY };
+	skyline.insert(skyline.begin() + best, { pos.x, bestY + rectSize.h, rectSize.w });
+
+	// Cut away the segments now hidden under the new one
+	size_t i = best + 1;
+	while (i < skyline.size()) {
+		int covered = skyline[best].x + skyline[best].w - skyline[i].x;
+		if (covered <= 0) break;
+		if (covered < skyline[i].w) {
+			skyline[i].x += covered;
+			skyline[i].w -= covered;
+			break;
+		}
+		skyline.erase(skyline.begin() + i);
+	}
+
+	// Join neighbours at the same height
+	for (i = 0; i + 1 < skyline.size();) {
+		if (skyline[i].y == skyline[i + 1].y) {
+			skyline[i].w += skyline[i + 1].w;
+			skyline.erase(skyline.begin() + i + 1);
+		}
+		else i++;
+	}
+
+	used += rectSize.w * rectSize.h;
+	return true;
+}
+
+float AtlasPacker::Occupancy() const { return size.w > 0 && size.h > 0 ? (float)used / ((float)size.w * size.h) : 0.0f; }
+
+TextureAtlas::TextureAtlas(Renderer& renderer, const Point& pageSize, int padding, Uint32 format)
+	: renderer(renderer), pageSize(pageSize), padding(padding), format(format) {}
+
+bool TextureAtlas::AddPage() {
+	pages.emplace_back(renderer, pageSize, Texture::Access::SDL_TEXTUREACCESS_STATIC, format);
+	Texture& page = pages.back();
+	if (page.texture == NULL) {
+		pages.pop_back();
+		return false;
+	}
+
+	// Texture contents are undefined at creation, and the padding must be transparent
+	int pitch = pageSize.w * SDL_BYTESPERPIXEL(format);
+	std::vector<Uint8> blank((size_t)pitch * pageSize.h, 0);
+	page.Update(blank.data(), pitch);
+	page.SetBlendMode(SDL_BLENDMODE_BLEND);
+
+	packers.emplace_back(pageSize);
+	return true;
+}
+
+AtlasRegion TextureAtlas::Add(Surface& surface) {
+	if (surface.surface == NULL) return {};
+
+	Point size = { surface.surface->w, surface.surface->h };
+	Point padded = { size.w + padding * 2, size.h + padding * 2 };
+	if (padded.w > pageSize.w || padded.h > pageSize.h) {
+		SetError("Image of %dx%d does not fit in a %dx%d atlas page", size.w, size.h, pageSize.w, pageSize.h);
+		return {};
+	}
+
+	Point pos;
+	size_t page = 0;
+	while (page < packers.size() && !packers[page].Pack(padded, pos)) page++;
+	if (page == packers.size()) {
+		if (!AddPage()) return {};
+		packers.back().Pack(padded, pos);
+	}
+
+	AtlasRegion region;
+	region.texture = &pages[page];
+	region.src = Rect(pos.x + padding, pos.y + padding, size.w, size.h);
+
+	Surface converted = surface.surface->format->format == format ? Surface(surface.surface) : surface.ConvertSurfaceFormat(format, 0);
+	if (converted.surface == NULL) return {};
+
+	bool locked = converted.MustLock();
+	if (locked) converted.Lock();
+	int result = region.texture->UpdateRect(region.src, converted.surface->pixels, converted.surface->pitch);
+	if (locked) converted.Unlock();
+
+	if (result != 0) return {};
+	return region;
+}
+
+AtlasRegion TextureAtlas::Add(const std::string& file) {
+	Surface surface = IMG::Load(file);
+	return Add(surface);
+}
+
+std::vector<AtlasRegion> TextureAtlas::Add(const std::vector<Surface*>& surfaces) {
+	std::vector<size_t> order(surfaces.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	auto height = [&](size_t i) { return surfaces[i] && surfaces[i]->surface ? surfaces[i]->surface->h : 0; };
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return height(a) > height(b); });
+
+	std::vector<AtlasRegion> regions(surfaces.size());
+	for (size_t i : order)
+		if (surfaces[i]) regions[i] = Add(*surfaces[i]);
+	return regions;
+}
+
+std::vector<AtlasRegion> TextureAtlas::Add(const std::vector<std::string>& files) {
+	std::deque<Surface> loaded;
+	std::vector<Surface*> surfaces;
+	surfaces.reserve(files.size());
+	for (const std::string& file : files) {
+		loaded.emplace_back(IMG_Load(file.c_str()), true);
+		surfaces.push_back(&loaded.back());
+	}
+	return Add(surfaces);
+}
+
+void TextureAtlas::Clear() {
+	pages.clear();
+	packers.clear();
+}
@@ -0,0 +1,138 @@
+#include "audioconverter.hpp"
+#include <cstring>
+#include <future>
+
+using namespace SDL;
+
+void AudioConverterCache::StreamReturn::operator()(AudioStream* stream) const {
+	stream->Clear();
+	stream->error = 0;
+
+	std::lock_guard<std::mutex> lock(cache->mutex);
+	cache->streams[key].emplace_back(stream);
+}
+
+int AudioConverterCache::Get(const Key& key, SDL_AudioCVT& cvt) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = converters.find(key);
+	if (found == converters.end()) {
+		AudioCVT built(AudioFormat{ key.srcFormat }, key.srcChannels, key.srcRate, AudioFormat{ key.dstFormat }, key.dstChannels, key.dstRate);
+		// Failures are kept too, so they are not rebuilt on every call
+		found = converters.emplace(key, built).first;
+	}
+	cvt = found->second.cvt;
+	return found->second.error;
+}
+
+std::vector<Uint8> AudioConverterCache::TakeScratch() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (scratch.empty()) return std::vector<Uint8>();
+	std::vector<Uint8> buffer = std::move(scratch.back());
+	scratch.pop_back();
+	return buffer;
+}
+
+void AudioConverterCache::GiveScratch(std::vector<Uint8>&& buffer) {
+	std::lock_guard<std::mutex> lock(mutex);
+	scratch.push_back(std::move(buffer));
+}
+
+template<typename T>
+int AudioConverterCache::ConvertInto(const Key& key, const Uint8* data, Uint32 len, std::vector<T>& out) {
+	SDL_AudioCVT cvt;
+	int error = Get(key, cvt);
+	if (error < 0) return -1;
+
+	if (error == 0) {
+		out.resize(len / sizeof(T));
+		memcpy(out.data(), data, out.size() * sizeof(T));
+		return 0;
+	}
+
+	// Convert in a pooled buffer big enough for the worst case, then copy out only the result
+	std::vector<Uint8> buffer = TakeScratch();
+	if (buffer.size() < (size_t)len * cvt.len_mult) buffer.resize((size_t)len * cvt.len_mult);
+	memcpy(buffer.data(), data, len);
+	cvt.buf = buffer.data();
+	cvt.len = (int)len;
+	int result = SDL_ConvertAudio(&cvt);
+	if (result == 0) {
+		out.resize((size_t)cvt.len_cvt / sizeof(T));
+		memcpy(out.data(), buffer.data(), out.size() * sizeof(T));
+	}
+	GiveScratch(std::move(buffer));
+	return result;
+}
+
+int AudioConverterCache::Convert(const Key& key, const Uint8* data, Uint32 len, std::vector<Uint8>& out) { return ConvertInto(key, data, len, out); }
+
+int AudioConverterCache::Convert(const WAV& wav, const AudioSpec& dst, std::vector<Uint8>& out) {
+	if (!wav.freeWAV) return SDL_SetError("Parameter '%s' is invalid", "wav");
+	return ConvertInto(Conversion(wav.spec, dst), wav.audio_buf, wav.audio_len, out);
+}
+
+Sound AudioConverterCache::ToSound(const WAV& wav, int rate) {
+	Sound sound;
+	if (!wav.freeWAV) return sound;
+
+	Uint8 channels = wav.spec.channels == 1 ? 1 : 2;
+	if (rate == 0) rate = wav.spec.freq;
+	Key key{ wav.spec.format, wav.spec.channels, wav.spec.freq, AUDIO_F32SYS, channels, rate };
+	if (ConvertInto(key, wav.audio_buf, wav.audio_len, sound.samples) != 0) return sound;
+
+	sound.channels = channels;
+	sound.rate = rate;
+	return sound;
+}
+
+std::vector<std::vector<Uint8>> AudioConverterCache::ConvertAll(const std::vector<const WAV*>& wavs, const AudioSpec& dst, ThreadPool& pool) {
+	std::vector<std::vector<Uint8>> results(wavs.size());
+	std::vector<std::future<void>> jobs;
+	jobs.reserve(wavs.size());
+	for (size_t i = 0; i < wavs.size(); i++) {
+		jobs.push_back(pool.Submit([this, &wavs, &dst, &results, i]() {
+			if (Convert(*wavs[i], dst, results[i]) != 0) results[i].clear();
+		}));
+	}
+	for (auto& job : jobs) job.wait();
+	return results;
+}
+
+std::vector<Sound> AudioConverterCache::ConvertAll(const std::vector<const WAV*>& wavs, int rate, ThreadPool& pool) {
+	std::vector<Sound> results(wavs.size());
+	std::vector<std::future<void>> jobs;
+	jobs.reserve(wavs.size());
+	for (size_t i = 0; i < wavs.size(); i++)
+		jobs.push_back(pool.Submit([this, &wavs, &results, rate, i]() { results[i] = ToSound(*wavs[i], rate); }));
+	for (auto& job : jobs) job.wait();
+	return results;
+}
+
+AudioConverterCache::Stream AudioConverterCache::GetStream(const Key& key) {
+	StreamReturn giveBack{ this, key };
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& idle = streams[key];
+		if (!idle.empty()) {
+			AudioStream* stream = idle.back().release();
+			idle.pop_back();
+			return Stream(stream, giveBack);
+		}
+	}
+
+	std::unique_ptr<AudioStream> stream(new AudioStream(AudioFormat{ key.srcFormat }, key.srcChannels, key.srcRate, AudioFormat{ key.dstFormat }, key.dstChannels, key.dstRate));
+	if (stream->stream == NULL) return Stream(nullptr, giveBack);
+	return Stream(stream.release(), giveBack);
+}
+
+size_t AudioConverterCache::Size() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return converters.size();
+}
+
+void AudioConverterCache::Clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	converters.clear();
+	scratch.clear();
+	streams.clear();
+}
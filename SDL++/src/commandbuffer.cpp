@@ -0,0 +1,243 @@
+#include "commandbuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include "profiler.hpp"
+
+using namespace SDL;
+
+// Everything is recorded as floats, which is what SDL turns integer draws into anyway
+static FPoint ToFloat(const Point& p) { return FPoint((float)p.x, (float)p.y); }
+static FPoint ToFloat(const FPoint& p) { return p; }
+static FRect ToFloat(const Rect& r) { return FRect((float)r.x, (float)r.y, (float)r.w, (float)r.h); }
+static FRect ToFloat(const FRect& r) { return r; }
+
+CommandBuffer::CommandBuffer(size_t blockSize) : blockSize(std::max(blockSize, (size_t)1024)) {}
+
+void* CommandBuffer::Allocate(size_t bytes) {
+	bytes = (bytes + 15) & ~(size_t)15;
+	for (; block < blocks.size(); block++, used = 0) {
+		if (used + bytes <= blocks[block].size) {
+			void* memory = blocks[block].memory.get() + used;
+			used += bytes;
+			return memory;
+		}
+	}
+
+	size_t size = std::max(blockSize, bytes);
+	blocks.push_back({ std::unique_ptr<Uint8[]>(new Uint8[size]), size });
+	used = bytes;
+	return blocks[block].memory.get();
+}
+
+CommandBuffer::Command& CommandBuffer::Push(Op op, SDL_Texture* texture, int count, size_t dataBytes) {
+	Command* command = new (Allocate(sizeof(Command))) Command{ op, blendMode, layer, color, texture, count, 0, NULL };
+	if (dataBytes != 0) command->data = Allocate(dataBytes);
+	commands.push_back(command);
+	return *command;
+}
+
+template<typename T, typename S>
+CommandBuffer& CommandBuffer::PushConverted(Op op, const S* items, int count) {
+	if (count <= 0) return *this;
+	Command& command = Push(op, NULL, count, sizeof(T) * count);
+	T* out = (T*)command.data;
+	for (int i = 0; i < count; i++) new (&out[i]) T(ToFloat(items[i]));
+	return *this;
+}
+
+CommandBuffer& CommandBuffer::PushCopy(Op op, Texture& texture, const Rect* src, const FRect* dst, const FPoint* center, double angle, Texture::Flip flipType) {
+	Command& command = Push(op, texture.texture, 0, sizeof(CopyData));
+	CopyData* copy = (CopyData*)command.data;
+	SDL_zerop(copy);
+	copy->hasSrc = src != NULL;
+	copy->hasDst = dst != NULL;
+	copy->hasCenter = center != NULL;
+	if (src != NULL) copy->src = src->rect;
+	if (dst != NULL) copy->dst = dst->rect;
+	if (center != NULL) copy->center = center->point;
+	copy->angle = angle;
+	copy->flip = flipType;
+	return *this;
+}
+
+CommandBuffer& CommandBuffer::SetLayer(Uint16 layer) { this->layer = layer; return *this; }
+CommandBuffer& CommandBuffer::SetDrawColor(const Colour& color) { this->color = color; return *this; }
+CommandBuffer& CommandBuffer::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) { color = { r, g, b, a }; return *this; }
+CommandBuffer& CommandBuffer::SetDrawBlendMode(const BlendMode& blendMode) { this->blendMode = blendMode; return *this; }
+
+CommandBuffer& CommandBuffer::DrawLine(const Point& a, const Point& b) { const Point points[] = { a, b }; return PushConverted<FPoint>(Op::LINES, points, 2); }
+CommandBuffer& CommandBuffer::DrawLineF(const FPoint& a, const FPoint& b) { const FPoint points[] = { a, b }; return PushConverted<FPoint>(Op::LINES, points, 2); }
+CommandBuffer& CommandBuffer::DrawLines(const Point* points, int count) { return PushConverted<FPoint>(Op::LINES, points, count); }
+CommandBuffer& CommandBuffer::DrawLinesF(const FPoint* points, int count) { return PushConverted<FPoint>(Op::LINES, points, count); }
+CommandBuffer& CommandBuffer::DrawPoint(const Point& point) { return PushConverted<FPoint>(Op::POINTS, &point, 1); }
+CommandBuffer& CommandBuffer::DrawPointF(const FPoint& point) { return PushConverted<FPoint>(Op::POINTS, &point, 1); }
+CommandBuffer& CommandBuffer::DrawPoints(const Point* points, int count) { return PushConverted<FPoint>(Op::POINTS, points, count); }
+CommandBuffer& CommandBuffer::DrawPointsF(const FPoint* points, int count) { return PushConverted<FPoint>(Op::POINTS, points, count); }
+
+CommandBuffer& CommandBuffer::DrawOutline() { Push(Op::RECTS); return *this; }
+CommandBuffer& CommandBuffer::DrawRect(const Rect& rect) { return PushConverted<FRect>(Op::RECTS, &rect, 1); }
+CommandBuffer& CommandBuffer::DrawRectF(const FRect& rect) { return PushConverted<FRect>(Op::RECTS, &rect, 1); }
+CommandBuffer& CommandBuffer::DrawRects(const Rect* rects, int count) { return PushConverted<FRect>(Op::RECTS, rects, count); }
+CommandBuffer& CommandBuffer::DrawRectsF(const FRect* rects, int count) { return PushConverted<FRect>(Op::RECTS, rects, count); }
+
+CommandBuffer& CommandBuffer::Fill() { Push(Op::FILL_RECTS); return *this; }
+CommandBuffer& CommandBuffer::FillRect(const Rect& rect) { return PushConverted<FRect>(Op::FILL_RECTS, &rect, 1); }
+CommandBuffer& CommandBuffer::FillRectF(const FRect& rect) { return PushConverted<FRect>(Op::FILL_RECTS, &rect, 1); }
+CommandBuffer& CommandBuffer::FillRects(const Rect* rects, int count) { return PushConverted<FRect>(Op::FILL_RECTS, rects, count); }
+CommandBuffer& CommandBuffer::FillRectsF(const FRect* rects, int count) { return PushConverted<FRect>(Op::FILL_RECTS, rects, count); }
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+CommandBuffer& CommandBuffer::Geometry(const Vertex* vertices, int numVertices, const int* indices, int numIndices) {
+	if (numVertices <= 0) return *this;
+	if (indices == NULL) numIndices = 0;
+
+	// The indices follow the vertices
+	Command& command = Push(Op::GEOMETRY, NULL, numVertices, sizeof(Vertex) * numVertices + sizeof(int) * numIndices);
+	command.numIndices = numIndices;
+	memcpy(command.data, vertices, sizeof(Vertex) * numVertices);
+	if (numIndices) memcpy((Vertex*)command.data + numVertices, indices, sizeof(int) * numIndices);
+	return *this;
+}
+
+CommandBuffer& CommandBuffer::Geometry(Texture& texture, const Vertex* vertices, int numVertices, const int* indices, int numIndices) {
+	size_t first = commands.size();
+	Geometry(vertices, numVertices, indices, numIndices);
+	if (commands.size() != first) commands.back()->texture = texture.texture;
+	return *this;
+}
+#endif
+
+CommandBuffer& CommandBuffer::Copy(Texture& texture, const Rect* src, const Rect* dst) {
+	FRect fdst = dst != NULL ? ToFloat(*dst) : FRect();
+	return PushCopy(Op::COPY, texture, src, dst != NULL ? &fdst : NULL, NULL, 0, Texture::Flip::SDL_FLIP_NONE);
+}
+CommandBuffer& CommandBuffer::Copy(Texture& texture, const Rect& src, const Rect& dst) { return Copy(texture, &src, &dst); }
+CommandBuffer& CommandBuffer::Copy(Texture& texture, const Rect& dst) { return Copy(texture, NULL, &dst); }
+
+CommandBuffer& CommandBuffer::CopyF(Texture& texture, const Rect* src, const FRect* dst) { return PushCopy(Op::COPY, texture, src, dst, NULL, 0, Texture::Flip::SDL_FLIP_NONE); }
+CommandBuffer& CommandBuffer::CopyF(Texture& texture, const Rect& src, const FRect& dst) { return CopyF(texture, &src, &dst); }
+CommandBuffer& CommandBuffer::CopyF(Texture& texture, const FRect& dst) { return CopyF(texture, NULL, &dst); }
+
+CommandBuffer& CommandBuffer::CopyEx(Texture& texture, const Rect* src, const Rect* dst, const Point* center, double angle, Texture::Flip flipType) {
+	FRect fdst = dst != NULL ? ToFloat(*dst) : FRect();
+	FPoint fcenter = center != NULL ? ToFloat(*center) : FPoint();
+	return PushCopy(Op::COPY_EX, texture, src, dst != NULL ? &fdst : NULL, center != NULL ? &fcenter : NULL, angle, flipType);
+}
+
+CommandBuffer& CommandBuffer::CopyExF(Texture& texture, const Rect* src, const FRect* dst, const FPoint* center, double angle, Texture::Flip flipType) {
+	return PushCopy(Op::COPY_EX, texture, src, dst, center, angle, flipType);
+}
+
+CommandBuffer& CommandBuffer::Clear() {
+	commands.clear();
+	block = 0;
+	used = 0;
+	layer = 0;
+	color = { 0, 0, 0, 255 };
+	blendMode = SDL_BLENDMODE_NONE;
+	return *this;
+}
+
+int CommandBuffer::Replay(Renderer& renderer, Sort sort) const { return Replay(renderer, { this }, sort); }
+
+int CommandBuffer::Replay(Renderer& renderer, const std::vector<const CommandBuffer*>& buffers, Sort sort) {
+	SDLPP_PROFILE_ZONE("CommandBuffer::Replay");
+
+	std::vector<const Command*> list;
+	size_t total = 0;
+	for (const CommandBuffer* buffer : buffers) total += buffer->commands.size();
+	list.reserve(total);
+	for (const CommandBuffer* buffer : buffers) list.insert(list.end(), buffer->commands.begin(), buffer->commands.end());
+
+	if (sort == Sort::LAYER)
+		std::stable_sort(list.begin(), list.end(), [](const Command* a, const Command* b) { return a->layer < b->layer; });
+	else if (sort == Sort::STATE)
+		std::stable_sort(list.begin(), list.end(), [](const Command* a, const Command* b) {
+			if (a->layer != b->layer) return a->layer < b->layer;
+			if (a->blendMode != b->blendMode) return a->blendMode < b->blendMode;
+			return a->texture < b->texture;
+		});
+
+	// Draw failures are collected apart from any error the renderer already had
+	int previous = renderer.error;
+	renderer.error = 0;
+	int error = 0;
+
+	std::vector<FPoint> points;
+	std::vector<FRect> rects;
+	for (size_t i = 0; i < list.size();) {
+		const Command& command = *list[i];
+		bool untextured = command.texture == NULL;
+		if (untextured) {
+			renderer.SetDrawColor(command.color);
+			renderer.SetDrawBlendMode(command.blendMode);
+		}
+
+		// The run of commands that can be joined into this one's call
+		size_t end = i + 1;
+		if (command.count > 0 && (command.op == Op::POINTS || command.op == Op::RECTS || command.op == Op::FILL_RECTS))
+			while (end < list.size() && list[end]->op == command.op && list[end]->count > 0 && list[end]->blendMode == command.blendMode
+				&& memcmp(&list[end]->color, &command.color, sizeof(Colour)) == 0)
+				end++;
+
+		switch (command.op) {
+		case Op::LINES:
+			renderer.DrawLinesF((const FPoint*)command.data, command.count);
+			break;
+		case Op::POINTS:
+			if (end == i + 1) renderer.DrawPointsF((const FPoint*)command.data, command.count);
+			else {
+				points.clear();
+				for (size_t j = i; j < end; j++) points.insert(points.end(), (const FPoint*)list[j]->data, (const FPoint*)list[j]->data + list[j]->count);
+				renderer.DrawPointsF(points);
+			}
+			break;
+		case Op::RECTS:
+		case Op::FILL_RECTS: {
+			bool fill = command.op == Op::FILL_RECTS;
+			if (command.count == 0) {
+				if (fill) renderer.FillF();
+				else renderer.DrawOutlineF();
+			}
+			else if (end == i + 1) {
+				if (fill) renderer.FillRectsF((const FRect*)command.data, command.count);
+				else renderer.DrawRectsF((const FRect*)command.data, command.count);
+			}
+			else {
+				rects.clear();
+				for (size_t j = i; j < end; j++) rects.insert(rects.end(), (const FRect*)list[j]->data, (const FRect*)list[j]->data + list[j]->count);
+				if (fill) renderer.FillRectsF(rects);
+				else renderer.DrawRectsF(rects);
+			}
+			break;
+		}
+#if SDL_VERSION_ATLEAST(2,0,18)
+		case Op::GEOMETRY: {
+			const Vertex* vertices = (const Vertex*)command.data;
+			const int* indices = command.numIndices ? (const int*)(vertices + command.count) : NULL;
+			if (untextured) renderer.Geometry(vertices, command.count, indices, command.numIndices);
+			else error |= Texture(renderer, command.texture, false).Geometry(vertices, command.count, indices, command.numIndices);
+			break;
+		}
+#endif
+		case Op::COPY:
+		case Op::COPY_EX: {
+			const CopyData& copy = *(const CopyData*)command.data;
+			Texture texture(renderer, command.texture, false);
+			const Rect* src = copy.hasSrc ? (const Rect*)&copy.src : NULL;
+			const FRect* dst = copy.hasDst ? (const FRect*)&copy.dst : NULL;
+			if (command.op == Op::COPY) error |= texture.CopyF(src, dst);
+			else error |= texture.CopyExF(src, dst, copy.hasCenter ? (const FPoint*)&copy.center : NULL, copy.angle, copy.flip);
+			break;
+		}
+		default:
+			break;
+		}
+		i = end;
+	}
+
+	error |= renderer.error;
+	renderer.error = previous | error;
+	return error != 0 ? -1 : 0;
+}
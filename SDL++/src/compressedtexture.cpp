@@ -0,0 +1,588 @@
+#include "compressedtexture.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "error.hpp"
+#include "profiler.hpp"
+#include "simd.hpp"
+
+using namespace SDL;
+
+typedef CompressedImage::Format Format;
+
+//
+// OpenGL, declared here so that no GL headers are needed
+//
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define SDLPP_GLAPI __stdcall
+#else
+#define SDLPP_GLAPI
+#endif
+
+namespace {
+	typedef void (SDLPP_GLAPI* CompressedTexImage2DProc)(unsigned target, int level, unsigned internalformat, int width, int height, int border, int imageSize, const void* data);
+	typedef void (SDLPP_GLAPI* GetIntegervProc)(unsigned pname, int* data);
+	typedef unsigned (SDLPP_GLAPI* GetErrorProc)();
+
+	enum : unsigned {
+		GL_TEXTURE_2D = 0x0DE1,
+		GL_TEXTURE_BINDING_2D = 0x8069,
+		GL_COMPRESSED_RGBA_S3TC_DXT1_EXT = 0x83F1,
+		GL_COMPRESSED_RGBA_S3TC_DXT3_EXT = 0x83F2,
+		GL_COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3,
+		GL_COMPRESSED_RED_RGTC1 = 0x8DBB,
+		GL_COMPRESSED_RG_RGTC2 = 0x8DBD,
+		GL_COMPRESSED_RGBA_BPTC_UNORM = 0x8E8C,
+		GL_COMPRESSED_RGB8_ETC2 = 0x9274,
+		GL_COMPRESSED_RGBA8_ETC2_EAC = 0x9278,
+		GL_COMPRESSED_RGBA_ASTC_4x4_KHR = 0x93B0
+	};
+}
+
+static unsigned GLFormat(Format format) {
+	switch (format) {
+	case Format::BC1: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	case Format::BC2: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	case Format::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case Format::BC4: return GL_COMPRESSED_RED_RGTC1;
+	case Format::BC5: return GL_COMPRESSED_RG_RGTC2;
+	case Format::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	case Format::ETC2_RGB: return GL_COMPRESSED_RGB8_ETC2;
+	case Format::ETC2_RGBA: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+	case Format::ASTC_4x4: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+	default: return 0;
+	}
+}
+
+// Replaces the storage of an SDL texture with the blocks; false leaves the texture unusable
+static bool UploadBlocks(Texture& texture, const CompressedImage& image) {
+	CompressedTexImage2DProc compressedTexImage2D = (CompressedTexImage2DProc)SDL_GL_GetProcAddress("glCompressedTexImage2D");
+	GetIntegervProc getIntegerv = (GetIntegervProc)SDL_GL_GetProcAddress("glGetIntegerv");
+	GetErrorProc getError = (GetErrorProc)SDL_GL_GetProcAddress("glGetError");
+	if (compressedTexImage2D == NULL || getIntegerv == NULL || getError == NULL) return false;
+
+	// SDL pads textures to powers of two on old drivers and uses rectangle
+	// textures on others, and compressed storage can replace neither
+	FPoint scale;
+	if (GL::BindTexture(texture, scale) != 0) return false;
+	int bound = 0;
+	getIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+
+	bool ok = false;
+	if (bound != 0 && scale.x == 1.0f && scale.y == 1.0f) {
+		while (getError() != 0) {}
+		compressedTexImage2D(GL_TEXTURE_2D, 0, GLFormat(image.format), image.w, image.h, 0, (int)image.data.size(), image.data.data());
+		ok = getError() == 0;
+	}
+	GL::UnbindTexture(texture);
+	return ok;
+}
+
+//
+// Decoding
+//
+
+static inline Uint32 Pack(unsigned r, unsigned g, unsigned b, unsigned a) {
+	Uint8 bytes[4] = { (Uint8)r, (Uint8)g, (Uint8)b, (Uint8)a };
+	Uint32 pixel;
+	memcpy(&pixel, bytes, 4);
+	return pixel;
+}
+
+static inline Uint16 Read16(const Uint8* p) { return (Uint16)(p[0] | p[1] << 8); }
+static inline Uint32 Read32(const Uint8* p) { return (Uint32)p[0] | (Uint32)p[1] << 8 | (Uint32)p[2] << 16 | (Uint32)p[3] << 24; }
+
+// The colour half of a BC1, BC2 or BC3 block into 16 pixels
+static void DecodeColor(const Uint8* block, bool punchThrough, Uint8* dst, int pitch) {
+	Uint16 c0 = Read16(block), c1 = Read16(block + 2);
+	unsigned r0 = (c0 >> 11) & 31, g0 = (c0 >> 5) & 63, b0 = c0 & 31;
+	unsigned r1 = (c1 >> 11) & 31, g1 = (c1 >> 5) & 63, b1 = c1 & 31;
+	r0 = r0 << 3 | r0 >> 2; g0 = g0 << 2 | g0 >> 4; b0 = b0 << 3 | b0 >> 2;
+	r1 = r1 << 3 | r1 >> 2; g1 = g1 << 2 | g1 >> 4; b1 = b1 << 3 | b1 >> 2;
+
+	Uint32 palette[4];
+	palette[0] = Pack(r0, g0, b0, 255);
+	palette[1] = Pack(r1, g1, b1, 255);
+	if (c0 > c1 || !punchThrough) {
+		palette[2] = Pack((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+		palette[3] = Pack((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+	}
+	else {
+		palette[2] = Pack((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+		palette[3] = Pack(0, 0, 0, 0);
+	}
+	SIMD::Palette4x4(palette, Read32(block + 4), dst, pitch);
+}
+
+// A BC3 alpha or BC4 channel block into byte \c channel of 16 pixels
+static void DecodeChannel(const Uint8* block, Uint8* dst, int pitch, int channel) {
+	unsigned a0 = block[0], a1 = block[1];
+	Uint8 values[8] = { (Uint8)a0, (Uint8)a1 };
+	if (a0 > a1)
+		for (int i = 1; i < 7; i++) values[i + 1] = (Uint8)(((7 - i) * a0 + i * a1) / 7);
+	else {
+		for (int i = 1; i < 5; i++) values[i + 1] = (Uint8)(((5 - i) * a0 + i * a1) / 5);
+		values[6] = 0;
+		values[7] = 255;
+	}
+
+	Uint64 indices = 0;
+	for (int i = 0; i < 6; i++) indices |= (Uint64)block[2 + i] << (8 * i);
+	for (int y = 0; y < 4; y++, dst += pitch)
+		for (int x = 0; x < 4; x++, indices >>= 3) dst[x * 4 + channel] = values[indices & 7];
+}
+
+// BC2's explicit 4 bit alpha into byte 3 of 16 pixels
+static void DecodeExplicitAlpha(const Uint8* block, Uint8* dst, int pitch) {
+	for (int y = 0; y < 4; y++, dst += pitch) {
+		Uint16 row = Read16(block + y * 2);
+		for (int x = 0; x < 4; x++, row >>= 4) dst[x * 4 + 3] = (Uint8)((row & 15) * 17);
+	}
+}
+
+// For each BC7 partition of two subsets, a bit per pixel set for the second subset
+static const Uint16 BC7Partitions2[64] = {
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+
+// For each partition of three subsets, two bits per pixel giving its subset
+static const Uint32 BC7Partitions3[64] = {
+	0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+	0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+	0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+	0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+	0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+	0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+	0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+	0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+};
+
+// The pixel of each subset after the first whose index has an implied top bit of 0
+static const Uint8 BC7Anchors2[64] = {
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+	15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+	6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+};
+static const Uint8 BC7Anchors3[2][64] = {
+	{
+		3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+		3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+		8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+		3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+	},
+	{
+		15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+		15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+		15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+		15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+	}
+};
+
+static const Uint8 BC7Weights2[4] = { 0, 21, 43, 64 };
+static const Uint8 BC7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const Uint8 BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+namespace {
+	struct BC7Mode {
+		Uint8 subsets, partitionBits, rotationBits, selectorBits, colorBits, alphaBits, endpointPBits, sharedPBits, indexBits, index2Bits;
+	};
+
+	// Reads the fields of a block from its lowest bit up
+	struct BitReader {
+		Uint64 low, high;
+		explicit BitReader(const Uint8* block) {
+			low = high = 0;
+			for (int i = 0; i < 8; i++) {
+				low |= (Uint64)block[i] << (8 * i);
+				high |= (Uint64)block[8 + i] << (8 * i);
+			}
+		}
+		unsigned Read(int bits) {
+			if (bits == 0) return 0;
+			unsigned value = (unsigned)(low & ((1ull << bits) - 1));
+			low = low >> bits | high << (64 - bits);
+			high >>= bits;
+			return value;
+		}
+	};
+}
+
+static const BC7Mode BC7Modes[8] = {
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+
+static inline unsigned BC7Interpolate(unsigned e0, unsigned e1, unsigned weight) { return ((64 - weight) * e0 + weight * e1 + 32) >> 6; }
+
+static const Uint8* BC7WeightTable(int bits) { return bits == 2 ? BC7Weights2 : bits == 3 ? BC7Weights3 : BC7Weights4; }
+
+// Every mode of BC7 into 16 pixels
+static void DecodeBC7(const Uint8* block, Uint8* dst, int pitch) {
+	int mode = 0;
+	while (mode < 8 && !(block[0] & (1 << mode))) mode++;
+	if (mode == 8) {
+		// Reserved, which decoders must make transparent black
+		for (int y = 0; y < 4; y++) memset(dst + (size_t)pitch * y, 0, 16);
+		return;
+	}
+	const BC7Mode& m = BC7Modes[mode];
+	BitReader bits(block);
+	bits.Read(mode + 1);
+	unsigned partition = bits.Read(m.partitionBits);
+	unsigned rotation = bits.Read(m.rotationBits);
+	unsigned selector = bits.Read(m.selectorBits);
+
+	// Endpoints by subset and end, channel by channel
+	unsigned endpoints[3][2][4];
+	for (int c = 0; c < 3; c++)
+		for (int s = 0; s < m.subsets; s++)
+			for (int e = 0; e < 2; e++) endpoints[s][e][c] = bits.Read(m.colorBits);
+	for (int s = 0; s < m.subsets; s++)
+		for (int e = 0; e < 2; e++) endpoints[s][e][3] = bits.Read(m.alphaBits);
+
+	// Each endpoint gets a low bit of its own, or one shared by its subset
+	int colorBits = m.colorBits, alphaBits = m.alphaBits;
+	if (m.endpointPBits || m.sharedPBits) {
+		for (int s = 0; s < m.subsets; s++) {
+			unsigned shared = m.sharedPBits ? bits.Read(1) : 0;
+			for (int e = 0; e < 2; e++) {
+				unsigned p = m.sharedPBits ? shared : bits.Read(1);
+				for (int c = 0; c < 4; c++) endpoints[s][e][c] = endpoints[s][e][c] << 1 | p;
+			}
+		}
+		colorBits++;
+		if (alphaBits) alphaBits++;
+	}
+	for (int s = 0; s < m.subsets; s++)
+		for (int e = 0; e < 2; e++) {
+			for (int c = 0; c < 3; c++) {
+				unsigned v = endpoints[s][e][c] << (8 - colorBits);
+				endpoints[s][e][c] = v | v >> colorBits;
+			}
+			unsigned a = endpoints[s][e][3] << (8 - alphaBits);
+			endpoints[s][e][3] = alphaBits ? a | a >> alphaBits : 255;
+		}
+
+	Uint8 subsetOf[16] = {};
+	unsigned anchor1 = 0, anchor2 = 0;
+	if (m.subsets == 2) {
+		for (int i = 0; i < 16; i++) subsetOf[i] = (BC7Partitions2[partition] >> i) & 1;
+		anchor1 = BC7Anchors2[partition];
+	}
+	else if (m.subsets == 3) {
+		for (int i = 0; i < 16; i++) subsetOf[i] = (BC7Partitions3[partition] >> (2 * i)) & 3;
+		anchor1 = BC7Anchors3[0][partition];
+		anchor2 = BC7Anchors3[1][partition];
+	}
+
+	unsigned indices[16], indices2[16] = {};
+	for (unsigned i = 0; i < 16; i++) {
+		bool anchor = i == 0 || (m.subsets > 1 && i == anchor1) || (m.subsets > 2 && i == anchor2);
+		indices[i] = bits.Read(m.indexBits - anchor);
+	}
+	for (int i = 0; i < 16 && m.index2Bits; i++) indices2[i] = bits.Read(m.index2Bits - (i == 0));
+
+	// Modes 4 and 5 weight alpha with the second indices, or in mode 4 colour with them
+	const Uint8* colorWeights = BC7WeightTable(m.indexBits);
+	const Uint8* alphaWeights = colorWeights;
+	const unsigned* colorIndices = indices;
+	const unsigned* alphaIndices = indices;
+	if (m.index2Bits) {
+		alphaWeights = BC7WeightTable(m.index2Bits);
+		alphaIndices = indices2;
+		if (selector) {
+			std::swap(colorWeights, alphaWeights);
+			std::swap(colorIndices, alphaIndices);
+		}
+	}
+
+	for (int i = 0; i < 16; i++) {
+		const unsigned(&e)[2][4] = endpoints[subsetOf[i]];
+		unsigned colorWeight = colorWeights[colorIndices[i]], alphaWeight = alphaWeights[alphaIndices[i]];
+		Uint8 pixel[4];
+		for (int c = 0; c < 3; c++) pixel[c] = (Uint8)BC7Interpolate(e[0][c], e[1][c], colorWeight);
+		pixel[3] = (Uint8)BC7Interpolate(e[0][3], e[1][3], alphaWeight);
+		if (rotation) std::swap(pixel[3], pixel[rotation - 1]);
+		memcpy(dst + (size_t)pitch * (i / 4) + (i % 4) * 4, pixel, 4);
+	}
+}
+
+static void DecodeBlock(Format format, const Uint8* block, Uint8* dst, int pitch) {
+	switch (format) {
+	case Format::BC1:
+		DecodeColor(block, true, dst, pitch);
+		break;
+	case Format::BC2:
+		DecodeColor(block + 8, false, dst, pitch);
+		DecodeExplicitAlpha(block, dst, pitch);
+		break;
+	case Format::BC3:
+		DecodeColor(block + 8, false, dst, pitch);
+		DecodeChannel(block, dst, pitch, 3);
+		break;
+	case Format::BC4: {
+		const Uint32 black[4] = { Pack(0, 0, 0, 255), Pack(0, 0, 0, 255), Pack(0, 0, 0, 255), Pack(0, 0, 0, 255) };
+		SIMD::Palette4x4(black, 0, dst, pitch);
+		DecodeChannel(block, dst, pitch, 0);
+		break;
+	}
+	case Format::BC5: {
+		const Uint32 black[4] = { Pack(0, 0, 0, 255), Pack(0, 0, 0, 255), Pack(0, 0, 0, 255), Pack(0, 0, 0, 255) };
+		SIMD::Palette4x4(black, 0, dst, pitch);
+		DecodeChannel(block, dst, pitch, 0);
+		DecodeChannel(block + 8, dst, pitch, 1);
+		break;
+	}
+	case Format::BC7:
+		DecodeBC7(block, dst, pitch);
+		break;
+	default:
+		break;
+	}
+}
+
+//
+// CompressedImage
+//
+
+CompressedImage::CompressedImage(const std::string& file) : CompressedImage(SDL_RWFromFile(file.c_str(), "rb"), true) {}
+
+CompressedImage::CompressedImage(SDL_RWops* src, bool freesrc) {
+	if (src == NULL) {
+		error = -1;
+		return;
+	}
+	error = Read(src);
+	if (freesrc) SDL_RWclose(src);
+	if (error != 0) {
+		format = Format::UNKNOWN;
+		data.clear();
+	}
+}
+
+CompressedImage& CompressedImage::FlushError() { error = 0; return *this; }
+
+int CompressedImage::BlockBytes(Format format) {
+	switch (format) {
+	case Format::BC1:
+	case Format::BC4:
+	case Format::ETC2_RGB:
+		return 8;
+	case Format::UNKNOWN:
+		return 0;
+	default:
+		return 16;
+	}
+}
+
+bool CompressedImage::Decodable(Format format) { return format >= Format::BC1 && format <= Format::BC7; }
+
+const char* CompressedImage::GetFormatName(Format format) {
+	switch (format) {
+	case Format::BC1: return "BC1";
+	case Format::BC2: return "BC2";
+	case Format::BC3: return "BC3";
+	case Format::BC4: return "BC4";
+	case Format::BC5: return "BC5";
+	case Format::BC7: return "BC7";
+	case Format::ETC2_RGB: return "ETC2 RGB";
+	case Format::ETC2_RGBA: return "ETC2 RGBA";
+	case Format::ASTC_4x4: return "ASTC 4x4";
+	default: return "unknown";
+	}
+}
+
+int CompressedImage::Read(SDL_RWops* src) {
+	Uint8 magic[12];
+	if (SDL_RWread(src, magic, 4, 1) != 1) return SetError("Not a DDS or KTX2 file");
+	if (memcmp(magic, "DDS ", 4) == 0) return ReadDDS(src);
+
+	static const Uint8 KTX2[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	if (SDL_RWread(src, magic + 4, 8, 1) == 1 && memcmp(magic, KTX2, 12) == 0) return ReadKTX2(src);
+	return SetError("Not a DDS or KTX2 file");
+}
+
+int CompressedImage::ReadDDS(SDL_RWops* src) {
+	Uint32 header[31];
+	if (SDL_RWread(src, header, sizeof(header), 1) != 1) return SetError("DDS file is truncated");
+	for (Uint32& field : header) field = SDL_SwapLE32(field);
+	if (header[0] != 124) return SetError("DDS header is corrupt");
+	h = (int)header[2];
+	w = (int)header[3];
+
+	const Uint32 DDPF_FOURCC = 0x4;
+	Uint32 fourCC = header[19] & DDPF_FOURCC ? header[20] : 0;
+	Sint64 offset = 4 + sizeof(header);
+	if (fourCC == SDL_FOURCC('D', 'X', '1', '0')) {
+		Uint32 dx10[5];
+		if (SDL_RWread(src, dx10, sizeof(dx10), 1) != 1) return SetError("DDS file is truncated");
+		offset += sizeof(dx10);
+		// One 2D texture is all that is kept, so arrays and cubes are just truncated
+		switch (SDL_SwapLE32(dx10[0])) {
+		case 70: case 71: case 72: format = Format::BC1; break;
+		case 73: case 74: case 75: format = Format::BC2; break;
+		case 76: case 77: case 78: format = Format::BC3; break;
+		case 79: case 80: format = Format::BC4; break;
+		case 82: case 83: format = Format::BC5; break;
+		case 97: case 98: case 99: format = Format::BC7; break;
+		default: return SetError("DDS DXGI format %u is not supported", SDL_SwapLE32(dx10[0]));
+		}
+	}
+	else if (fourCC == SDL_FOURCC('D', 'X', 'T', '1')) format = Format::BC1;
+	else if (fourCC == SDL_FOURCC('D', 'X', 'T', '2') || fourCC == SDL_FOURCC('D', 'X', 'T', '3')) format = Format::BC2;
+	else if (fourCC == SDL_FOURCC('D', 'X', 'T', '4') || fourCC == SDL_FOURCC('D', 'X', 'T', '5')) format = Format::BC3;
+	else if (fourCC == SDL_FOURCC('A', 'T', 'I', '1') || fourCC == SDL_FOURCC('B', 'C', '4', 'U')) format = Format::BC4;
+	else if (fourCC == SDL_FOURCC('A', 'T', 'I', '2') || fourCC == SDL_FOURCC('B', 'C', '5', 'U')) format = Format::BC5;
+	else return SetError("DDS file is not block compressed");
+
+	return ReadBlocks(src, offset);
+}
+
+int CompressedImage::ReadKTX2(SDL_RWops* src) {
+	// vkFormat, typeSize, size, depth, layers, faces, levels, supercompression
+	Uint32 header[9];
+	if (SDL_RWread(src, header, sizeof(header), 1) != 1) return SetError("KTX2 file is truncated");
+	for (Uint32& field : header) field = SDL_SwapLE32(field);
+	w = (int)header[2];
+	h = (int)header[3];
+	if (header[4] > 1) return SetError("3D KTX2 textures are not supported");
+	if (header[8] != 0) return SetError("Supercompressed KTX2 files are not supported");
+
+	switch (header[0]) {
+	case 131: case 132: case 133: case 134: format = Format::BC1; break;
+	case 135: case 136: format = Format::BC2; break;
+	case 137: case 138: format = Format::BC3; break;
+	case 139: format = Format::BC4; break;
+	case 141: format = Format::BC5; break;
+	case 145: case 146: format = Format::BC7; break;
+	case 147: case 148: format = Format::ETC2_RGB; break;
+	case 151: case 152: format = Format::ETC2_RGBA; break;
+	case 157: case 158: format = Format::ASTC_4x4; break;
+	default: return SetError("KTX2 vkFormat %u is not supported", header[0]);
+	}
+
+	// Skip the data format, key/value and supercompression indices to reach level 0
+	if (SDL_RWseek(src, 12 + sizeof(header) + 32, RW_SEEK_SET) < 0) return SetError("KTX2 file is truncated");
+	Uint64 level[3];
+	if (SDL_RWread(src, level, sizeof(level), 1) != 1) return SetError("KTX2 file is truncated");
+	return ReadBlocks(src, (Sint64)SDL_SwapLE64(level[0]));
+}
+
+int CompressedImage::ReadBlocks(SDL_RWops* src, Sint64 offset) {
+	if (w <= 0 || h <= 0 || w > 65536 || h > 65536) return SetError("Compressed image of %dx%d is not supported", w, h);
+	Uint64 size = (Uint64)((w + 3) / 4) * (Uint64)((h + 3) / 4) * (Uint64)BlockBytes(format);
+	// Checked before allocating, so a corrupt header cannot ask for gigabytes
+	Sint64 total = SDL_RWsize(src);
+	if (offset < 0 || total < 0 || (Uint64)offset > (Uint64)total || size > (Uint64)total - (Uint64)offset) return SetError("Compressed image is truncated");
+	if (size > SIZE_MAX) return SetError("Compressed image of %dx%d is too large", w, h);
+	data.resize((size_t)size);
+	if (SDL_RWseek(src, offset, RW_SEEK_SET) < 0 || SDL_RWread(src, data.data(), (size_t)size, 1) != 1) return SetError("Compressed image is truncated");
+	return 0;
+}
+
+bool CompressedImage::UploadSupported(Renderer& renderer, Format format) {
+	Renderer::Info info;
+	if (renderer.renderer == NULL || SDL_GetRendererInfo(renderer.renderer, &info) != 0 || SDL_GL_GetCurrentContext() == NULL) return false;
+	bool es = strcmp(info.name, "opengles2") == 0;
+	if (!es && strcmp(info.name, "opengl") != 0) return false;
+
+	switch (format) {
+	case Format::BC1:
+		return SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc") || SDL_GL_ExtensionSupported("GL_EXT_texture_compression_dxt1");
+	case Format::BC2:
+	case Format::BC3:
+		return SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc");
+	case Format::BC4:
+	case Format::BC5:
+		return SDL_GL_ExtensionSupported("GL_ARB_texture_compression_rgtc") || SDL_GL_ExtensionSupported("GL_EXT_texture_compression_rgtc");
+	case Format::BC7:
+		return SDL_GL_ExtensionSupported("GL_ARB_texture_compression_bptc") || SDL_GL_ExtensionSupported("GL_EXT_texture_compression_bptc");
+	case Format::ETC2_RGB:
+	case Format::ETC2_RGBA: {
+		// Core in OpenGL ES 3, which SDL's ES 2 renderer may have been given
+		int major = 0;
+		if (es && SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major) == 0 && major >= 3) return true;
+		return SDL_GL_ExtensionSupported("GL_ARB_ES3_compatibility");
+	}
+	case Format::ASTC_4x4:
+		return SDL_GL_ExtensionSupported("GL_KHR_texture_compression_astc_ldr");
+	default:
+		return false;
+	}
+}
+
+Surface CompressedImage::Decode() const {
+	if (!Valid()) return Surface();
+	if (!Decodable(format)) {
+		SetError("%s textures cannot be decoded in software", GetFormatName(format));
+		return Surface();
+	}
+
+	SDLPP_PROFILE_ZONE("CompressedImage::Decode");
+	Surface surface(0, w, h, SDL_PIXELFORMAT_RGBA32);
+	if (surface.surface == NULL) return surface;
+
+	Uint8* pixels = (Uint8*)surface.surface->pixels;
+	int pitch = surface.surface->pitch;
+	int blockBytes = BlockBytes(format);
+	const Uint8* block = data.data();
+	Uint8 edge[4 * 4 * 4];
+	for (int y = 0; y < h; y += 4) {
+		for (int x = 0; x < w; x += 4, block += blockBytes) {
+			Uint8* dst = pixels + (size_t)pitch * y + (size_t)x * 4;
+			if (x + 4 <= w && y + 4 <= h) {
+				DecodeBlock(format, block, dst, pitch);
+				continue;
+			}
+
+			// Blocks over the right or bottom edge are decoded aside and clipped
+			DecodeBlock(format, block, edge, 16);
+			int rows = std::min(4, h - y), columns = std::min(4, w - x);
+			for (int r = 0; r < rows; r++) memcpy(dst + (size_t)pitch * r, edge + r * 16, (size_t)columns * 4);
+		}
+	}
+	return surface;
+}
+
+Texture CompressedImage::CreateTexture(Renderer& renderer, bool* compressed) {
+	if (compressed) *compressed = false;
+	if (!Valid()) {
+		error = SetError("No compressed image to create a texture from");
+		return Texture(renderer, NULL);
+	}
+
+	if (UploadSupported(renderer, format)) {
+		SDLPP_PROFILE_ZONE("CompressedImage::Upload");
+		Texture texture(renderer, { w, h }, Texture::Access::SDL_TEXTUREACCESS_STATIC, SDL_PIXELFORMAT_RGBA32);
+		if (texture.texture != NULL && UploadBlocks(texture, *this)) {
+			SDLPP_PROFILE_UPLOAD(data.size());
+			texture.SetBlendMode(SDL_BLENDMODE_BLEND);
+			if (compressed) *compressed = true;
+			return texture;
+		}
+	}
+
+	Surface decoded = Decode();
+	if (decoded.surface == NULL) {
+		error = -1;
+		return Texture(renderer, NULL);
+	}
+	Texture texture(renderer, { w, h }, Texture::Access::SDL_TEXTUREACCESS_STATIC, SDL_PIXELFORMAT_RGBA32);
+	if (texture.texture == NULL || texture.Update(decoded.surface->pixels, decoded.surface->pitch) != 0) {
+		error = -1;
+		return Texture(renderer, NULL);
+	}
+	texture.SetBlendMode(SDL_BLENDMODE_BLEND);
+	return texture;
+}
@@ -0,0 +1,112 @@
+#include "dirtyregion.hpp"
+#include <climits>
+#include <cmath>
+#include "video.hpp"
+
+using namespace SDL;
+
+// The cost of updating one more rectangle, in pixels copied
+static constexpr int RECT_COST = 32 * 32;
+
+DirtyRegion::DirtyRegion(int width, int height, int maxRects) : bounds(0, 0, width, height), maxRects(maxRects > 0 ? maxRects : 1) {}
+
+void DirtyRegion::Resize(int width, int height) {
+	bounds = Rect(0, 0, width, height);
+	AddAll();
+}
+
+void DirtyRegion::Add(const Rect& rect) {
+	Rect clipped = rect;
+	if (!bounds.empty() && !bounds.intersectRect(rect, clipped)) return;
+	if (clipped.empty()) return;
+
+	// Redrawing the same place is common, and needs nothing new
+	for (const Rect& r : rects)
+		if (clipped.x >= r.x && clipped.y >= r.y && clipped.x + clipped.w <= r.x + r.w && clipped.y + clipped.h <= r.y + r.h) return;
+
+	rects.push_back(clipped);
+	merged = false;
+}
+
+void DirtyRegion::Add(const FRect& rect) {
+	int x = (int)std::floor(rect.x), y = (int)std::floor(rect.y);
+	Add(Rect(x, y, (int)std::ceil(rect.x + rect.w) - x, (int)std::ceil(rect.y + rect.h) - y));
+}
+
+void DirtyRegion::AddAll() {
+	rects.clear();
+	if (!bounds.empty()) rects.push_back(bounds);
+	merged = true;
+}
+
+void DirtyRegion::Merge() {
+	if (merged) return;
+	merged = true;
+
+	// Join any two rectangles whose union costs less to copy than both apart, which
+	// includes every pair that touches, until no pair does
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (size_t i = 0; i < rects.size(); i++) {
+			for (size_t j = i + 1; j < rects.size(); j++) {
+				Rect joined;
+				rects[i].rectUnion(rects[j], joined);
+				if (joined.area() > rects[i].area() + rects[j].area() + RECT_COST) continue;
+
+				rects[i] = joined;
+				rects[j] = rects.back();
+				rects.pop_back();
+				changed = true;
+				j = i;
+			}
+		}
+	}
+
+	// Then join the pairs that waste least until few enough are left
+	while ((int)rects.size() > maxRects) {
+		size_t bestI = 0, bestJ = 1;
+		int bestWaste = INT_MAX;
+		for (size_t i = 0; i < rects.size(); i++) {
+			for (size_t j = i + 1; j < rects.size(); j++) {
+				Rect joined;
+				rects[i].rectUnion(rects[j], joined);
+				int waste = joined.area() - rects[i].area() - rects[j].area();
+				if (waste < bestWaste) {
+					bestWaste = waste;
+					bestI = i;
+					bestJ = j;
+				}
+			}
+		}
+		rects[bestI].rectUnion(rects[bestJ], rects[bestI]);
+		rects[bestJ] = rects.back();
+		rects.pop_back();
+	}
+
+	if (!bounds.empty() && Area() > bounds.area() * FULL_SHARE) {
+		rects.clear();
+		rects.push_back(bounds);
+	}
+}
+
+const std::vector<Rect>& DirtyRegion::Rects() {
+	Merge();
+	return rects;
+}
+
+int DirtyRegion::Area() {
+	Merge();
+	int area = 0;
+	for (const Rect& r : rects) area += r.area();
+	return area;
+}
+
+int DirtyRegion::Present(Window& window) {
+	Merge();
+	if (rects.empty()) return 0;
+
+	window.UpdateSurfaceRects(rects);
+	Clear();
+	return window.error;
+}
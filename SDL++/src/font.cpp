@@ -0,0 +1,287 @@
+#include "font.hpp"
+#include "error.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace SDL;
+
+// SDL_ttf 2.0.18 added the 32 bit glyph functions; before it only the basic
+// multilingual plane can be rendered
+#if defined(SDL_TTF_VERSION_ATLEAST)
+#if SDL_TTF_VERSION_ATLEAST(2,0,18)
+#define SDLPP_TTF_GLYPH32
+#endif
+#endif
+
+#ifdef SDLPP_TTF_GLYPH32
+#define GLYPH_METRICS TTF_GlyphMetrics32
+#define RENDER_GLYPH TTF_RenderGlyph32_Blended
+#define KERNING_GLYPHS TTF_GetFontKerningSizeGlyphs32
+#else
+#define GLYPH_METRICS(font, c, minx, maxx, miny, maxy, advance) ((c) > 0xFFFF ? -1 : TTF_GlyphMetrics(font, (Uint16)(c), minx, maxx, miny, maxy, advance))
+#define RENDER_GLYPH(font, c, fg) ((c) > 0xFFFF ? NULL : TTF_RenderGlyph_Blended(font, (Uint16)(c), fg))
+#define KERNING_GLYPHS(font, a, b) ((a) > 0xFFFF || (b) > 0xFFFF ? 0 : TTF_GetFontKerningSizeGlyphs(font, (Uint16)(a), (Uint16)(b)))
+#endif
+
+// Decode one code point and step past it, giving U+FFFD for malformed input
+static Uint32 NextCodepoint(const std::string& s, size_t& i) {
+	Uint8 c = (Uint8)s[i++];
+	if (c < 0x80) return c;
+
+	int length = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+	if (length == 0 || c >= 0xF8) return 0xFFFD;
+	Uint32 codepoint = c & (0x3F >> length);
+	for (int k = 0; k < length; k++) {
+		if (i >= s.size() || ((Uint8)s[i] & 0xC0) != 0x80) return 0xFFFD;
+		codepoint = codepoint << 6 | ((Uint8)s[i++] & 0x3F);
+	}
+	return codepoint;
+}
+
+GlyphCache::GlyphCache(Renderer& renderer, Font& font, const Point& pageSize)
+	: renderer(renderer), font(font), atlas(renderer, pageSize), kerningEnabled(font.font != NULL && font.GetKerning()) {}
+
+GlyphCache& GlyphCache::FlushError() { error = 0; return *this; }
+
+GlyphCache::Glyph GlyphCache::Render(Uint32 codepoint) {
+	SDLPP_PROFILE_ZONE("GlyphCache::Render");
+	Glyph glyph;
+	if (font.font == NULL) {
+		error = SetError("GlyphCache: no font");
+		return glyph;
+	}
+
+	int minx, maxx, miny, maxy, advance;
+	if (GLYPH_METRICS(font.font, codepoint, &minx, &maxx, &miny, &maxy, &advance) != 0) return glyph;
+	glyph.advance = advance;
+
+	Surface rendered(RENDER_GLYPH(font.font, codepoint, SDL_Color{ 255, 255, 255, 255 }), true);
+	bool convert = rendered.surface != NULL && rendered.surface->format->format != SDL_PIXELFORMAT_ARGB8888;
+	Surface converted = convert ? rendered.ConvertSurfaceFormat(SDL_PIXELFORMAT_ARGB8888, 0) : Surface();
+	Surface& argb = converted.surface != NULL ? converted : rendered;
+	if (argb.surface == NULL || argb.surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+		error = -1;
+		return glyph;
+	}
+
+	// The glyph is drawn into a box one line tall that starts at the pen, or
+	// before it by a negative bearing; keep only the pixels that show
+	bool locked = argb.MustLock();
+	if (locked) argb.Lock();
+	SDL_Surface* s = argb.surface;
+	int x0 = s->w, y0 = s->h, x1 = -1, y1 = -1;
+	for (int y = 0; y < s->h; y++) {
+		const Uint32* row = (const Uint32*)((const Uint8*)s->pixels + (size_t)y * s->pitch);
+		for (int x = 0; x < s->w; x++) {
+			if ((row[x] >> 24) == 0) continue;
+			x0 = std::min(x0, x);
+			x1 = std::max(x1, x);
+			y0 = std::min(y0, y);
+			y1 = std::max(y1, y);
+		}
+	}
+
+	if (x1 >= 0) {
+		Surface cropped((Uint8*)s->pixels + (size_t)y0 * s->pitch + x0 * 4, x1 - x0 + 1, y1 - y0 + 1, s->pitch, SDL_PIXELFORMAT_ARGB8888);
+		if (cropped.surface != NULL) glyph.region = atlas.Add(cropped);
+		if (!glyph.region.Valid()) error = -1;
+		glyph.offset = Point(x0 + std::min(minx, 0), y0);
+	}
+	if (locked) argb.Unlock();
+	return glyph;
+}
+
+const GlyphCache::Glyph& GlyphCache::Get(Uint32 codepoint) {
+	if (codepoint < 128) {
+		if (!asciiCached[codepoint]) {
+			ascii[codepoint] = Render(codepoint);
+			asciiCached[codepoint] = true;
+		}
+		return ascii[codepoint];
+	}
+
+	auto it = glyphs.find(codepoint);
+	if (it != glyphs.end()) return it->second;
+	return glyphs.emplace(codepoint, Render(codepoint)).first->second;
+}
+
+int GlyphCache::Kerning(Uint32 previous, Uint32 codepoint) {
+	if (!kerningEnabled || previous == 0) return 0;
+	Uint64 key = (Uint64)previous << 32 | codepoint;
+	auto it = kerning.find(key);
+	if (it != kerning.end()) return it->second;
+	int amount = KERNING_GLYPHS(font.font, previous, codepoint);
+	kerning.emplace(key, amount);
+	return amount;
+}
+
+GlyphCache& GlyphCache::Preload(const std::string& utf8) {
+	for (size_t i = 0; i < utf8.size();) Get(NextCodepoint(utf8, i));
+	return *this;
+}
+
+GlyphCache& GlyphCache::Clear() {
+	for (bool& cached : asciiCached) cached = false;
+	glyphs.clear();
+	kerning.clear();
+	atlas.Clear();
+	generation++;
+	kerningEnabled = font.font != NULL && font.GetKerning();
+	return *this;
+}
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+TextBuffer::TextBuffer(GlyphCache& cache) : cache(cache), generation(cache.generation) {}
+
+TextBuffer& TextBuffer::FlushError() { error = 0; return *this; }
+
+void TextBuffer::Push(const GlyphCache::Glyph& glyph, float x, float y, const SDL_Color& colour) {
+	if (lastBatch >= batches.size() || batches[lastBatch].page != glyph.region.texture) {
+		lastBatch = 0;
+		while (lastBatch < batches.size() && batches[lastBatch].page != glyph.region.texture) lastBatch++;
+		if (lastBatch == batches.size()) batches.push_back({ glyph.region.texture });
+	}
+	Batch& batch = batches[lastBatch];
+
+	const Rect& src = glyph.region.src;
+	const Point& pageSize = cache.atlas.pageSize;
+	float u0 = (float)src.x / pageSize.w, u1 = (float)(src.x + src.w) / pageSize.w;
+	float v0 = (float)src.y / pageSize.h, v1 = (float)(src.y + src.h) / pageSize.h;
+	float x0 = x + glyph.offset.x, y0 = y + glyph.offset.y;
+	float x1 = x0 + src.w, y1 = y0 + src.h;
+
+	int base = (int)batch.vertices.size();
+	batch.vertices.push_back({ { x0, y0 }, colour, { u0, v0 } });
+	batch.vertices.push_back({ { x1, y0 }, colour, { u1, v0 } });
+	batch.vertices.push_back({ { x1, y1 }, colour, { u1, v1 } });
+	batch.vertices.push_back({ { x0, y1 }, colour, { u0, v1 } });
+	batch.indices.insert(batch.indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+}
+
+FRect TextBuffer::Layout(const std::string& utf8, const FPoint& pos, float wrapWidth, Align align, const SDL_Color* colour) {
+	SDLPP_PROFILE_ZONE("TextBuffer::Layout");
+	if (cache.font.font == NULL) {
+		error = SetError("TextBuffer: no font");
+		return FRect(pos.x, pos.y, 0, 0);
+	}
+
+	float lineSkip = (float)cache.font.LineSkip();
+	float y = pos.y, left = FLT_MAX, right = -FLT_MAX;
+	int lines = 0;
+
+	// Emit the first count glyphs of the line, which are width wide without trailing spaces
+	auto emit = [&](size_t count, float width) {
+		float x = pos.x;
+		if (align == Align::CENTER) x += ((wrapWidth > 0 ? wrapWidth : 0) - width) / 2;
+		else if (align == Align::RIGHT) x += (wrapWidth > 0 ? wrapWidth : 0) - width;
+		x = std::round(x);
+
+		if (colour != NULL)
+			for (size_t i = 0; i < count; i++)
+				if (line[i].glyph->region.Valid()) Push(*line[i].glyph, x + line[i].x, std::round(y), *colour);
+		if (width > 0) {
+			left = std::min(left, x);
+			right = std::max(right, x + width);
+		}
+		line.erase(line.begin(), line.begin() + count);
+		y += lineSkip;
+		lines++;
+	};
+
+	line.clear();
+	float pen = 0;
+	Uint32 previous = 0;
+	// Where the line may be broken: the glyphs before the last space, their width, and where the next word starts
+	size_t breakCount = 0;
+	float breakWidth = 0, breakPen = 0;
+	float width = 0;
+
+	for (size_t i = 0; i < utf8.size();) {
+		Uint32 codepoint = NextCodepoint(utf8, i);
+		if (codepoint == '\n') {
+			emit(line.size(), width);
+			pen = width = 0;
+			previous = 0;
+			breakCount = 0;
+			continue;
+		}
+
+		const GlyphCache::Glyph& glyph = cache.Get(codepoint);
+		pen += cache.Kerning(previous, codepoint);
+		previous = codepoint;
+
+		if (codepoint == ' ') {
+			breakCount = line.size();
+			breakWidth = width;
+			breakPen = pen + glyph.advance;
+		}
+		else if (wrapWidth > 0 && breakCount > 0 && pen + glyph.advance > wrapWidth) {
+			// Carry the word being laid out over to the next line
+			emit(breakCount, breakWidth);
+			while (!line.empty() && line.front().glyph == &cache.Get(' ')) line.erase(line.begin());
+			for (Placed& placed : line) placed.x -= breakPen;
+			pen -= breakPen;
+			width -= breakPen;
+			breakCount = 0;
+		}
+
+		line.push_back({ &glyph, pen });
+		pen += glyph.advance;
+		if (codepoint != ' ') width = pen;
+	}
+	if (!line.empty() || lines == 0) emit(line.size(), width);
+
+	if (left > right) left = right = pos.x;
+	float height = (lines - 1) * lineSkip + cache.font.Height();
+	if (cache.error != 0) error = -1;
+	return FRect(left, pos.y, right - left, height);
+}
+
+bool TextBuffer::DropStale() {
+	if (generation == cache.generation) return false;
+	generation = cache.generation;
+	batches.clear();
+	return true;
+}
+
+FRect TextBuffer::Add(const std::string& utf8, const FPoint& pos, const Colour& colour, float wrapWidth, Align align) {
+	DropStale();
+	SDL_Color c = colour;
+	return Layout(utf8, pos, wrapWidth, align, &c);
+}
+
+FPoint TextBuffer::Measure(const std::string& utf8, float wrapWidth) {
+	FRect bounds = Layout(utf8, FPoint(0, 0), wrapWidth, Align::LEFT, NULL);
+	return FPoint(bounds.w, bounds.h);
+}
+
+size_t TextBuffer::Size() const {
+	size_t count = 0;
+	for (const Batch& batch : batches) count += batch.vertices.size() / 4;
+	return count;
+}
+
+TextBuffer& TextBuffer::Clear() {
+	for (Batch& batch : batches) {
+		batch.vertices.clear();
+		batch.indices.clear();
+	}
+	return *this;
+}
+
+int TextBuffer::Draw() {
+	SDLPP_PROFILE_ZONE("TextBuffer::Draw");
+	if (generation != cache.generation) {
+		bool laidOut = Size() != 0;
+		DropStale();
+		if (laidOut) return error = SetError("TextBuffer: the glyph cache was cleared since the text was added");
+	}
+	int result = 0;
+	for (Batch& batch : batches)
+		if (!batch.indices.empty()) result |= batch.page->Geometry(batch.vertices, batch.indices);
+	if (result != 0) error = -1;
+	return result != 0 ? -1 : 0;
+}
+#endif
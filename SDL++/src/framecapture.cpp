@@ -0,0 +1,184 @@
+#include "framecapture.hpp"
+#include "error.hpp"
+#include "image.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+
+using namespace SDL;
+
+FrameCapture::FrameCapture(Renderer& renderer, Encoder encoder, int ringSize, Uint32 format, size_t maxQueued)
+	: renderer(renderer), format(format), maxQueued(std::max(maxQueued, (size_t)1)), encoder(std::move(encoder)), ring(std::max(ringSize, 2)) {}
+
+FrameCapture::~FrameCapture() { worker.Wait(); }
+
+FrameCapture& FrameCapture::FlushError() { error = 0; return *this; }
+
+int FrameCapture::Resize(const Point& outputSize) {
+	// Keep the frames drawn at the old size
+	int result = Flush();
+
+	size = outputSize;
+	for (Slot& slot : ring) {
+		slot.texture.reset(new Texture(renderer, size, Texture::Access::SDL_TEXTUREACCESS_TARGET, SDL_PIXELFORMAT_RGBA32));
+		if (slot.texture->texture == NULL) {
+			slot.texture.reset();
+			size = Point(0, 0);
+			return -1;
+		}
+		slot.texture->SetBlendMode(SDL_BLENDMODE_NONE);
+	}
+	next = 0;
+	return result;
+}
+
+int FrameCapture::Begin() {
+	SDLPP_PROFILE_ZONE("FrameCapture::Begin");
+	if (drawing) {
+		error = SetError("FrameCapture: Begin() called twice");
+		return -1;
+	}
+
+	Point outputSize = renderer.GetOutputSize();
+	if (outputSize.w != size.w || outputSize.h != size.h || !ring[next].texture) {
+		if (Resize(outputSize) != 0) {
+			error = -1;
+			return -1;
+		}
+	}
+
+	// Read back before anything of this frame is queued, so the read does not wait on it
+	Slot& slot = ring[next];
+	if (slot.pending && Readback(slot) != 0) error = -1;
+	renderer.SetTarget(*slot.texture);
+	if (SDL_GetRenderTarget(renderer.renderer) != slot.texture->texture) {
+		error = -1;
+		return -1;
+	}
+	drawing = true;
+	return 0;
+}
+
+int FrameCapture::End() {
+	SDLPP_PROFILE_ZONE("FrameCapture::End");
+	if (!drawing) {
+		error = SetError("FrameCapture: End() called without Begin()");
+		return -1;
+	}
+	drawing = false;
+
+	Slot& slot = ring[next];
+	slot.pending = true;
+	slot.index = frames++;
+	slot.ticks = SDL_GetTicks();
+
+	// The frame was drawn at the output size, so copy it pixel for pixel
+	// whatever the window's viewport and scale
+	renderer.ResetTarget();
+	Rect viewport = renderer.GetViewport();
+	FPoint scale = renderer.GetScale();
+	Rect whole(0, 0, size.w, size.h);
+	renderer.SetScale(FPoint(1, 1)).SetViewport(whole);
+	int result = slot.texture->Copy(whole);
+	renderer.SetScale(scale).SetViewport(viewport);
+
+	// The slot drawn into next holds the oldest frame, which Begin() reads back
+	next = (next + 1) % ring.size();
+
+	if (result != 0) error = -1;
+	return result != 0 ? -1 : 0;
+}
+
+int FrameCapture::Readback(Slot& slot) {
+	SDLPP_PROFILE_ZONE("FrameCapture::Readback");
+	slot.pending = false;
+
+	Frame frame;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// Dropped before reading back, so an encoder that is behind costs no stall
+		if (queued >= maxQueued) {
+			dropped++;
+			return 0;
+		}
+		if (!spare.empty()) {
+			frame.pixels = std::move(spare.back());
+			spare.pop_back();
+		}
+	}
+	frame.size = size;
+	frame.pitch = size.w * SDL_BYTESPERPIXEL(format);
+	frame.format = format;
+	frame.index = slot.index;
+	frame.ticks = slot.ticks;
+	frame.pixels.resize((size_t)frame.pitch * size.h);
+
+	int result;
+	{
+		TargetGuard target(renderer, *slot.texture);
+		result = target.error;
+		if (result == 0) result = SDL_RenderReadPixels(renderer.renderer, NULL, format, frame.pixels.data(), frame.pitch);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (result != 0) {
+		spare.push_back(std::move(frame.pixels));
+		return result;
+	}
+	queued++;
+	captured++;
+	worker.Push([this, frame = std::move(frame)]() mutable {
+		if (encoder(frame) != 0) failed++;
+		std::lock_guard<std::mutex> lock(mutex);
+		spare.push_back(std::move(frame.pixels));
+		queued--;
+	});
+	return 0;
+}
+
+int FrameCapture::Flush() {
+	SDLPP_PROFILE_ZONE("FrameCapture::Flush");
+	if (drawing) {
+		error = SetError("FrameCapture: Flush() called between Begin() and End()");
+		return -1;
+	}
+
+	// Oldest first, starting with the slot that would be drawn into next
+	int result = 0;
+	for (size_t i = 0; i < ring.size(); i++) {
+		Slot& slot = ring[(next + i) % ring.size()];
+		if (!slot.pending) continue;
+		// Flush() blocks anyway, so it waits for the encoder rather than dropping frames
+		if (Queued() >= maxQueued) worker.Wait();
+		result |= Readback(slot);
+	}
+	worker.Wait();
+
+	if (result != 0) error = -1;
+	return result != 0 ? -1 : 0;
+}
+
+size_t FrameCapture::Queued() {
+	std::lock_guard<std::mutex> lock(mutex);
+	return queued;
+}
+
+FrameCapture::Encoder FrameCapture::PNGFiles(const std::string& pattern) {
+	return [pattern](Frame& frame) {
+		char file[1024];
+		SDL_snprintf(file, sizeof(file), pattern.c_str(), (unsigned long long)frame.index);
+		Surface surface(frame.pixels.data(), frame.size.w, frame.size.h, frame.pitch, frame.format);
+		if (surface.surface == NULL) return -1;
+		return IMG::SavePNG(surface, file);
+	};
+}
+
+FrameCapture::Encoder FrameCapture::RawFrames(SDL_RWops* dst, bool freedst) {
+	std::shared_ptr<SDL_RWops> out(dst, [freedst](SDL_RWops* rw) { if (freedst && rw != NULL) SDL_RWclose(rw); });
+	return [out](Frame& frame) {
+		if (!out) return -1;
+		// Readback() packs the rows, so the pixels go out in one write
+		size_t bytes = (size_t)frame.pitch * frame.size.h;
+		if (bytes == 0) return 0;
+		return SDL_RWwrite(out.get(), frame.pixels.data(), bytes, 1) == 1 ? 0 : -1;
+	};
+}
@@ -0,0 +1,213 @@
+#include "imageloader.hpp"
+
+using namespace SDL;
+using namespace SDL::IMG;
+
+typedef AsyncLoader::Status Status;
+
+// Whether a load has nothing left to do
+static bool IsFinal(Status status, bool upload) {
+	switch (status) {
+	case Status::UPLOADED:
+	case Status::FAILED:
+	case Status::CANCELLED:
+		return true;
+	case Status::DECODED:
+		return !upload;
+	default:
+		return false;
+	}
+}
+
+// Moves a load into a final state, unless it already reached one
+static bool Finish(AsyncLoader::Request& request, Status status) {
+	Status current = request.status.load();
+	while (!IsFinal(current, request.upload))
+		if (request.status.compare_exchange_weak(current, status)) return true;
+	return false;
+}
+
+AsyncLoader::Request::~Request() {
+	if (surface != NULL) SDL_FreeSurface(surface);
+	if (texture != NULL) SDL_DestroyTexture(texture);
+	if (src != NULL && freesrc) SDL_RWclose(src);
+}
+
+Status AsyncLoader::Handle::GetStatus() const { return request ? request->status.load() : Status::CANCELLED; }
+bool AsyncLoader::Handle::Done() const { return !request || IsFinal(request->status, request->upload); }
+bool AsyncLoader::Handle::Succeeded() const {
+	Status status = GetStatus();
+	return request && (status == (request->upload ? Status::UPLOADED : Status::DECODED));
+}
+const std::string& AsyncLoader::Handle::GetError() const {
+	static const std::string none;
+	return request && request->status == Status::FAILED ? request->error : none;
+}
+
+bool AsyncLoader::Handle::Cancel() {
+	if (!request) return false;
+	request->cancelled = true;
+	return Finish(*request, Status::CANCELLED);
+}
+
+Surface AsyncLoader::Handle::TakeSurface() {
+	if (!request || request->upload || request->status != Status::DECODED) return Surface();
+	Surface surface(request->surface, true);
+	request->surface = NULL;
+	return surface;
+}
+
+Texture AsyncLoader::Handle::TakeTexture(Renderer& renderer) {
+	if (!request || !request->upload || request->status != Status::UPLOADED) return Texture(renderer, NULL);
+	Texture texture(renderer, request->texture, true);
+	request->texture = NULL;
+	return texture;
+}
+
+AsyncLoader::AsyncLoader(ThreadPool& pool) : pool(pool), shared(std::make_shared<Shared>()) {}
+AsyncLoader::~AsyncLoader() { CancelAll(); }
+
+AsyncLoader::Handle AsyncLoader::Queue(std::shared_ptr<Request> request) {
+	{
+		std::lock_guard<std::mutex> lock(requestsMutex);
+		// Start counting progress afresh once everything queued before has finished
+		if (CountPending() == 0) requests.clear();
+		requests.push_back(request);
+	}
+
+	std::shared_ptr<Shared> shared = this->shared;
+	pool.Push([shared, request]() {
+		Status expected = Status::QUEUED;
+		if (request->cancelled || !request->status.compare_exchange_strong(expected, Status::DECODING)) return;
+
+		SDL_Surface* surface;
+		if (request->src != NULL) {
+			surface = request->type.empty()
+				? IMG_Load_RW(request->src, request->freesrc)
+				: IMG_LoadTyped_RW(request->src, request->freesrc, request->type.c_str());
+			if (request->freesrc) request->src = NULL;
+		}
+		else surface = IMG_Load(request->file.c_str());
+
+		if (surface == NULL) {
+			request->error = SDL_GetError();
+			Finish(*request, Status::FAILED);
+			return;
+		}
+
+		request->surface = surface;
+		expected = Status::DECODING;
+		if (!request->status.compare_exchange_strong(expected, Status::DECODED)) return;
+
+		if (request->upload) {
+			std::lock_guard<std::mutex> lock(shared->mutex);
+			shared->decoded.push_back(request);
+		}
+	});
+
+	return { request };
+}
+
+AsyncLoader::Handle AsyncLoader::Load(const std::string& file) {
+	auto request = std::make_shared<Request>();
+	request->file = file;
+	return Queue(request);
+}
+
+AsyncLoader::Handle AsyncLoader::Load_RW(SDL_RWops* src, bool freesrc, const char* type) {
+	auto request = std::make_shared<Request>();
+	request->src = src;
+	request->freesrc = freesrc;
+	if (type != NULL) request->type = type;
+	return Queue(request);
+}
+
+AsyncLoader::Handle AsyncLoader::LoadTexture(const std::string& file) {
+	auto request = std::make_shared<Request>();
+	request->upload = true;
+	request->file = file;
+	return Queue(request);
+}
+
+AsyncLoader::Handle AsyncLoader::LoadTexture_RW(SDL_RWops* src, bool freesrc, const char* type) {
+	auto request = std::make_shared<Request>();
+	request->upload = true;
+	request->src = src;
+	request->freesrc = freesrc;
+	if (type != NULL) request->type = type;
+	return Queue(request);
+}
+
+int AsyncLoader::Upload(Renderer& renderer, Uint32 budgetMs) {
+	Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 budget = SDL_GetPerformanceFrequency() * budgetMs / 1000;
+	int uploaded = 0;
+
+	for (;;) {
+		std::shared_ptr<Request> request;
+		{
+			std::lock_guard<std::mutex> lock(shared->mutex);
+			if (shared->decoded.empty()) break;
+			request = std::move(shared->decoded.front());
+			shared->decoded.pop_front();
+		}
+		// Cancelled after decoding; the surface is freed with the request
+		if (request->status != Status::DECODED) continue;
+
+		request->texture = SDL_CreateTextureFromSurface(renderer.renderer, request->surface);
+		SDL_FreeSurface(request->surface);
+		request->surface = NULL;
+
+		if (request->texture == NULL) {
+			request->error = SDL_GetError();
+			Finish(*request, Status::FAILED);
+		}
+		else if (!Finish(*request, Status::UPLOADED)) {
+			SDL_DestroyTexture(request->texture);
+			request->texture = NULL;
+		}
+		uploaded++;
+
+		if (SDL_GetPerformanceCounter() - start >= budget) break;
+	}
+
+	return uploaded;
+}
+
+void AsyncLoader::CancelAll() {
+	std::lock_guard<std::mutex> lock(requestsMutex);
+	for (auto& weak : requests) {
+		std::shared_ptr<Request> request = weak.lock();
+		if (request) Handle{ request }.Cancel();
+	}
+}
+
+int AsyncLoader::Pending() const {
+	std::lock_guard<std::mutex> lock(requestsMutex);
+	return CountPending();
+}
+
+int AsyncLoader::CountPending() const {
+	int pending = 0;
+	for (auto& weak : requests) {
+		std::shared_ptr<Request> request = weak.lock();
+		if (request && !IsFinal(request->status, request->upload)) pending++;
+	}
+	return pending;
+}
+
+float AsyncLoader::Progress() const {
+	std::lock_guard<std::mutex> lock(requestsMutex);
+	if (requests.empty()) return 1.0f;
+	return 1.0f - (float)CountPending() / requests.size();
+}
+
+void AsyncLoader::ResetProgress() {
+	std::lock_guard<std::mutex> lock(requestsMutex);
+	std::vector<std::weak_ptr<Request>> pending;
+	for (auto& weak : requests) {
+		std::shared_ptr<Request> request = weak.lock();
+		if (request && !IsFinal(request->status, request->upload)) pending.push_back(weak);
+	}
+	requests.swap(pending);
+}
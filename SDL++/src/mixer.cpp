@@ -0,0 +1,470 @@
+#include "mixer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "simd.hpp"
+
+#if defined(SDLPP_SIMD_X86)
+#include <immintrin.h>
+#elif defined(SDLPP_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace SDL;
+
+Sound::Sound(const float* samples, int frames, int channels, int rate)
+	: samples(samples, samples + (size_t)frames * channels), channels(channels), rate(rate) {}
+
+Sound::Sound(const WAV& wav) {
+	if (!wav.freeWAV) return;
+
+	int dstChannels = wav.spec.channels == 1 ? 1 : 2;
+	AudioCVT cvt(AudioFormat{ wav.spec.format }, wav.spec.channels, wav.spec.freq, F32SYS, dstChannels, wav.spec.freq);
+	if (cvt.error < 0) return;
+
+	std::vector<Uint8> buffer((size_t)wav.audio_len * cvt.cvt.len_mult);
+	memcpy(buffer.data(), wav.audio_buf, wav.audio_len);
+	cvt.cvt.buf = buffer.data();
+	cvt.cvt.len = (int)wav.audio_len;
+	if (cvt.error > 0 && cvt.ConvertAudio() != 0) return;
+
+	int bytes = cvt.error > 0 ? cvt.cvt.len_cvt : (int)wav.audio_len;
+	this->samples.resize(bytes / sizeof(float));
+	memcpy(this->samples.data(), buffer.data(), this->samples.size() * sizeof(float));
+	channels = dstChannels;
+	rate = wav.spec.freq;
+}
+
+// Kernels adding a source into the stereo mix, with the gains ramping by dl and dr each frame
+static void MixStereoScalar(const float* src, float* dst, int frames, float gl, float gr, float dl, float dr) {
+	for (int i = 0; i < frames; i++, gl += dl, gr += dr) {
+		dst[i * 2] += src[i * 2] * gl;
+		dst[i * 2 + 1] += src[i * 2 + 1] * gr;
+	}
+}
+
+static void MixMonoScalar(const float* src, float* dst, int frames, float gl, float gr, float dl, float dr) {
+	for (int i = 0; i < frames; i++, gl += dl, gr += dr) {
+		dst[i * 2] += src[i] * gl;
+		dst[i * 2 + 1] += src[i] * gr;
+	}
+}
+
+static void ClampF32Scalar(const float* src, float* dst, int count) {
+	for (int i = 0; i < count; i++) dst[i] = std::min(std::max(src[i], -1.0f), 1.0f);
+}
+
+static void ToS16Scalar(const float* src, Sint16* dst, int count) {
+	for (int i = 0; i < count; i++) dst[i] = (Sint16)std::lrint(std::min(std::max(src[i], -1.0f), 1.0f) * 32767.0f);
+}
+
+#ifdef SDLPP_SIMD_X86
+// Two stereo frames at a time
+SDLPP_TARGET("sse2") static void MixStereoSSE2(const float* src, float* dst, int frames, float gl, float gr, float dl, float dr) {
+	__m128 gain = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+	__m128 step = _mm_setr_ps(dl * 2, dr * 2, dl * 2, dr * 2);
+	int i = 0;
+	for (; i + 2 <= frames; i += 2) {
+		__m128 s = _mm_loadu_ps(src + i * 2);
+		__m128 d = _mm_loadu_ps(dst + i * 2);
+		_mm_storeu_ps(dst + i * 2, _mm_add_ps(d, _mm_mul_ps(s, gain)));
+		gain = _mm_add_ps(gain, step);
+	}
+	MixStereoScalar(src + i * 2, dst + i * 2, frames - i, gl + dl * i, gr + dr * i, dl, dr);
+}
+
+SDLPP_TARGET("sse2") static void MixMonoSSE2(const float* src, float* dst, int frames, float gl, float gr, float dl, float dr) {
+	__m128 gain = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+	__m128 step = _mm_setr_ps(dl * 2, dr * 2, dl * 2, dr * 2);
+	int i = 0;
+	for (; i + 2 <= frames; i += 2) {
+		// Duplicate each of two mono samples into a left and right pair
+		__m128 s = _mm_castpd_ps(_mm_load_sd((const double*)(src + i)));
+		s = _mm_unpacklo_ps(s, s);
+		__m128 d = _mm_loadu_ps(dst + i * 2);
+		_mm_storeu_ps(dst + i * 2, _mm_add_ps(d, _mm_mul_ps(s, gain)));
+		gain = _mm_add_ps(gain, step);
+	}
+	MixMonoScalar(src + i, dst + i * 2, frames - i, gl + dl * i, gr + dr * i, dl, dr);
+}
+
+SDLPP_TARGET("sse2") static void ClampF32SSE2(const float* src, float* dst, int count) {
+	__m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi));
+	ClampF32Scalar(src + i, dst + i, count - i);
+}
+
+SDLPP_TARGET("sse2") static void ToS16SSE2(const float* src, Sint16* dst, int count) {
+	__m128 scale = _mm_set1_ps(32767.0f);
+	__m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+		_mm_storeu_si128((__m128i*)(dst + i), packed);
+	}
+	ToS16Scalar(src + i, dst + i, count - i);
+}
+#endif
+
+#ifdef SDLPP_SIMD_NEON
+static void MixStereoNEON(const float* src, float* dst, int frames, float gl, float gr, float dl, float dr) {
+	float g[4] = { gl, gr, gl + dl, gr + dr };
+	float s2[4] = { dl * 2, dr * 2, dl * 2, dr * 2 };
+	float32x4_t gain = vld1q_f32(g), step = vld1q_f32(s2);
+	int i = 0;
+	for (; i + 2 <= frames; i += 2) {
+		vst1q_f32(dst + i * 2, vmlaq_f32(vld1q_f32(dst + i * 2), vld1q_f32(src + i * 2), gain));
+		gain = vaddq_f32(gain, step);
+	}
+	MixStereoScalar(src + i * 2, dst + i * 2, frames - i, gl + dl * i, gr + dr * i, dl, dr);
+}
+
+static void MixMonoNEON(const float* src, float* dst, int frames, float gl, float gr, float dl, float dr) {
+	float g[4] = { gl, gr, gl + dl, gr + dr };
+	float s2[4] = { dl * 2, dr * 2, dl * 2, dr * 2 };
+	float32x4_t gain = vld1q_f32(g), step = vld1q_f32(s2);
+	int i = 0;
+	for (; i + 2 <= frames; i += 2) {
+		float32x2_t m = vld1_f32(src + i);
+		float32x4_t s = vcombine_f32(vdup_lane_f32(m, 0), vdup_lane_f32(m, 1));
+		vst1q_f32(dst + i * 2, vmlaq_f32(vld1q_f32(dst + i * 2), s, gain));
+		gain = vaddq_f32(gain, step);
+	}
+	MixMonoScalar(src + i, dst + i * 2, frames - i, gl + dl * i, gr + dr * i, dl, dr);
+}
+
+static void ClampF32NEON(const float* src, float* dst, int count) {
+	float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) vst1q_f32(dst + i, vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi));
+	ClampF32Scalar(src + i, dst + i, count - i);
+}
+
+static void ToS16NEON(const float* src, Sint16* dst, int count) {
+	float32x4_t scale = vdupq_n_f32(32767.0f);
+	float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f);
+#ifndef __aarch64__
+	float32x4_t half = vdupq_n_f32(0.5f);
+	uint32x4_t sign = vdupq_n_u32(0x80000000u);
+#endif
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		float32x4_t a = vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i), lo), hi), scale);
+		float32x4_t b = vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(src + i + 4), lo), hi), scale);
+#ifdef __aarch64__
+		int32x4_t ia = vcvtnq_s32_f32(a), ib = vcvtnq_s32_f32(b);
+#else
+		// ARMv7 only converts toward zero, so add a half with the sample's sign first
+		int32x4_t ia = vcvtq_s32_f32(vaddq_f32(a, vbslq_f32(sign, a, half)));
+		int32x4_t ib = vcvtq_s32_f32(vaddq_f32(b, vbslq_f32(sign, b, half)));
+#endif
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+	}
+	ToS16Scalar(src + i, dst + i, count - i);
+}
+#endif
+
+namespace {
+	struct AudioKernels {
+		void (*mixStereo)(const float*, float*, int, float, float, float, float);
+		void (*mixMono)(const float*, float*, int, float, float, float, float);
+		void (*clampF32)(const float*, float*, int);
+		void (*toS16)(const float*, Sint16*, int);
+	};
+
+	const AudioKernels& Kernels() {
+		static const AudioKernels scalar = { MixStereoScalar, MixMonoScalar, ClampF32Scalar, ToS16Scalar };
+#ifdef SDLPP_SIMD_X86
+		static const AudioKernels sse2 = { MixStereoSSE2, MixMonoSSE2, ClampF32SSE2, ToS16SSE2 };
+		if (SIMD::GetLevel() != SIMD::Level::SCALAR) return sse2;
+#endif
+#ifdef SDLPP_SIMD_NEON
+		static const AudioKernels neon = { MixStereoNEON, MixMonoNEON, ClampF32NEON, ToS16NEON };
+		if (SIMD::GetLevel() == SIMD::Level::NEON) return neon;
+#endif
+		return scalar;
+	}
+
+	// Store one sample in any SDL audio format
+	void WriteSample(Uint8* out, float v, SDL_AudioFormat format) {
+		v = std::min(std::max(v, -1.0f), 1.0f);
+		int bits = SDL_AUDIO_BITSIZE(format);
+		Uint32 raw;
+		if (SDL_AUDIO_ISFLOAT(format)) memcpy(&raw, &v, 4);
+		else if (bits == 8) raw = (Uint32)(SDL_AUDIO_ISSIGNED(format) ? (Sint8)(v * 127) : (Uint8)(v * 127 + 128));
+		else if (bits == 16) raw = (Uint32)(SDL_AUDIO_ISSIGNED(format) ? (Uint16)(Sint16)(v * 32767) : (Uint16)(v * 32767 + 32768));
+		else raw = (Uint32)(Sint32)(v * 2147483520.0f);
+
+		bool big = SDL_AUDIO_ISBIGENDIAN(format) != 0;
+		for (int b = 0; b < bits / 8; b++) out[big ? bits / 8 - 1 - b : b] = (Uint8)(raw >> (b * 8));
+	}
+}
+
+AudioSpec Mixer::Desired(int rate, Uint16 samples, Mixer* mixer) {
+	AudioSpec spec;
+	SDL_zero(spec);
+	spec.freq = rate;
+	spec.format = AUDIO_F32SYS;
+	spec.channels = 2;
+	spec.samples = samples;
+	spec.callback = Callback;
+	spec.userdata = mixer;
+	return spec;
+}
+
+Mixer::Mixer(const char* deviceName, int rate, Uint16 samples, size_t commandCount)
+	: commands(commandCount),
+	device(deviceName, false, Desired(rate, samples, this), spec, SDL_AUDIO_ALLOW_ANY_CHANGE) {
+	for (auto& id : playing) id.store(0, std::memory_order_relaxed);
+	if (!Valid()) return;
+
+	// The device starts paused, so the callback cannot run before this
+	mix.resize((size_t)spec.samples * 2);
+	resampled.resize((size_t)spec.samples * 2);
+	device.Play();
+}
+
+void SDLCALL Mixer::Callback(void* userdata, Uint8* stream, int len) { ((Mixer*)userdata)->Mix(stream, len); }
+
+bool Mixer::Send(Op op, VoiceID id, float value) {
+	Command command = {};
+	command.op = op;
+	command.id = id;
+	command.gain = command.pan = command.pitch = value;
+	return commands.Push(command);
+}
+
+Mixer::VoiceID Mixer::Play(const Sound& sound, float gain, float pan, float pitch, bool loop) {
+	if (!sound.Valid()) return 0;
+
+	Command command;
+	command.op = Op::PLAY;
+	command.loop = loop;
+	command.id = nextID;
+	command.sound = &sound;
+	command.source = nullptr;
+	command.gain = gain;
+	command.pan = pan;
+	command.pitch = pitch;
+	if (!commands.Push(command)) return 0;
+
+	if (++nextID == 0) nextID = 1;
+	return command.id;
+}
+
+Mixer::VoiceID Mixer::Play(Source& source, float gain, float pan) {
+	Command command;
+	command.op = Op::PLAY;
+	command.loop = false;
+	command.id = nextID;
+	command.sound = nullptr;
+	command.source = &source;
+	command.gain = gain;
+	command.pan = pan;
+	command.pitch = 1;
+	if (!commands.Push(command)) return 0;
+
+	if (++nextID == 0) nextID = 1;
+	return command.id;
+}
+
+void Mixer::Stop(VoiceID voice) { Send(Op::STOP, voice); }
+void Mixer::SetGain(VoiceID voice, float gain) { Send(Op::GAIN, voice, gain); }
+void Mixer::SetPan(VoiceID voice, float pan) { Send(Op::PAN, voice, pan); }
+void Mixer::SetPitch(VoiceID voice, float pitch) { Send(Op::PITCH, voice, pitch); }
+void Mixer::SetPaused(VoiceID voice, bool paused) { Send(Op::PAUSE, voice, paused ? 1.0f : 0.0f); }
+void Mixer::StopAll() { Send(Op::STOP_ALL, 0); }
+void Mixer::SetMasterGain(float gain) { Send(Op::MASTER_GAIN, 0, gain); }
+
+bool Mixer::Playing(VoiceID voice) const {
+	if (voice == 0) return false;
+	// Not reached by the callback yet
+	if (voice > started.load(std::memory_order_acquire)) return true;
+	for (auto& id : playing)
+		if (id.load(std::memory_order_relaxed) == voice) return true;
+	return false;
+}
+
+int Mixer::ActiveVoices() const {
+	int count = 0;
+	for (auto& id : playing) count += id.load(std::memory_order_relaxed) != 0;
+	return count;
+}
+
+Mixer::Voice* Mixer::Find(VoiceID id) {
+	for (auto& voice : voices)
+		if (voice.id == id) return &voice;
+	return nullptr;
+}
+
+void Mixer::End(int slot) {
+	voices[slot].id = 0;
+	voices[slot].sound = nullptr;
+	voices[slot].source = nullptr;
+	playing[slot].store(0, std::memory_order_relaxed);
+}
+
+void Mixer::Run(const Command& command) {
+	// Playing backwards is not supported, and would read before the sound
+	float pitch = std::max(0.0f, command.pitch);
+
+	if (command.op == Op::PLAY) {
+		started.store(command.id, std::memory_order_release);
+
+		int slot = 0;
+		while (slot < MAX_VOICES && voices[slot].id != 0) slot++;
+		// Every voice is busy, so the sound is dropped
+		if (slot == MAX_VOICES) return;
+
+		Voice& voice = voices[slot];
+		voice = Voice();
+		voice.id = command.id;
+		voice.sound = command.sound;
+		voice.source = command.source;
+		voice.gain = command.gain;
+		voice.pan = command.pan;
+		voice.pitch = pitch;
+		voice.loop = command.loop;
+		playing[slot].store(command.id, std::memory_order_relaxed);
+		return;
+	}
+	if (command.op == Op::STOP_ALL) {
+		for (int i = 0; i < MAX_VOICES; i++) End(i);
+		return;
+	}
+	if (command.op == Op::MASTER_GAIN) {
+		masterGain = command.gain;
+		return;
+	}
+
+	Voice* voice = Find(command.id);
+	if (!voice) return;
+	switch (command.op) {
+	case Op::STOP: End((int)(voice - voices)); break;
+	case Op::GAIN: voice->gain = command.gain; break;
+	case Op::PAN: voice->pan = command.pan; break;
+	case Op::PITCH: voice->pitch = pitch; break;
+	case Op::PAUSE: voice->paused = command.gain != 0; break;
+	default: break;
+	}
+}
+
+void Mixer::MixVoice(int slot, int frames) {
+	Voice& voice = voices[slot];
+	const AudioKernels& kernels = Kernels();
+
+	// Equal power panning, ramped across the block from the last gains
+	float angle = (std::min(std::max(voice.pan, -1.0f), 1.0f) + 1) * 0.785398163f;
+	float gain = voice.gain * masterGain;
+	float left = std::cos(angle) * gain, right = std::sin(angle) * gain;
+	float dl = (left - voice.left) / frames, dr = (right - voice.right) / frames;
+	float gl = voice.left, gr = voice.right;
+	voice.left = left;
+	voice.right = right;
+
+	if (voice.source) {
+		int count = voice.source->Read(resampled.data(), frames);
+		kernels.mixStereo(resampled.data(), mix.data(), count, gl, gr, dl, dr);
+		if (count < frames && voice.source->Finished()) End(slot);
+		return;
+	}
+
+	const Sound& sound = *voice.sound;
+	auto mixKernel = sound.channels == 1 ? kernels.mixMono : kernels.mixStereo;
+
+	int length = sound.Frames();
+	int channels = sound.channels;
+	double step = (double)voice.pitch * sound.rate / spec.freq;
+	float* out = mix.data();
+
+	while (frames > 0) {
+		int count;
+		if (step == 1.0 && voice.position == std::floor(voice.position)) {
+			// Nothing to resample, so mix straight from the sound
+			int pos = (int)voice.position;
+			count = std::min(frames, length - pos);
+			mixKernel(&sound.samples[(size_t)pos * channels], out, count, gl, gr, dl, dr);
+			voice.position += count;
+		}
+		else {
+			// Linear interpolation, up to the end of the sound
+			float* dst = resampled.data();
+			double pos = voice.position;
+			for (count = 0; count < frames && pos < length; count++, pos += step) {
+				int i = (int)pos;
+				float t = (float)(pos - i);
+				int j = i + 1 < length ? i + 1 : (voice.loop ? 0 : i);
+				for (int c = 0; c < channels; c++) {
+					float a = sound.samples[(size_t)i * channels + c], b = sound.samples[(size_t)j * channels + c];
+					*dst++ = a + (b - a) * t;
+				}
+			}
+			mixKernel(resampled.data(), out, count, gl, gr, dl, dr);
+			voice.position = pos;
+		}
+
+		out += count * 2;
+		frames -= count;
+		gl += dl * count;
+		gr += dr * count;
+
+		if (voice.position >= length) {
+			if (!voice.loop || step <= 0) {
+				End(slot);
+				return;
+			}
+			voice.position = std::fmod(voice.position, (double)length);
+		}
+		if (count == 0) break;
+	}
+}
+
+void Mixer::Write(Uint8* stream, int frames) {
+	const AudioKernels& kernels = Kernels();
+	int channels = spec.channels;
+
+	if (channels == 2 && spec.format == AUDIO_F32SYS) {
+		kernels.clampF32(mix.data(), (float*)stream, frames * 2);
+		return;
+	}
+	if (channels == 2 && spec.format == AUDIO_S16SYS) {
+		kernels.toS16(mix.data(), (Sint16*)stream, frames * 2);
+		return;
+	}
+
+	int bytes = SDL_AUDIO_BITSIZE(spec.format) / 8;
+	for (int i = 0; i < frames; i++) {
+		float l = mix[i * 2], r = mix[i * 2 + 1];
+		if (channels == 1) {
+			WriteSample(stream, (l + r) * 0.5f, spec.format);
+			stream += bytes;
+			continue;
+		}
+		// Front left and right, and silence in the rest
+		for (int c = 0; c < channels; c++, stream += bytes) WriteSample(stream, c == 0 ? l : c == 1 ? r : 0.0f, spec.format);
+	}
+}
+
+void Mixer::Mix(Uint8* stream, int len) {
+	Command command;
+	while (commands.Pop(command)) Run(command);
+
+	int frameBytes = SDL_AUDIO_BITSIZE(spec.format) / 8 * spec.channels;
+	int frames = len / frameBytes;
+	int block = (int)spec.samples;
+
+	while (frames > 0) {
+		int count = std::min(frames, block);
+		std::fill(mix.begin(), mix.begin() + count * 2, 0.0f);
+
+		for (int i = 0; i < MAX_VOICES; i++)
+			if (voices[i].id != 0 && !voices[i].paused) MixVoice(i, count);
+
+		Write(stream, count);
+		stream += count * frameBytes;
+		frames -= count;
+	}
+}
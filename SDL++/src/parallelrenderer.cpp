@@ -0,0 +1,494 @@
+#include "parallelrenderer.hpp"
+#include "error.hpp"
+#include "profiler.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+using namespace SDL;
+
+namespace {
+	// Where the channels of a 32 bit pixel format sit
+	struct Channels {
+		Uint8 r, g, b, a;
+		bool alpha;
+
+		Channels(const SDL_PixelFormat* format)
+			: r(format->Rshift), g(format->Gshift), b(format->Bshift), a(format->Ashift), alpha(format->Amask != 0) {}
+
+		void Unpack(Uint32 pixel, Uint32& pr, Uint32& pg, Uint32& pb, Uint32& pa) const {
+			pr = pixel >> r & 0xFF;
+			pg = pixel >> g & 0xFF;
+			pb = pixel >> b & 0xFF;
+			pa = alpha ? pixel >> a & 0xFF : 255;
+		}
+		Uint32 Pack(Uint32 pr, Uint32 pg, Uint32 pb, Uint32 pa) const {
+			return pr << r | pg << g | pb << b | (alpha ? pa << a : 0);
+		}
+	};
+}
+
+// x * y / 255, rounded
+static inline Uint32 Mul255(Uint32 x, Uint32 y) {
+	Uint32 t = x * y + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+// Blend one source colour into a pixel, as SDL's software renderer does
+template<int Mode>
+static inline void BlendPixel(Uint32& pixel, Uint32 sr, Uint32 sg, Uint32 sb, Uint32 sa, const Channels& c) {
+	if (Mode == SDL_BLENDMODE_NONE) {
+		pixel = c.Pack(sr, sg, sb, sa);
+		return;
+	}
+
+	Uint32 dr, dg, db, da;
+	c.Unpack(pixel, dr, dg, db, da);
+	switch (Mode) {
+	case SDL_BLENDMODE_BLEND:
+		dr = Mul255(sr, sa) + Mul255(dr, 255 - sa);
+		dg = Mul255(sg, sa) + Mul255(dg, 255 - sa);
+		db = Mul255(sb, sa) + Mul255(db, 255 - sa);
+		da = sa + Mul255(da, 255 - sa);
+		break;
+	case SDL_BLENDMODE_ADD:
+		dr = std::min(Mul255(sr, sa) + dr, 255u);
+		dg = std::min(Mul255(sg, sa) + dg, 255u);
+		db = std::min(Mul255(sb, sa) + db, 255u);
+		break;
+	case SDL_BLENDMODE_MOD:
+		dr = Mul255(sr, dr);
+		dg = Mul255(sg, dg);
+		db = Mul255(sb, db);
+		break;
+	default: // SDL_BLENDMODE_MUL
+		dr = std::min(Mul255(sr, dr) + Mul255(dr, 255 - sa), 255u);
+		dg = std::min(Mul255(sg, dg) + Mul255(dg, 255 - sa), 255u);
+		db = std::min(Mul255(sb, db) + Mul255(db, 255 - sa), 255u);
+		break;
+	}
+	pixel = c.Pack(dr, dg, db, da);
+}
+
+template<int Mode>
+static void BlendSpan(Uint32* pixels, int count, const Colour& color, const Channels& c) {
+	for (int i = 0; i < count; i++) BlendPixel<Mode>(pixels[i], color.r, color.g, color.b, color.a, c);
+}
+
+// Blend a solid colour over a rectangle of the target
+static void FillArea(SDL_Surface* s, const Rect& area, const Colour& color, BlendMode mode, const Channels& c) {
+	// Modes that cannot change the pixels, and blends that simply replace them
+	if (color.a == 0 && (mode == SDL_BLENDMODE_BLEND || mode == SDL_BLENDMODE_ADD)) return;
+	if (color.a == 255 && mode == SDL_BLENDMODE_BLEND) mode = SDL_BLENDMODE_NONE;
+
+	for (int y = area.y; y < area.y + area.h; y++) {
+		Uint32* row = (Uint32*)((Uint8*)s->pixels + (size_t)y * s->pitch) + area.x;
+		switch (mode) {
+		case SDL_BLENDMODE_NONE: SIMD::Fill32(row, area.w, c.Pack(color.r, color.g, color.b, color.a)); break;
+		case SDL_BLENDMODE_BLEND: BlendSpan<SDL_BLENDMODE_BLEND>(row, area.w, color, c); break;
+		case SDL_BLENDMODE_ADD: BlendSpan<SDL_BLENDMODE_ADD>(row, area.w, color, c); break;
+		case SDL_BLENDMODE_MOD: BlendSpan<SDL_BLENDMODE_MOD>(row, area.w, color, c); break;
+		default: BlendSpan<SDL_BLENDMODE_MUL>(row, area.w, color, c); break;
+		}
+	}
+}
+
+static void PlotPixel(SDL_Surface* s, int x, int y, const Colour& color, BlendMode mode, const Channels& c) {
+	Uint32& pixel = ((Uint32*)((Uint8*)s->pixels + (size_t)y * s->pitch))[x];
+	switch (mode) {
+	case SDL_BLENDMODE_NONE: BlendPixel<SDL_BLENDMODE_NONE>(pixel, color.r, color.g, color.b, color.a, c); break;
+	case SDL_BLENDMODE_BLEND: BlendPixel<SDL_BLENDMODE_BLEND>(pixel, color.r, color.g, color.b, color.a, c); break;
+	case SDL_BLENDMODE_ADD: BlendPixel<SDL_BLENDMODE_ADD>(pixel, color.r, color.g, color.b, color.a, c); break;
+	case SDL_BLENDMODE_MOD: BlendPixel<SDL_BLENDMODE_MOD>(pixel, color.r, color.g, color.b, color.a, c); break;
+	default: BlendPixel<SDL_BLENDMODE_MUL>(pixel, color.r, color.g, color.b, color.a, c); break;
+	}
+}
+
+static inline bool Inside(const Rect& area, int x, int y) {
+	return x >= area.x && y >= area.y && x < area.x + area.w && y < area.y + area.h;
+}
+
+/*
+ *  Draw the pixels of a line that fall in an area.  The minor coordinate of
+ *  each step is worked out from the step alone, so every tile agrees on which
+ *  pixels the line covers and only the steps crossing the area are visited.
+ */
+static void DrawSegment(SDL_Surface* s, const Rect& area, const Point& a, const Point& b, bool drawEnd, const Colour& color, BlendMode mode, const Channels& c) {
+	int dx = b.x - a.x, dy = b.y - a.y;
+	int steps = std::max(std::abs(dx), std::abs(dy));
+	int last = drawEnd ? steps : steps - 1;
+	if (steps == 0) {
+		if (drawEnd && Inside(area, a.x, a.y)) PlotPixel(s, a.x, a.y, color, mode, c);
+		return;
+	}
+
+	bool xMajor = std::abs(dx) >= std::abs(dy);
+	int major = xMajor ? dx : dy, minor = xMajor ? dy : dx;
+	int step = major > 0 ? 1 : -1;
+	int start = xMajor ? a.x : a.y;
+	int lo = xMajor ? area.x : area.y, hi = lo + (xMajor ? area.w : area.h) - 1;
+
+	// The steps whose major coordinate is inside the area
+	int i0 = step > 0 ? lo - start : start - hi;
+	int i1 = step > 0 ? hi - start : start - lo;
+	i0 = std::max(i0, 0);
+	i1 = std::min(i1, last);
+
+	Sint64 twiceSteps = 2 * (Sint64)steps;
+	for (int i = i0; i <= i1; i++) {
+		Sint64 offset = (2 * (Sint64)i * std::abs(minor) + steps) / twiceSteps;
+		int m = start + i * step;
+		int n = (xMajor ? a.y : a.x) + (int)(minor < 0 ? -offset : offset);
+		int x = xMajor ? m : n, y = xMajor ? n : m;
+		if (Inside(area, x, y)) PlotPixel(s, x, y, color, mode, c);
+	}
+}
+
+template<int Mode>
+static void CopyRow(Uint32* dst, const Uint32* src, const int* columns, int count, const Colour& mod, const Channels& dc, const Channels& sc) {
+	Uint32 sr, sg, sb, sa;
+	for (int i = 0; i < count; i++) {
+		sc.Unpack(src[columns[i]], sr, sg, sb, sa);
+		BlendPixel<Mode>(dst[i], Mul255(sr, mod.r), Mul255(sg, mod.g), Mul255(sb, mod.b), Mul255(sa, mod.a), dc);
+	}
+}
+
+ParallelRenderer::ParallelRenderer(Surface& target, ThreadPool& pool, const Point& tileSize)
+	: target(target), pool(pool), tileSize(std::max(tileSize.w, 1), std::max(tileSize.h, 1)) {}
+
+ParallelRenderer& ParallelRenderer::FlushError() { error = 0; return *this; }
+
+ParallelRenderer& ParallelRenderer::SetDrawColor(const Colour& color) { this->color = color; return *this; }
+ParallelRenderer& ParallelRenderer::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) { color = { r, g, b, a }; return *this; }
+
+ParallelRenderer& ParallelRenderer::SetDrawBlendMode(const BlendMode& blendMode) {
+	switch (blendMode) {
+	case SDL_BLENDMODE_NONE:
+	case SDL_BLENDMODE_BLEND:
+	case SDL_BLENDMODE_ADD:
+	case SDL_BLENDMODE_MOD:
+	case SDL_BLENDMODE_MUL:
+		this->blendMode = blendMode;
+		break;
+	default:
+		error = SetError("ParallelRenderer: custom blend modes are not supported");
+	}
+	return *this;
+}
+
+ParallelRenderer& ParallelRenderer::SetClipRect(const Rect& rect) { clip = rect; clipEnabled = true; return *this; }
+ParallelRenderer& ParallelRenderer::DisableClip() { clipEnabled = false; return *this; }
+
+Rect ParallelRenderer::TargetRect() const {
+	return target.surface != NULL ? Rect(0, 0, target.surface->w, target.surface->h) : Rect(0, 0, 0, 0);
+}
+
+Rect ParallelRenderer::Clipped(const Rect& rect) const {
+	Rect bounds = TargetRect(), result(0, 0, 0, 0);
+	if (clipEnabled && !bounds.intersectRect(clip, bounds)) return result;
+	bounds.intersectRect(rect, result);
+	return result;
+}
+
+ParallelRenderer::Command& ParallelRenderer::Record(Op op, const Rect& bounds, size_t first, int count) {
+	commands.push_back({ op, blendMode, color, bounds, first, count });
+	return commands.back();
+}
+
+ParallelRenderer& ParallelRenderer::Clear() {
+	Rect all = TargetRect();
+	rects.push_back(all);
+	Record(Op::FILL_RECTS, all, rects.size() - 1, 1).blendMode = SDL_BLENDMODE_NONE;
+	return *this;
+}
+
+ParallelRenderer& ParallelRenderer::DrawPoint(const Point& point) { return DrawPoints(&point, 1); }
+
+ParallelRenderer& ParallelRenderer::DrawPoints(const Point* points, int count) {
+	if (count <= 0) return *this;
+	int x0 = points[0].x, y0 = points[0].y, x1 = x0, y1 = y0;
+	for (int i = 1; i < count; i++) {
+		x0 = std::min(x0, points[i].x);
+		y0 = std::min(y0, points[i].y);
+		x1 = std::max(x1, points[i].x);
+		y1 = std::max(y1, points[i].y);
+	}
+	Rect bounds = Clipped(Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1));
+	if (bounds.w <= 0 || bounds.h <= 0) return *this;
+	Record(Op::POINTS, bounds, this->points.size(), count);
+	this->points.insert(this->points.end(), points, points + count);
+	return *this;
+}
+
+ParallelRenderer& ParallelRenderer::DrawLine(const Point& a, const Point& b) {
+	Point line[2] = { a, b };
+	return DrawLines(line, 2);
+}
+
+ParallelRenderer& ParallelRenderer::DrawLines(const Point* points, int count) {
+	if (count < 2) return DrawPoints(points, count);
+	int x0 = points[0].x, y0 = points[0].y, x1 = x0, y1 = y0;
+	for (int i = 1; i < count; i++) {
+		x0 = std::min(x0, points[i].x);
+		y0 = std::min(y0, points[i].y);
+		x1 = std::max(x1, points[i].x);
+		y1 = std::max(y1, points[i].y);
+	}
+	Rect bounds = Clipped(Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1));
+	if (bounds.w <= 0 || bounds.h <= 0) return *this;
+	Record(Op::LINES, bounds, this->points.size(), count);
+	this->points.insert(this->points.end(), points, points + count);
+	return *this;
+}
+
+ParallelRenderer& ParallelRenderer::DrawRect(const Rect& rect) { return DrawRects(&rect, 1); }
+
+ParallelRenderer& ParallelRenderer::DrawRects(const Rect* rects, int count) {
+	// Outlines are four strips that do not overlap, so blended corners are drawn once
+	std::vector<Rect> strips;
+	for (int i = 0; i < count; i++) {
+		const Rect& r = rects[i];
+		if (r.w <= 0 || r.h <= 0) continue;
+		if (r.w <= 2 || r.h <= 2) {
+			strips.push_back(r);
+			continue;
+		}
+		strips.push_back(Rect(r.x, r.y, r.w, 1));
+		strips.push_back(Rect(r.x, r.y + r.h - 1, r.w, 1));
+		strips.push_back(Rect(r.x, r.y + 1, 1, r.h - 2));
+		strips.push_back(Rect(r.x + r.w - 1, r.y + 1, 1, r.h - 2));
+	}
+	return FillRects(strips.data(), (int)strips.size());
+}
+
+ParallelRenderer& ParallelRenderer::FillRect(const Rect& rect) { return FillRects(&rect, 1); }
+
+ParallelRenderer& ParallelRenderer::FillRects(const Rect* rects, int count) {
+	size_t first = this->rects.size();
+	int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+	for (int i = 0; i < count; i++) {
+		Rect r = Clipped(rects[i]);
+		if (r.w <= 0 || r.h <= 0) continue;
+		this->rects.push_back(r);
+		x0 = std::min(x0, r.x);
+		y0 = std::min(y0, r.y);
+		x1 = std::max(x1, r.x + r.w);
+		y1 = std::max(y1, r.y + r.h);
+	}
+	if (this->rects.size() > first) Record(Op::FILL_RECTS, Rect(x0, y0, x1 - x0, y1 - y0), first, (int)(this->rects.size() - first));
+	return *this;
+}
+
+ParallelRenderer& ParallelRenderer::Fill() { return FillRect(TargetRect()); }
+
+ParallelRenderer& ParallelRenderer::Copy(Surface& source, const Rect* src, const Rect* dst, Texture::Flip flipType) {
+	SDL_Surface* s = source.surface;
+	if (s == NULL) return *this;
+	if (s->format->BytesPerPixel != 4) {
+		error = SetError("ParallelRenderer: sources must be 32 bits per pixel");
+		return *this;
+	}
+
+	Rect all(0, 0, s->w, s->h), from(0, 0, 0, 0);
+	if (!all.intersectRect(src != NULL ? *src : all, from)) return *this;
+	Rect to = dst != NULL ? *dst : TargetRect();
+	Rect bounds = Clipped(to);
+	if (bounds.w <= 0 || bounds.h <= 0) return *this;
+
+	SDL_BlendMode mode = SDL_BLENDMODE_NONE;
+	Colour mod = { 255, 255, 255, 255 };
+	SDL_GetSurfaceBlendMode(s, &mode);
+	SDL_GetSurfaceColorMod(s, &mod.r, &mod.g, &mod.b);
+	SDL_GetSurfaceAlphaMod(s, &mod.a);
+	if (mode != SDL_BLENDMODE_NONE && mode != SDL_BLENDMODE_BLEND && mode != SDL_BLENDMODE_ADD && mode != SDL_BLENDMODE_MOD && mode != SDL_BLENDMODE_MUL) {
+		error = SetError("ParallelRenderer: custom blend modes are not supported");
+		return *this;
+	}
+
+	Command& command = Record(Op::COPY, bounds, 0, 0);
+	command.blendMode = mode;
+	command.color = mod;
+	command.source = s;
+	command.src = from;
+	command.dst = to;
+	command.flip = flipType;
+	return *this;
+}
+
+ParallelRenderer& ParallelRenderer::Copy(Surface& source, const Rect& src, const Rect& dst, Texture::Flip flipType) { return Copy(source, &src, &dst, flipType); }
+ParallelRenderer& ParallelRenderer::Copy(Surface& source, const Rect& dst, Texture::Flip flipType) { return Copy(source, NULL, &dst, flipType); }
+
+ParallelRenderer& ParallelRenderer::Discard() {
+	commands.clear();
+	points.clear();
+	rects.clear();
+	return *this;
+}
+
+void ParallelRenderer::Bin(Uint32 index, const Point& tiles) {
+	const Command& command = commands[index];
+	const Rect& b = command.bounds;
+	int tx0 = b.x / tileSize.w, tx1 = (b.x + b.w - 1) / tileSize.w;
+	int ty0 = b.y / tileSize.h, ty1 = (b.y + b.h - 1) / tileSize.h;
+
+	// An opaque fill hides everything before it in the tiles it covers
+	bool covers = command.op == Op::FILL_RECTS && command.count == 1 && command.blendMode == SDL_BLENDMODE_NONE;
+	Rect all = TargetRect();
+	for (int ty = ty0; ty <= ty1; ty++) {
+		for (int tx = tx0; tx <= tx1; tx++) {
+			std::vector<Uint32>& bin = bins[(size_t)ty * tiles.w + tx];
+			if (covers) {
+				Rect tile(tx * tileSize.w, ty * tileSize.h, tileSize.w, tileSize.h);
+				tile.intersectRect(all, tile);
+				if (tile.x >= b.x && tile.y >= b.y && tile.x + tile.w <= b.x + b.w && tile.y + tile.h <= b.y + b.h) bin.clear();
+			}
+			bin.push_back(index);
+		}
+	}
+}
+
+void ParallelRenderer::DrawTile(const Rect& tile, const std::vector<Uint32>& bin) const {
+	SDL_Surface* s = target.surface;
+	Channels dc(s->format);
+	std::vector<int> columns;
+	Rect area;
+
+	for (Uint32 index : bin) {
+		const Command& command = commands[index];
+		if (!tile.intersectRect(command.bounds, area)) continue;
+
+		switch (command.op) {
+		case Op::POINTS:
+			for (int i = 0; i < command.count; i++) {
+				const Point& p = points[command.first + i];
+				if (Inside(area, p.x, p.y)) PlotPixel(s, p.x, p.y, command.color, command.blendMode, dc);
+			}
+			break;
+
+		case Op::LINES: {
+			const Point* p = &points[command.first];
+			int n = command.count;
+			// A closed shape does not draw its first point twice
+			bool closed = n > 2 && p[0].x == p[n - 1].x && p[0].y == p[n - 1].y;
+			for (int i = 0; i + 1 < n; i++) DrawSegment(s, area, p[i], p[i + 1], i + 2 == n && !closed, command.color, command.blendMode, dc);
+			break;
+		}
+
+		case Op::FILL_RECTS:
+			for (int i = 0; i < command.count; i++) {
+				Rect part;
+				if (area.intersectRect(rects[command.first + i], part)) FillArea(s, part, command.color, command.blendMode, dc);
+			}
+			break;
+
+		case Op::COPY: {
+			const SDL_Surface* from = command.source;
+			const Rect& src = command.src;
+			const Rect& dst = command.dst;
+			Channels sc(from->format);
+
+			// Sample the middle of each destination pixel, in 16.16 fixed point
+			Sint64 stepX = ((Sint64)src.w << 16) / dst.w, stepY = ((Sint64)src.h << 16) / dst.h;
+			columns.resize(area.w);
+			for (int x = 0; x < area.w; x++) {
+				int column = (int)(((x + area.x - dst.x) * stepX + stepX / 2) >> 16);
+				if (command.flip & SDL_FLIP_HORIZONTAL) column = src.w - 1 - column;
+				columns[x] = src.x + std::min(std::max(column, 0), src.w - 1);
+			}
+
+			for (int y = area.y; y < area.y + area.h; y++) {
+				int row = (int)(((y - dst.y) * stepY + stepY / 2) >> 16);
+				if (command.flip & SDL_FLIP_VERTICAL) row = src.h - 1 - row;
+				row = src.y + std::min(std::max(row, 0), src.h - 1);
+
+				Uint32* out = (Uint32*)((Uint8*)s->pixels + (size_t)y * s->pitch) + area.x;
+				const Uint32* in = (const Uint32*)((const Uint8*)from->pixels + (size_t)row * from->pitch);
+				switch (command.blendMode) {
+				case SDL_BLENDMODE_NONE: CopyRow<SDL_BLENDMODE_NONE>(out, in, columns.data(), area.w, command.color, dc, sc); break;
+				case SDL_BLENDMODE_BLEND: CopyRow<SDL_BLENDMODE_BLEND>(out, in, columns.data(), area.w, command.color, dc, sc); break;
+				case SDL_BLENDMODE_ADD: CopyRow<SDL_BLENDMODE_ADD>(out, in, columns.data(), area.w, command.color, dc, sc); break;
+				case SDL_BLENDMODE_MOD: CopyRow<SDL_BLENDMODE_MOD>(out, in, columns.data(), area.w, command.color, dc, sc); break;
+				default: CopyRow<SDL_BLENDMODE_MUL>(out, in, columns.data(), area.w, command.color, dc, sc); break;
+				}
+			}
+			break;
+		}
+		}
+	}
+}
+
+int ParallelRenderer::Present() {
+	SDLPP_PROFILE_ZONE("ParallelRenderer::Present");
+	drawnTiles = 0;
+	SDL_Surface* s = target.surface;
+	if (s == NULL || s->format->BytesPerPixel != 4) {
+		Discard();
+		return error = SetError("ParallelRenderer: the target must be 32 bits per pixel");
+	}
+	if (commands.empty()) return 0;
+
+	// Decode any RLE surfaces up front, as locking is not thread safe
+	std::vector<SDL_Surface*> locked;
+	if (SDL_MUSTLOCK(s)) locked.push_back(s);
+	for (const Command& command : commands)
+		if (command.op == Op::COPY && SDL_MUSTLOCK(command.source) && std::find(locked.begin(), locked.end(), command.source) == locked.end()) locked.push_back(command.source);
+	for (SDL_Surface* surface : locked) SDL_LockSurface(surface);
+
+	Point tiles((s->w + tileSize.w - 1) / tileSize.w, (s->h + tileSize.h - 1) / tileSize.h);
+	bins.resize((size_t)tiles.w * tiles.h);
+	for (std::vector<Uint32>& bin : bins) bin.clear();
+	{
+		SDLPP_PROFILE_ZONE("ParallelRenderer::Bin");
+		for (Uint32 i = 0; i < (Uint32)commands.size(); i++) {
+			Bin(i, tiles);
+			target.MarkDirty(&commands[i].bounds.rect);
+		}
+	}
+
+	// Shared with the helpers, so one the pool only starts after every tile is
+	// drawn finds nothing left, and touches nothing but this
+	struct Tiles {
+		std::vector<Uint32> work;
+		std::atomic<size_t> next{ 0 };
+		size_t done = 0;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	std::shared_ptr<Tiles> shared = std::make_shared<Tiles>();
+	std::vector<Uint32>& work = shared->work;
+	for (Uint32 i = 0; i < (Uint32)bins.size(); i++)
+		if (!bins[i].empty()) work.push_back(i);
+	drawnTiles = (int)work.size();
+
+	auto drain = [this, shared, tiles, s]() {
+		size_t drawn = 0;
+		for (size_t i; (i = shared->next++) < shared->work.size(); drawn++) {
+			Uint32 t = shared->work[i];
+			int tx = (int)(t % tiles.w), ty = (int)(t / tiles.w);
+			Rect tile(tx * tileSize.w, ty * tileSize.h, std::min(tileSize.w, s->w - tx * tileSize.w), std::min(tileSize.h, s->h - ty * tileSize.h));
+			DrawTile(tile, bins[t]);
+		}
+		if (drawn == 0) return;
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		shared->done += drawn;
+		if (shared->done == shared->work.size()) shared->finished.notify_all();
+	};
+
+	size_t count = work.empty() ? 0 : std::min(pool.Size(), work.size() - 1);
+	for (size_t i = 0; i < count; i++) pool.Push(drain);
+	drain();
+	// Only tiles a helper has taken are waited on, never a helper still queued
+	{
+		std::unique_lock<std::mutex> lock(shared->mutex);
+		shared->finished.wait(lock, [&]() { return shared->done == work.size(); });
+	}
+
+	for (SDL_Surface* surface : locked) SDL_UnlockSurface(surface);
+	Discard();
+	return 0;
+}
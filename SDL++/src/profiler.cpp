@@ -0,0 +1,212 @@
+#include "profiler.hpp"
+#include <memory>
+#include <mutex>
+#include <SDL_rwops.h>
+#include "error.hpp"
+
+using namespace SDL;
+using namespace SDL::Profiler;
+
+namespace {
+	// Written only by its thread; drained under State::mutex
+	struct Ring {
+		std::atomic<Uint32> head{ 0 };
+		std::atomic<Uint32> tail{ 0 };
+		std::atomic<Uint32> dropped{ 0 };
+		Uint32 thread = 0;
+		const char* name = NULL;
+		Sample samples[RING_SIZE];
+	};
+
+	struct State {
+		std::mutex mutex;
+		// Rings are kept after their thread exits so its zones can still be drained
+		std::vector<std::unique_ptr<Ring>> rings;
+
+		std::atomic<Uint32> drawCalls{ 0 };
+		std::atomic<Uint32> textureSwitches{ 0 };
+		std::atomic<Uint64> bytesUploaded{ 0 };
+
+		Uint64 frameStart = 0;
+		Frame lastFrame;
+
+		bool capturing = false;
+		Uint64 captureStart = 0;
+		std::vector<Sample> samples;
+		std::vector<Frame> frames;
+	};
+
+	// Never destroyed, so threads still running at exit can record safely
+	State& GetState() {
+		static State* state = new State;
+		return *state;
+	}
+
+	thread_local Ring* threadRing = NULL;
+	thread_local const void* lastTexture = NULL;
+
+	Ring& GetRing() {
+		if (threadRing) return *threadRing;
+
+		State& state = GetState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		state.rings.emplace_back(new Ring);
+		threadRing = state.rings.back().get();
+		threadRing->thread = (Uint32)state.rings.size();
+		return *threadRing;
+	}
+
+	void AppendString(std::string& out, const char* s) {
+		out += '"';
+		for (; *s; s++) {
+			char c = *s;
+			if (c == '"' || c == '\\') {
+				out += '\\';
+				out += c;
+			}
+			else if ((unsigned char)c < 0x20) out += ' ';
+			else out += c;
+		}
+		out += '"';
+	}
+
+	void AppendEvent(std::string& out, const char* name, const char* phase, double ts, Uint32 thread) {
+		char buffer[64];
+		out += out.back() == '[' ? "\n{\"name\":" : ",\n{\"name\":";
+		AppendString(out, name);
+		SDL_snprintf(buffer, sizeof(buffer), ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u", phase, ts, (unsigned)thread);
+		out += buffer;
+	}
+}
+
+double Frame::Milliseconds() const { return (end - start) * 1000.0 / SDL_GetPerformanceFrequency(); }
+
+void Profiler::Record(const char* name, Uint64 start, Uint64 end) {
+	Ring& ring = GetRing();
+	Uint32 head = ring.head.load(std::memory_order_relaxed);
+	if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	ring.samples[head & (RING_SIZE - 1)] = { name, start, end, ring.thread };
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::CountDraw(const void* texture) {
+	State& state = GetState();
+	state.drawCalls.fetch_add(1, std::memory_order_relaxed);
+	if (texture != lastTexture) {
+		state.textureSwitches.fetch_add(1, std::memory_order_relaxed);
+		lastTexture = texture;
+	}
+}
+
+void Profiler::CountUpload(Uint64 bytes) { GetState().bytesUploaded.fetch_add(bytes, std::memory_order_relaxed); }
+
+void Profiler::SetThreadName(const char* name) { GetRing().name = name; }
+
+void Profiler::EndFrame() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	Frame frame;
+	frame.start = state.frameStart ? state.frameStart : now;
+	frame.end = now;
+	frame.counters.drawCalls = state.drawCalls.exchange(0, std::memory_order_relaxed);
+	frame.counters.textureSwitches = state.textureSwitches.exchange(0, std::memory_order_relaxed);
+	frame.counters.bytesUploaded = state.bytesUploaded.exchange(0, std::memory_order_relaxed);
+
+	for (auto& ring : state.rings) {
+		Uint32 tail = ring->tail.load(std::memory_order_relaxed);
+		Uint32 head = ring->head.load(std::memory_order_acquire);
+		if (state.capturing)
+			for (; tail != head; tail++) state.samples.push_back(ring->samples[tail & (RING_SIZE - 1)]);
+		ring->tail.store(head, std::memory_order_release);
+		frame.counters.dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+	}
+
+	if (state.capturing) state.frames.push_back(frame);
+	state.lastFrame = frame;
+	state.frameStart = now;
+}
+
+Frame Profiler::LastFrame() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	return state.lastFrame;
+}
+
+void Profiler::BeginCapture() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.samples.clear();
+	state.frames.clear();
+	state.capturing = true;
+	state.captureStart = SDL_GetPerformanceCounter();
+}
+
+void Profiler::EndCapture() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.capturing = false;
+}
+
+bool Profiler::Capturing() {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	return state.capturing;
+}
+
+// Only safe to read while no capture is running
+const std::vector<Sample>& Profiler::CapturedSamples() { return GetState().samples; }
+const std::vector<Frame>& Profiler::CapturedFrames() { return GetState().frames; }
+
+int Profiler::WriteChromeTrace(const std::string& file) {
+	State& state = GetState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	double scale = 1000000.0 / SDL_GetPerformanceFrequency();
+	Uint64 origin = state.captureStart;
+	auto Micros = [=](Uint64 t) { return t > origin ? (t - origin) * scale : 0.0; };
+	char buffer[160];
+
+	std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	// Frames and their counters go on their own track, numbered 0
+	AppendEvent(out, "thread_name", "M", 0, 0);
+	out += ",\"args\":{\"name\":\"Frames\"}}";
+	for (auto& ring : state.rings) {
+		if (!ring->name) continue;
+		AppendEvent(out, "thread_name", "M", 0, ring->thread);
+		out += ",\"args\":{\"name\":";
+		AppendString(out, ring->name);
+		out += "}}";
+	}
+
+	for (auto& frame : state.frames) {
+		AppendEvent(out, "Frame", "X", Micros(frame.start), 0);
+		SDL_snprintf(buffer, sizeof(buffer), ",\"dur\":%.3f}", (frame.end - frame.start) * scale);
+		out += buffer;
+
+		const Counters& c = frame.counters;
+		AppendEvent(out, "Counters", "C", Micros(frame.end), 0);
+		SDL_snprintf(buffer, sizeof(buffer), ",\"args\":{\"drawCalls\":%u,\"textureSwitches\":%u,\"bytesUploaded\":%llu,\"dropped\":%u}}",
+			(unsigned)c.drawCalls, (unsigned)c.textureSwitches, (unsigned long long)c.bytesUploaded, (unsigned)c.dropped);
+		out += buffer;
+	}
+
+	for (auto& sample : state.samples) {
+		AppendEvent(out, sample.name, "X", Micros(sample.start), sample.thread);
+		SDL_snprintf(buffer, sizeof(buffer), ",\"dur\":%.3f}", (sample.end - sample.start) * scale);
+		out += buffer;
+	}
+	out += "\n]}\n";
+
+	SDL_RWops* rw = SDL_RWFromFile(file.c_str(), "wb");
+	if (rw == NULL) return -1;
+	size_t written = SDL_RWwrite(rw, out.data(), 1, out.size());
+	if (SDL_RWclose(rw) != 0 || written != out.size()) return SetError("Could not write trace to %s", file.c_str());
+	return 0;
+}
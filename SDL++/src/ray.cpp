@@ -1,129 +1,304 @@
 #include "ray.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
 
-using namespace SDL;
+#if defined(SDLPP_SIMD_X86)
+#include <immintrin.h>
+#elif defined(SDLPP_SIMD_NEON)
+#include <arm_neon.h>
+#endif
 
-Ray::Ray() : origin(), dir() {}
-Ray::Ray(FPoint origin, FPoint dir) : origin(origin), dir(dir) {}
+using namespace SDL;
 
-Ray::operator std::string() const { return "(" + (std::string)origin + " -> " + (std::string)dir + ")"; }
+/*
+ *  Every intersection test, scalar or vector, follows this definition of a contact.
+ *
+ *  The ray hits if it overlaps the rectangle's slab on both axes before the end of the
+ *  ray, and the rectangle overlaps the ray's bounding box.  An axis the ray does not
+ *  move along only needs the origin to be strictly inside the slab.  The normal faces
+ *  back along the axis whose slab was entered last, or both on a corner.
+ *
+ *  Returns the time of the contact, or INFINITY if there is none.
+ */
+static inline float Contact(float ox, float oy, float dx, float dy, float rx, float ry, float rw, float rh, float& nx, float& ny) {
+	nx = ny = 0;
+	if (dx == 0 && dy == 0) return INFINITY;
+
+	float nearT[2], ok[2];
+	float farT[2];
+	const float o[2] = { ox, oy }, d[2] = { dx, dy }, lo[2] = { rx, ry }, size[2] = { rw, rh };
+	for (int i = 0; i < 2; i++) {
+		float hi = lo[i] + size[i];
+		float end = o[i] + d[i];
+		bool broad = lo[i] < std::max(o[i], end) && hi > std::min(o[i], end);
+		if (d[i] == 0) {
+			nearT[i] = -INFINITY;
+			farT[i] = INFINITY;
+			ok[i] = broad && lo[i] < o[i] && o[i] < hi;
+		}
+		else {
+			float inv = 1.0f / d[i];
+			float t0 = (lo[i] - o[i]) * inv, t1 = (hi - o[i]) * inv;
+			nearT[i] = std::min(t0, t1);
+			farT[i] = std::max(t0, t1);
+			ok[i] = broad;
+		}
+	}
 
-bool Ray::intersectRect(const Rect& rect) {
-	hit.contact = false;
+	float time = std::max(nearT[0], nearT[1]);
+	if (!ok[0] || !ok[1] || time > std::min(farT[0], farT[1]) || time > 1) return INFINITY;
+	if (nearT[0] >= nearT[1]) nx = dx < 0 ? 1.0f : -1.0f;
+	if (nearT[0] <= nearT[1]) ny = dy < 0 ? 1.0f : -1.0f;
+	return time;
+}
 
-	// Broad collision check
-	if (!rect.intersectsRect({ FPoint::min(origin, origin + dir), dir.abs() })) return false;
+namespace {
+	// The inputs of a batch; a stride of 0 repeats the first element for every lane
+	struct Batch {
+		const float* ox, * oy, * dx, * dy;
+		int rayStride;
+		const float* rx, * ry, * rw, * rh;
+		int rectStride;
+		int count;
+		// Outputs; the normals may be NULL
+		float* times, * nx, * ny;
+	};
+}
 
-	if (dir.x == 0 && dir.y == 0) return false; // No ray
-	if (dir.y == 0) { // Horizontal
-		float invX = 1.0 / dir.x;
-		float nearX = (rect.pos.x - origin.x) * invX;
-		float farX = (rect.pos.x + rect.size.x - origin.x) * invX;
-		float time = std::min(nearX, farX);
-
-		hit = {
-			true,
-			origin + time * dir,
-			dir.x < 0 ? FPoint(1,0) : FPoint(-1,0),
-			time,
-		};
-
-		return true;
-	}
-	if (dir.x == 0) { // Vertical
-		float invY = 1.0 / dir.y;
-		float nearY = (rect.pos.y - origin.y) * invY;
-		float farY = (rect.pos.y + rect.size.y - origin.y) * invY;
-		float time = std::min(nearY, farY);
-
-		hit = {
-			true,
-			origin + time * dir,
-			dir.x < 0 ? FPoint(0,1) : FPoint(0,-1),
-			time,
-		};
-
-		return true;
+static void ContactScalar(const Batch& b, int start) {
+	for (int i = start; i < b.count; i++) {
+		int r = i * b.rayStride, q = i * b.rectStride;
+		float nx, ny;
+		b.times[i] = Contact(b.ox[r], b.oy[r], b.dx[r], b.dy[r], b.rx[q], b.ry[q], b.rw[q], b.rh[q], nx, ny);
+		if (b.nx != NULL) {
+			b.nx[i] = nx;
+			b.ny[i] = ny;
+		}
 	}
+}
 
-	FPoint invDir = 1.0f / dir;
+#ifdef SDLPP_SIMD_X86
 
-	// Normalised proportion of ray
-	FPoint nearNorm = (rect.pos - origin) * invDir;
-	FPoint farNorm = (rect.pos + rect.size - origin) * invDir;
+SDLPP_TARGET("sse2") static inline __m128 SelectSSE2(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+SDLPP_TARGET("sse2") static inline __m128 LoadSSE2(const float* p, int i, int stride) { return stride ? _mm_loadu_ps(p + i) : _mm_set1_ps(*p); }
 
-	if (nearNorm.x > farNorm.x) std::swap(nearNorm.x, farNorm.x);
-	if (nearNorm.y > farNorm.y) std::swap(nearNorm.y, farNorm.y);
+SDLPP_TARGET("sse2") static inline void AxisSSE2(__m128 o, __m128 d, __m128 lo, __m128 size, __m128& nearT, __m128& farT, __m128& ok) {
+	const __m128 zero = _mm_setzero_ps();
+	__m128 hi = _mm_add_ps(lo, size);
+	__m128 end = _mm_add_ps(o, d);
+	__m128 broad = _mm_and_ps(_mm_cmplt_ps(lo, _mm_max_ps(o, end)), _mm_cmpgt_ps(hi, _mm_min_ps(o, end)));
+	__m128 flat = _mm_cmpeq_ps(d, zero);
+	__m128 inside = _mm_and_ps(_mm_cmplt_ps(lo, o), _mm_cmplt_ps(o, hi));
 
-	if (nearNorm.x > farNorm.y || nearNorm.y > farNorm.x || nearNorm.max() > 1) return false;
+	__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), d);
+	__m128 t0 = _mm_mul_ps(_mm_sub_ps(lo, o), inv), t1 = _mm_mul_ps(_mm_sub_ps(hi, o), inv);
+	nearT = SelectSSE2(flat, _mm_set1_ps(-INFINITY), _mm_min_ps(t0, t1));
+	farT = SelectSSE2(flat, _mm_set1_ps(INFINITY), _mm_max_ps(t0, t1));
+	ok = _mm_and_ps(broad, _mm_or_ps(_mm_cmpneq_ps(d, zero), inside));
+}
 
-	hit.contact = true;
-	hit.time = nearNorm.max();
-	hit.point = origin + hit.time * dir;
+SDLPP_TARGET("sse2") static void ContactSSE2(const Batch& b) {
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), minusOne = _mm_set1_ps(-1.0f);
+	int i = 0;
+	for (; i + 4 <= b.count; i += 4) {
+		__m128 ox = LoadSSE2(b.ox, i, b.rayStride), oy = LoadSSE2(b.oy, i, b.rayStride);
+		__m128 dx = LoadSSE2(b.dx, i, b.rayStride), dy = LoadSSE2(b.dy, i, b.rayStride);
+		__m128 nearX, farX, okX, nearY, farY, okY;
+		AxisSSE2(ox, dx, LoadSSE2(b.rx, i, b.rectStride), LoadSSE2(b.rw, i, b.rectStride), nearX, farX, okX);
+		AxisSSE2(oy, dy, LoadSSE2(b.ry, i, b.rectStride), LoadSSE2(b.rh, i, b.rectStride), nearY, farY, okY);
+
+		__m128 time = _mm_max_ps(nearX, nearY);
+		__m128 moving = _mm_or_ps(_mm_cmpneq_ps(dx, zero), _mm_cmpneq_ps(dy, zero));
+		__m128 hit = _mm_and_ps(_mm_and_ps(okX, okY), moving);
+		hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(time, _mm_min_ps(farX, farY)), _mm_cmple_ps(time, one)));
+		_mm_storeu_ps(b.times + i, SelectSSE2(hit, time, _mm_set1_ps(INFINITY)));
+
+		if (b.nx != NULL) {
+			__m128 sx = SelectSSE2(_mm_cmplt_ps(dx, zero), one, minusOne);
+			__m128 sy = SelectSSE2(_mm_cmplt_ps(dy, zero), one, minusOne);
+			_mm_storeu_ps(b.nx + i, _mm_and_ps(_mm_and_ps(hit, _mm_cmpge_ps(nearX, nearY)), sx));
+			_mm_storeu_ps(b.ny + i, _mm_and_ps(_mm_and_ps(hit, _mm_cmple_ps(nearX, nearY)), sy));
+		}
+	}
+	ContactScalar(b, i);
+}
 
-	hit.normal = { 0, 0 };
-	if (nearNorm.x >= nearNorm.y) hit.normal.x = dir.x < 0 ? 1 : -1;
-	if (nearNorm.x <= nearNorm.y) hit.normal.y = dir.y < 0 ? 1 : -1;
+SDLPP_TARGET("avx") static inline __m256 LoadAVX(const float* p, int i, int stride) { return stride ? _mm256_loadu_ps(p + i) : _mm256_set1_ps(*p); }
+
+SDLPP_TARGET("avx") static inline void AxisAVX(__m256 o, __m256 d, __m256 lo, __m256 size, __m256& nearT, __m256& farT, __m256& ok) {
+	const __m256 zero = _mm256_setzero_ps();
+	__m256 hi = _mm256_add_ps(lo, size);
+	__m256 end = _mm256_add_ps(o, d);
+	__m256 broad = _mm256_and_ps(_mm256_cmp_ps(lo, _mm256_max_ps(o, end), _CMP_LT_OQ), _mm256_cmp_ps(hi, _mm256_min_ps(o, end), _CMP_GT_OQ));
+	__m256 flat = _mm256_cmp_ps(d, zero, _CMP_EQ_OQ);
+	__m256 inside = _mm256_and_ps(_mm256_cmp_ps(lo, o, _CMP_LT_OQ), _mm256_cmp_ps(o, hi, _CMP_LT_OQ));
+
+	__m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), d);
+	__m256 t0 = _mm256_mul_ps(_mm256_sub_ps(lo, o), inv), t1 = _mm256_mul_ps(_mm256_sub_ps(hi, o), inv);
+	nearT = _mm256_blendv_ps(_mm256_min_ps(t0, t1), _mm256_set1_ps(-INFINITY), flat);
+	farT = _mm256_blendv_ps(_mm256_max_ps(t0, t1), _mm256_set1_ps(INFINITY), flat);
+	ok = _mm256_and_ps(broad, _mm256_or_ps(_mm256_cmp_ps(d, zero, _CMP_NEQ_UQ), inside));
+}
 
-	return true;
+SDLPP_TARGET("avx") static void ContactAVX(const Batch& b) {
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), minusOne = _mm256_set1_ps(-1.0f);
+	int i = 0;
+	for (; i + 8 <= b.count; i += 8) {
+		__m256 ox = LoadAVX(b.ox, i, b.rayStride), oy = LoadAVX(b.oy, i, b.rayStride);
+		__m256 dx = LoadAVX(b.dx, i, b.rayStride), dy = LoadAVX(b.dy, i, b.rayStride);
+		__m256 nearX, farX, okX, nearY, farY, okY;
+		AxisAVX(ox, dx, LoadAVX(b.rx, i, b.rectStride), LoadAVX(b.rw, i, b.rectStride), nearX, farX, okX);
+		AxisAVX(oy, dy, LoadAVX(b.ry, i, b.rectStride), LoadAVX(b.rh, i, b.rectStride), nearY, farY, okY);
+
+		__m256 time = _mm256_max_ps(nearX, nearY);
+		__m256 moving = _mm256_or_ps(_mm256_cmp_ps(dx, zero, _CMP_NEQ_UQ), _mm256_cmp_ps(dy, zero, _CMP_NEQ_UQ));
+		__m256 hit = _mm256_and_ps(_mm256_and_ps(okX, okY), moving);
+		hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(time, _mm256_min_ps(farX, farY), _CMP_LE_OQ), _mm256_cmp_ps(time, one, _CMP_LE_OQ)));
+		_mm256_storeu_ps(b.times + i, _mm256_blendv_ps(_mm256_set1_ps(INFINITY), time, hit));
+
+		if (b.nx != NULL) {
+			__m256 sx = _mm256_blendv_ps(minusOne, one, _mm256_cmp_ps(dx, zero, _CMP_LT_OQ));
+			__m256 sy = _mm256_blendv_ps(minusOne, one, _mm256_cmp_ps(dy, zero, _CMP_LT_OQ));
+			_mm256_storeu_ps(b.nx + i, _mm256_and_ps(_mm256_and_ps(hit, _mm256_cmp_ps(nearX, nearY, _CMP_GE_OQ)), sx));
+			_mm256_storeu_ps(b.ny + i, _mm256_and_ps(_mm256_and_ps(hit, _mm256_cmp_ps(nearX, nearY, _CMP_LE_OQ)), sy));
+		}
+	}
+	ContactSSE2(Batch{ b.ox + i * b.rayStride, b.oy + i * b.rayStride, b.dx + i * b.rayStride, b.dy + i * b.rayStride, b.rayStride,
+		b.rx + i * b.rectStride, b.ry + i * b.rectStride, b.rw + i * b.rectStride, b.rh + i * b.rectStride, b.rectStride,
+		b.count - i, b.times + i, b.nx != NULL ? b.nx + i : NULL, b.ny != NULL ? b.ny + i : NULL });
 }
-bool Ray::intersectRect(const FRect& rect) {
-	hit.contact = false;
 
-	// Broad collision check
-	if (!rect.intersectsRect(FRect(FPoint::min(origin, origin + dir), dir.abs()))) return false;
+#endif
 
-	if (dir.x == 0 && dir.y == 0) return false; // No ray
-	if (dir.y == 0) { // Horizontal
-		float invX = 1.0 / dir.x;
-		float nearX = (rect.pos.x - origin.x) * invX;
-		float farX = (rect.pos.x + rect.size.x - origin.x) * invX;
-		float time = std::min(nearX, farX);
-
-		hit = {
-			true,
-			origin + time * dir,
-			dir.x < 0 ? FPoint(1,0) : FPoint(-1,0),
-			time,
-		};
-
-		return true;
+#if defined(SDLPP_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+
+static inline float32x4_t LoadNEON(const float* p, int i, int stride) { return stride ? vld1q_f32(p + i) : vdupq_n_f32(*p); }
+
+static inline void AxisNEON(float32x4_t o, float32x4_t d, float32x4_t lo, float32x4_t size, float32x4_t& nearT, float32x4_t& farT, uint32x4_t& ok) {
+	const float32x4_t zero = vdupq_n_f32(0);
+	float32x4_t hi = vaddq_f32(lo, size);
+	float32x4_t end = vaddq_f32(o, d);
+	uint32x4_t broad = vandq_u32(vcltq_f32(lo, vmaxq_f32(o, end)), vcgtq_f32(hi, vminq_f32(o, end)));
+	uint32x4_t flat = vceqq_f32(d, zero);
+	uint32x4_t inside = vandq_u32(vcltq_f32(lo, o), vcltq_f32(o, hi));
+
+	float32x4_t inv = vdivq_f32(vdupq_n_f32(1.0f), d);
+	float32x4_t t0 = vmulq_f32(vsubq_f32(lo, o), inv), t1 = vmulq_f32(vsubq_f32(hi, o), inv);
+	nearT = vbslq_f32(flat, vdupq_n_f32(-INFINITY), vminq_f32(t0, t1));
+	farT = vbslq_f32(flat, vdupq_n_f32(INFINITY), vmaxq_f32(t0, t1));
+	ok = vandq_u32(broad, vorrq_u32(vmvnq_u32(flat), inside));
+}
+
+static void ContactNEON(const Batch& b) {
+	const float32x4_t zero = vdupq_n_f32(0), one = vdupq_n_f32(1.0f), minusOne = vdupq_n_f32(-1.0f);
+	int i = 0;
+	for (; i + 4 <= b.count; i += 4) {
+		float32x4_t ox = LoadNEON(b.ox, i, b.rayStride), oy = LoadNEON(b.oy, i, b.rayStride);
+		float32x4_t dx = LoadNEON(b.dx, i, b.rayStride), dy = LoadNEON(b.dy, i, b.rayStride);
+		float32x4_t nearX, farX, nearY, farY;
+		uint32x4_t okX, okY;
+		AxisNEON(ox, dx, LoadNEON(b.rx, i, b.rectStride), LoadNEON(b.rw, i, b.rectStride), nearX, farX, okX);
+		AxisNEON(oy, dy, LoadNEON(b.ry, i, b.rectStride), LoadNEON(b.rh, i, b.rectStride), nearY, farY, okY);
+
+		float32x4_t time = vmaxq_f32(nearX, nearY);
+		uint32x4_t moving = vmvnq_u32(vandq_u32(vceqq_f32(dx, zero), vceqq_f32(dy, zero)));
+		uint32x4_t hit = vandq_u32(vandq_u32(okX, okY), moving);
+		hit = vandq_u32(hit, vandq_u32(vcleq_f32(time, vminq_f32(farX, farY)), vcleq_f32(time, one)));
+		vst1q_f32(b.times + i, vbslq_f32(hit, time, vdupq_n_f32(INFINITY)));
+
+		if (b.nx != NULL) {
+			float32x4_t sx = vbslq_f32(vcltq_f32(dx, zero), one, minusOne);
+			float32x4_t sy = vbslq_f32(vcltq_f32(dy, zero), one, minusOne);
+			vst1q_f32(b.nx + i, vbslq_f32(vandq_u32(hit, vcgeq_f32(nearX, nearY)), sx, zero));
+			vst1q_f32(b.ny + i, vbslq_f32(vandq_u32(hit, vcleq_f32(nearX, nearY)), sy, zero));
+		}
 	}
-	if (dir.x == 0) { // Vertical
-		float invY = 1.0 / dir.y;
-		float nearY = (rect.pos.y - origin.y) * invY;
-		float farY = (rect.pos.y + rect.size.y - origin.y) * invY;
-		float time = std::min(nearY, farY);
-
-		hit = {
-			true,
-			origin + time * dir,
-			dir.x < 0 ? FPoint(0,1) : FPoint(0,-1),
-			time,
-		};
-
-		return true;
+	ContactScalar(b, i);
+}
+
+#endif
+
+static void RunBatch(const Batch& b) {
+	switch (SIMD::GetLevel()) {
+#ifdef SDLPP_SIMD_X86
+	case SIMD::Level::AVX2: ContactAVX(b); return;
+	case SIMD::Level::SSE41:
+	case SIMD::Level::SSE2: ContactSSE2(b); return;
+#endif
+#if defined(SDLPP_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+	case SIMD::Level::NEON: ContactNEON(b); return;
+#endif
+	default: ContactScalar(b, 0); return;
 	}
+}
 
-	FPoint invDir = 1.0f / dir;
+// Runs a batch in chunks small enough for the stack, turning times and normals into contacts
+static int RunBatch(Batch b, RayContact* contacts) {
+	const int chunk = 256;
+	float times[chunk], nx[chunk], ny[chunk];
+	int total = b.count, hits = 0;
+	for (int start = 0; start < total; start += chunk) {
+		Batch part = b;
+		part.ox += start * b.rayStride; part.oy += start * b.rayStride;
+		part.dx += start * b.rayStride; part.dy += start * b.rayStride;
+		part.rx += start * b.rectStride; part.ry += start * b.rectStride;
+		part.rw += start * b.rectStride; part.rh += start * b.rectStride;
+		part.count = std::min(chunk, total - start);
+		part.times = times;
+		part.nx = nx;
+		part.ny = ny;
+		RunBatch(part);
+
+		for (int i = 0; i < part.count; i++) {
+			RayContact& contact = contacts[start + i];
+			if (times[i] == INFINITY) {
+				contact = RayContact();
+				continue;
+			}
+			int r = i * b.rayStride;
+			FPoint origin(part.ox[r], part.oy[r]), dir(part.dx[r], part.dy[r]);
+			contact = { true, origin + times[i] * dir, FPoint(nx[i], ny[i]), times[i] };
+			hits++;
+		}
+	}
+	return hits;
+}
 
-	// Normalised proportion of ray
-	FPoint nearNorm = (rect.pos - origin) * invDir;
-	FPoint farNorm = (rect.pos + rect.size - origin) * invDir;
+static int CountHits(const float* times, int count) {
+	int hits = 0;
+	for (int i = 0; i < count; i++) hits += times[i] != INFINITY;
+	return hits;
+}
 
-	if (nearNorm.x > farNorm.x) std::swap(nearNorm.x, farNorm.x);
-	if (nearNorm.y > farNorm.y) std::swap(nearNorm.y, farNorm.y);
+void RayArray::push_back(const Ray& ray) {
+	originX.push_back(ray.origin.x);
+	originY.push_back(ray.origin.y);
+	dirX.push_back(ray.dir.x);
+	dirY.push_back(ray.dir.y);
+}
 
-	if (nearNorm.x > farNorm.y || nearNorm.y > farNorm.x || nearNorm.max() > 1) return false;
+Ray::Ray() : origin(), dir() {}
+Ray::Ray(FPoint origin, FPoint dir) : origin(origin), dir(dir) {}
 
-	hit.contact = true;
-	hit.time = nearNorm.max();
-	hit.point = origin + hit.time * dir;
+Ray::operator std::string() const { return "(" + (std::string)origin + " -> " + (std::string)dir + ")"; }
+int Ray::Format(char* buffer, size_t size) const { return SDL_snprintf(buffer, size, "((%f, %f) -> (%f, %f))", (double)origin.x, (double)origin.y, (double)dir.x, (double)dir.y); }
 
-	hit.normal = { 0, 0 };
-	if (nearNorm.x >= nearNorm.y) hit.normal.x = dir.x < 0 ? 1 : -1;
-	if (nearNorm.x <= nearNorm.y) hit.normal.y = dir.y < 0 ? 1 : -1;
+bool Ray::intersectRect(const Rect& rect) {
+	hit = intersect(rect);
+	return hit.contact;
+}
+bool Ray::intersectRect(const FRect& rect) {
+	hit = intersect(rect);
+	return hit.contact;
+}
 
-	return true;
+RayContact Ray::intersect(const Rect& rect) const { return intersect((FRect)rect); }
+RayContact Ray::intersect(const FRect& rect) const {
+	FPoint normal;
+	float time = Contact(origin.x, origin.y, dir.x, dir.y, rect.x, rect.y, rect.w, rect.h, normal.x, normal.y);
+	if (time == INFINITY) return RayContact();
+	return { true, origin + time * dir, normal, time };
 }
 
 bool Ray::intersectsRect(const Rect& rect) const {
@@ -163,4 +338,42 @@ bool Ray::intersectsRect(const FRect& rect) const {
 	return nearNorm.x < farNorm.y&& nearNorm.y > farNorm.x && nearNorm.max() <= 1;
 }
 
-static std::ostream& operator<<(std::ostream& os, const Ray& r) { return os << (std::string)r; }
\ No newline at end of file
+int Ray::intersectRects(const FRectArray& rects, RayContact* contacts) const {
+	Batch b = { &origin.x, &origin.y, &dir.x, &dir.y, 0, rects.x.data(), rects.y.data(), rects.w.data(), rects.h.data(), 1, (int)rects.size(), NULL, NULL, NULL };
+	return RunBatch(b, contacts);
+}
+int Ray::intersectRects(const FRectArray& rects, float* times) const {
+	Batch b = { &origin.x, &origin.y, &dir.x, &dir.y, 0, rects.x.data(), rects.y.data(), rects.w.data(), rects.h.data(), 1, (int)rects.size(), times, NULL, NULL };
+	RunBatch(b);
+	return CountHits(times, b.count);
+}
+int Ray::nearestRect(const FRectArray& rects, RayContact& contact) const {
+	const int chunk = 256;
+	float times[chunk];
+	int nearest = -1;
+	float best = INFINITY;
+	for (int start = 0; start < (int)rects.size(); start += chunk) {
+		Batch b = { &origin.x, &origin.y, &dir.x, &dir.y, 0, rects.x.data() + start, rects.y.data() + start, rects.w.data() + start, rects.h.data() + start, 1,
+			std::min(chunk, (int)rects.size() - start), times, NULL, NULL };
+		RunBatch(b);
+		for (int i = 0; i < b.count; i++)
+			if (times[i] < best) {
+				best = times[i];
+				nearest = start + i;
+			}
+	}
+	contact = nearest == -1 ? RayContact() : intersect(rects[nearest]);
+	return nearest;
+}
+
+int Ray::intersectRays(const RayArray& rays, const FRect& rect, RayContact* contacts) {
+	Batch b = { rays.originX.data(), rays.originY.data(), rays.dirX.data(), rays.dirY.data(), 1, &rect.x, &rect.y, &rect.w, &rect.h, 0, (int)rays.size(), NULL, NULL, NULL };
+	return RunBatch(b, contacts);
+}
+int Ray::intersectRays(const RayArray& rays, const FRect& rect, float* times) {
+	Batch b = { rays.originX.data(), rays.originY.data(), rays.dirX.data(), rays.dirY.data(), 1, &rect.x, &rect.y, &rect.w, &rect.h, 0, (int)rays.size(), times, NULL, NULL };
+	RunBatch(b);
+	return CountHits(times, b.count);
+}
+
+static std::ostream& operator<<(std::ostream& os, const Ray& r) { char buffer[256]; r.Format(buffer, sizeof(buffer)); return os << buffer; }
\ No newline at end of file
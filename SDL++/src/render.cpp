@@ -1,27 +1,146 @@
 #include "render.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 using namespace SDL;
 
-Renderer::Renderer(const Renderer& r) : renderer(r.renderer) { }
-Renderer::Renderer(Renderer&& r) : renderer(r.renderer), freeRenderer(r.freeRenderer) { r.freeRenderer = false; }
+// Each texture copy is a zone and a draw call
+#define PROFILE_COPY() SDLPP_PROFILE_ZONE("Texture::Copy"); SDLPP_PROFILE_DRAW(texture)
+
+// Draws only reach a tracked surface when no texture is the target
+static bool Tracking(const Renderer& r) { return r.dirty != nullptr && SDL_GetRenderTarget(r.renderer) == NULL; }
+
+// Mark the output pixels under a box in render coordinates, padded for rounding
+static void MarkBox(const Renderer& r, float x0, float y0, float x1, float y1) {
+	float sx, sy;
+	SDL_Rect view;
+	SDL_RenderGetScale(r.renderer, &sx, &sy);
+	SDL_RenderGetViewport(r.renderer, &view);
+	r.dirty->Add(FRect((x0 + view.x) * sx - 1, (y0 + view.y) * sy - 1, (x1 - x0) * sx + 2, (y1 - y0) * sy + 2));
+}
+
+static void MarkViewport(const Renderer& r) {
+	if (!Tracking(r)) return;
+	SDL_Rect view;
+	SDL_RenderGetViewport(r.renderer, &view);
+	MarkBox(r, 0, 0, (float)view.w, (float)view.h);
+}
+
+template<typename P>
+static void MarkPoints(const Renderer& r, const P* points, int count) {
+	if (!Tracking(r) || count <= 0) return;
+	float x0 = (float)points[0].x, y0 = (float)points[0].y, x1 = x0, y1 = y0;
+	for (int i = 1; i < count; i++) {
+		x0 = std::min(x0, (float)points[i].x);
+		y0 = std::min(y0, (float)points[i].y);
+		x1 = std::max(x1, (float)points[i].x);
+		y1 = std::max(y1, (float)points[i].y);
+	}
+	MarkBox(r, x0, y0, x1 + 1, y1 + 1);
+}
+
+template<typename P>
+static void MarkLine(const Renderer& r, const P& a, const P& b) {
+	const P points[] = { a, b };
+	MarkPoints(r, points, 2);
+}
+
+// Rectangles are marked separately, NULL meaning the whole viewport
+template<typename R>
+static void MarkRects(const Renderer& r, const R* rects, int count) {
+	if (rects == NULL) return MarkViewport(r);
+	if (!Tracking(r)) return;
+	for (int i = 0; i < count; i++) MarkBox(r, (float)rects[i].x, (float)rects[i].y, (float)(rects[i].x + rects[i].w), (float)(rects[i].y + rects[i].h));
+}
+
+static void MarkVertices(const Renderer& r, const Vertex* vertices, int count) {
+	if (!Tracking(r) || count <= 0) return;
+	float x0 = vertices[0].position.x, y0 = vertices[0].position.y, x1 = x0, y1 = y0;
+	for (int i = 1; i < count; i++) {
+		x0 = std::min(x0, vertices[i].position.x);
+		y0 = std::min(y0, vertices[i].position.y);
+		x1 = std::max(x1, vertices[i].position.x);
+		y1 = std::max(y1, vertices[i].position.y);
+	}
+	MarkBox(r, x0, y0, x1, y1);
+}
+
+// The box around a copy rotated about its centre, which defaults to the middle of dst
+template<typename R, typename P>
+static void MarkCopy(const Renderer& r, const R* dst, const P* center, double angle) {
+	if (!Tracking(r)) return;
+	if (std::fmod(angle, 360.0) == 0) return MarkRects(r, dst, 1);
+
+	float x, y, w, h;
+	if (dst != NULL) {
+		x = (float)dst->x; y = (float)dst->y; w = (float)dst->w; h = (float)dst->h;
+	}
+	else {
+		SDL_Rect view;
+		SDL_RenderGetViewport(r.renderer, &view);
+		x = 0; y = 0; w = (float)view.w; h = (float)view.h;
+	}
+	float cx = x + (center != NULL ? (float)center->x : w / 2), cy = y + (center != NULL ? (float)center->y : h / 2);
+
+	float c = (float)std::cos(angle * M_PI / 180), s = (float)std::sin(angle * M_PI / 180);
+	const float corners[4][2] = { { x, y }, { x + w, y }, { x, y + h }, { x + w, y + h } };
+	float x0 = FLT_MAX, y0 = FLT_MAX, x1 = -FLT_MAX, y1 = -FLT_MAX;
+	for (const auto& p : corners) {
+		float px = cx + (p[0] - cx) * c - (p[1] - cy) * s;
+		float py = cy + (p[0] - cx) * s + (p[1] - cy) * c;
+		x0 = std::min(x0, px); y0 = std::min(y0, py);
+		x1 = std::max(x1, px); y1 = std::max(y1, py);
+	}
+	MarkBox(r, x0, y0, x1, y1);
+}
+
+template<typename R>
+static void MarkCopy(const Renderer& r, const R* dst) { MarkCopy(r, dst, (const Point*)NULL, 0); }
+
+Renderer::Renderer(const Renderer& r) : renderer(r.renderer), dirty(r.dirty) { }
+Renderer::Renderer(Renderer&& r) : renderer(r.renderer), freeRenderer(r.freeRenderer), dirty(r.dirty) { r.freeRenderer = false; }
 Renderer& Renderer::operator=(Renderer that)
 {
 	std::swap(renderer, that.renderer);
 	std::swap(freeRenderer, that.freeRenderer);
+	std::swap(dirty, that.dirty);
+	InvalidateStateCache();
 	return *this;
 }
 
 Renderer::Renderer(SDL_Renderer* renderer, bool free) : renderer(renderer), freeRenderer(free && renderer != NULL) {}
 Renderer::Renderer(Window& window, Uint32 flags, int index) : Renderer(SDL_CreateRenderer(window.window, index, flags), true) {}
-Renderer::Renderer(Surface& surface) : Renderer(SDL_CreateSoftwareRenderer(surface.surface), true) {}
+Renderer::Renderer(Surface& surface) : Renderer(SDL_CreateSoftwareRenderer(surface.surface), true) { dirty = surface.dirty; }
 Renderer::Renderer(Window& window) : Renderer(SDL_GetRenderer(window.window), true) {}
 Renderer::~Renderer() { if (freeRenderer) SDL_DestroyRenderer(renderer); }
 
 // Resets the error
 Renderer& Renderer::FlushError() { error = 0; return *this; }
 
-Renderer& Renderer::SetScale(const FPoint& scale) { error |= SDL_RenderSetScale(renderer, scale.x, scale.y); return *this; }
-Renderer& Renderer::SetScale(float scaleX, float scaleY) { error |= SDL_RenderSetScale(renderer, scaleX, scaleY); return *this; }
+Renderer& Renderer::Track(DirtyRegion* region) { dirty = region; return *this; }
+
+Renderer& Renderer::EnableStateCache(bool enable) { cache.enabled = enable; return InvalidateStateCache(); }
+Renderer& Renderer::InvalidateStateCache() {
+	cache.colorValid = false;
+	cache.blendModeValid = false;
+	cache.scaleValid = false;
+	cache.viewportValid = false;
+	cache.clipValid = false;
+	cache.targetValid = false;
+	return *this;
+}
+
+Renderer& Renderer::SetScale(const FPoint& scale) { return SetScale(scale.x, scale.y); }
+Renderer& Renderer::SetScale(float scaleX, float scaleY) {
+	if (cache.enabled && cache.scaleValid && cache.scale.x == scaleX && cache.scale.y == scaleY) { cache.skipped.scale++; return *this; }
+	int result = SDL_RenderSetScale(renderer, scaleX, scaleY);
+	cache.scale = { scaleX, scaleY };
+	cache.scaleValid = result == 0;
+	error |= result;
+	return *this;
+}
 
 FPoint Renderer::GetScale() {
 	FPoint returnVal;
@@ -31,53 +150,86 @@ FPoint Renderer::GetScale() {
 Renderer& Renderer::GetScale(FPoint& scale) { SDL_RenderGetScale(renderer, &scale.x, &scale.y); return *this; }
 Renderer& Renderer::GetScale(float& scaleX, float& scaleY) { SDL_RenderGetScale(renderer, &scaleX, &scaleY); return *this; }
 
-Renderer& Renderer::SetDrawColor(const Colour& color) { error |= SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a); return *this; }
-Renderer& Renderer::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) { error |= SDL_SetRenderDrawColor(renderer, r, g, b, a); return *this; }
+Renderer& Renderer::SetDrawColor(const Colour& color) { return SetDrawColor(color.r, color.g, color.b, color.a); }
+Renderer& Renderer::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+	if (cache.enabled && cache.colorValid && cache.color.r == r && cache.color.g == g && cache.color.b == b && cache.color.a == a) { cache.skipped.color++; return *this; }
+	int result = SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	cache.color = { r, g, b, a };
+	cache.colorValid = result == 0;
+	error |= result;
+	return *this;
+}
 Renderer& Renderer::GetDrawColor(Colour& color) { error |= SDL_GetRenderDrawColor(renderer, &color.r, &color.g, &color.b, &color.a); return *this; }
 Renderer& Renderer::GetDrawColor(Uint8& r, Uint8& g, Uint8& b, Uint8& a) { error |= SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a); return *this; }
 
-Renderer& Renderer::SetDrawBlendMode(const BlendMode& blendMode) { error |= SDL_SetRenderDrawBlendMode(renderer, blendMode); return *this; }
+Renderer& Renderer::SetDrawBlendMode(const BlendMode& blendMode) {
+	if (cache.enabled && cache.blendModeValid && cache.blendMode == blendMode) { cache.skipped.blendMode++; return *this; }
+	int result = SDL_SetRenderDrawBlendMode(renderer, blendMode);
+	cache.blendMode = blendMode;
+	cache.blendModeValid = result == 0;
+	error |= result;
+	return *this;
+}
 Renderer& Renderer::GetDrawBlendMode(BlendMode& blendMode) { error |= SDL_GetRenderDrawBlendMode(renderer, &blendMode); return *this; }
 
-Renderer& Renderer::Clear() { error |= SDL_RenderClear(renderer); return *this; }
+Renderer& Renderer::Clear() { SDLPP_PROFILE_DRAW(NULL); if (Tracking(*this)) dirty->AddAll(); error |= SDL_RenderClear(renderer); return *this; }
 Renderer& Renderer::Flush() { error |= SDL_RenderFlush(renderer); return *this; }
-Renderer& Renderer::Present() { SDL_RenderPresent(renderer); return *this; }
-
-Renderer& Renderer::DrawLine(const  Point& a, const  Point& b) { error |= SDL_RenderDrawLine(renderer, a.x, a.y, b.x, b.y); return *this; }
-Renderer& Renderer::DrawLineF(const FPoint& a, const FPoint& b) { error |= SDL_RenderDrawLineF(renderer, a.x, a.y, b.x, b.y); return *this; }
-Renderer& Renderer::DrawLines(const  Point* points, int count) { error |= SDL_RenderDrawLines(renderer, (const  SDL_Point*)points, count); return *this; }
-Renderer& Renderer::DrawLinesF(const FPoint* points, int count) { error |= SDL_RenderDrawLinesF(renderer, (const SDL_FPoint*)points, count); return *this; }
-Renderer& Renderer::DrawLines(const std::vector< Point>& points) { error |= SDL_RenderDrawLines(renderer, (const  SDL_Point*)points.data(), points.size()); return *this; }
-Renderer& Renderer::DrawLinesF(const std::vector<FPoint>& points) { error |= SDL_RenderDrawLinesF(renderer, (const SDL_FPoint*)points.data(), points.size()); return *this; }
-
-Renderer& Renderer::DrawPoint(const  Point& point) { error |= SDL_RenderDrawPoint(renderer, point.x, point.y); return *this; }
-Renderer& Renderer::DrawPointF(const FPoint& point) { error |= SDL_RenderDrawPointF(renderer, point.x, point.y); return *this; }
-Renderer& Renderer::DrawPoints(const  Point* points, int count) { error |= SDL_RenderDrawPoints(renderer, (const SDL_Point*)points, count); return *this; }
-Renderer& Renderer::DrawPointsF(const FPoint* points, int count) { error |= SDL_RenderDrawPointsF(renderer, (const SDL_FPoint*)points, count); return *this; }
-Renderer& Renderer::DrawPoints(const std::vector< Point>& points) { error |= SDL_RenderDrawPoints(renderer, (const SDL_Point*)points.data(), points.size()); return *this; }
-Renderer& Renderer::DrawPointsF(const std::vector<FPoint>& points) { error |= SDL_RenderDrawPointsF(renderer, (const SDL_FPoint*)points.data(), points.size()); return *this; }
-
-Renderer& Renderer::DrawOutline() { error |= SDL_RenderDrawRect(renderer, NULL); return *this; }
-Renderer& Renderer::DrawOutlineF() { error |= SDL_RenderDrawRectF(renderer, NULL); return *this; }
-Renderer& Renderer::DrawRect(const Rect& rect) { error |= SDL_RenderDrawRect(renderer, &rect.rect); return *this; }
-Renderer& Renderer::DrawRect(const  Rect* rect) { error |= SDL_RenderDrawRect(renderer, (const SDL_Rect*)rect); return *this; }
-Renderer& Renderer::DrawRectF(const FRect& rect) { error |= SDL_RenderDrawRectF(renderer, &rect.rect); return *this; }
-Renderer& Renderer::DrawRectF(const FRect* rect) { error |= SDL_RenderDrawRectF(renderer, (const SDL_FRect*)rect); return *this; }
-Renderer& Renderer::DrawRects(const Rect* rects, int count) { error |= SDL_RenderDrawRects(renderer, (const SDL_Rect*)rects, count); return *this; }
-Renderer& Renderer::DrawRectsF(const FRect* rects, int count) { error |= SDL_RenderDrawRectsF(renderer, (const SDL_FRect*)rects, count); return *this; }
-Renderer& Renderer::DrawRects(const std::vector<Rect>& rects) { error |= SDL_RenderDrawRects(renderer, (const SDL_Rect*)rects.data(), rects.size()); return *this; }
-Renderer& Renderer::DrawRectsF(const std::vector<FRect>& rects) { error |= SDL_RenderDrawRectsF(renderer, (const SDL_FRect*)rects.data(), rects.size()); return *this; }
-
-Renderer& Renderer::Fill() { error |= SDL_RenderFillRect(renderer, NULL); return *this; }
-Renderer& Renderer::FillF() { error |= SDL_RenderFillRectF(renderer, NULL); return *this; }
-Renderer& Renderer::FillRect (const  Rect& rect) { error |= SDL_RenderFillRect(renderer, &rect.rect); return *this; }
-Renderer& Renderer::FillRect (const  Rect* rect) { error |= SDL_RenderFillRect(renderer, (const SDL_Rect*)rect); return *this; }
-Renderer& Renderer::FillRectF(const FRect& rect) { error |= SDL_RenderFillRectF(renderer, &rect.rect); return *this; }
-Renderer& Renderer::FillRectF(const FRect* rect) { error |= SDL_RenderFillRectF(renderer, (const SDL_FRect*)rect); return *this; }
-Renderer& Renderer::FillRects(const Rect* rects, int count) { error |= SDL_RenderFillRects(renderer, (const SDL_Rect*)rects, count); return *this; }
-Renderer& Renderer::FillRectsF(const FRect* rects, int count) { error |= SDL_RenderFillRectsF(renderer, (const SDL_FRect*)rects, count); return *this; }
-Renderer& Renderer::FillRects(const std::vector< Rect>& rects) { error |= SDL_RenderFillRects(renderer, (const SDL_Rect*)rects.data(), rects.size()); return *this; }
-Renderer& Renderer::FillRectsF(const std::vector<FRect>& rects) { error |= SDL_RenderFillRectsF(renderer, (const SDL_FRect*)rects.data(), rects.size()); return *this; }
+Renderer& Renderer::Present() {
+	{
+		SDLPP_PROFILE_ZONE("Renderer::Present");
+		SDL_RenderPresent(renderer);
+	}
+	SDLPP_PROFILE_FRAME();
+	cache.lastFrame = cache.skipped;
+	cache.skipped = {};
+	return InvalidateStateCache();
+}
+
+Renderer& Renderer::DrawLine(const  Point& a, const  Point& b) { SDLPP_PROFILE_DRAW(NULL); MarkLine(*this, a, b); error |= SDL_RenderDrawLine(renderer, a.x, a.y, b.x, b.y); return *this; }
+Renderer& Renderer::DrawLineF(const FPoint& a, const FPoint& b) { SDLPP_PROFILE_DRAW(NULL); MarkLine(*this, a, b); error |= SDL_RenderDrawLineF(renderer, a.x, a.y, b.x, b.y); return *this; }
+Renderer& Renderer::DrawLines(const  Point* points, int count) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points, count); error |= SDL_RenderDrawLines(renderer, (const  SDL_Point*)points, count); return *this; }
+Renderer& Renderer::DrawLinesF(const FPoint* points, int count) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points, count); error |= SDL_RenderDrawLinesF(renderer, (const SDL_FPoint*)points, count); return *this; }
+Renderer& Renderer::DrawLines(const std::vector< Point>& points) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points.data(), (int)points.size()); error |= SDL_RenderDrawLines(renderer, (const  SDL_Point*)points.data(), points.size()); return *this; }
+Renderer& Renderer::DrawLinesF(const std::vector<FPoint>& points) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points.data(), (int)points.size()); error |= SDL_RenderDrawLinesF(renderer, (const SDL_FPoint*)points.data(), points.size()); return *this; }
+
+Renderer& Renderer::DrawPoint(const  Point& point) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, &point, 1); error |= SDL_RenderDrawPoint(renderer, point.x, point.y); return *this; }
+Renderer& Renderer::DrawPointF(const FPoint& point) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, &point, 1); error |= SDL_RenderDrawPointF(renderer, point.x, point.y); return *this; }
+Renderer& Renderer::DrawPoints(const  Point* points, int count) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points, count); error |= SDL_RenderDrawPoints(renderer, (const SDL_Point*)points, count); return *this; }
+Renderer& Renderer::DrawPointsF(const FPoint* points, int count) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points, count); error |= SDL_RenderDrawPointsF(renderer, (const SDL_FPoint*)points, count); return *this; }
+Renderer& Renderer::DrawPoints(const std::vector< Point>& points) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points.data(), (int)points.size()); error |= SDL_RenderDrawPoints(renderer, (const SDL_Point*)points.data(), points.size()); return *this; }
+Renderer& Renderer::DrawPointsF(const std::vector<FPoint>& points) { SDLPP_PROFILE_DRAW(NULL); MarkPoints(*this, points.data(), (int)points.size()); error |= SDL_RenderDrawPointsF(renderer, (const SDL_FPoint*)points.data(), points.size()); return *this; }
+
+Renderer& Renderer::DrawOutline() { SDLPP_PROFILE_DRAW(NULL); MarkViewport(*this); error |= SDL_RenderDrawRect(renderer, NULL); return *this; }
+Renderer& Renderer::DrawOutlineF() { SDLPP_PROFILE_DRAW(NULL); MarkViewport(*this); error |= SDL_RenderDrawRectF(renderer, NULL); return *this; }
+Renderer& Renderer::DrawRect(const Rect& rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, &rect, 1); error |= SDL_RenderDrawRect(renderer, &rect.rect); return *this; }
+Renderer& Renderer::DrawRect(const  Rect* rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rect, 1); error |= SDL_RenderDrawRect(renderer, (const SDL_Rect*)rect); return *this; }
+Renderer& Renderer::DrawRectF(const FRect& rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, &rect, 1); error |= SDL_RenderDrawRectF(renderer, &rect.rect); return *this; }
+Renderer& Renderer::DrawRectF(const FRect* rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rect, 1); error |= SDL_RenderDrawRectF(renderer, (const SDL_FRect*)rect); return *this; }
+Renderer& Renderer::DrawRects(const Rect* rects, int count) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects, count); error |= SDL_RenderDrawRects(renderer, (const SDL_Rect*)rects, count); return *this; }
+Renderer& Renderer::DrawRectsF(const FRect* rects, int count) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects, count); error |= SDL_RenderDrawRectsF(renderer, (const SDL_FRect*)rects, count); return *this; }
+Renderer& Renderer::DrawRects(const std::vector<Rect>& rects) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects.data(), (int)rects.size()); error |= SDL_RenderDrawRects(renderer, (const SDL_Rect*)rects.data(), rects.size()); return *this; }
+Renderer& Renderer::DrawRectsF(const std::vector<FRect>& rects) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects.data(), (int)rects.size()); error |= SDL_RenderDrawRectsF(renderer, (const SDL_FRect*)rects.data(), rects.size()); return *this; }
+
+Renderer& Renderer::Fill() { SDLPP_PROFILE_DRAW(NULL); MarkViewport(*this); error |= SDL_RenderFillRect(renderer, NULL); return *this; }
+Renderer& Renderer::FillF() { SDLPP_PROFILE_DRAW(NULL); MarkViewport(*this); error |= SDL_RenderFillRectF(renderer, NULL); return *this; }
+Renderer& Renderer::FillRect (const  Rect& rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, &rect, 1); error |= SDL_RenderFillRect(renderer, &rect.rect); return *this; }
+Renderer& Renderer::FillRect (const  Rect* rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rect, 1); error |= SDL_RenderFillRect(renderer, (const SDL_Rect*)rect); return *this; }
+Renderer& Renderer::FillRectF(const FRect& rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, &rect, 1); error |= SDL_RenderFillRectF(renderer, &rect.rect); return *this; }
+Renderer& Renderer::FillRectF(const FRect* rect) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rect, 1); error |= SDL_RenderFillRectF(renderer, (const SDL_FRect*)rect); return *this; }
+Renderer& Renderer::FillRects(const Rect* rects, int count) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects, count); error |= SDL_RenderFillRects(renderer, (const SDL_Rect*)rects, count); return *this; }
+Renderer& Renderer::FillRectsF(const FRect* rects, int count) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects, count); error |= SDL_RenderFillRectsF(renderer, (const SDL_FRect*)rects, count); return *this; }
+Renderer& Renderer::FillRects(const std::vector< Rect>& rects) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects.data(), (int)rects.size()); error |= SDL_RenderFillRects(renderer, (const SDL_Rect*)rects.data(), rects.size()); return *this; }
+Renderer& Renderer::FillRectsF(const std::vector<FRect>& rects) { SDLPP_PROFILE_DRAW(NULL); MarkRects(*this, rects.data(), (int)rects.size()); error |= SDL_RenderFillRectsF(renderer, (const SDL_FRect*)rects.data(), rects.size()); return *this; }
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+Renderer& Renderer::Geometry(const Vertex* vertices, int numVertices, const int* indices, int numIndices) { SDLPP_PROFILE_DRAW(NULL); MarkVertices(*this, vertices, numVertices); error |= SDL_RenderGeometry(renderer, NULL, vertices, numVertices, indices, numIndices); return *this; }
+Renderer& Renderer::Geometry(const std::vector<Vertex>& vertices, const std::vector<int>& indices) {
+	SDLPP_PROFILE_DRAW(NULL);
+	MarkVertices(*this, vertices.data(), (int)vertices.size());
+	error |= SDL_RenderGeometry(renderer, NULL, vertices.data(), vertices.size(), indices.empty() ? NULL : indices.data(), indices.size());
+	return *this;
+}
+#endif
 
 int Renderer::GetNumDrivers() { return SDL_GetNumRenderDrivers(); }
 Renderer& Renderer::GetDriverInfo(int index, Info& info) { error |= SDL_GetRenderDriverInfo(index, &info); return *this; }
@@ -95,16 +247,39 @@ Renderer& Renderer::GetOutputSize(int& w, int& h) { error |= SDL_GetRendererOutp
 bool Renderer::TargetSupported() { return SDL_RenderTargetSupported(renderer); }
 Renderer& Renderer::TargetSupported(bool& support) { support = SDL_RenderTargetSupported(renderer); return *this; }
 
-Renderer& Renderer::SetTarget(Texture& texture) { error |= SDL_SetRenderTarget(renderer, texture.texture); return *this; }
-Texture Renderer::GetTarget() { return Texture(*this, SDL_GetRenderTarget(renderer)); }
+Renderer& Renderer::SetTarget(Texture& texture) { return SetTarget(texture.texture); }
+Renderer& Renderer::SetTarget(SDL_Texture* texture) {
+	if (cache.enabled && cache.targetValid && cache.target == texture) { cache.skipped.target++; return *this; }
+	int result = SDL_SetRenderTarget(renderer, texture);
+	// Each target keeps its own viewport, clip rectangle and scale
+	cache.viewportValid = false;
+	cache.clipValid = false;
+	cache.scaleValid = false;
+	cache.target = texture;
+	cache.targetValid = result == 0;
+	error |= result;
+	return *this;
+}
+Renderer& Renderer::ResetTarget() { return SetTarget((SDL_Texture*)NULL); }
+Texture Renderer::GetTarget() { return Texture(*this, GetTargetTexture(), false); }
 Renderer& Renderer::GetTarget(Texture& target) {
 	target.~Texture();
-	target.texture = SDL_GetRenderTarget(renderer);
+	target.texture = GetTargetTexture();
+	target.freeTexture = false;
 	return *this;
 }
+SDL_Texture* Renderer::GetTargetTexture() {
+	if (cache.enabled && cache.targetValid) return cache.target;
+	return SDL_GetRenderTarget(renderer);
+}
 
-Renderer& Renderer::SetLogicalSize(const Point& size) { error |= SDL_RenderSetLogicalSize(renderer, size.w, size.h); return *this; }
-Renderer& Renderer::SetLogicalSize(int w, int h) { error |= SDL_RenderSetLogicalSize(renderer, w, h); return *this; }
+Renderer& Renderer::SetLogicalSize(const Point& size) { return SetLogicalSize(size.w, size.h); }
+Renderer& Renderer::SetLogicalSize(int w, int h) {
+	error |= SDL_RenderSetLogicalSize(renderer, w, h);
+	cache.viewportValid = false;
+	cache.scaleValid = false;
+	return *this;
+}
 
 Point Renderer::GetLogicalSize() {
 	Point returnVal;
@@ -114,12 +289,32 @@ Point Renderer::GetLogicalSize() {
 Renderer& Renderer::GetLogicalSize(Point& size) { SDL_RenderGetLogicalSize(renderer, &size.w, &size.h); return *this; }
 Renderer& Renderer::GetLogicalSize(int& w, int& h) { SDL_RenderGetLogicalSize(renderer, &w, &h); return *this; }
 
-Renderer& Renderer::SetIntegerScale(bool enable) { error |= SDL_RenderSetIntegerScale(renderer, (SDL_bool)enable); return *this; }
+Renderer& Renderer::SetIntegerScale(bool enable) {
+	error |= SDL_RenderSetIntegerScale(renderer, (SDL_bool)enable);
+	cache.viewportValid = false;
+	cache.scaleValid = false;
+	return *this;
+}
 bool Renderer::GetIntegerScale() { return SDL_RenderGetIntegerScale(renderer); }
 Renderer& Renderer::GetIntegerScale(bool& enabled) { enabled = SDL_RenderGetIntegerScale(renderer); return *this; }
 
-Renderer& Renderer::SetViewport(const Rect& rect) { error |= SDL_RenderSetViewport(renderer, &rect.rect); return *this; }
-Renderer& Renderer::FillViewport() { error |= SDL_RenderSetViewport(renderer, NULL); return *this; }
+Renderer& Renderer::SetViewport(const Rect& rect) {
+	if (cache.enabled && cache.viewportValid && !cache.viewportFull && cache.viewport == rect) { cache.skipped.viewport++; return *this; }
+	int result = SDL_RenderSetViewport(renderer, &rect.rect);
+	cache.viewportFull = false;
+	cache.viewport = rect;
+	cache.viewportValid = result == 0;
+	error |= result;
+	return *this;
+}
+Renderer& Renderer::FillViewport() {
+	if (cache.enabled && cache.viewportValid && cache.viewportFull) { cache.skipped.viewport++; return *this; }
+	int result = SDL_RenderSetViewport(renderer, NULL);
+	cache.viewportFull = true;
+	cache.viewportValid = result == 0;
+	error |= result;
+	return *this;
+}
 
 Rect Renderer::GetViewport() {
 	Rect returnVal;
@@ -128,8 +323,23 @@ Rect Renderer::GetViewport() {
 }
 Renderer& Renderer::GetViewport(Rect& rect) { SDL_RenderGetViewport(renderer, &rect.rect); return *this; }
 
-Renderer& Renderer::SetClipRect(const Rect& rect) { error |= SDL_RenderSetClipRect(renderer, &rect.rect); return *this; }
-Renderer& Renderer::DisableClip() { error |= SDL_RenderSetClipRect(renderer, NULL); return *this; }
+Renderer& Renderer::SetClipRect(const Rect& rect) {
+	if (cache.enabled && cache.clipValid && cache.clipEnabled && cache.clip == rect) { cache.skipped.clip++; return *this; }
+	int result = SDL_RenderSetClipRect(renderer, &rect.rect);
+	cache.clipEnabled = true;
+	cache.clip = rect;
+	cache.clipValid = result == 0;
+	error |= result;
+	return *this;
+}
+Renderer& Renderer::DisableClip() {
+	if (cache.enabled && cache.clipValid && !cache.clipEnabled) { cache.skipped.clip++; return *this; }
+	int result = SDL_RenderSetClipRect(renderer, NULL);
+	cache.clipEnabled = false;
+	cache.clipValid = result == 0;
+	error |= result;
+	return *this;
+}
 
 Rect Renderer::GetClipRect() {
 	Rect returnVal;
@@ -182,47 +392,73 @@ int Texture::LockToSurface(Surface& surface) {
 void Texture::Unlock() { SDL_UnlockTexture(texture); }
 
 
-int Texture::UpdateRect(const Rect& rect, void* pixels, int pitch) { return SDL_UpdateTexture(texture, (const SDL_Rect*)&rect.rect, pixels, pitch); }
-int Texture::Update(void* pixels, int pitch) { return SDL_UpdateTexture(texture, NULL, pixels, pitch); }
+#ifdef SDLPP_PROFILE
+// The height of the texture, for counting the bytes of whole texture uploads
+static int TextureHeight(SDL_Texture* texture) {
+	int h = 0;
+	SDL_QueryTexture(texture, NULL, NULL, NULL, &h);
+	return h;
+}
+#endif
+
+int Texture::UpdateRect(const Rect& rect, void* pixels, int pitch) {
+	SDLPP_PROFILE_UPLOAD((Uint64)pitch * rect.h);
+	return SDL_UpdateTexture(texture, (const SDL_Rect*)&rect.rect, pixels, pitch);
+}
+int Texture::Update(void* pixels, int pitch) {
+	SDLPP_PROFILE_UPLOAD((Uint64)pitch * TextureHeight(texture));
+	return SDL_UpdateTexture(texture, NULL, pixels, pitch);
+}
 
 int Texture::UpdateYUVRect(const Rect& rect, const Uint8* Yplane, int Ypitch, const Uint8* Uplane, int Upitch, const Uint8* Vplane, int Vpitch) {
+	SDLPP_PROFILE_UPLOAD((Uint64)Ypitch * rect.h + ((Uint64)Upitch + Vpitch) * ((rect.h + 1) / 2));
 	return SDL_UpdateYUVTexture(texture, &rect.rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
 }
 int Texture::UpdateYUV(const Uint8* Yplane, int Ypitch, const Uint8* Uplane, int Upitch, const Uint8* Vplane, int Vpitch) {
+	SDLPP_PROFILE_UPLOAD((Uint64)Ypitch * TextureHeight(texture) + ((Uint64)Upitch + Vpitch) * ((TextureHeight(texture) + 1) / 2));
 	return SDL_UpdateYUVTexture(texture, NULL, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
 }
 
-int Texture::Copy(const Rect& src, const Rect& dst) { return SDL_RenderCopy(renderer.renderer, texture, &src.rect, &dst.rect); }
-int Texture::Copy(const Rect& dst) { return SDL_RenderCopy(renderer.renderer, texture, NULL, &dst.rect); }
-int Texture::Copy_Fill(const Rect& src) { return SDL_RenderCopy(renderer.renderer, texture, &src.rect, NULL); }
-int Texture::Copy_Fill() { return SDL_RenderCopy(renderer.renderer, texture, NULL, NULL); }
-int Texture::Copy(const Rect* src, const Rect* dst) { return SDL_RenderCopy(renderer.renderer, texture, (SDL_Rect*)src, (SDL_Rect*)dst); }
-
-int Texture::CopyF(const Rect& src, const FRect& dst) { return SDL_RenderCopyF(renderer.renderer, texture, &src.rect, &dst.rect); }
-int Texture::CopyF(const FRect& dst) { return SDL_RenderCopyF(renderer.renderer, texture, NULL, &dst.rect); }
-int Texture::CopyF_Fill(const Rect& src) { return SDL_RenderCopyF(renderer.renderer, texture, &src.rect, NULL); }
-int Texture::CopyF_Fill() { return SDL_RenderCopyF(renderer.renderer, texture, NULL, NULL); }
-int Texture::CopyF(const Rect* src, const FRect* dst) { return SDL_RenderCopyF(renderer.renderer, texture, (SDL_Rect*)src, (SDL_FRect*)dst); }
-
-int Texture::CopyEx(const Rect& src, const Rect& dst, const Point& center, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, &dst.rect, angle, &center.point, flipType); }
-int Texture::CopyEx(const Rect& src, const Rect& dst, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, &dst.rect, angle, NULL, flipType); }
-int Texture::CopyEx(const Rect& dst, const Point& center, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, NULL, &dst.rect, angle, &center.point, flipType); }
-int Texture::CopyEx(const Rect& dst, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, NULL, &dst.rect, angle, NULL, flipType); }
-int Texture::CopyEx_Fill(const Rect& src, const Point& center, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, NULL, angle, &center.point, flipType); }
-int Texture::CopyEx_Fill(const Rect& src, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, NULL, angle, NULL, flipType); }
-int Texture::CopyEx_Fill(const Point& center, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, NULL, NULL, angle, &center.point, flipType); }
-int Texture::CopyEx_Fill(double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, NULL, NULL, angle, NULL, flipType); }
-int Texture::CopyEx(const Rect* src, const Rect* dst, const Point* center, double angle, Flip flipType) { return SDL_RenderCopyEx(renderer.renderer, texture, (SDL_Rect*)src, (SDL_Rect*)dst, angle, (SDL_Point*)center, flipType); }
-
-int Texture::CopyExF(const Rect& src, const FRect& dst, const FPoint& center, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, &dst.rect, angle, &center.point, flipType); }
-int Texture::CopyExF(const Rect& src, const FRect& dst, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, &dst.rect, angle, NULL, flipType); }
-int Texture::CopyExF(const FRect& dst, const FPoint& center, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, NULL, &dst.rect, angle, &center.point, flipType); }
-int Texture::CopyExF(const FRect& dst, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, NULL, &dst.rect, angle, NULL, flipType); }
-int Texture::CopyExF_Fill(const Rect& src, const FPoint& center, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, NULL, angle, &center.point, flipType); }
-int Texture::CopyExF_Fill(const Rect& src, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, NULL, angle, NULL, flipType); }
-int Texture::CopyExF_Fill(const FPoint& center, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, NULL, NULL, angle, &center.point, flipType); }
-int Texture::CopyExF_Fill(double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, NULL, NULL, angle, NULL, flipType); }
-int Texture::CopyExF(const Rect* src, const FRect* dst, const FPoint* center, double angle, Flip flipType) { return SDL_RenderCopyExF(renderer.renderer, texture, (SDL_Rect*)src, (SDL_FRect*)dst, angle, (SDL_FPoint*)center, flipType); }
+int Texture::Copy(const Rect& src, const Rect& dst) { PROFILE_COPY(); MarkCopy(renderer, &dst); return SDL_RenderCopy(renderer.renderer, texture, &src.rect, &dst.rect); }
+int Texture::Copy(const Rect& dst) { PROFILE_COPY(); MarkCopy(renderer, &dst); return SDL_RenderCopy(renderer.renderer, texture, NULL, &dst.rect); }
+int Texture::Copy_Fill(const Rect& src) { PROFILE_COPY(); MarkCopy(renderer, (const Rect*)NULL); return SDL_RenderCopy(renderer.renderer, texture, &src.rect, NULL); }
+int Texture::Copy_Fill() { PROFILE_COPY(); MarkCopy(renderer, (const Rect*)NULL); return SDL_RenderCopy(renderer.renderer, texture, NULL, NULL); }
+int Texture::Copy(const Rect* src, const Rect* dst) { PROFILE_COPY(); MarkCopy(renderer, dst); return SDL_RenderCopy(renderer.renderer, texture, (SDL_Rect*)src, (SDL_Rect*)dst); }
+
+int Texture::CopyF(const Rect& src, const FRect& dst) { PROFILE_COPY(); MarkCopy(renderer, &dst); return SDL_RenderCopyF(renderer.renderer, texture, &src.rect, &dst.rect); }
+int Texture::CopyF(const FRect& dst) { PROFILE_COPY(); MarkCopy(renderer, &dst); return SDL_RenderCopyF(renderer.renderer, texture, NULL, &dst.rect); }
+int Texture::CopyF_Fill(const Rect& src) { PROFILE_COPY(); MarkCopy(renderer, (const FRect*)NULL); return SDL_RenderCopyF(renderer.renderer, texture, &src.rect, NULL); }
+int Texture::CopyF_Fill() { PROFILE_COPY(); MarkCopy(renderer, (const FRect*)NULL); return SDL_RenderCopyF(renderer.renderer, texture, NULL, NULL); }
+int Texture::CopyF(const Rect* src, const FRect* dst) { PROFILE_COPY(); MarkCopy(renderer, dst); return SDL_RenderCopyF(renderer.renderer, texture, (SDL_Rect*)src, (SDL_FRect*)dst); }
+
+int Texture::CopyEx(const Rect& src, const Rect& dst, const Point& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, &center, angle); return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, &dst.rect, angle, &center.point, flipType); }
+int Texture::CopyEx(const Rect& src, const Rect& dst, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, (const Point*)NULL, angle); return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, &dst.rect, angle, NULL, flipType); }
+int Texture::CopyEx(const Rect& dst, const Point& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, &center, angle); return SDL_RenderCopyEx(renderer.renderer, texture, NULL, &dst.rect, angle, &center.point, flipType); }
+int Texture::CopyEx(const Rect& dst, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, (const Point*)NULL, angle); return SDL_RenderCopyEx(renderer.renderer, texture, NULL, &dst.rect, angle, NULL, flipType); }
+int Texture::CopyEx_Fill(const Rect& src, const Point& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const Rect*)NULL, &center, angle); return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, NULL, angle, &center.point, flipType); }
+int Texture::CopyEx_Fill(const Rect& src, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const Rect*)NULL, (const Point*)NULL, angle); return SDL_RenderCopyEx(renderer.renderer, texture, &src.rect, NULL, angle, NULL, flipType); }
+int Texture::CopyEx_Fill(const Point& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const Rect*)NULL, &center, angle); return SDL_RenderCopyEx(renderer.renderer, texture, NULL, NULL, angle, &center.point, flipType); }
+int Texture::CopyEx_Fill(double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const Rect*)NULL, (const Point*)NULL, angle); return SDL_RenderCopyEx(renderer.renderer, texture, NULL, NULL, angle, NULL, flipType); }
+int Texture::CopyEx(const Rect* src, const Rect* dst, const Point* center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, dst, center, angle); return SDL_RenderCopyEx(renderer.renderer, texture, (SDL_Rect*)src, (SDL_Rect*)dst, angle, (SDL_Point*)center, flipType); }
+
+int Texture::CopyExF(const Rect& src, const FRect& dst, const FPoint& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, &center, angle); return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, &dst.rect, angle, &center.point, flipType); }
+int Texture::CopyExF(const Rect& src, const FRect& dst, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, (const FPoint*)NULL, angle); return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, &dst.rect, angle, NULL, flipType); }
+int Texture::CopyExF(const FRect& dst, const FPoint& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, &center, angle); return SDL_RenderCopyExF(renderer.renderer, texture, NULL, &dst.rect, angle, &center.point, flipType); }
+int Texture::CopyExF(const FRect& dst, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, &dst, (const FPoint*)NULL, angle); return SDL_RenderCopyExF(renderer.renderer, texture, NULL, &dst.rect, angle, NULL, flipType); }
+int Texture::CopyExF_Fill(const Rect& src, const FPoint& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const FRect*)NULL, &center, angle); return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, NULL, angle, &center.point, flipType); }
+int Texture::CopyExF_Fill(const Rect& src, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const FRect*)NULL, (const FPoint*)NULL, angle); return SDL_RenderCopyExF(renderer.renderer, texture, &src.rect, NULL, angle, NULL, flipType); }
+int Texture::CopyExF_Fill(const FPoint& center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const FRect*)NULL, &center, angle); return SDL_RenderCopyExF(renderer.renderer, texture, NULL, NULL, angle, &center.point, flipType); }
+int Texture::CopyExF_Fill(double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, (const FRect*)NULL, (const FPoint*)NULL, angle); return SDL_RenderCopyExF(renderer.renderer, texture, NULL, NULL, angle, NULL, flipType); }
+int Texture::CopyExF(const Rect* src, const FRect* dst, const FPoint* center, double angle, Flip flipType) { PROFILE_COPY(); MarkCopy(renderer, dst, center, angle); return SDL_RenderCopyExF(renderer.renderer, texture, (SDL_Rect*)src, (SDL_FRect*)dst, angle, (SDL_FPoint*)center, flipType); }
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+int Texture::Geometry(const Vertex* vertices, int numVertices, const int* indices, int numIndices) { SDLPP_PROFILE_DRAW(texture); MarkVertices(renderer, vertices, numVertices); return SDL_RenderGeometry(renderer.renderer, texture, vertices, numVertices, indices, numIndices); }
+int Texture::Geometry(const std::vector<Vertex>& vertices, const std::vector<int>& indices) {
+	SDLPP_PROFILE_DRAW(texture);
+	MarkVertices(renderer, vertices.data(), (int)vertices.size());
+	return SDL_RenderGeometry(renderer.renderer, texture, vertices.data(), vertices.size(), indices.empty() ? NULL : indices.data(), indices.size());
+}
+#endif
 
 int Texture::QueryFormat(Uint32& format) { return SDL_QueryTexture(texture, &format, NULL, NULL, NULL); }
 int Texture::QueryAccess(int& access) { return SDL_QueryTexture(texture, NULL, &access, NULL, NULL); }
@@ -245,6 +481,27 @@ int Texture::GetBlendMode(BlendMode& blendMode) { return SDL_GetTextureBlendMode
 int Texture::SetScaleMode(ScaleMode scaleMode) { return SDL_SetTextureScaleMode(texture, scaleMode); }
 int Texture::GetScaleMode(ScaleMode& scaleMode) { return SDL_GetTextureScaleMode(texture, &scaleMode); }
 
+int TextureRef::Copy(const Rect* src, const Rect* dst) const { PROFILE_COPY(); MarkCopy(*renderer, dst); return SDL_RenderCopy(renderer->renderer, texture, (SDL_Rect*)src, (SDL_Rect*)dst); }
+int TextureRef::CopyF(const Rect* src, const FRect* dst) const { PROFILE_COPY(); MarkCopy(*renderer, dst); return SDL_RenderCopyF(renderer->renderer, texture, (SDL_Rect*)src, (SDL_FRect*)dst); }
+int TextureRef::CopyExF(const Rect* src, const FRect* dst, const FPoint* center, double angle, Texture::Flip flipType) const { PROFILE_COPY(); MarkCopy(*renderer, dst, center, angle); return SDL_RenderCopyExF(renderer->renderer, texture, (SDL_Rect*)src, (SDL_FRect*)dst, angle, (SDL_FPoint*)center, flipType); }
+#if SDL_VERSION_ATLEAST(2,0,18)
+int TextureRef::Geometry(const Vertex* vertices, int numVertices, const int* indices, int numIndices) const { SDLPP_PROFILE_DRAW(texture); MarkVertices(*renderer, vertices, numVertices); return SDL_RenderGeometry(renderer->renderer, texture, vertices, numVertices, indices, numIndices); }
+#endif
+
+TargetGuard::TargetGuard(Renderer& renderer, Texture& target) : renderer(renderer), previous(renderer.GetTargetTexture()) {
+	if (previous != NULL) {
+		viewport = renderer.GetViewport();
+		scale = renderer.GetScale();
+	}
+	renderer.SetTarget(target);
+	error = SDL_GetRenderTarget(renderer.renderer) == target.texture ? 0 : -1;
+}
+
+TargetGuard::~TargetGuard() {
+	renderer.SetTarget(previous);
+	if (previous != NULL) renderer.SetScale(scale).SetViewport(viewport);
+}
+
 int SDL::CreateWindowAndRenderer(const Point& size, Window& window, Renderer& renderer, Uint32 window_flags) {
 	window.~Window();
 	renderer.~Renderer();
@@ -0,0 +1,309 @@
+#include "shapebatch.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+using namespace SDL;
+
+static float Cross(const FPoint& a, const FPoint& b) { return a.x * b.y - a.y * b.x; }
+static float Length(const FPoint& v) { return std::sqrt(v.x * v.x + v.y * v.y); }
+
+// The unit normal to the left of a direction
+static FPoint Normal(const FPoint& d) {
+	float length = Length(d);
+	return length > 0 ? FPoint(-d.y / length, d.x / length) : FPoint(0, 0);
+}
+
+// Whether p is inside or on triangle abc, which winds anticlockwise
+static bool InTriangle(const FPoint& p, const FPoint& a, const FPoint& b, const FPoint& c) {
+	return Cross(FPoint(b.x - a.x, b.y - a.y), FPoint(p.x - a.x, p.y - a.y)) >= 0
+		&& Cross(FPoint(c.x - b.x, c.y - b.y), FPoint(p.x - b.x, p.y - b.y)) >= 0
+		&& Cross(FPoint(a.x - c.x, a.y - c.y), FPoint(p.x - c.x, p.y - c.y)) >= 0;
+}
+
+ShapeBatch::ShapeBatch(Renderer& renderer, size_t reserve) : renderer(renderer) {
+	vertices.reserve(reserve);
+	indices.reserve(reserve * 3);
+}
+
+ShapeBatch& ShapeBatch::FlushError() { error = 0; return *this; }
+
+ShapeBatch& ShapeBatch::SetBlendMode(BlendMode blendMode) {
+	if (blendMode != this->blendMode) Flush();
+	this->blendMode = blendMode;
+	return *this;
+}
+
+int ShapeBatch::Segments(float radius, int segments, float turn) const {
+	if (segments > 0) return segments;
+	// The angle of a chord that strays tolerance from an arc of this radius
+	float step = 2 * std::acos(std::max(1 - tolerance / std::max(radius, tolerance), -1.0f));
+	int count = step > 0 ? (int)std::ceil(2 * M_PI * turn / step) : 1;
+	return std::min(std::max(count, 1), 1024);
+}
+
+int ShapeBatch::Add(float x, float y, const Colour& color) {
+	vertices.push_back({ { x, y }, color, { 0, 0 } });
+	return (int)vertices.size() - 1;
+}
+
+void ShapeBatch::Triangle(int a, int b, int c) {
+	indices.push_back(a);
+	indices.push_back(b);
+	indices.push_back(c);
+}
+
+void ShapeBatch::Fan(int center, int first, int count) {
+	for (int i = 0; i < count; i++) Triangle(center, first + i, first + (i + 1) % count);
+}
+
+void ShapeBatch::Ring(int outer, int inner, int count) {
+	for (int i = 0; i < count; i++) {
+		int next = (i + 1) % count;
+		Triangle(outer + i, outer + next, inner + next);
+		Triangle(outer + i, inner + next, inner + i);
+	}
+}
+
+void ShapeBatch::Ellipse(const FPoint& center, float rx, float ry, int segments, const Colour& color) {
+	for (int i = 0; i < segments; i++) {
+		double angle = 2 * M_PI * i / segments;
+		Add(center.x + rx * (float)std::cos(angle), center.y + ry * (float)std::sin(angle), color);
+	}
+}
+
+ShapeBatch& ShapeBatch::FillCircle(const FPoint& center, float radius, const Colour& color, int segments) { return FillEllipse(center, FPoint(radius, radius), color, segments); }
+ShapeBatch& ShapeBatch::DrawCircle(const FPoint& center, float radius, float thickness, const Colour& color, int segments) { return DrawEllipse(center, FPoint(radius, radius), thickness, color, segments); }
+
+ShapeBatch& ShapeBatch::FillEllipse(const FPoint& center, const FPoint& radii, const Colour& color, int segments) {
+	if (radii.x <= 0 || radii.y <= 0) return *this;
+	segments = std::max(Segments(std::max(radii.x, radii.y), segments), 3);
+
+	int middle = Add(center.x, center.y, color);
+	Ellipse(center, radii.x, radii.y, segments, color);
+	Fan(middle, middle + 1, segments);
+	return *this;
+}
+
+ShapeBatch& ShapeBatch::DrawEllipse(const FPoint& center, const FPoint& radii, float thickness, const Colour& color, int segments) {
+	if (radii.x <= 0 || radii.y <= 0 || thickness <= 0) return *this;
+	float half = thickness / 2;
+	segments = std::max(Segments(std::max(radii.x, radii.y) + half, segments), 3);
+
+	int outer = (int)vertices.size();
+	Ellipse(center, radii.x + half, radii.y + half, segments, color);
+	int inner = (int)vertices.size();
+	Ellipse(center, std::max(radii.x - half, 0.0f), std::max(radii.y - half, 0.0f), segments, color);
+	Ring(outer, inner, segments);
+	return *this;
+}
+
+ShapeBatch& ShapeBatch::FillPolygon(const std::vector<FPoint>& points, const Colour& color) { return FillPolygon(points.data(), (int)points.size(), color); }
+
+ShapeBatch& ShapeBatch::FillPolygon(const FPoint* points, int count, const Colour& color) {
+	if (count < 3) return *this;
+
+	int first = (int)vertices.size();
+	for (int i = 0; i < count; i++) Add(points[i].x, points[i].y, color);
+
+	// Convex when every corner turns the same way
+	float area = 0;
+	bool left = false, right = false;
+	for (int i = 0; i < count; i++) {
+		const FPoint& a = points[i];
+		const FPoint& b = points[(i + 1) % count];
+		const FPoint& c = points[(i + 2) % count];
+		area += Cross(a, b);
+		float turn = Cross(FPoint(b.x - a.x, b.y - a.y), FPoint(c.x - b.x, c.y - b.y));
+		if (turn > 0) left = true;
+		else if (turn < 0) right = true;
+	}
+	if (!(left && right)) {
+		for (int i = 1; i + 1 < count; i++) Triangle(first, first + i, first + i + 1);
+		return *this;
+	}
+
+	// Ear clipping, walking the points anticlockwise
+	polygon.clear();
+	for (int i = 0; i < count; i++) polygon.push_back(area > 0 ? i : count - 1 - i);
+
+	int misses = 0;
+	for (size_t i = 0; polygon.size() > 3;) {
+		size_t n = polygon.size();
+		int a = polygon[(i + n - 1) % n], b = polygon[i % n], c = polygon[(i + 1) % n];
+		const FPoint& pa = points[a];
+		const FPoint& pb = points[b];
+		const FPoint& pc = points[c];
+
+		bool ear = Cross(FPoint(pb.x - pa.x, pb.y - pa.y), FPoint(pc.x - pb.x, pc.y - pb.y)) > 0;
+		for (size_t j = 0; ear && j < n; j++) {
+			int p = polygon[j];
+			if (p != a && p != b && p != c && InTriangle(points[p], pa, pb, pc)) ear = false;
+		}
+
+		if (ear) {
+			Triangle(first + a, first + b, first + c);
+			polygon.erase(polygon.begin() + i % n);
+			misses = 0;
+		}
+		else if (++misses > (int)n) {
+			// Crossing edges leave no ear; fan what is left rather than loop forever
+			for (size_t j = 1; j + 1 < polygon.size(); j++) Triangle(first + polygon[0], first + polygon[j], first + polygon[j + 1]);
+			return *this;
+		}
+		else i = (i + 1) % n;
+	}
+	Triangle(first + polygon[0], first + polygon[1], first + polygon[2]);
+	return *this;
+}
+
+ShapeBatch& ShapeBatch::DrawPolygon(const FPoint* points, int count, float thickness, const Colour& color, Join join) { return DrawLines(points, count, thickness, color, join, true); }
+
+ShapeBatch& ShapeBatch::DrawLine(const FPoint& a, const FPoint& b, float thickness, const Colour& color) {
+	const FPoint points[] = { a, b };
+	return DrawLines(points, 2, thickness, color, Join::BEVEL, false);
+}
+
+ShapeBatch& ShapeBatch::DrawLines(const std::vector<FPoint>& points, float thickness, const Colour& color, Join join, bool closed) { return DrawLines(points.data(), (int)points.size(), thickness, color, join, closed); }
+
+void ShapeBatch::AddJoin(const FPoint& p, const FPoint& d0, const FPoint& d1, float half, Join join, const Colour& color) {
+	float turn = Cross(d0, d1);
+	if (std::fabs(turn) <= 1e-6f * Length(d0) * Length(d1)) return;
+
+	// The gap opens on the outside of the turn
+	float side = turn > 0 ? -1.0f : 1.0f;
+	FPoint n0 = Normal(d0), n1 = Normal(d1);
+	FPoint a(p.x + n0.x * half * side, p.y + n0.y * half * side);
+	FPoint b(p.x + n1.x * half * side, p.y + n1.y * half * side);
+	int center = Add(p.x, p.y, color);
+
+	if (join == Join::MITER) {
+		// The miter runs along the bisector of the two normals
+		FPoint sum(n0.x + n1.x, n0.y + n1.y);
+		float sumLength = Length(sum);
+		FPoint m = sumLength > 0 ? FPoint(sum.x / sumLength, sum.y / sumLength) : FPoint(0, 0);
+		float cosine = m.x * n1.x + m.y * n1.y;
+		float length = cosine > 0 ? half / cosine : 0;
+		if (cosine > 0 && length <= miterLimit * half) {
+			int ia = Add(a.x, a.y, color);
+			int im = Add(p.x + m.x * length * side, p.y + m.y * length * side, color);
+			int ib = Add(b.x, b.y, color);
+			Triangle(center, ia, im);
+			Triangle(center, im, ib);
+			return;
+		}
+	}
+
+	if (join == Join::ROUND) {
+		float start = std::atan2(a.y - p.y, a.x - p.x);
+		float sweep = std::atan2(b.y - p.y, b.x - p.x) - start;
+		if (sweep > M_PI) sweep -= (float)(2 * M_PI);
+		if (sweep < -M_PI) sweep += (float)(2 * M_PI);
+		int steps = Segments(half, 0, std::fabs(sweep) / (float)(2 * M_PI));
+		int previous = Add(a.x, a.y, color);
+		for (int i = 1; i <= steps; i++) {
+			float angle = start + sweep * i / steps;
+			int next = Add(p.x + half * std::cos(angle), p.y + half * std::sin(angle), color);
+			Triangle(center, previous, next);
+			previous = next;
+		}
+		return;
+	}
+
+	Triangle(center, Add(a.x, a.y, color), Add(b.x, b.y, color));
+}
+
+ShapeBatch& ShapeBatch::DrawLines(const FPoint* points, int count, float thickness, const Colour& color, Join join, bool closed) {
+	if (count < 2 || thickness <= 0) return *this;
+	float half = thickness / 2;
+
+	// A quad along each segment, with the corners between them filled by joins
+	int segments = closed ? count : count - 1;
+	for (int i = 0; i < segments; i++) {
+		const FPoint& a = points[i];
+		const FPoint& b = points[(i + 1) % count];
+		FPoint n = Normal(FPoint(b.x - a.x, b.y - a.y));
+		if (n.x == 0 && n.y == 0) continue;
+
+		n = FPoint(n.x * half, n.y * half);
+		int first = Add(a.x + n.x, a.y + n.y, color);
+		Add(b.x + n.x, b.y + n.y, color);
+		Add(b.x - n.x, b.y - n.y, color);
+		Add(a.x - n.x, a.y - n.y, color);
+		Triangle(first, first + 1, first + 2);
+		Triangle(first, first + 2, first + 3);
+	}
+
+	for (int i = closed ? 0 : 1; i < (closed ? count : count - 1); i++) {
+		const FPoint& prev = points[(i + count - 1) % count];
+		const FPoint& p = points[i];
+		const FPoint& next = points[(i + 1) % count];
+		AddJoin(p, FPoint(p.x - prev.x, p.y - prev.y), FPoint(next.x - p.x, next.y - p.y), half, join, color);
+	}
+	return *this;
+}
+
+void ShapeBatch::RoundedRect(const FRect& rect, float radius, int segments, const Colour& color) {
+	// Corners clockwise from the top left, each an arc of segments steps
+	const FPoint centers[] = {
+		FPoint(rect.x + radius, rect.y + radius),
+		FPoint(rect.x + rect.w - radius, rect.y + radius),
+		FPoint(rect.x + rect.w - radius, rect.y + rect.h - radius),
+		FPoint(rect.x + radius, rect.y + rect.h - radius)
+	};
+	for (int corner = 0; corner < 4; corner++) {
+		for (int i = 0; i <= segments; i++) {
+			double angle = M_PI * (1 + corner * 0.5 + 0.5 * i / segments);
+			Add(centers[corner].x + radius * (float)std::cos(angle), centers[corner].y + radius * (float)std::sin(angle), color);
+		}
+	}
+}
+
+ShapeBatch& ShapeBatch::FillRoundedRect(const FRect& rect, float radius, const Colour& color, int segments) {
+	if (rect.w <= 0 || rect.h <= 0) return *this;
+	radius = std::min(std::max(radius, 0.0f), std::min(rect.w, rect.h) / 2);
+	segments = Segments(radius, segments, 0.25f);
+
+	int middle = Add(rect.x + rect.w / 2, rect.y + rect.h / 2, color);
+	RoundedRect(rect, radius, segments, color);
+	Fan(middle, middle + 1, 4 * (segments + 1));
+	return *this;
+}
+
+ShapeBatch& ShapeBatch::DrawRoundedRect(const FRect& rect, float radius, float thickness, const Colour& color, int segments) {
+	if (rect.w <= 0 || rect.h <= 0 || thickness <= 0) return *this;
+	float half = thickness / 2;
+	radius = std::min(std::max(radius, 0.0f), std::min(rect.w, rect.h) / 2);
+	segments = Segments(radius + half, segments, 0.25f);
+
+	// The inner edge can shrink to nothing, but keeps as many points as the outer
+	FRect inner(rect.x + half, rect.y + half, std::max(rect.w - thickness, 0.0f), std::max(rect.h - thickness, 0.0f));
+	int outerFirst = (int)vertices.size();
+	RoundedRect(FRect(rect.x - half, rect.y - half, rect.w + thickness, rect.h + thickness), radius + half, segments, color);
+	int innerFirst = (int)vertices.size();
+	RoundedRect(inner, std::min(std::max(radius - half, 0.0f), std::min(inner.w, inner.h) / 2), segments, color);
+	Ring(outerFirst, innerFirst, 4 * (segments + 1));
+	return *this;
+}
+
+size_t ShapeBatch::Size() const { return vertices.size(); }
+
+ShapeBatch& ShapeBatch::Clear() {
+	vertices.clear();
+	indices.clear();
+	return *this;
+}
+
+ShapeBatch& ShapeBatch::Flush() {
+	drawCalls = 0;
+	if (indices.empty()) return Clear();
+
+	SDLPP_PROFILE_ZONE("ShapeBatch::Flush");
+	renderer.SetDrawBlendMode(blendMode);
+	renderer.Geometry(vertices, indices);
+	error |= renderer.error;
+	drawCalls = 1;
+	return Clear();
+}
+#endif
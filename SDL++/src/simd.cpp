@@ -0,0 +1,641 @@
+#include "simd.hpp"
+#include <string.h>
+#include <SDL_cpuinfo.h>
+#include <SDL_error.h>
+#include <SDL_version.h>
+
+#if defined(SDLPP_SIMD_X86)
+#include <immintrin.h>
+#elif defined(SDLPP_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace SDL;
+using namespace SDL::SIMD;
+
+// Rounded c * a / 255, exact for all 8 bit inputs
+static inline Uint8 MulDiv255(unsigned c, unsigned a) {
+	unsigned t = c * a + 128;
+	return (Uint8)((t + (t >> 8)) >> 8);
+}
+
+//
+// Scalar kernels, also used for the tails of the vector ones
+//
+
+static void Shuffle32Scalar(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	for (int i = 0; i < count; i++, src += 4, dst += 4) {
+		Uint8 p[4] = { src[0], src[1], src[2], src[3] };
+		for (int d = 0; d < 4; d++) dst[d] = order[d] < 4 ? p[order[d]] : 0xFF;
+	}
+}
+
+static void Expand24To32Scalar(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	for (int i = 0; i < count; i++, src += 3, dst += 4)
+		for (int d = 0; d < 4; d++) dst[d] = order[d] < 3 ? src[order[d]] : 0xFF;
+}
+
+static void Pack32To24Scalar(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	for (int i = 0; i < count; i++, src += 4, dst += 3) {
+		Uint8 p[4] = { src[0], src[1], src[2], src[3] };
+		for (int d = 0; d < 3; d++) dst[d] = p[order[d]];
+	}
+}
+
+static void Premultiply32Scalar(Uint8* pixels, int count, int alphaByte) {
+	for (int i = 0; i < count; i++, pixels += 4) {
+		unsigned a = pixels[alphaByte];
+		for (int c = 0; c < 4; c++)
+			if (c != alphaByte) pixels[c] = MulDiv255(pixels[c], a);
+	}
+}
+
+static void Fill32Scalar(Uint8* dst, int count, Uint32 color) {
+	Uint32* p = (Uint32*)dst;
+	for (int i = 0; i < count; i++) p[i] = color;
+}
+
+static void Palette4x4Scalar(const Uint32* palette, Uint32 indices, Uint8* dst, int pitch) {
+	for (int y = 0; y < 4; y++, dst += pitch) {
+		Uint32* row = (Uint32*)dst;
+		for (int x = 0; x < 4; x++, indices >>= 2) row[x] = palette[indices & 3];
+	}
+}
+
+#if defined(SDLPP_SIMD_X86) || (defined(SDLPP_SIMD_NEON) && defined(__aarch64__))
+// Byte shuffle controls that pick 4 pixels from a palette of 4, for every byte of 2 bit indices
+static const Uint8* PaletteControls() {
+	static const struct Table {
+		Uint8 control[256][16];
+		Table() {
+			for (int b = 0; b < 256; b++)
+				for (int p = 0; p < 4; p++)
+					for (int c = 0; c < 4; c++) control[b][p * 4 + c] = (Uint8)(((b >> (p * 2)) & 3) * 4 + c);
+		}
+	} table;
+	return &table.control[0][0];
+}
+#endif
+
+#ifdef SDLPP_SIMD_X86
+
+//
+// SSE2: byte moves are done with 32 bit shifts, as there is no byte shuffle
+//
+
+SDLPP_TARGET("sse2") static void Shuffle32SSE2(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	__m128i right[4], left[4], mask[4];
+	Uint32 constant = 0;
+	for (int d = 0; d < 4; d++) {
+		int shift = order[d] < 4 ? 8 * (order[d] - d) : 0;
+		right[d] = _mm_cvtsi32_si128(shift > 0 ? shift : 0);
+		left[d] = _mm_cvtsi32_si128(shift < 0 ? -shift : 0);
+		mask[d] = _mm_set1_epi32(order[d] < 4 ? (int)(0xFFu << (8 * d)) : 0);
+		if (order[d] >= 4) constant |= 0xFFu << (8 * d);
+	}
+	__m128i fill = _mm_set1_epi32((int)constant);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		__m128i r = fill;
+		for (int d = 0; d < 4; d++)
+			r = _mm_or_si128(r, _mm_and_si128(_mm_sll_epi32(_mm_srl_epi32(x, right[d]), left[d]), mask[d]));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), r);
+	}
+	Shuffle32Scalar(src + i * 4, dst + i * 4, count - i, order);
+}
+
+SDLPP_TARGET("sse2") static void Premultiply32SSE2(Uint8* pixels, int count, int alphaByte) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(128);
+	const __m128i byte = _mm_set1_epi32(0xFF);
+	const __m128i shift = _mm_cvtsi32_si128(8 * alphaByte);
+	// Keeps alpha unchanged by multiplying it by 255 instead of itself
+	Uint16 keep[8] = { 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF };
+	Uint16 opaque[8] = { 0 };
+	keep[alphaByte] = keep[alphaByte + 4] = 0;
+	opaque[alphaByte] = opaque[alphaByte + 4] = 255;
+	const __m128i keepMask = _mm_loadu_si128((const __m128i*)keep);
+	const __m128i opaqueMask = _mm_loadu_si128((const __m128i*)opaque);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+		// Alpha broadcast to every 16 bit channel of its pixel
+		__m128i a = _mm_and_si128(_mm_srl_epi32(x, shift), byte);
+		a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+		__m128i alo = _mm_or_si128(_mm_and_si128(_mm_unpacklo_epi32(a, a), keepMask), opaqueMask);
+		__m128i ahi = _mm_or_si128(_mm_and_si128(_mm_unpackhi_epi32(a, a), keepMask), opaqueMask);
+
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), alo), round);
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), ahi), round);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+		_mm_storeu_si128((__m128i*)(pixels + i * 4), _mm_packus_epi16(lo, hi));
+	}
+	Premultiply32Scalar(pixels + i * 4, count - i, alphaByte);
+}
+
+SDLPP_TARGET("sse2") static void Fill32SSE2(Uint8* dst, int count, Uint32 color) {
+	const __m128i c = _mm_set1_epi32((int)color);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(dst + i * 4), c);
+	Fill32Scalar(dst + i * 4, count - i, color);
+}
+
+//
+// SSE4.1: byte shuffles through pshufb
+//
+
+// Builds a pshufb control for 4 pixels and the constant bytes to OR in after it
+static void ShuffleControl(const Uint8* order, int srcBytes, int dstBytes, int dstChannels, Uint8* control, Uint8* constant) {
+	memset(control, 0x80, 16);
+	memset(constant, 0, 16);
+	for (int p = 0; p < 4; p++)
+		for (int d = 0; d < dstChannels; d++) {
+			if (order[d] < srcBytes) control[p * dstBytes + d] = (Uint8)(p * srcBytes + order[d]);
+			else constant[p * dstBytes + d] = 0xFF;
+		}
+}
+
+SDLPP_TARGET("sse4.1") static void Shuffle32SSE41(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	Uint8 control[16], constant[16];
+	ShuffleControl(order, 4, 4, 4, control, constant);
+	const __m128i c = _mm_loadu_si128((const __m128i*)control);
+	const __m128i k = _mm_loadu_si128((const __m128i*)constant);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(x, c), k));
+	}
+	Shuffle32Scalar(src + i * 4, dst + i * 4, count - i, order);
+}
+
+SDLPP_TARGET("sse4.1") static void Expand24To32SSE41(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	Uint8 control[16], constant[16];
+	ShuffleControl(order, 3, 4, 4, control, constant);
+	const __m128i c = _mm_loadu_si128((const __m128i*)control);
+	const __m128i k = _mm_loadu_si128((const __m128i*)constant);
+
+	// Each step reads 16 bytes to use 12, so stop while 16 are still left
+	int i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(src + i * 3));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(x, c), k));
+	}
+	Expand24To32Scalar(src + i * 3, dst + i * 4, count - i, order);
+}
+
+SDLPP_TARGET("sse4.1") static void Pack32To24SSE41(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	Uint8 control[16], constant[16];
+	ShuffleControl(order, 4, 3, 3, control, constant);
+	const __m128i c = _mm_loadu_si128((const __m128i*)control);
+
+	// Each step writes 16 bytes of which only 12 are kept, so stop while 16 are still left
+	int i = 0;
+	for (; i + 6 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		_mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(x, c));
+	}
+	Pack32To24Scalar(src + i * 4, dst + i * 3, count - i, order);
+}
+
+SDLPP_TARGET("sse4.1") static void Palette4x4SSE41(const Uint32* palette, Uint32 indices, Uint8* dst, int pitch) {
+	const Uint8* controls = PaletteControls();
+	const __m128i p = _mm_loadu_si128((const __m128i*)palette);
+	for (int y = 0; y < 4; y++, dst += pitch, indices >>= 8)
+		_mm_storeu_si128((__m128i*)dst, _mm_shuffle_epi8(p, _mm_loadu_si128((const __m128i*)(controls + (indices & 0xFF) * 16))));
+}
+
+//
+// AVX2: the SSE kernels on twice the pixels
+//
+
+SDLPP_TARGET("avx2") static void Shuffle32AVX2(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	Uint8 control[16], constant[16];
+	ShuffleControl(order, 4, 4, 4, control, constant);
+	const __m256i c = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)control));
+	const __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)constant));
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(x, c), k));
+	}
+	Shuffle32Scalar(src + i * 4, dst + i * 4, count - i, order);
+}
+
+SDLPP_TARGET("avx2") static void Expand24To32AVX2(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	Uint8 control[16], constant[16];
+	ShuffleControl(order, 3, 4, 4, control, constant);
+	const __m256i c = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)control));
+	const __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)constant));
+
+	// pshufb works within each 128 bit lane, so each lane gets its own 4 pixels
+	int i = 0;
+	for (; i + 10 <= count; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(src + i * 3));
+		__m128i b = _mm_loadu_si128((const __m128i*)(src + i * 3 + 12));
+		__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(x, c), k));
+	}
+	Expand24To32SSE41(src + i * 3, dst + i * 4, count - i, order);
+}
+
+SDLPP_TARGET("avx2") static void Premultiply32AVX2(Uint8* pixels, int count, int alphaByte) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i round = _mm256_set1_epi16(128);
+	const __m256i byte = _mm256_set1_epi32(0xFF);
+	const __m128i shift = _mm_cvtsi32_si128(8 * alphaByte);
+	Uint16 keep[16], opaque[16];
+	for (int j = 0; j < 16; j++) {
+		keep[j] = (j & 3) == alphaByte ? 0 : 0xFFFF;
+		opaque[j] = (j & 3) == alphaByte ? 255 : 0;
+	}
+	const __m256i keepMask = _mm256_loadu_si256((const __m256i*)keep);
+	const __m256i opaqueMask = _mm256_loadu_si256((const __m256i*)opaque);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(pixels + i * 4));
+		__m256i a = _mm256_and_si256(_mm256_srl_epi32(x, shift), byte);
+		a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+		__m256i alo = _mm256_or_si256(_mm256_and_si256(_mm256_unpacklo_epi32(a, a), keepMask), opaqueMask);
+		__m256i ahi = _mm256_or_si256(_mm256_and_si256(_mm256_unpackhi_epi32(a, a), keepMask), opaqueMask);
+
+		__m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(x, zero), alo), round);
+		__m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(x, zero), ahi), round);
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+		_mm256_storeu_si256((__m256i*)(pixels + i * 4), _mm256_packus_epi16(lo, hi));
+	}
+	Premultiply32SSE2(pixels + i * 4, count - i, alphaByte);
+}
+
+SDLPP_TARGET("avx") static void Fill32AVX2(Uint8* dst, int count, Uint32 color) {
+	const __m256i c = _mm256_set1_epi32((int)color);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) _mm256_storeu_si256((__m256i*)(dst + i * 4), c);
+	Fill32SSE2(dst + i * 4, count - i, color);
+}
+
+#endif
+
+#ifdef SDLPP_SIMD_NEON
+
+//
+// NEON: vld3/vld4 split pixels into one register per byte, which makes any order cheap
+//
+
+static void Shuffle32NEON(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	const uint8x16_t opaque = vdupq_n_u8(0xFF);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x4_t in = vld4q_u8(src + i * 4), out;
+		for (int d = 0; d < 4; d++) out.val[d] = order[d] < 4 ? in.val[order[d]] : opaque;
+		vst4q_u8(dst + i * 4, out);
+	}
+	Shuffle32Scalar(src + i * 4, dst + i * 4, count - i, order);
+}
+
+static void Expand24To32NEON(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	const uint8x16_t opaque = vdupq_n_u8(0xFF);
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x3_t in = vld3q_u8(src + i * 3);
+		uint8x16x4_t out;
+		for (int d = 0; d < 4; d++) out.val[d] = order[d] < 3 ? in.val[order[d]] : opaque;
+		vst4q_u8(dst + i * 4, out);
+	}
+	Expand24To32Scalar(src + i * 3, dst + i * 4, count - i, order);
+}
+
+static void Pack32To24NEON(const Uint8* src, Uint8* dst, int count, const Uint8* order) {
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x4_t in = vld4q_u8(src + i * 4);
+		uint8x16x3_t out;
+		for (int d = 0; d < 3; d++) out.val[d] = in.val[order[d]];
+		vst3q_u8(dst + i * 3, out);
+	}
+	Pack32To24Scalar(src + i * 4, dst + i * 3, count - i, order);
+}
+
+static inline uint8x8_t MulDiv255NEON(uint8x8_t c, uint8x8_t a) {
+	uint16x8_t t = vmull_u8(c, a);
+	return vrshrn_n_u16(vrsraq_n_u16(t, t, 8), 8);
+}
+
+static void Premultiply32NEON(Uint8* pixels, int count, int alphaByte) {
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x4_t x = vld4q_u8(pixels + i * 4);
+		uint8x16_t a = x.val[alphaByte];
+		for (int c = 0; c < 4; c++) {
+			if (c == alphaByte) continue;
+			x.val[c] = vcombine_u8(MulDiv255NEON(vget_low_u8(x.val[c]), vget_low_u8(a)),
+				MulDiv255NEON(vget_high_u8(x.val[c]), vget_high_u8(a)));
+		}
+		vst4q_u8(pixels + i * 4, x);
+	}
+	Premultiply32Scalar(pixels + i * 4, count - i, alphaByte);
+}
+
+static void Fill32NEON(Uint8* dst, int count, Uint32 color) {
+	const uint32x4_t c = vdupq_n_u32(color);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) vst1q_u32((uint32_t*)(dst + i * 4), c);
+	Fill32Scalar(dst + i * 4, count - i, color);
+}
+
+#ifdef __aarch64__
+static void Palette4x4NEON(const Uint32* palette, Uint32 indices, Uint8* dst, int pitch) {
+	const Uint8* controls = PaletteControls();
+	const uint8x16_t p = vld1q_u8((const Uint8*)palette);
+	for (int y = 0; y < 4; y++, dst += pitch, indices >>= 8)
+		vst1q_u8(dst, vqtbl1q_u8(p, vld1q_u8(controls + (indices & 0xFF) * 16)));
+}
+#else
+#define Palette4x4NEON Palette4x4Scalar
+#endif
+
+#endif
+
+//
+// Dispatch
+//
+
+namespace {
+	struct Kernels {
+		void (*shuffle32)(const Uint8*, Uint8*, int, const Uint8*);
+		void (*expand24To32)(const Uint8*, Uint8*, int, const Uint8*);
+		void (*pack32To24)(const Uint8*, Uint8*, int, const Uint8*);
+		void (*premultiply32)(Uint8*, int, int);
+		void (*fill32)(Uint8*, int, Uint32);
+		void (*palette4x4)(const Uint32*, Uint32, Uint8*, int);
+	};
+}
+
+static const Kernels scalarKernels = { Shuffle32Scalar, Expand24To32Scalar, Pack32To24Scalar, Premultiply32Scalar, Fill32Scalar, Palette4x4Scalar };
+#ifdef SDLPP_SIMD_X86
+static const Kernels sse2Kernels = { Shuffle32SSE2, Expand24To32Scalar, Pack32To24Scalar, Premultiply32SSE2, Fill32SSE2, Palette4x4Scalar };
+static const Kernels sse41Kernels = { Shuffle32SSE41, Expand24To32SSE41, Pack32To24SSE41, Premultiply32SSE2, Fill32SSE2, Palette4x4SSE41 };
+static const Kernels avx2Kernels = { Shuffle32AVX2, Expand24To32AVX2, Pack32To24SSE41, Premultiply32AVX2, Fill32AVX2, Palette4x4SSE41 };
+#endif
+#ifdef SDLPP_SIMD_NEON
+static const Kernels neonKernels = { Shuffle32NEON, Expand24To32NEON, Pack32To24NEON, Premultiply32NEON, Fill32NEON, Palette4x4NEON };
+#endif
+
+static const Kernels& KernelsFor(Level level) {
+	switch (level) {
+#ifdef SDLPP_SIMD_X86
+	case Level::AVX2: return avx2Kernels;
+	case Level::SSE41: return sse41Kernels;
+	case Level::SSE2: return sse2Kernels;
+#endif
+#ifdef SDLPP_SIMD_NEON
+	case Level::NEON: return neonKernels;
+#endif
+	default: return scalarKernels;
+	}
+}
+
+static bool Supported(Level level) {
+	switch (level) {
+	case Level::SCALAR: return true;
+#ifdef SDLPP_SIMD_X86
+	case Level::SSE2: return SDL_HasSSE2() == SDL_TRUE;
+	case Level::SSE41: return SDL_HasSSE41() == SDL_TRUE;
+	case Level::AVX2: return SDL_HasAVX2() == SDL_TRUE;
+#endif
+#ifdef SDLPP_SIMD_NEON
+	case Level::NEON: return SDL_HasNEON() == SDL_TRUE;
+#endif
+	default: return false;
+	}
+}
+
+static Level& CurrentLevel() {
+	static Level level = GetSupportedLevel();
+	return level;
+}
+
+static const Kernels& Current() { return KernelsFor(CurrentLevel()); }
+
+Level SIMD::GetSupportedLevel() {
+	const Level levels[] = { Level::AVX2, Level::SSE41, Level::SSE2, Level::NEON };
+	for (Level level : levels)
+		if (Supported(level)) return level;
+	return Level::SCALAR;
+}
+
+Level SIMD::GetLevel() { return CurrentLevel(); }
+
+bool SIMD::SetLevel(Level level) {
+	if (!Supported(level)) return false;
+	CurrentLevel() = level;
+	return true;
+}
+
+const char* SIMD::GetLevelName(Level level) {
+	switch (level) {
+	case Level::SSE2: return "SSE2";
+	case Level::SSE41: return "SSE4.1";
+	case Level::AVX2: return "AVX2";
+	case Level::NEON: return "NEON";
+	default: return "scalar";
+	}
+}
+
+void SIMD::Shuffle32(const void* src, void* dst, int count, const Uint8 order[4]) { Current().shuffle32((const Uint8*)src, (Uint8*)dst, count, order); }
+void SIMD::Expand24To32(const void* src, void* dst, int count, const Uint8 order[4]) { Current().expand24To32((const Uint8*)src, (Uint8*)dst, count, order); }
+void SIMD::Pack32To24(const void* src, void* dst, int count, const Uint8 order[3]) { Current().pack32To24((const Uint8*)src, (Uint8*)dst, count, order); }
+void SIMD::Premultiply32(void* pixels, int count, int alphaByte) { Current().premultiply32((Uint8*)pixels, count, alphaByte); }
+void SIMD::Fill32(void* dst, int count, Uint32 color) { Current().fill32((Uint8*)dst, count, color); }
+void SIMD::Palette4x4(const Uint32 palette[4], Uint32 indices, void* dst, int pitch) { Current().palette4x4(palette, indices, (Uint8*)dst, pitch); }
+
+//
+// Surfaces
+//
+
+namespace {
+	// Where each channel of an 8 bit per channel format lives in memory
+	struct Layout {
+		int bytes;
+		// The byte of R, G, B and A, or -1 if the format does not have it
+		int channel[4];
+	};
+}
+
+static bool GetLayout(Uint32 format, Layout& layout) {
+	if (SDL_ISPIXELFORMAT_FOURCC(format) || SDL_ISPIXELFORMAT_INDEXED(format)) return false;
+	layout.bytes = SDL_BYTESPERPIXEL(format);
+	if (layout.bytes != 3 && layout.bytes != 4) return false;
+
+	int bpp;
+	Uint32 masks[4];
+	if (!SDL_PixelFormatEnumToMasks(format, &bpp, &masks[0], &masks[1], &masks[2], &masks[3])) return false;
+	for (int c = 0; c < 4; c++) {
+		layout.channel[c] = -1;
+		if (masks[c] == 0) continue;
+		int shift = 0;
+		while (shift < 32 && (masks[c] >> shift) != 0xFF) shift += 8;
+		if (shift == 32) return false;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		layout.channel[c] = shift / 8;
+#else
+		layout.channel[c] = layout.bytes - 1 - shift / 8;
+#endif
+	}
+	return layout.channel[0] >= 0 && layout.channel[1] >= 0 && layout.channel[2] >= 0;
+}
+
+// The byte order taking pixels of layout src to layout dst
+static void GetOrder(const Layout& src, const Layout& dst, Uint8* order) {
+	for (int d = 0; d < dst.bytes; d++) {
+		order[d] = OPAQUE_BYTE;
+		for (int c = 0; c < 4; c++)
+			if (dst.channel[c] == d && src.channel[c] >= 0) order[d] = (Uint8)src.channel[c];
+	}
+}
+
+static void ConvertRow(const Layout& src, const Layout& dst, const Uint8* order, const void* from, void* to, int count) {
+	if (src.bytes == 4 && dst.bytes == 4) Shuffle32(from, to, count, order);
+	else if (src.bytes == 3 && dst.bytes == 4) Expand24To32(from, to, count, order);
+	else if (src.bytes == 4 && dst.bytes == 3) Pack32To24(from, to, count, order);
+	else {
+		const Uint8* s = (const Uint8*)from;
+		Uint8* d = (Uint8*)to;
+		for (int i = 0; i < count; i++, s += 3, d += 3) {
+			Uint8 p[3] = { s[0], s[1], s[2] };
+			for (int j = 0; j < 3; j++) d[j] = p[order[j]];
+		}
+	}
+}
+
+static void ConvertRows(const Layout& src, const Layout& dst, int width, int height, const Uint8* from, int src_pitch, Uint8* to, int dst_pitch) {
+	Uint8 order[4];
+	GetOrder(src, dst, order);
+	bool same = memcmp(&src, &dst, sizeof(Layout)) == 0;
+	for (int y = 0; y < height; y++, from += src_pitch, to += dst_pitch) {
+		if (same) memmove(to, from, (size_t)width * dst.bytes);
+		else ConvertRow(src, dst, order, from, to, width);
+	}
+}
+
+bool SIMD::CanConvert(Uint32 src_format, Uint32 dst_format) {
+	Layout src, dst;
+	return GetLayout(src_format, src) && GetLayout(dst_format, dst);
+}
+
+int SIMD::ConvertPixels(int width, int height, Uint32 src_format, const void* src, int src_pitch, Uint32 dst_format, void* dst, int dst_pitch) {
+	Layout from, to;
+	if (!GetLayout(src_format, from) || !GetLayout(dst_format, to))
+		return SDL_ConvertPixels(width, height, src_format, src, src_pitch, dst_format, dst, dst_pitch);
+	ConvertRows(from, to, width, height, (const Uint8*)src, src_pitch, (Uint8*)dst, dst_pitch);
+	return 0;
+}
+
+SDL_Surface* SIMD::ConvertSurfaceFormat(SDL_Surface* surface, Uint32 pixel_format, Uint32 flags) {
+	Layout from, to;
+	if (surface == NULL || flags != 0 || SDL_HasColorKey(surface) || SDL_MUSTLOCK(surface)
+		|| !GetLayout(surface->format->format, from) || !GetLayout(pixel_format, to))
+		return SDL_ConvertSurfaceFormat(surface, pixel_format, flags);
+
+	SDL_Surface* converted = SDL_CreateRGBSurfaceWithFormat(0, surface->w, surface->h, SDL_BITSPERPIXEL(pixel_format), pixel_format);
+	if (converted == NULL) return NULL;
+	ConvertRows(from, to, surface->w, surface->h, (const Uint8*)surface->pixels, surface->pitch, (Uint8*)converted->pixels, converted->pitch);
+
+	// Carry over what SDL_ConvertSurface() would
+	Uint8 r, g, b, a;
+	SDL_BlendMode blendMode;
+	SDL_GetSurfaceColorMod(surface, &r, &g, &b);
+	SDL_SetSurfaceColorMod(converted, r, g, b);
+	SDL_GetSurfaceAlphaMod(surface, &a);
+	SDL_SetSurfaceAlphaMod(converted, a);
+	SDL_GetSurfaceBlendMode(surface, &blendMode);
+	SDL_SetSurfaceBlendMode(converted, blendMode);
+	SDL_SetClipRect(converted, &surface->clip_rect);
+	return converted;
+}
+
+int SIMD::PremultiplyAlpha(SDL_Surface* surface) {
+	Layout layout;
+	if (surface == NULL) return SDL_SetError("Parameter '%s' is invalid", "surface");
+	if (!GetLayout(surface->format->format, layout) || layout.bytes != 4 || layout.channel[3] < 0) {
+#if SDL_VERSION_ATLEAST(2,0,18)
+		Uint32 format = surface->format->format;
+		return SDL_PremultiplyAlpha(surface->w, surface->h, format, surface->pixels, surface->pitch, format, surface->pixels, surface->pitch);
+#else
+		return SDL_SetError("Premultiplying this pixel format is not supported");
+#endif
+	}
+
+	if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0) return -1;
+	Uint8* row = (Uint8*)surface->pixels;
+	for (int y = 0; y < surface->h; y++, row += surface->pitch)
+		Premultiply32(row, surface->w, layout.channel[3]);
+	if (SDL_MUSTLOCK(surface)) SDL_UnlockSurface(surface);
+	return 0;
+}
+
+int SIMD::FillRects(SDL_Surface* dst, const SDL_Rect* rects, int count, Uint32 color) {
+	if (dst == NULL || dst->format->BytesPerPixel != 4 || SDL_MUSTLOCK(dst) || dst->pixels == NULL) {
+		if (rects == NULL) return SDL_FillRect(dst, NULL, color);
+		return SDL_FillRects(dst, rects, count, color);
+	}
+
+	if (rects == NULL) {
+		rects = &dst->clip_rect;
+		count = 1;
+	}
+	for (int i = 0; i < count; i++) {
+		SDL_Rect clipped;
+		if (!SDL_IntersectRect(&rects[i], &dst->clip_rect, &clipped)) continue;
+		Uint8* row = (Uint8*)dst->pixels + clipped.y * dst->pitch + clipped.x * 4;
+		for (int y = 0; y < clipped.h; y++, row += dst->pitch) Fill32(row, clipped.w, color);
+	}
+	return 0;
+}
+
+int SIMD::BlitSurface(SDL_Surface* src, const SDL_Rect* srcrect, SDL_Surface* dst, SDL_Rect* dstrect) {
+	Layout from, to;
+	Uint8 r, g, b, a;
+	SDL_BlendMode blendMode;
+	if (src == NULL || dst == NULL || src == dst || SDL_MUSTLOCK(src) || SDL_MUSTLOCK(dst)
+		|| src->pixels == NULL || dst->pixels == NULL || SDL_HasColorKey(src)
+		|| SDL_GetSurfaceBlendMode(src, &blendMode) != 0 || blendMode != SDL_BLENDMODE_NONE
+		|| SDL_GetSurfaceColorMod(src, &r, &g, &b) != 0 || (r & g & b) != 255
+		|| SDL_GetSurfaceAlphaMod(src, &a) != 0 || a != 255
+		|| !GetLayout(src->format->format, from) || !GetLayout(dst->format->format, to))
+		return SDL_BlitSurface(src, srcrect, dst, dstrect);
+
+	// Clip the same way SDL_UpperBlit() does
+	SDL_Rect s = srcrect != NULL ? *srcrect : SDL_Rect{ 0, 0, src->w, src->h };
+	int dx = dstrect != NULL ? dstrect->x : 0;
+	int dy = dstrect != NULL ? dstrect->y : 0;
+	if (s.x < 0) { dx -= s.x; s.w += s.x; s.x = 0; }
+	if (s.y < 0) { dy -= s.y; s.h += s.y; s.y = 0; }
+	if (s.x + s.w > src->w) s.w = src->w - s.x;
+	if (s.y + s.h > src->h) s.h = src->h - s.y;
+
+	const SDL_Rect& clip = dst->clip_rect;
+	int over = clip.x - dx;
+	if (over > 0) { s.x += over; s.w -= over; dx += over; }
+	over = dx + s.w - clip.x - clip.w;
+	if (over > 0) s.w -= over;
+	over = clip.y - dy;
+	if (over > 0) { s.y += over; s.h -= over; dy += over; }
+	over = dy + s.h - clip.y - clip.h;
+	if (over > 0) s.h -= over;
+
+	if (dstrect != NULL) *dstrect = { dx, dy, s.w > 0 ? s.w : 0, s.h > 0 ? s.h : 0 };
+	if (s.w <= 0 || s.h <= 0) return 0;
+
+	ConvertRows(from, to, s.w, s.h,
+		(const Uint8*)src->pixels + s.y * src->pitch + s.x * from.bytes, src->pitch,
+		(Uint8*)dst->pixels + dy * dst->pitch + dx * to.bytes, dst->pitch);
+	return 0;
+}
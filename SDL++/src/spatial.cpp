@@ -0,0 +1,360 @@
+#include "spatial.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace SDL;
+
+typedef SpatialIndex::ID ID;
+
+static FRect Union(const FRect& a, const FRect& b) {
+	float x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+	float x1 = std::max(a.x + a.w, b.x + b.w), y1 = std::max(a.y + a.h, b.y + b.h);
+	return FRect(x0, y0, x1 - x0, y1 - y0);
+}
+
+static bool Encloses(const FRect& outer, const FRect& inner) {
+	return outer.x <= inner.x && outer.y <= inner.y
+		&& outer.x + outer.w >= inner.x + inner.w && outer.y + outer.h >= inner.y + inner.h;
+}
+
+// Whether the segment origin + t * dir, t in [0, tMax], passes through the box
+static bool SegmentHitsBox(const FPoint& origin, const FPoint& dir, const FRect& box, float tMax) {
+	float t0 = 0, t1 = tMax;
+	const float o[2] = { origin.x, origin.y }, d[2] = { dir.x, dir.y };
+	const float lo[2] = { box.x, box.y }, hi[2] = { box.x + box.w, box.y + box.h };
+	for (int i = 0; i < 2; i++) {
+		if (d[i] == 0) {
+			if (o[i] < lo[i] || o[i] > hi[i]) return false;
+			continue;
+		}
+		float inv = 1.0f / d[i];
+		float n = (lo[i] - o[i]) * inv, f = (hi[i] - o[i]) * inv;
+		if (n > f) std::swap(n, f);
+		t0 = std::max(t0, n);
+		t1 = std::min(t1, f);
+		if (t0 > t1) return false;
+	}
+	return true;
+}
+
+static Uint64 CellKey(int x, int y) { return ((Uint64)(Uint32)x << 32) | (Uint32)y; }
+
+SpatialIndex::SpatialIndex(Mode mode, float cellSize) : mode(mode), cellSize(cellSize > 0 ? cellSize : 1) {}
+
+void SpatialIndex::Insert(ID id, const FRect& rect) {
+	if (Move(id, rect)) return;
+
+	Entry& entry = entries[id];
+	entry.rect = rect;
+	if (mode == Mode::GRID) GridAdd(id, entry);
+	else {
+		entry.node = AllocateNode();
+		Node& node = nodes[entry.node];
+		node.id = id;
+		node.box = FRect(rect.x - cellSize, rect.y - cellSize, rect.w + 2 * cellSize, rect.h + 2 * cellSize);
+		TreeInsert(entry.node);
+	}
+}
+
+bool SpatialIndex::Move(ID id, const FRect& rect) {
+	auto it = entries.find(id);
+	if (it == entries.end()) return false;
+	Entry& entry = it->second;
+	entry.rect = rect;
+
+	if (mode == Mode::GRID) {
+		int x0, y0, x1, y1;
+		CellRange(rect, x0, y0, x1, y1);
+		if (x0 != entry.x0 || y0 != entry.y0 || x1 != entry.x1 || y1 != entry.y1) {
+			GridRemove(id, entry);
+			GridAdd(id, entry);
+		}
+	}
+	else if (!Encloses(nodes[entry.node].box, rect)) {
+		TreeRemove(entry.node);
+		nodes[entry.node].box = FRect(rect.x - cellSize, rect.y - cellSize, rect.w + 2 * cellSize, rect.h + 2 * cellSize);
+		TreeInsert(entry.node);
+	}
+	return true;
+}
+
+bool SpatialIndex::Remove(ID id) {
+	auto it = entries.find(id);
+	if (it == entries.end()) return false;
+	if (mode == Mode::GRID) GridRemove(id, it->second);
+	else {
+		TreeRemove(it->second.node);
+		FreeNode(it->second.node);
+	}
+	entries.erase(it);
+	return true;
+}
+
+void SpatialIndex::Clear() {
+	entries.clear();
+	cells.clear();
+	nodes.clear();
+	root = -1;
+	freeNode = -1;
+}
+
+bool SpatialIndex::Contains(ID id) const { return entries.find(id) != entries.end(); }
+const FRect& SpatialIndex::Get(ID id) const { return entries.at(id).rect; }
+size_t SpatialIndex::Size() const { return entries.size(); }
+
+Uint32 SpatialIndex::NextStamp() const {
+	if (++stamp == 0) {
+		// Wrapped around; old stamps could now look current
+		for (auto& entry : entries) entry.second.stamp = 0;
+		stamp = 1;
+	}
+	return stamp;
+}
+
+bool SpatialIndex::Visit(const Entry& entry) const {
+	if (entry.stamp == stamp) return false;
+	entry.stamp = stamp;
+	return true;
+}
+
+bool SpatialIndex::TestRay(const Ray& ray, ID id, const Entry& entry, Hit& hit) const {
+	Ray test(ray.origin, ray.dir);
+	if (!test.intersectRect(entry.rect) || test.hit.time < 0) return false;
+	if (hit.contact.contact && test.hit.time >= hit.contact.time) return false;
+	hit.id = id;
+	hit.contact = test.hit;
+	return true;
+}
+
+void SpatialIndex::Query(const FRect& region, std::vector<ID>& result) const {
+	if (mode == Mode::GRID) {
+		NextStamp();
+		int x0, y0, x1, y1;
+		CellRange(region, x0, y0, x1, y1);
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++) {
+				auto cell = cells.find(CellKey(x, y));
+				if (cell == cells.end()) continue;
+				for (ID id : cell->second) {
+					const Entry& entry = entries.find(id)->second;
+					if (Visit(entry) && entry.rect.intersectsRect(region)) result.push_back(id);
+				}
+			}
+		return;
+	}
+
+	if (root == -1) return;
+	std::vector<int> stack(1, root);
+	while (!stack.empty()) {
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		if (!node.box.intersectsRect(region)) continue;
+		if (node.Leaf()) {
+			if (entries.find(node.id)->second.rect.intersectsRect(region)) result.push_back(node.id);
+		}
+		else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+}
+
+void SpatialIndex::QueryPairs(std::vector<std::pair<ID, ID>>& pairs) const {
+	std::vector<ID> found;
+	for (auto& entry : entries) {
+		found.clear();
+		Query(entry.second.rect, found);
+		for (ID other : found)
+			if (entry.first < other) pairs.emplace_back(entry.first, other);
+	}
+}
+
+bool SpatialIndex::RayCast(const Ray& ray, Hit& hit) const {
+	hit = Hit();
+	if (entries.empty() || (ray.dir.x == 0 && ray.dir.y == 0)) return false;
+	return mode == Mode::GRID ? GridRayCast(ray, hit) : TreeRayCast(ray, hit);
+}
+
+//
+// Grid
+//
+
+void SpatialIndex::CellRange(const FRect& rect, int& x0, int& y0, int& x1, int& y1) const {
+	x0 = (int)std::floor(rect.x / cellSize);
+	y0 = (int)std::floor(rect.y / cellSize);
+	x1 = (int)std::floor((rect.x + rect.w) / cellSize);
+	y1 = (int)std::floor((rect.y + rect.h) / cellSize);
+}
+
+void SpatialIndex::GridAdd(ID id, Entry& entry) {
+	CellRange(entry.rect, entry.x0, entry.y0, entry.x1, entry.y1);
+	for (int y = entry.y0; y <= entry.y1; y++)
+		for (int x = entry.x0; x <= entry.x1; x++)
+			cells[CellKey(x, y)].push_back(id);
+}
+
+void SpatialIndex::GridRemove(ID id, Entry& entry) {
+	for (int y = entry.y0; y <= entry.y1; y++)
+		for (int x = entry.x0; x <= entry.x1; x++) {
+			auto cell = cells.find(CellKey(x, y));
+			if (cell == cells.end()) continue;
+			std::vector<ID>& ids = cell->second;
+			auto it = std::find(ids.begin(), ids.end(), id);
+			if (it != ids.end()) {
+				*it = ids.back();
+				ids.pop_back();
+			}
+			if (ids.empty()) cells.erase(cell);
+		}
+}
+
+bool SpatialIndex::GridRayCast(const Ray& ray, Hit& hit) const {
+	NextStamp();
+
+	// Walk the cells along the ray (Amanatides & Woo), in units of the ray's length
+	int x = (int)std::floor(ray.origin.x / cellSize);
+	int y = (int)std::floor(ray.origin.y / cellSize);
+	int endX = (int)std::floor((ray.origin.x + ray.dir.x) / cellSize);
+	int endY = (int)std::floor((ray.origin.y + ray.dir.y) / cellSize);
+	int stepX = ray.dir.x > 0 ? 1 : -1;
+	int stepY = ray.dir.y > 0 ? 1 : -1;
+
+	const float inf = INFINITY;
+	float deltaX = ray.dir.x != 0 ? cellSize / std::fabs(ray.dir.x) : inf;
+	float deltaY = ray.dir.y != 0 ? cellSize / std::fabs(ray.dir.y) : inf;
+	float nextX = ray.dir.x != 0 ? ((x + (stepX > 0)) * cellSize - ray.origin.x) / ray.dir.x : inf;
+	float nextY = ray.dir.y != 0 ? ((y + (stepY > 0)) * cellSize - ray.origin.y) / ray.dir.y : inf;
+
+	int steps = std::abs(endX - x) + std::abs(endY - y);
+	for (int i = 0; i <= steps; i++) {
+		auto cell = cells.find(CellKey(x, y));
+		if (cell != cells.end())
+			for (ID id : cell->second) {
+				const Entry& entry = entries.find(id)->second;
+				if (Visit(entry)) TestRay(ray, id, entry, hit);
+			}
+
+		// Any hit in a later cell would be further along than this one
+		float leave = std::min(nextX, nextY);
+		if (hit.contact.contact && hit.contact.time <= leave) break;
+
+		if (nextX < nextY) {
+			x += stepX;
+			nextX += deltaX;
+		}
+		else {
+			y += stepY;
+			nextY += deltaY;
+		}
+	}
+	return hit.contact.contact;
+}
+
+//
+// Tree
+//
+
+int SpatialIndex::AllocateNode() {
+	if (freeNode == -1) {
+		nodes.emplace_back();
+		return (int)nodes.size() - 1;
+	}
+	int node = freeNode;
+	freeNode = nodes[node].parent;
+	nodes[node] = Node();
+	return node;
+}
+
+void SpatialIndex::FreeNode(int node) {
+	nodes[node].parent = freeNode;
+	nodes[node].left = nodes[node].right = -1;
+	freeNode = node;
+}
+
+void SpatialIndex::TreeInsert(int leaf) {
+	if (root == -1) {
+		root = leaf;
+		nodes[leaf].parent = -1;
+		return;
+	}
+
+	// Descend towards the sibling that grows the tree's perimeter the least
+	const FRect box = nodes[leaf].box;
+	int sibling = root;
+	while (!nodes[sibling].Leaf()) {
+		const Node& node = nodes[sibling];
+		float combined = Union(node.box, box).perimeter();
+		// Cost of making a new parent here, and the cost pushed down to the children
+		float here = 2 * combined;
+		float inherited = 2 * (combined - node.box.perimeter());
+
+		float cost[2];
+		int children[2] = { node.left, node.right };
+		for (int i = 0; i < 2; i++) {
+			const Node& child = nodes[children[i]];
+			float grown = Union(child.box, box).perimeter();
+			cost[i] = (child.Leaf() ? grown : grown - child.box.perimeter()) + inherited;
+		}
+		if (here < cost[0] && here < cost[1]) break;
+		sibling = cost[0] < cost[1] ? node.left : node.right;
+	}
+
+	int oldParent = nodes[sibling].parent;
+	int parent = AllocateNode();
+	nodes[parent].parent = oldParent;
+	nodes[parent].box = Union(box, nodes[sibling].box);
+	nodes[parent].left = sibling;
+	nodes[parent].right = leaf;
+	nodes[sibling].parent = parent;
+	nodes[leaf].parent = parent;
+
+	if (oldParent == -1) root = parent;
+	else if (nodes[oldParent].left == sibling) nodes[oldParent].left = parent;
+	else nodes[oldParent].right = parent;
+
+	// Refit the ancestors
+	for (int node = oldParent; node != -1; node = nodes[node].parent)
+		nodes[node].box = Union(nodes[nodes[node].left].box, nodes[nodes[node].right].box);
+}
+
+void SpatialIndex::TreeRemove(int leaf) {
+	if (leaf == root) {
+		root = -1;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandparent = nodes[parent].parent;
+	int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+	if (grandparent == -1) {
+		root = sibling;
+		nodes[sibling].parent = -1;
+	}
+	else {
+		if (nodes[grandparent].left == parent) nodes[grandparent].left = sibling;
+		else nodes[grandparent].right = sibling;
+		nodes[sibling].parent = grandparent;
+		for (int node = grandparent; node != -1; node = nodes[node].parent)
+			nodes[node].box = Union(nodes[nodes[node].left].box, nodes[nodes[node].right].box);
+	}
+	FreeNode(parent);
+	nodes[leaf].parent = -1;
+}
+
+bool SpatialIndex::TreeRayCast(const Ray& ray, Hit& hit) const {
+	if (root == -1) return false;
+	std::vector<int> stack(1, root);
+	while (!stack.empty()) {
+		const Node& node = nodes[stack.back()];
+		stack.pop_back();
+		float limit = hit.contact.contact ? hit.contact.time : 1.0f;
+		if (!SegmentHitsBox(ray.origin, ray.dir, node.box, limit)) continue;
+		if (node.Leaf()) TestRay(ray, node.id, entries.find(node.id)->second, hit);
+		else {
+			stack.push_back(node.left);
+			stack.push_back(node.right);
+		}
+	}
+	return hit.contact.contact;
+}
@@ -0,0 +1,132 @@
+#include "spritebatch.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+using namespace SDL;
+
+SpriteBatch::SpriteBatch(Renderer& renderer, size_t reserve) : renderer(renderer) {
+	sprites.reserve(reserve);
+	vertices.reserve(reserve * 4);
+}
+
+SpriteBatch& SpriteBatch::FlushError() { error = 0; return *this; }
+
+SpriteBatch& SpriteBatch::SetBlendMode(BlendMode blendMode) { this->blendMode = blendMode; return *this; }
+SpriteBatch& SpriteBatch::SetSort(bool sort) { this->sort = sort; return *this; }
+
+SpriteBatch::Sprite& SpriteBatch::Push(Texture& texture, const Rect& src, const Colour& mod, Texture::Flip flipType) {
+	if (texture.texture != sizedTexture) {
+		int w = 0, h = 0;
+		error |= SDL_QueryTexture(texture.texture, NULL, NULL, &w, &h);
+		sizedTexture = texture.texture;
+		texelSize = { w > 0 ? 1.0f / w : 0.0f, h > 0 ? 1.0f / h : 0.0f };
+	}
+
+	float u0 = src.x * texelSize.x, u1 = (src.x + src.w) * texelSize.x;
+	float v0 = src.y * texelSize.y, v1 = (src.y + src.h) * texelSize.y;
+	if (flipType & SDL_FLIP_HORIZONTAL) std::swap(u0, u1);
+	if (flipType & SDL_FLIP_VERTICAL) std::swap(v0, v1);
+
+	sprites.push_back({ texture.texture, blendMode });
+	Sprite& sprite = sprites.back();
+	sprite.vertices[0] = { { 0, 0 }, mod, { u0, v0 } };
+	sprite.vertices[1] = { { 0, 0 }, mod, { u1, v0 } };
+	sprite.vertices[2] = { { 0, 0 }, mod, { u1, v1 } };
+	sprite.vertices[3] = { { 0, 0 }, mod, { u0, v1 } };
+	return sprite;
+}
+
+SpriteBatch& SpriteBatch::Draw(Texture& texture, const Rect& src, const FRect& dst, const Colour& mod) {
+	Sprite& sprite = Push(texture, src, mod, Texture::Flip::SDL_FLIP_NONE);
+	sprite.vertices[0].position = { dst.x, dst.y };
+	sprite.vertices[1].position = { dst.x + dst.w, dst.y };
+	sprite.vertices[2].position = { dst.x + dst.w, dst.y + dst.h };
+	sprite.vertices[3].position = { dst.x, dst.y + dst.h };
+	return *this;
+}
+
+SpriteBatch& SpriteBatch::Draw(Texture& texture, const FRect& dst, const Colour& mod) {
+	Point size;
+	error |= texture.QuerySize(size);
+	return Draw(texture, Rect(0, 0, size.w, size.h), dst, mod);
+}
+
+SpriteBatch& SpriteBatch::DrawEx(Texture& texture, const Rect& src, const FRect& dst, const FPoint& center, double angle, Texture::Flip flipType, const Colour& mod) {
+	Sprite& sprite = Push(texture, src, mod, flipType);
+
+	float radians = (float)(angle * M_PI / 180.0);
+	float c = std::cos(radians), s = std::sin(radians);
+	float cx = dst.x + center.x, cy = dst.y + center.y;
+
+	// Corners relative to the centre of rotation
+	float x0 = -center.x, x1 = dst.w - center.x;
+	float y0 = -center.y, y1 = dst.h - center.y;
+
+	sprite.vertices[0].position = { cx + x0 * c - y0 * s, cy + x0 * s + y0 * c };
+	sprite.vertices[1].position = { cx + x1 * c - y0 * s, cy + x1 * s + y0 * c };
+	sprite.vertices[2].position = { cx + x1 * c - y1 * s, cy + x1 * s + y1 * c };
+	sprite.vertices[3].position = { cx + x0 * c - y1 * s, cy + x0 * s + y1 * c };
+	return *this;
+}
+
+SpriteBatch& SpriteBatch::DrawEx(Texture& texture, const Rect& src, const FRect& dst, double angle, Texture::Flip flipType, const Colour& mod) {
+	return DrawEx(texture, src, dst, FPoint(dst.w / 2, dst.h / 2), angle, flipType, mod);
+}
+
+SpriteBatch& SpriteBatch::Draw(const AtlasRegion& region, const FRect& dst, const Colour& mod) { return Draw(*region.texture, region.src, dst, mod); }
+SpriteBatch& SpriteBatch::DrawEx(const AtlasRegion& region, const FRect& dst, const FPoint& center, double angle, Texture::Flip flipType, const Colour& mod) {
+	return DrawEx(*region.texture, region.src, dst, center, angle, flipType, mod);
+}
+SpriteBatch& SpriteBatch::DrawEx(const AtlasRegion& region, const FRect& dst, double angle, Texture::Flip flipType, const Colour& mod) {
+	return DrawEx(*region.texture, region.src, dst, angle, flipType, mod);
+}
+
+size_t SpriteBatch::Size() const { return sprites.size(); }
+
+SpriteBatch& SpriteBatch::Clear() {
+	sprites.clear();
+	sizedTexture = nullptr;
+	return *this;
+}
+
+SpriteBatch& SpriteBatch::Flush() {
+	drawCalls = 0;
+	if (sprites.empty()) return *this;
+
+	if (sort)
+		std::stable_sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) {
+			if (a.texture != b.texture) return a.texture < b.texture;
+			return a.blendMode < b.blendMode;
+		});
+
+	auto run = sprites.begin();
+	while (run != sprites.end()) {
+		auto end = run;
+		while (end != sprites.end() && end->texture == run->texture && end->blendMode == run->blendMode) ++end;
+
+		size_t count = end - run;
+		vertices.clear();
+		for (auto it = run; it != end; ++it)
+			vertices.insert(vertices.end(), it->vertices, it->vertices + 4);
+
+		// Every quad uses the same index pattern, so the list only has to grow
+		for (int i = (int)indices.size() / 6; i < (int)count; i++) {
+			int v = i * 4;
+			indices.insert(indices.end(), { v, v + 1, v + 2, v, v + 2, v + 3 });
+		}
+
+		BlendMode current;
+		if (SDL_GetTextureBlendMode(run->texture, &current) != 0 || current != run->blendMode)
+			error |= SDL_SetTextureBlendMode(run->texture, run->blendMode);
+		SDLPP_PROFILE_DRAW(run->texture);
+		error |= SDL_RenderGeometry(renderer.renderer, run->texture, vertices.data(), (int)vertices.size(), indices.data(), (int)count * 6);
+		drawCalls++;
+
+		run = end;
+	}
+
+	return Clear();
+}
+#endif
@@ -0,0 +1,69 @@
+#include "streamingtexture.hpp"
+#include "profiler.hpp"
+
+using namespace SDL;
+
+StreamingTexture::StreamingTexture(Renderer& renderer, const Point& size, int count, Uint32 format)
+	: renderer(renderer), size(size), format(format) {
+	if (count < 1) count = 1;
+	for (int i = 0; i < count; i++) {
+		textures.emplace_back(renderer, size, Texture::Access::SDL_TEXTUREACCESS_STREAMING, format);
+		// Nothing has been written to any texture yet
+		stale.push_back(Rect({ 0, 0 }, size));
+	}
+}
+
+int StreamingTexture::Lock(void*& pixels, int& pitch) {
+	Rect locked;
+	return LockRect(Rect({ 0, 0 }, size), pixels, pitch, locked);
+}
+
+int StreamingTexture::LockRect(const Rect& rect, void*& pixels, int& pitch, Rect& locked) {
+	if (this->locked != -1) Unlock();
+
+	int next = ((int)textures.size() == 1) ? 0 : (current + 1) % (int)textures.size();
+
+	Rect bounds({ 0, 0 }, size);
+	Rect want;
+	if (!rect.intersectRect(bounds, want)) want = Rect();
+	if (!stale[next].empty()) {
+		if (want.empty()) want = stale[next];
+		else want.rectUnion(stale[next], want);
+	}
+	if (want.empty()) {
+		SetError("Nothing to lock in streaming texture");
+		return -1;
+	}
+
+	int result = textures[next].LockRect(want, pixels, pitch);
+	if (result != 0) return result;
+
+	this->locked = next;
+	lockedRect = want;
+	locked = want;
+	return 0;
+}
+
+void StreamingTexture::Unlock() {
+	if (locked == -1) return;
+	textures[locked].Unlock();
+	SDLPP_PROFILE_UPLOAD((Uint64)lockedRect.w * lockedRect.h * SDL_BYTESPERPIXEL(format));
+
+	// The other textures now miss what was just written
+	for (int i = 0; i < (int)textures.size(); i++) {
+		if (i == locked) stale[i] = Rect();
+		else if (stale[i].empty()) stale[i] = lockedRect;
+		else stale[i].rectUnion(lockedRect, stale[i]);
+	}
+
+	current = locked;
+	locked = -1;
+}
+
+Texture& StreamingTexture::Current() { return textures[current]; }
+
+bool StreamingTexture::Valid() const {
+	for (const Texture& texture : textures)
+		if (texture.texture == NULL) return false;
+	return !textures.empty();
+}
@@ -0,0 +1,105 @@
+#include "targetpool.hpp"
+#include "profiler.hpp"
+
+using namespace SDL;
+
+RenderTargetPool::RenderTargetPool(Renderer& renderer, int maxIdleFrames) : renderer(renderer), maxIdleFrames(maxIdleFrames) {}
+
+RenderTargetPool& RenderTargetPool::FlushError() { error = 0; return *this; }
+
+Texture& RenderTargetPool::Acquire(const Point& size, Uint32 format, Texture::Access access) {
+	Key key = { size.w, size.h, format, access };
+	for (Entry& entry : entries) {
+		if (entry.leased || !(entry.key == key) || entry.texture->texture == NULL) continue;
+		entry.leased = true;
+		entry.lastUsed = frame;
+		stats.reused++;
+		return *entry.texture;
+	}
+
+	SDLPP_PROFILE_ZONE("RenderTargetPool::Acquire");
+	std::unique_ptr<Texture> texture(new Texture(renderer, size, access, format));
+	// A texture that failed is lent out all the same, so there is always a
+	// reference to return, and dropped at the end of the frame
+	if (texture->texture == NULL) error = -1;
+	else stats.created++;
+	entries.push_back({ key, std::move(texture), true, frame });
+	return *entries.back().texture;
+}
+
+RenderTargetPool& RenderTargetPool::Release(Texture& texture) {
+	for (Entry& entry : entries) {
+		if (entry.texture.get() != &texture) continue;
+		entry.leased = false;
+		entry.lastUsed = frame;
+		break;
+	}
+	return *this;
+}
+
+void RenderTargetPool::Destroy(Entry& entry) {
+	if (entry.texture->texture != NULL && renderer.GetTargetTexture() == entry.texture->texture) {
+		renderer.ResetTarget();
+		error |= renderer.error;
+	}
+	entry.texture.reset();
+}
+
+RenderTargetPool& RenderTargetPool::EndFrame() {
+	frame++;
+	for (size_t i = 0; i < entries.size();) {
+		Entry& entry = entries[i];
+		if (entry.leased) {
+			entry.leased = false;
+			entry.lastUsed = frame;
+		}
+		if (entry.texture->texture != NULL && frame - entry.lastUsed <= (Uint64)maxIdleFrames) { i++; continue; }
+
+		if (entry.texture->texture != NULL) stats.evicted++;
+		Destroy(entry);
+		entries[i] = std::move(entries.back());
+		entries.pop_back();
+	}
+	return *this;
+}
+
+RenderTargetPool& RenderTargetPool::Trim() {
+	for (size_t i = 0; i < entries.size();) {
+		if (entries[i].leased) { i++; continue; }
+		stats.evicted++;
+		Destroy(entries[i]);
+		entries[i] = std::move(entries.back());
+		entries.pop_back();
+	}
+	return *this;
+}
+
+RenderTargetPool& RenderTargetPool::Clear() {
+	for (Entry& entry : entries) Destroy(entry);
+	entries.clear();
+	return *this;
+}
+
+size_t RenderTargetPool::Bytes(const Key& key) {
+	return (size_t)key.w * key.h * SDL_BYTESPERPIXEL(key.format);
+}
+
+size_t RenderTargetPool::Leased() const {
+	size_t count = 0;
+	for (const Entry& entry : entries) count += entry.leased;
+	return count;
+}
+
+size_t RenderTargetPool::Memory() const {
+	size_t bytes = 0;
+	for (const Entry& entry : entries)
+		if (entry.texture->texture != NULL) bytes += Bytes(entry.key);
+	return bytes;
+}
+
+size_t RenderTargetPool::LeasedMemory() const {
+	size_t bytes = 0;
+	for (const Entry& entry : entries)
+		if (entry.leased && entry.texture->texture != NULL) bytes += Bytes(entry.key);
+	return bytes;
+}
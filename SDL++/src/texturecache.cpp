@@ -0,0 +1,360 @@
+#include "texturecache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include "error.hpp"
+#include "image.hpp"
+#include "profiler.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SDLPP_HAVE_MMAP
+#endif
+
+using namespace SDL;
+
+static const char MAGIC[8] = { 'S', 'D', 'L', 'P', 'P', 'T', 'E', 'X' };
+static const Uint32 VERSION = 1;
+static const size_t ALIGNMENT = 64;
+
+struct FileHeader {
+	char magic[8];
+	Uint32 version;
+	Uint32 format;
+	Uint32 pageCount;
+	Uint32 regionCount;
+	Uint32 namesSize;
+	Uint32 reserved;
+};
+
+struct FilePage {
+	Uint32 w, h;
+	// From the start of the file; rows are w pixels with no padding
+	Uint64 offset;
+};
+
+struct FileRegion {
+	Uint32 page;
+	Sint32 x, y, w, h;
+	// Into the names, which follow the regions
+	Uint32 nameOffset, nameLength;
+	Uint32 reserved;
+};
+
+static size_t Align(size_t n) { return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+static bool CacheFormat(Uint32 format) { return format != SDL_PIXELFORMAT_UNKNOWN && !SDL_ISPIXELFORMAT_FOURCC(format) && SDL_BYTESPERPIXEL(format) > 0; }
+
+TextureCacheBaker::TextureCacheBaker(Uint32 format, const Point& pageSize, int padding) : format(format), pageSize(pageSize), padding(padding) {}
+
+Uint32 TextureCacheBaker::NativeFormat(Renderer& renderer) {
+	Renderer::Info info;
+	if (SDL_GetRendererInfo(renderer.renderer, &info) == 0)
+		for (Uint32 i = 0; i < info.num_texture_formats; i++)
+			if (CacheFormat(info.texture_formats[i]) && !SDL_ISPIXELFORMAT_INDEXED(info.texture_formats[i])) return info.texture_formats[i];
+	return SDL_PIXELFORMAT_RGBA32;
+}
+
+TextureCacheBaker& TextureCacheBaker::FlushError() { error = 0; return *this; }
+
+int TextureCacheBaker::Add(const std::string& name, Surface& surface) {
+	if (surface.surface == NULL) return error = SetError("No image for \"%s\"", name.c_str());
+	if (!CacheFormat(format)) return error = SetError("Texture caches cannot hold %s", SDL_GetPixelFormatName(format));
+
+	Surface converted = surface.surface->format->format == format ? Surface(surface.surface) : surface.ConvertSurfaceFormat(format, 0);
+	if (converted.surface == NULL) return error = -1;
+	if (converted.surface->w <= 0 || converted.surface->h <= 0) return error = SetError("Image \"%s\" is empty", name.c_str());
+
+	Image image;
+	image.name = name;
+	image.w = converted.surface->w;
+	image.h = converted.surface->h;
+	size_t row = (size_t)image.w * SDL_BYTESPERPIXEL(format);
+	image.pixels.resize(row * image.h);
+
+	bool locked = converted.MustLock();
+	if (locked) converted.Lock();
+	const Uint8* src = (const Uint8*)converted.surface->pixels;
+	for (int y = 0; y < image.h; y++) memcpy(&image.pixels[row * y], src + (size_t)converted.surface->pitch * y, row);
+	if (locked) converted.Unlock();
+
+	for (Image& existing : images) {
+		if (existing.name != name) continue;
+		existing = std::move(image);
+		return 0;
+	}
+	images.push_back(std::move(image));
+	return 0;
+}
+
+int TextureCacheBaker::Add(const std::string& name, const std::string& file) {
+	Surface surface = IMG::Load(file);
+	return Add(name, surface);
+}
+
+int TextureCacheBaker::Write(const std::string& file) {
+	SDL_RWops* dst = SDL_RWFromFile(file.c_str(), "wb");
+	if (dst == NULL) return error = -1;
+	return Write_RW(dst, true);
+}
+
+int TextureCacheBaker::Write_RW(SDL_RWops* dst, bool freedst) {
+	struct Page {
+		Point size;
+		// Either an image's own pixels or the atlas page's
+		const Uint8* pixels;
+		std::vector<Uint8> atlas;
+	};
+	std::vector<Page> pages;
+	std::vector<FileRegion> regions(images.size());
+	int bpp = SDL_BYTESPERPIXEL(format);
+	bool atlas = pageSize.w > 0 && pageSize.h > 0;
+
+	if (!atlas) {
+		for (size_t i = 0; i < images.size(); i++) {
+			pages.push_back({ { images[i].w, images[i].h }, images[i].pixels.data(), {} });
+			regions[i] = { (Uint32)i, 0, 0, images[i].w, images[i].h, 0, 0, 0 };
+		}
+	}
+	else {
+		// Tallest first packs tighter than the order they were added in
+		std::vector<size_t> order(images.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return images[a].h > images[b].h; });
+
+		std::vector<AtlasPacker> packers;
+		for (size_t i : order) {
+			const Image& image = images[i];
+			Point padded = { image.w + padding * 2, image.h + padding * 2 };
+			if (padded.w > pageSize.w || padded.h > pageSize.h) {
+				if (freedst) SDL_RWclose(dst);
+				return error = SetError("Image \"%s\" of %dx%d does not fit in a %dx%d atlas page", image.name.c_str(), image.w, image.h, pageSize.w, pageSize.h);
+			}
+
+			Point pos;
+			size_t page = 0;
+			while (page < packers.size() && !packers[page].Pack(padded, pos)) page++;
+			if (page == packers.size()) {
+				packers.emplace_back(pageSize);
+				packers.back().Pack(padded, pos);
+				// Zeroed, so the padding is transparent
+				pages.push_back({ pageSize, NULL, std::vector<Uint8>((size_t)pageSize.w * pageSize.h * bpp, 0) });
+				pages.back().pixels = pages.back().atlas.data();
+			}
+
+			Rect src(pos.x + padding, pos.y + padding, image.w, image.h);
+			size_t row = (size_t)image.w * bpp, pitch = (size_t)pageSize.w * bpp;
+			Uint8* to = pages[page].atlas.data() + pitch * src.y + (size_t)src.x * bpp;
+			for (int y = 0; y < image.h; y++) memcpy(to + pitch * y, &image.pixels[row * y], row);
+			regions[i] = { (Uint32)page, src.x, src.y, src.w, src.h, 0, 0, 0 };
+		}
+	}
+
+	std::string names;
+	for (size_t i = 0; i < images.size(); i++) {
+		regions[i].nameOffset = (Uint32)names.size();
+		regions[i].nameLength = (Uint32)images[i].name.size();
+		names += images[i].name;
+	}
+
+	FileHeader header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.format = format;
+	header.pageCount = (Uint32)pages.size();
+	header.regionCount = (Uint32)regions.size();
+	header.namesSize = (Uint32)names.size();
+	header.reserved = 0;
+
+	std::vector<FilePage> filePages(pages.size());
+	size_t offset = Align(sizeof(FileHeader) + sizeof(FilePage) * pages.size() + sizeof(FileRegion) * regions.size() + names.size());
+	for (size_t i = 0; i < pages.size(); i++) {
+		filePages[i] = { (Uint32)pages[i].size.w, (Uint32)pages[i].size.h, offset };
+		offset = Align(offset + (size_t)pages[i].size.w * pages[i].size.h * bpp);
+	}
+
+	static const Uint8 zeros[ALIGNMENT] = { 0 };
+	bool ok = SDL_RWwrite(dst, &header, sizeof(header), 1) == 1;
+	if (ok && !filePages.empty()) ok = SDL_RWwrite(dst, filePages.data(), sizeof(FilePage), filePages.size()) == filePages.size();
+	if (ok && !regions.empty()) ok = SDL_RWwrite(dst, regions.data(), sizeof(FileRegion), regions.size()) == regions.size();
+	if (ok && !names.empty()) ok = SDL_RWwrite(dst, names.data(), names.size(), 1) == 1;
+	size_t written = sizeof(FileHeader) + sizeof(FilePage) * pages.size() + sizeof(FileRegion) * regions.size() + names.size();
+	for (size_t i = 0; ok && i < pages.size(); i++) {
+		size_t gap = (size_t)filePages[i].offset - written;
+		if (gap > 0) ok = SDL_RWwrite(dst, zeros, gap, 1) == 1;
+		size_t bytes = (size_t)pages[i].size.w * pages[i].size.h * bpp;
+		if (ok && bytes > 0) ok = SDL_RWwrite(dst, pages[i].pixels, bytes, 1) == 1;
+		written = (size_t)filePages[i].offset + bytes;
+	}
+
+	if (freedst && SDL_RWclose(dst) != 0) ok = false;
+	if (!ok) return error = -1;
+	return 0;
+}
+
+namespace {
+	// A read-only view of a whole file, mapped where the platform allows and read otherwise
+	struct FileView {
+		const void* data = NULL;
+		size_t size = 0;
+		std::vector<Uint8> buffer;
+#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+#elif defined(SDLPP_HAVE_MMAP)
+		void* mapped = MAP_FAILED;
+#endif
+
+		FileView(const std::string& path) {
+			if (!Map(path)) Read(path);
+		}
+
+		~FileView() {
+#if defined(_WIN32)
+			if (mapping != NULL) {
+				UnmapViewOfFile(data);
+				CloseHandle(mapping);
+			}
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#elif defined(SDLPP_HAVE_MMAP)
+			if (mapped != MAP_FAILED) munmap(mapped, size);
+#endif
+		}
+
+		FileView(const FileView&) = delete;
+		FileView& operator=(const FileView&) = delete;
+
+		bool Map(const std::string& path) {
+#if defined(_WIN32)
+			int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, NULL, 0);
+			std::vector<wchar_t> wide(length > 0 ? length : 1);
+			if (length <= 0 || !MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wide.data(), length)) return false;
+
+			file = CreateFileW(wide.data(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (file == INVALID_HANDLE_VALUE) return false;
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return false;
+			mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping == NULL) return false;
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (data == NULL) {
+				CloseHandle(mapping);
+				mapping = NULL;
+				return false;
+			}
+			size = (size_t)fileSize.QuadPart;
+			return true;
+#elif defined(SDLPP_HAVE_MMAP)
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) return false;
+			struct stat info;
+			if (fstat(fd, &info) != 0 || info.st_size == 0) {
+				close(fd);
+				return false;
+			}
+			mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if (mapped == MAP_FAILED) return false;
+			data = mapped;
+			size = (size_t)info.st_size;
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		void Read(const std::string& path) {
+			SDL_RWops* src = SDL_RWFromFile(path.c_str(), "rb");
+			if (src == NULL) return;
+			Sint64 length = SDL_RWsize(src);
+			if (length > 0) {
+				buffer.resize((size_t)length);
+				if (SDL_RWread(src, buffer.data(), buffer.size(), 1) == 1) {
+					data = buffer.data();
+					size = buffer.size();
+				}
+			}
+			SDL_RWclose(src);
+		}
+	};
+}
+
+TextureCache::TextureCache(Renderer& renderer) : renderer(renderer) {}
+
+TextureCache& TextureCache::FlushError() { error = 0; return *this; }
+
+int TextureCache::Load(const std::string& file) {
+	SDLPP_PROFILE_ZONE("TextureCache::Load");
+	FileView view(file);
+	if (view.data == NULL) return error = SetError("Cannot read texture cache %s", file.c_str());
+	return Load(view.data, view.size);
+}
+
+int TextureCache::Load(const void* data, size_t size) {
+	const Uint8* bytes = (const Uint8*)data;
+	FileHeader header;
+	if (size < sizeof(header)) return error = SetError("Not a texture cache");
+	memcpy(&header, bytes, sizeof(header));
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return error = SetError("Not a texture cache");
+	if (header.version != VERSION) return error = SetError("Texture cache version %u is not %u, or was baked with the other byte order", header.version, VERSION);
+	if (!CacheFormat(header.format)) return error = SetError("Texture cache has unsupported format %s", SDL_GetPixelFormatName(header.format));
+
+	// In Uint64, and with the counts bounded first, so that no count can wrap
+	// the sum on 32 bit builds and pass for a small file
+	if (header.pageCount > size / sizeof(FilePage) || header.regionCount > size / sizeof(FileRegion)) return error = SetError("Texture cache is truncated");
+	Uint64 tables = (Uint64)sizeof(FileHeader) + (Uint64)sizeof(FilePage) * header.pageCount + (Uint64)sizeof(FileRegion) * header.regionCount;
+	if ((Uint64)size < tables + header.namesSize) return error = SetError("Texture cache is truncated");
+	const FilePage* filePages = (const FilePage*)(bytes + sizeof(FileHeader));
+	const FileRegion* fileRegions = (const FileRegion*)(filePages + header.pageCount);
+	const char* names = (const char*)(fileRegions + header.regionCount);
+
+	int bpp = SDL_BYTESPERPIXEL(header.format);
+	for (Uint32 i = 0; i < header.pageCount; i++) {
+		const FilePage& page = filePages[i];
+		if (page.w == 0 || page.h == 0 || page.offset > size || (Uint64)page.w * page.h > (size - page.offset) / bpp) return error = SetError("Texture cache is truncated");
+	}
+	for (Uint32 i = 0; i < header.regionCount; i++) {
+		const FileRegion& region = fileRegions[i];
+		if (region.page >= header.pageCount || (Uint64)region.nameOffset + region.nameLength > header.namesSize
+			|| region.x < 0 || region.y < 0 || region.w < 0 || region.h < 0
+			|| (Uint64)region.x + region.w > filePages[region.page].w || (Uint64)region.y + region.h > filePages[region.page].h)
+			return error = SetError("Texture cache has a bad region");
+	}
+
+	// Pages are created before any region is added, so a failure leaves the cache as it was
+	size_t first = pages.size();
+	for (Uint32 i = 0; i < header.pageCount; i++) {
+		const FilePage& page = filePages[i];
+		pages.emplace_back(renderer, Point((int)page.w, (int)page.h), Texture::Access::SDL_TEXTUREACCESS_STATIC, header.format);
+		Texture& texture = pages.back();
+		if (texture.texture == NULL || texture.Update((void*)(bytes + page.offset), (int)page.w * bpp) != 0) {
+			while (pages.size() > first) pages.pop_back();
+			return error = -1;
+		}
+		texture.SetBlendMode(SDL_BLENDMODE_BLEND);
+	}
+
+	for (Uint32 i = 0; i < header.regionCount; i++) {
+		const FileRegion& region = fileRegions[i];
+		AtlasRegion& to = regions[std::string(names + region.nameOffset, region.nameLength)];
+		to.texture = &pages[first + region.page];
+		to.src = Rect(region.x, region.y, region.w, region.h);
+	}
+	return 0;
+}
+
+AtlasRegion TextureCache::Get(const std::string& name) const {
+	auto found = regions.find(name);
+	return found == regions.end() ? AtlasRegion() : found->second;
+}
+
+void TextureCache::Clear() {
+	regions.clear();
+	pages.clear();
+}
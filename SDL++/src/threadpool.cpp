@@ -0,0 +1,53 @@
+#include "threadpool.hpp"
+#include <SDL_cpuinfo.h>
+
+using namespace SDL;
+
+ThreadPool::ThreadPool(unsigned threads) {
+	if (threads == 0) threads = SDL_GetCPUCount() > 1 ? SDL_GetCPUCount() - 1 : 1;
+
+	workers.reserve(threads);
+	for (unsigned i = 0; i < threads; i++)
+		workers.emplace_back([this]() {
+			std::unique_lock<std::mutex> lock(mutex);
+			for (;;) {
+				wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+				if (jobs.empty()) return;
+
+				std::function<void()> job = std::move(jobs.front());
+				jobs.pop_front();
+				active++;
+
+				lock.unlock();
+				job();
+				lock.lock();
+
+				active--;
+				if (jobs.empty() && active == 0) idle.notify_all();
+			}
+		});
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::Push(std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this]() { return jobs.empty() && active == 0; });
+}
+
+size_t ThreadPool::Size() const { return workers.size(); }
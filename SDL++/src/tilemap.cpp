@@ -0,0 +1,212 @@
+#include "tilemap.hpp"
+#include "error.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace SDL;
+
+TileMap::TileMap(Renderer& renderer, Texture& tileset, const Point& tileSize, const Point& size, int chunkTiles, Mode mode)
+	: renderer(renderer), tileset(tileset), tileSize(tileSize), size(size), chunkTiles(std::max(chunkTiles, 1)), mode(mode) {
+	if (size.w > 0 && size.h > 0) tiles.assign((size_t)size.w * size.h, 0);
+	chunkCount = size.w > 0 && size.h > 0 ? Point((size.w + this->chunkTiles - 1) / this->chunkTiles, (size.h + this->chunkTiles - 1) / this->chunkTiles) : Point(0, 0);
+	chunks.resize((size_t)chunkCount.w * chunkCount.h);
+#if !SDL_VERSION_ATLEAST(2,0,18)
+	if (mode == Mode::GEOMETRY) error = SetError("TileMap: geometry chunks need SDL 2.0.18");
+#endif
+}
+
+TileMap& TileMap::FlushError() { error = 0; return *this; }
+
+Uint16 TileMap::GetTile(int x, int y) const {
+	if (x < 0 || y < 0 || x >= size.w || y >= size.h) return 0;
+	return tiles[(size_t)y * size.w + x];
+}
+
+TileMap& TileMap::SetTile(int x, int y, Uint16 tile) {
+	if (x < 0 || y < 0 || x >= size.w || y >= size.h) return *this;
+	Uint16& slot = tiles[(size_t)y * size.w + x];
+	if (slot == tile) return *this;
+	slot = tile;
+	chunks[(size_t)(y / chunkTiles) * chunkCount.w + x / chunkTiles].dirty = true;
+	return *this;
+}
+
+TileMap& TileMap::Fill(const Rect& area, Uint16 tile) {
+	int x0 = std::max(area.x, 0), y0 = std::max(area.y, 0);
+	int x1 = std::min(area.x + area.w, size.w), y1 = std::min(area.y + area.h, size.h);
+	for (int y = y0; y < y1; y++)
+		for (int x = x0; x < x1; x++) SetTile(x, y, tile);
+	return *this;
+}
+
+TileMap& TileMap::Invalidate() {
+	for (Chunk& chunk : chunks) chunk.dirty = true;
+	return *this;
+}
+
+TileMap& TileMap::Invalidate(const Rect& area) {
+	int x0 = std::max(area.x, 0), y0 = std::max(area.y, 0);
+	int x1 = std::min(area.x + area.w, size.w), y1 = std::min(area.y + area.h, size.h);
+	if (x0 >= x1 || y0 >= y1) return *this;
+	for (int cy = y0 / chunkTiles; cy <= (y1 - 1) / chunkTiles; cy++)
+		for (int cx = x0 / chunkTiles; cx <= (x1 - 1) / chunkTiles; cx++) chunks[(size_t)cy * chunkCount.w + cx].dirty = true;
+	return *this;
+}
+
+TileMap& TileMap::Release() {
+	SDL_Texture* target = renderer.GetTargetTexture();
+	for (Chunk& chunk : chunks) {
+		if (chunk.texture && target != NULL && chunk.texture->texture == target) {
+			renderer.ResetTarget();
+			target = NULL;
+		}
+		chunk.texture.reset();
+		std::vector<Vertex>().swap(chunk.vertices);
+		std::vector<int>().swap(chunk.indices);
+		std::vector<FPoint>().swap(chunk.corners);
+		chunk.dirty = true;
+	}
+	return *this;
+}
+
+Rect TileMap::ChunkArea(int cx, int cy) const {
+	int x = cx * chunkTiles, y = cy * chunkTiles;
+	return Rect(x, y, std::min(chunkTiles, size.w - x), std::min(chunkTiles, size.h - y));
+}
+
+bool TileMap::TileSrc(Uint16 tile, int columns, int rows, Rect& src) const {
+	if (tile == 0 || columns <= 0) return false;
+	int index = tile - 1;
+	if (index / columns >= rows) return false;
+	src = Rect(index % columns * tileSize.w, index / columns * tileSize.h, tileSize.w, tileSize.h);
+	return true;
+}
+
+int TileMap::Bake(Chunk& chunk, const Rect& area, const Point& tilesetSize) {
+	SDLPP_PROFILE_ZONE("TileMap::Bake");
+	if (!chunk.texture) {
+		Point pixels(area.w * tileSize.w, area.h * tileSize.h);
+		chunk.texture.reset(new Texture(renderer, pixels, Texture::Access::SDL_TEXTUREACCESS_TARGET, SDL_PIXELFORMAT_RGBA32));
+		if (chunk.texture->texture == NULL) {
+			chunk.texture.reset();
+			return -1;
+		}
+		chunk.texture->SetBlendMode(SDL_BLENDMODE_BLEND);
+	}
+
+	Colour colour;
+	renderer.GetDrawColor(colour);
+	BlendMode blendMode = SDL_BLENDMODE_BLEND;
+	tileset.GetBlendMode(blendMode);
+
+	// Tiles are copied as they are, so the chunk blends like the tileset would
+	tileset.SetBlendMode(SDL_BLENDMODE_NONE);
+	TargetGuard target(renderer, *chunk.texture);
+	int result = target.error;
+	if (result == 0) renderer.SetDrawColor(0, 0, 0, 0).Clear();
+
+	int columns = tileSize.w > 0 ? tilesetSize.w / tileSize.w : 0, rows = tileSize.h > 0 ? tilesetSize.h / tileSize.h : 0;
+	Rect src;
+	for (int y = 0; y < area.h && result == 0; y++) {
+		const Uint16* row = &tiles[(size_t)(area.y + y) * size.w + area.x];
+		for (int x = 0; x < area.w; x++)
+			if (TileSrc(row[x], columns, rows, src)) result |= tileset.Copy(src, Rect(x * tileSize.w, y * tileSize.h, tileSize.w, tileSize.h));
+	}
+
+	renderer.SetDrawColor(colour);
+	tileset.SetBlendMode(blendMode);
+	return result;
+}
+
+void TileMap::Tessellate(Chunk& chunk, const Rect& area, const Point& tilesetSize) {
+	SDLPP_PROFILE_ZONE("TileMap::Tessellate");
+	chunk.vertices.clear();
+	chunk.indices.clear();
+	chunk.corners.clear();
+
+	int columns = tileSize.w > 0 ? tilesetSize.w / tileSize.w : 0, rows = tileSize.h > 0 ? tilesetSize.h / tileSize.h : 0;
+	float du = tilesetSize.w > 0 ? 1.0f / tilesetSize.w : 0.0f, dv = tilesetSize.h > 0 ? 1.0f / tilesetSize.h : 0.0f;
+	SDL_Color white = { 255, 255, 255, 255 };
+	Rect src;
+	for (int y = 0; y < area.h; y++) {
+		const Uint16* row = &tiles[(size_t)(area.y + y) * size.w + area.x];
+		for (int x = 0; x < area.w; x++) {
+			if (!TileSrc(row[x], columns, rows, src)) continue;
+			float x0 = (float)(x * tileSize.w), y0 = (float)(y * tileSize.h);
+			float x1 = x0 + tileSize.w, y1 = y0 + tileSize.h;
+			float u0 = src.x * du, u1 = (src.x + src.w) * du;
+			float v0 = src.y * dv, v1 = (src.y + src.h) * dv;
+
+			int base = (int)chunk.vertices.size();
+			chunk.corners.insert(chunk.corners.end(), { FPoint(x0, y0), FPoint(x1, y0), FPoint(x1, y1), FPoint(x0, y1) });
+			chunk.vertices.push_back({ { x0, y0 }, white, { u0, v0 } });
+			chunk.vertices.push_back({ { x1, y0 }, white, { u1, v0 } });
+			chunk.vertices.push_back({ { x1, y1 }, white, { u1, v1 } });
+			chunk.vertices.push_back({ { x0, y1 }, white, { u0, v1 } });
+			chunk.indices.insert(chunk.indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+		}
+	}
+	// Never equal to an origin, so the next draw moves the vertices into place
+	chunk.offset = FPoint(NAN, NAN);
+}
+
+int TileMap::Draw(const FPoint& camera) {
+	SDLPP_PROFILE_ZONE("TileMap::Draw");
+	drawnChunks = 0;
+	builtChunks = 0;
+	if (chunks.empty() || tileSize.w <= 0 || tileSize.h <= 0) return 0;
+
+	Rect view = renderer.GetViewport();
+	float chunkW = (float)(chunkTiles * tileSize.w), chunkH = (float)(chunkTiles * tileSize.h);
+	int cx0 = std::max((int)std::floor(camera.x / chunkW), 0), cy0 = std::max((int)std::floor(camera.y / chunkH), 0);
+	int cx1 = std::min((int)std::ceil((camera.x + view.w) / chunkW), chunkCount.w);
+	int cy1 = std::min((int)std::ceil((camera.y + view.h) / chunkH), chunkCount.h);
+	if (cx0 >= cx1 || cy0 >= cy1) return 0;
+
+	Point tilesetSize;
+	int result = tileset.QuerySize(tilesetSize);
+	for (int cy = cy0; cy < cy1; cy++) {
+		for (int cx = cx0; cx < cx1; cx++) {
+			Chunk& chunk = chunks[(size_t)cy * chunkCount.w + cx];
+			Rect area = ChunkArea(cx, cy);
+			FPoint origin(cx * chunkW - camera.x, cy * chunkH - camera.y);
+
+			if (mode == Mode::TARGET) {
+				if (chunk.dirty || !chunk.texture) {
+					if (Bake(chunk, area, tilesetSize) != 0) {
+						result = -1;
+						continue;
+					}
+					chunk.dirty = false;
+					builtChunks++;
+				}
+				result |= chunk.texture->CopyF(FRect(origin.x, origin.y, (float)(area.w * tileSize.w), (float)(area.h * tileSize.h)));
+				drawnChunks++;
+				continue;
+			}
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+			if (chunk.dirty) {
+				Tessellate(chunk, area, tilesetSize);
+				chunk.dirty = false;
+				builtChunks++;
+			}
+			if (chunk.vertices.empty()) continue;
+			if (chunk.offset.x != origin.x || chunk.offset.y != origin.y) {
+				for (size_t i = 0; i < chunk.vertices.size(); i++) {
+					chunk.vertices[i].position.x = chunk.corners[i].x + origin.x;
+					chunk.vertices[i].position.y = chunk.corners[i].y + origin.y;
+				}
+				chunk.offset = origin;
+			}
+			result |= tileset.Geometry(chunk.vertices, chunk.indices);
+			drawnChunks++;
+#else
+			result = -1;
+#endif
+		}
+	}
+	if (result != 0) error = -1;
+	return result != 0 ? -1 : 0;
+}
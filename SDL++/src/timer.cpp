@@ -0,0 +1,114 @@
+#include "timer.hpp"
+#include <algorithm>
+#include <cmath>
+#include "video.hpp"
+
+using namespace SDL;
+
+FramePacer::FramePacer(double rate, double fixedStep) : frequency(SDL_GetPerformanceFrequency()) {
+	history.reserve(HISTORY);
+	sorted.reserve(HISTORY);
+	SetTargetRate(rate);
+	SetFixedStep(fixedStep);
+	frameStart = SDL_GetPerformanceCounter();
+	deadline = frameStart + period;
+}
+
+void FramePacer::SetTargetRate(double rate) {
+	this->rate = rate > 0 ? rate : 0;
+	period = rate > 0 ? (Uint64)(frequency / rate) : 0;
+	deadline = frameStart + period;
+	if (defaultStep) fixedStep = rate > 0 ? 1.0 / rate : 1.0 / 60;
+}
+
+int FramePacer::MatchDisplay(Display display) {
+	Display::Mode mode;
+	int error = display.GetCurrentMode(mode);
+	if (error != 0) return error;
+	if (mode.refresh_rate > 0) SetTargetRate(mode.refresh_rate);
+	return 0;
+}
+
+void FramePacer::SetFixedStep(double seconds) {
+	defaultStep = seconds <= 0;
+	if (defaultStep) fixedStep = rate > 0 ? 1.0 / rate : 1.0 / 60;
+	else fixedStep = seconds;
+}
+
+void FramePacer::Sleep(Uint64 until) {
+	// Sleep in whole milliseconds while even a long Delay(1) would end in time
+	for (;;) {
+		Uint64 now = SDL_GetPerformanceCounter();
+		if (now >= until || (double)(until - now) / frequency <= sleepEstimate) break;
+
+		SDL_Delay(1);
+		double slept = (double)(SDL_GetPerformanceCounter() - now) / frequency;
+
+		// Welford's running variance; the estimate sits a standard deviation above the mean
+		sleepCount++;
+		double delta = slept - sleepMean;
+		sleepMean += delta / sleepCount;
+		sleepM2 += delta * (slept - sleepMean);
+		sleepEstimate = sleepMean + std::sqrt(sleepM2 / (sleepCount - 1));
+
+		// Forget old samples so the estimate follows changes in the system timer
+		if (sleepCount > 1000) {
+			sleepCount = 1;
+			sleepM2 = 0;
+		}
+	}
+
+	// Spin for the remainder
+	while (SDL_GetPerformanceCounter() < until) {}
+}
+
+double FramePacer::Wait() {
+	if (period) Sleep(deadline);
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	frameTime = (double)(now - frameStart) / frequency;
+	frameStart = now;
+
+	// Keep to the schedule unless a whole period has been missed
+	deadline += period;
+	if (deadline < now) deadline = now + period;
+
+	accumulator = std::min(accumulator + frameTime, MAX_ACCUMULATED);
+
+	if ((int)history.size() < HISTORY) history.push_back(frameTime);
+	else history[historyNext] = frameTime;
+	historyNext = (historyNext + 1) % HISTORY;
+
+	return frameTime;
+}
+
+bool FramePacer::Step() {
+	if (accumulator < fixedStep) return false;
+	accumulator -= fixedStep;
+	return true;
+}
+
+FramePacer::Stats FramePacer::GetStats() const {
+	Stats stats;
+	if (history.empty()) return stats;
+
+	sorted.assign(history.begin(), history.end());
+	std::sort(sorted.begin(), sorted.end());
+
+	auto Percentile = [this](double p) { return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)]; };
+
+	stats.frames = (int)sorted.size();
+	stats.min = sorted.front();
+	stats.max = sorted.back();
+	for (double t : sorted) stats.mean += t;
+	stats.mean /= sorted.size();
+	stats.p50 = Percentile(0.50);
+	stats.p95 = Percentile(0.95);
+	stats.p99 = Percentile(0.99);
+	return stats;
+}
+
+void FramePacer::ResetStats() {
+	history.clear();
+	historyNext = 0;
+}
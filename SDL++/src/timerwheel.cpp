@@ -0,0 +1,235 @@
+#include "timerwheel.hpp"
+#include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace SDL;
+
+// The index of the lowest set bit, which must exist
+static int LowestBit(Uint64 x) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (int)index;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+TimerWheel::TimerWheel() : start(SDL_GetPerformanceCounter()), frequency(SDL_GetPerformanceFrequency()) {
+	for (auto& level : slots)
+		for (int& slot : level) slot = -1;
+}
+
+Uint64 TimerWheel::Now() const {
+	// Split so the multiply cannot overflow
+	Uint64 ticks = SDL_GetPerformanceCounter() - start;
+	return ticks / frequency * 1000000 + ticks % frequency * 1000000 / frequency;
+}
+
+int TimerWheel::Find(ID id) const {
+	Uint32 index = (Uint32)id - 1;
+	if (index >= nodes.size()) return -1;
+
+	const Node& node = nodes[index];
+	if (node.generation != (Uint32)(id >> 32) || node.state == State::FREE || node.cancelled) return -1;
+	return (int)index;
+}
+
+int TimerWheel::Allocate() {
+	int index = freeNode;
+	if (index == -1) {
+		index = (int)nodes.size();
+		nodes.emplace_back();
+	}
+	else freeNode = nodes[index].next;
+
+	count++;
+	return index;
+}
+
+void TimerWheel::Free(int index) {
+	Node& node = nodes[index];
+	node.callback = nullptr;
+	node.generation++;
+	node.state = State::FREE;
+	node.cancelled = false;
+	node.prev = -1;
+	node.next = freeNode;
+	freeNode = index;
+	count--;
+}
+
+void TimerWheel::Link(int index) {
+	Node& node = nodes[index];
+	if (node.expiry < current) node.expiry = current;
+
+	// Pick the level by how far away the timer is, and the slot by its expiry
+	Uint64 expiry = node.expiry;
+	Uint64 delta = expiry - current;
+	if (delta >= RANGE) {
+		expiry = current + RANGE - 1;
+		delta = RANGE - 1;
+	}
+	int level = 0;
+	while (delta >= (Uint64)SLOTS << (BITS * level)) level++;
+	int slot = (int)(expiry >> (BITS * level)) & (SLOTS - 1);
+
+	node.state = State::SCHEDULED;
+	node.level = level;
+	node.slot = slot;
+	node.prev = -1;
+	node.next = slots[level][slot];
+	if (node.next != -1) nodes[node.next].prev = index;
+	slots[level][slot] = index;
+	occupied[level] |= (Uint64)1 << slot;
+}
+
+void TimerWheel::Unlink(int index) {
+	Node& node = nodes[index];
+	if (node.prev != -1) nodes[node.prev].next = node.next;
+	else {
+		slots[node.level][node.slot] = node.next;
+		if (node.next == -1) occupied[node.level] &= ~((Uint64)1 << node.slot);
+	}
+	if (node.next != -1) nodes[node.next].prev = node.prev;
+	node.prev = node.next = -1;
+}
+
+void TimerWheel::Cascade(int level) {
+	// Spread the slot of each level that has just come round over the levels below
+	for (; level < LEVELS; level++) {
+		int slot = (int)(current >> (BITS * level)) & (SLOTS - 1);
+
+		int index = slots[level][slot];
+		slots[level][slot] = -1;
+		occupied[level] &= ~((Uint64)1 << slot);
+		while (index != -1) {
+			int next = nodes[index].next;
+			Link(index);
+			index = next;
+		}
+
+		if (slot != 0) break;
+	}
+}
+
+Uint64 TimerWheel::NextTick() const {
+	// The earliest tick after the current one with a slot to run or cascade
+	Uint64 next = ~(Uint64)0;
+	for (int level = 0; level < LEVELS; level++) {
+		int shift = BITS * level;
+		int pos = (int)(current >> shift) & (SLOTS - 1);
+		Uint64 turn = current >> (shift + BITS);
+
+		Uint64 later = pos == SLOTS - 1 ? 0 : occupied[level] & (~(Uint64)0 << (pos + 1));
+		if (later) next = std::min(next, ((turn << BITS) | LowestBit(later)) << shift);
+		// Slots up to pos come round in the next turn of this level
+		else if (occupied[level]) next = std::min(next, (turn + 1) << (shift + BITS));
+	}
+	return next;
+}
+
+Uint64 TimerWheel::NextDue() const {
+	if (count == 0) return ~(Uint64)0;
+	// Timers that were due when added wait in the slot of the current tick
+	if (occupied[0] & ((Uint64)1 << (current & (SLOTS - 1)))) return current;
+	return NextTick();
+}
+
+TimerWheel::ID TimerWheel::Add(Uint64 delay, Callback callback, Uint64 period) { return AddAt(Time() + delay, std::move(callback), period); }
+
+TimerWheel::ID TimerWheel::AddAt(Uint64 time, Callback callback, Uint64 period) {
+	int index = Allocate();
+	Node& node = nodes[index];
+	node.expiry = time;
+	node.period = period;
+	node.callback = std::move(callback);
+	Link(index);
+	return MakeID(index);
+}
+
+bool TimerWheel::Cancel(ID id) {
+	int index = Find(id);
+	if (index == -1) return false;
+
+	switch (nodes[index].state) {
+	case State::SCHEDULED:
+		Unlink(index);
+		Free(index);
+		break;
+	case State::DUE:
+		Free(index);
+		break;
+	case State::RUNNING:
+		// Freed once its callback returns
+		nodes[index].cancelled = true;
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+bool TimerWheel::Pending(ID id) const { return Find(id) != -1; }
+
+void TimerWheel::Clear() {
+	for (int i = 0; i < (int)nodes.size(); i++) {
+		if (nodes[i].state == State::FREE) continue;
+		Cancel(MakeID(i));
+	}
+}
+
+int TimerWheel::Advance(Uint64 time) {
+	due.clear();
+
+	while (current <= time) {
+		int slot = (int)current & (SLOTS - 1);
+		if (slot == 0) Cascade(1);
+
+		int index = slots[0][slot];
+		slots[0][slot] = -1;
+		occupied[0] &= ~((Uint64)1 << slot);
+		while (index != -1) {
+			int next = nodes[index].next;
+			// Timers beyond the wheel's range come round before they are due
+			if (nodes[index].expiry > current) Link(index);
+			else {
+				nodes[index].state = State::DUE;
+				nodes[index].prev = nodes[index].next = -1;
+				due.push_back(MakeID(index));
+			}
+			index = next;
+		}
+
+		current = std::min(NextTick(), time + 1);
+	}
+
+	// Run the batch only once the wheel has moved, so callbacks can add timers freely
+	int ran = 0;
+	for (size_t i = 0; i < due.size(); i++) {
+		int index = Find(due[i]);
+		// Cancelled by an earlier callback
+		if (index == -1 || nodes[index].state != State::DUE) continue;
+
+		Node& node = nodes[index];
+		ran++;
+		if (node.period == 0) {
+			Callback callback = std::move(node.callback);
+			Free(index);
+			callback();
+			continue;
+		}
+
+		node.state = State::RUNNING;
+		node.callback();
+		if (node.cancelled) Free(index);
+		else {
+			node.expiry += node.period;
+			Link(index);
+		}
+	}
+
+	return ran;
+}
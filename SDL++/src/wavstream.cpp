@@ -0,0 +1,169 @@
+#include "wavstream.hpp"
+#include <algorithm>
+#include <cstring>
+#include "error.hpp"
+
+using namespace SDL;
+
+static constexpr Uint16 WAVE_FORMAT_PCM = 0x0001;
+static constexpr Uint16 WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+static constexpr Uint16 WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+static Uint32 FourCC(const char* id) { return (Uint32)id[0] | (Uint32)id[1] << 8 | (Uint32)id[2] << 16 | (Uint32)id[3] << 24; }
+
+WAVStream::WAVStream(const std::string& file, const AudioSpec& output, bool loop, double bufferSeconds)
+	: WAVStream(SDL_RWFromFile(file.c_str(), "rb"), true, output, loop, bufferSeconds) {}
+
+WAVStream::WAVStream(const void* mem, size_t size, const AudioSpec& output, bool loop, double bufferSeconds)
+	: WAVStream(SDL_RWFromConstMem(mem, (int)size), true, output, loop, bufferSeconds) {}
+
+WAVStream::WAVStream(SDL_RWops* src, bool freesrc, const AudioSpec& output, bool loop, double bufferSeconds)
+	: src(src), freesrc(freesrc), loop(loop), ring(RingSize(output, bufferSeconds)) {
+	SDL_zero(source);
+	Open(output);
+	// Nothing will ever be read, so a voice playing it ends straight away
+	if (!reader.joinable()) done.store(true, std::memory_order_release);
+}
+
+WAVStream::~WAVStream() {
+	stopping.store(true, std::memory_order_relaxed);
+	if (reader.joinable()) reader.join();
+	if (src != NULL && freesrc) SDL_RWclose(src);
+}
+
+size_t WAVStream::RingSize(const AudioSpec& output, double bufferSeconds) {
+	return std::max((size_t)(output.freq * bufferSeconds) * 2, (size_t)CHUNK_FRAMES * 2);
+}
+
+double WAVStream::Duration() const { return blockAlign && source.freq ? (double)dataLength / blockAlign / source.freq : 0; }
+
+void WAVStream::Open(const AudioSpec& output) {
+	if (src == NULL || ParseHeader() != 0) return;
+
+	stream.reset(new AudioStream(AudioFormat{ source.format }, source.channels, source.freq, F32SYS, 2, output.freq));
+	if (stream->stream == NULL) return;
+
+	chunk.resize((size_t)CHUNK_FRAMES * blockAlign);
+	if (packed24) widened.resize((size_t)CHUNK_FRAMES * source.channels * 4);
+	converted.resize((size_t)CHUNK_FRAMES * 2);
+	reader = std::thread(&WAVStream::Run, this);
+}
+
+int WAVStream::ParseHeader() {
+	if (SDL_ReadLE32(src) != FourCC("RIFF")) return SetError("Not a RIFF file");
+	SDL_ReadLE32(src);
+	if (SDL_ReadLE32(src) != FourCC("WAVE")) return SetError("Not a WAVE file");
+
+	Uint16 tag = 0, bits = 0;
+	bool haveFormat = false;
+	for (;;) {
+		Uint32 id = SDL_ReadLE32(src);
+		Uint32 size = SDL_ReadLE32(src);
+		Sint64 start = SDL_RWtell(src);
+		if (id == 0 && size == 0) return SetError("WAV file has no data chunk");
+
+		if (id == FourCC("fmt ")) {
+			if (size < 16) return SetError("WAV format chunk is too short");
+			tag = SDL_ReadLE16(src);
+			source.channels = (Uint8)SDL_ReadLE16(src);
+			source.freq = (int)SDL_ReadLE32(src);
+			SDL_ReadLE32(src);
+			blockAlign = SDL_ReadLE16(src);
+			bits = SDL_ReadLE16(src);
+			// The real format of an extensible file is the start of its sub-format GUID
+			if (tag == WAVE_FORMAT_EXTENSIBLE && size >= 40) {
+				SDL_RWseek(src, 8, RW_SEEK_CUR);
+				tag = SDL_ReadLE16(src);
+			}
+			haveFormat = true;
+		}
+		else if (id == FourCC("data")) {
+			if (!haveFormat) return SetError("WAV data chunk comes before its format");
+			dataStart = start;
+			dataLength = size;
+			break;
+		}
+
+		// Chunks are padded to an even length
+		if (SDL_RWseek(src, start + size + (size & 1), RW_SEEK_SET) < 0) return SetError("WAV file has no data chunk");
+	}
+
+	if (tag == WAVE_FORMAT_PCM && bits == 8) source.format = AUDIO_U8;
+	else if (tag == WAVE_FORMAT_PCM && bits == 16) source.format = AUDIO_S16LSB;
+	else if (tag == WAVE_FORMAT_PCM && bits == 24) packed24 = true;
+	else if (tag == WAVE_FORMAT_PCM && bits == 32) source.format = AUDIO_S32LSB;
+	else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) source.format = AUDIO_F32LSB;
+	else return SetError("Streaming WAV format 0x%04x with %d bit samples is not supported", tag, bits);
+	// 24 bit samples are widened as they are read
+	if (packed24) source.format = AUDIO_S32LSB;
+
+	if (source.channels == 0 || source.freq <= 0 || blockAlign != source.channels * bits / 8) return SetError("WAV format chunk is invalid");
+	dataLength -= dataLength % blockAlign;
+	return 0;
+}
+
+bool WAVStream::Drain() {
+	// Move converted audio into the ring, whole frames at a time
+	for (;;) {
+		size_t space = std::min(ring.Space() & ~(size_t)1, converted.size());
+		if (space == 0) return stream->Available() == 0;
+
+		int bytes = stream->Get(converted.data(), (int)(space * sizeof(float)));
+		if (bytes <= 0) return true;
+		ring.Write(converted.data(), bytes / sizeof(float));
+	}
+}
+
+void WAVStream::Run() {
+	Sint64 remaining = dataLength;
+	bool flushed = false;
+	// Whether the pass through the data since the last seek read anything
+	bool readAny = false;
+	while (!stopping.load(std::memory_order_relaxed)) {
+		// Wait for the audio thread while the ring is full
+		if (!Drain()) {
+			SDL_Delay(2);
+			continue;
+		}
+		if (flushed) break;
+
+		if (remaining == 0) {
+			// Keep feeding the same stream, so the resampler runs on across the loop.
+			// A pass that read nothing would only read nothing again, so it ends.
+			if (loop && readAny && SDL_RWseek(src, dataStart, RW_SEEK_SET) >= 0) {
+				remaining = dataLength;
+				readAny = false;
+			}
+			else {
+				stream->Flush();
+				flushed = true;
+			}
+			continue;
+		}
+
+		size_t want = (size_t)std::min<Sint64>(remaining, (Sint64)chunk.size());
+		size_t got = SDL_RWread(src, chunk.data(), 1, want);
+		got -= got % blockAlign;
+		if (got == 0) {
+			// Truncated file
+			remaining = 0;
+			continue;
+		}
+		remaining -= got;
+		readAny = true;
+
+		if (packed24) {
+			// SDL has no 24 bit format, so widen to 32 bits
+			size_t samples = got / 3;
+			for (size_t i = 0; i < samples; i++) {
+				widened[i * 4] = 0;
+				memcpy(&widened[i * 4 + 1], &chunk[i * 3], 3);
+			}
+			stream->Put(widened.data(), (int)(samples * 4));
+		}
+		else stream->Put(chunk.data(), (int)got);
+	}
+	done.store(true, std::memory_order_release);
+}
+
+int WAVStream::Read(float* stereo, int frames) { return (int)(ring.Read(stereo, (size_t)frames * 2) / 2); }
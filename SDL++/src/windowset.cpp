@@ -0,0 +1,109 @@
+#include "windowset.hpp"
+#include "profiler.hpp"
+
+using namespace SDL;
+
+WindowSet::Output::Output(const std::string& title, const Rect& shape, Uint32 windowFlags, Uint32 rendererFlags)
+	: window(title, shape, windowFlags), renderer(window, rendererFlags) {}
+
+WindowSet& WindowSet::FlushError() { error = 0; return *this; }
+
+int WindowSet::Add(const std::string& title, const Rect& shape, Uint32 windowFlags, Uint32 rendererFlags) {
+	// Only the first window waits on vsync, and the others are paced by the clock
+	if (!outputs.empty()) rendererFlags &= ~SDL_RENDERER_PRESENTVSYNC;
+
+	std::unique_ptr<Output> output(new Output(title, shape, windowFlags, rendererFlags));
+	if (output->window.window == NULL || output->renderer.renderer == NULL) {
+		error = -1;
+		return -1;
+	}
+	Renderer::Info info;
+	output->vsync = SDL_GetRendererInfo(output->renderer.renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+
+	outputs.push_back(std::move(output));
+	UpdateRefreshRates();
+	return (int)outputs.size() - 1;
+}
+
+int WindowSet::Find(Uint32 windowID) const {
+	for (size_t i = 0; i < outputs.size(); i++)
+		if (SDL_GetWindowID(outputs[i]->window.window) == windowID) return (int)i;
+	return -1;
+}
+
+WindowSet& WindowSet::Submit(size_t index) {
+	Output& output = *outputs[index];
+	if (output.submitted) output.dropped++;
+	std::swap(output.recording, output.pending);
+	output.submitted = true;
+	// Either a frame that was dropped or one already presented
+	output.recording->Clear();
+	return *this;
+}
+
+WindowSet& WindowSet::SubmitAll() {
+	for (size_t i = 0; i < outputs.size(); i++) Submit(i);
+	return *this;
+}
+
+int WindowSet::Draw(Output& output) {
+	int result = output.pending->Replay(output.renderer, sort);
+	output.renderer.Present();
+	output.presented++;
+	output.submitted = false;
+	if (result < 0) error = -1;
+	return result;
+}
+
+void WindowSet::Schedule(Output& output, Uint64 now, Uint64 frequency) {
+	Uint64 period = frequency / PacingRate(output);
+	// Late frames start a new schedule instead of hurrying to catch up
+	output.deadline = output.deadline + period > now ? output.deadline + period : now + period;
+}
+
+void WindowSet::SleepUntilDue(Output& output, Uint64 frequency) {
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (output.deadline > now) SDL_Delay((Uint32)((output.deadline - now) * 1000 / frequency));
+	Schedule(output, SDL_GetPerformanceCounter(), frequency);
+}
+
+int WindowSet::Present() {
+	SDLPP_PROFILE_ZONE("WindowSet::Present");
+	if (outputs.empty()) return 0;
+
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 now = SDL_GetPerformanceCounter();
+	// Calls come once per refresh of the first display, so a window due within
+	// half of one is presented now rather than a whole refresh late
+	Output& first = *outputs[0];
+	Uint64 slack = frequency / PacingRate(first) / 2;
+
+	int result = 0;
+	for (size_t i = 1; i < outputs.size(); i++) {
+		Output& output = *outputs[i];
+		if (!output.submitted) continue;
+		// Not due, so the frame waits and may be replaced by a newer one
+		if (now + slack < output.deadline) continue;
+		Schedule(output, now, frequency);
+		if (Draw(output) < 0) result = -1;
+	}
+
+	// With vsync the present waits for the refresh.  Without it, or without a
+	// frame to present, the call sleeps instead, so a loop around it never spins
+	if (!first.submitted || !first.vsync) SleepUntilDue(first, frequency);
+	if (first.submitted) {
+		if (Draw(first) < 0) result = -1;
+		// The next refresh, for a call without a frame to sleep until
+		if (first.vsync) Schedule(first, SDL_GetPerformanceCounter(), frequency);
+	}
+	return result;
+}
+
+WindowSet& WindowSet::UpdateRefreshRates() {
+	for (auto& output : outputs) {
+		Display display = output->window.GetDisplay();
+		Display::Mode mode;
+		output->refreshRate = display.index >= 0 && display.GetCurrentMode(mode) == 0 ? mode.refresh_rate : 0;
+	}
+	return *this;
+}